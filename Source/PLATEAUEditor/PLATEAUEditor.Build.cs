@@ -48,8 +48,11 @@ public class PLATEAUEditor : ModuleRules
                 "FBX",
                 "Engine",
                 "InputCore",
+                "Json",
+                "JsonUtilities",
                 "LevelEditor",
                 "UnrealEd",
+                "ImageWrapper",
                 "EditorStyle",
                 "PLATEAURuntime",
                 "PropertyEditor",
@@ -0,0 +1,470 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Commandlet/PLATEAUConvertDatasetCommandlet.h"
+
+#include "AssetCompilingManager.h"
+#include "EngineUtils.h"
+#include "JsonObjectConverter.h"
+#include "PLATEAUCityModelLoader.h"
+#include "PLATEAUExportSettings.h"
+#include "PLATEAUImportSettings.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUMeshExporter.h"
+#include "Dataset/PLATEAUDatasetArchive.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+#include <plateau/dataset/dataset_source.h>
+#include <plateau/dataset/i_dataset_accessor.h>
+#include <plateau/dataset/mesh_code.h>
+
+DEFINE_LOG_CATEGORY_STATIC(LogPLATEAUConvertDataset, Log, All);
+
+namespace {
+    /**
+     * @brief コマンドライン引数から読み取った変換設定です。
+     */
+    struct FConvertOptions {
+        FString Source;
+        TArray<FString> MeshCodes;
+        FString ImportSettingsPath;
+        TArray<FString> Packages;
+        int MinLod = -1;
+        int MaxLod = -1;
+        FString Granularity;
+        bool bNoTextures = false;
+        bool bNoAttrInfo = false;
+        bool bNoCollision = false;
+        //! GMLファイルをプロジェクトにコピーせずに読み込む
+        bool bNoCopy = false;
+        int ZoneID = 9;
+        TOptional<FVector> ReferencePoint;
+
+        //! 保存するマップのパッケージ名(/Game/...)。メッシュコードごとに"_{メッシュコード}"を付けて保存します。
+        FString OutputMap;
+        //! モデル出力先フォルダ。メッシュコードごとにサブフォルダを作成します。
+        FString ExportDir;
+        FPLATEAUMeshExportOptions ExportOptions;
+
+        int ShardCount = 1;
+        int ShardIndex = 0;
+        bool bResume = false;
+        FString StateDir;
+        //! 1つのメッシュコードの読み込みを待つ最大秒数。0以下の場合は無制限です。
+        double TimeoutSeconds = 3600.0;
+    };
+
+    //! 読み込みを中断した後、中断の完了を待つ最大秒数
+    constexpr double CancelTimeoutSeconds = 60.0;
+
+    bool ParseOptions(const FString& Params, FConvertOptions& OutOptions) {
+        if (!FParse::Value(*Params, TEXT("Source="), OutOptions.Source))
+            return false;
+
+        FString MeshCodes;
+        if (FParse::Value(*Params, TEXT("MeshCodes="), MeshCodes, false))
+            MeshCodes.ParseIntoArray(OutOptions.MeshCodes, TEXT(","));
+        FString MeshCodesFile;
+        if (FParse::Value(*Params, TEXT("MeshCodesFile="), MeshCodesFile)) {
+            TArray<FString> Lines;
+            FFileHelper::LoadFileToStringArray(Lines, *MeshCodesFile);
+            for (const auto& Line : Lines) {
+                if (!Line.TrimStartAndEnd().IsEmpty())
+                    OutOptions.MeshCodes.Add(Line.TrimStartAndEnd());
+            }
+        }
+
+        FParse::Value(*Params, TEXT("ImportSettings="), OutOptions.ImportSettingsPath);
+        FString Packages;
+        if (FParse::Value(*Params, TEXT("Packages="), Packages, false))
+            Packages.ParseIntoArray(OutOptions.Packages, TEXT(","));
+        FParse::Value(*Params, TEXT("MinLod="), OutOptions.MinLod);
+        FParse::Value(*Params, TEXT("MaxLod="), OutOptions.MaxLod);
+        FParse::Value(*Params, TEXT("Granularity="), OutOptions.Granularity);
+        OutOptions.bNoTextures = FParse::Param(*Params, TEXT("NoTextures"));
+        OutOptions.bNoAttrInfo = FParse::Param(*Params, TEXT("NoAttrInfo"));
+        OutOptions.bNoCollision = FParse::Param(*Params, TEXT("NoCollision"));
+        OutOptions.bNoCopy = FParse::Param(*Params, TEXT("NoCopy"));
+        FParse::Value(*Params, TEXT("ZoneID="), OutOptions.ZoneID);
+        FString ReferencePoint;
+        if (FParse::Value(*Params, TEXT("ReferencePoint="), ReferencePoint, false)) {
+            TArray<FString> Values;
+            ReferencePoint.ParseIntoArray(Values, TEXT(","));
+            if (Values.Num() != 3)
+                return false;
+            OutOptions.ReferencePoint = FVector(FCString::Atod(*Values[0]), FCString::Atod(*Values[1]), FCString::Atod(*Values[2]));
+        }
+
+        FParse::Value(*Params, TEXT("OutputMap="), OutOptions.OutputMap);
+        FParse::Value(*Params, TEXT("ExportDir="), OutOptions.ExportDir);
+        if (OutOptions.OutputMap.IsEmpty() && OutOptions.ExportDir.IsEmpty())
+            return false;
+
+        FString Format;
+        if (FParse::Value(*Params, TEXT("Format="), Format)) {
+            const auto FormatValue = StaticEnum<EMeshFileFormat>()->GetValueByNameString(Format);
+            if (FormatValue == INDEX_NONE)
+                return false;
+            OutOptions.ExportOptions.FileFormat = static_cast<EMeshFileFormat>(FormatValue);
+        }
+        FString TransformType;
+        if (FParse::Value(*Params, TEXT("TransformType="), TransformType)) {
+            const auto TransformTypeValue = StaticEnum<EMeshTransformType>()->GetValueByNameString(TransformType);
+            if (TransformTypeValue == INDEX_NONE)
+                return false;
+            OutOptions.ExportOptions.TransformType = static_cast<EMeshTransformType>(TransformTypeValue);
+        }
+        FString CoordinateSystem;
+        if (FParse::Value(*Params, TEXT("CoordinateSystem="), CoordinateSystem)) {
+            const auto CoordinateSystemValue = StaticEnum<ECoordinateSystem>()->GetValueByNameString(CoordinateSystem);
+            if (CoordinateSystemValue == INDEX_NONE)
+                return false;
+            OutOptions.ExportOptions.CoordinateSystem = static_cast<ECoordinateSystem>(CoordinateSystemValue);
+        }
+        OutOptions.ExportOptions.bExportAsBinary = FParse::Param(*Params, TEXT("Binary"));
+        OutOptions.ExportOptions.bExportHiddenObjects = FParse::Param(*Params, TEXT("ExportHidden"));
+        OutOptions.ExportOptions.bExportTexture = !FParse::Param(*Params, TEXT("NoExportTextures"));
+
+        FParse::Value(*Params, TEXT("ShardCount="), OutOptions.ShardCount);
+        FParse::Value(*Params, TEXT("ShardIndex="), OutOptions.ShardIndex);
+        if (OutOptions.ShardCount < 1 || OutOptions.ShardIndex < 0 || OutOptions.ShardIndex >= OutOptions.ShardCount)
+            return false;
+        OutOptions.bResume = FParse::Param(*Params, TEXT("Resume"));
+        FParse::Value(*Params, TEXT("Timeout="), OutOptions.TimeoutSeconds);
+
+        if (!FParse::Value(*Params, TEXT("StateDir="), OutOptions.StateDir)) {
+            // 同じ入出力の組み合わせであれば同じ状態フォルダを使用する
+            const auto Key = FMD5::HashAnsiString(*(OutOptions.Source + TEXT("|") + OutOptions.OutputMap + TEXT("|") + OutOptions.ExportDir));
+            OutOptions.StateDir = FPaths::ProjectSavedDir() / TEXT("PLATEAU/Convert") / Key;
+        }
+        return true;
+    }
+
+    UPLATEAUImportSettings* CreateImportSettings(const FConvertOptions& Options) {
+        const auto ImportSettings = DuplicateObject(GetMutableDefault<UPLATEAUImportSettings>(), GetTransientPackage());
+        ImportSettings->AddToRoot();
+
+        if (!Options.ImportSettingsPath.IsEmpty()) {
+            FString Json;
+            if (!FFileHelper::LoadFileToString(Json, *Options.ImportSettingsPath)) {
+                UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Failed to read import settings: %s"), *Options.ImportSettingsPath);
+                return nullptr;
+            }
+            TSharedPtr<FJsonObject> JsonObject;
+            if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), JsonObject) ||
+                !FJsonObjectConverter::JsonObjectToUStruct(JsonObject.ToSharedRef(), UPLATEAUImportSettings::StaticClass(), ImportSettings)) {
+                UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Failed to parse import settings: %s"), *Options.ImportSettingsPath);
+                return nullptr;
+            }
+        }
+
+        TArray<plateau::dataset::PredefinedCityModelPackage> TargetPackages;
+        for (const auto& Package : Options.Packages) {
+            TargetPackages.Add(plateau::dataset::UdxSubFolder::getPackage(TCHAR_TO_UTF8(*Package)));
+        }
+
+        const auto Granularity = Options.Granularity.IsEmpty() ? INDEX_NONE : StaticEnum<EPLATEAUMeshGranularity>()->GetValueByNameString(Options.Granularity);
+        if (!Options.Granularity.IsEmpty() && Granularity == INDEX_NONE) {
+            UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Invalid granularity: %s"), *Options.Granularity);
+            return nullptr;
+        }
+
+        for (const auto& Package : UPLATEAUImportSettings::GetAllPackages()) {
+            auto& Feature = ImportSettings->GetFeatureSettingsRef(Package);
+            if (TargetPackages.Num() > 0)
+                Feature.bImport = TargetPackages.Contains(Package);
+            if (Options.MinLod >= 0)
+                Feature.MinLod = Options.MinLod;
+            if (Options.MaxLod >= 0)
+                Feature.MaxLod = Options.MaxLod;
+            if (Granularity != INDEX_NONE)
+                Feature.MeshGranularity = static_cast<EPLATEAUMeshGranularity>(Granularity);
+            if (Options.bNoTextures)
+                Feature.bImportTexture = false;
+            if (Options.bNoAttrInfo)
+                Feature.bIncludeAttrInfo = false;
+            if (Options.bNoCollision)
+                Feature.bSetCollider = false;
+        }
+        return ImportSettings;
+    }
+
+    /**
+     * @brief 処理対象のメッシュコードのうち、このプロセスが担当するものを返します。
+     * 全プロセスで同じ割り当てとなるよう、ソート後のインデックスで分配します。
+     */
+    TArray<FString> GetShardMeshCodes(TArray<FString> MeshCodes, const int ShardCount, const int ShardIndex) {
+        MeshCodes.Sort();
+        TArray<FString> ShardMeshCodes;
+        for (int i = ShardIndex; i < MeshCodes.Num(); i += ShardCount) {
+            ShardMeshCodes.Add(MeshCodes[i]);
+        }
+        return ShardMeshCodes;
+    }
+
+    /**
+     * @brief zipアーカイブ内のGMLファイルからメッシュコードを求めます。
+     */
+    bool GetArchiveMeshCodes(const FConvertOptions& Options, TArray<FString>& InOutMeshCodes) {
+        const auto Archive = FPLATEAUDatasetArchive::Get(Options.Source);
+        if (!Archive.IsValid()) {
+            UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Failed to open dataset archive %s"), *Options.Source);
+            return false;
+        }
+
+        if (InOutMeshCodes.Num() == 0)
+            InOutMeshCodes = Archive->GetMeshCodes().Array();
+        return true;
+    }
+
+    /**
+     * @brief 基準点を設定します。
+     * 指定が無い場合は、全シャードで同じ基準点を使用するため、シャード分割前の全メッシュコードの範囲の中心を基準点とします。
+     * データセットの形式(フォルダ、zipアーカイブ)によらず同じ基準点となります。
+     */
+    void SetReferencePoint(const FConvertOptions& Options, const TArray<FString>& AllMeshCodes, FPLATEAUGeoReference& OutGeoReference) {
+        if (Options.ReferencePoint.IsSet()) {
+            OutGeoReference.ReferencePoint = Options.ReferencePoint.GetValue();
+        }
+        else if (AllMeshCodes.Num() > 0) {
+            auto Extent = plateau::dataset::MeshCode(TCHAR_TO_UTF8(*AllMeshCodes[0])).getExtent();
+            for (const auto& MeshCode : AllMeshCodes) {
+                const auto MeshCodeExtent = plateau::dataset::MeshCode(TCHAR_TO_UTF8(*MeshCode)).getExtent();
+                Extent.min.latitude = FMath::Min(Extent.min.latitude, MeshCodeExtent.min.latitude);
+                Extent.min.longitude = FMath::Min(Extent.min.longitude, MeshCodeExtent.min.longitude);
+                Extent.max.latitude = FMath::Max(Extent.max.latitude, MeshCodeExtent.max.latitude);
+                Extent.max.longitude = FMath::Max(Extent.max.longitude, MeshCodeExtent.max.longitude);
+            }
+            OutGeoReference.UpdateNativeData();
+            const auto CenterPoint = OutGeoReference.GetData().project(Extent.centerPoint());
+            OutGeoReference.ReferencePoint = FVector(CenterPoint.x, CenterPoint.y, 0);
+        }
+        OutGeoReference.UpdateNativeData();
+    }
+
+    FString GetStateFilePath(const FConvertOptions& Options, const FString& MeshCode, const TCHAR* Extension) {
+        return Options.StateDir / MeshCode + Extension;
+    }
+
+    /**
+     * @brief ワーカースレッドからゲームスレッドに投げられるタスクを処理しながら読み込み完了を待ちます。
+     * @param TimeoutSeconds 最大待ち時間(秒)。0以下の場合は無制限です。
+     * @return 時間内に完了した場合true
+     */
+    bool WaitForPhase(const APLATEAUCityModelLoader& Loader, const double TimeoutSeconds) {
+        const double StartSeconds = FPlatformTime::Seconds();
+        double LastTickSeconds = StartSeconds;
+        while (Loader.Phase != ECityModelLoadingPhase::Finished) {
+            FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+            const auto CurrentSeconds = FPlatformTime::Seconds();
+            FTSTicker::GetCoreTicker().Tick(CurrentSeconds - LastTickSeconds);
+            LastTickSeconds = CurrentSeconds;
+            if (TimeoutSeconds > 0.0 && CurrentSeconds - StartSeconds > TimeoutSeconds)
+                return false;
+            FPlatformProcess::Sleep(0.01f);
+        }
+        FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+        FAssetCompilingManager::Get().FinishAllCompilation();
+        return true;
+    }
+
+    /**
+     * @brief 読み込み完了を待ちます。時間内に完了しない場合は読み込みを中断します。
+     * @param bOutCancelCompleted 中断した場合に、中断が完了したかどうか。完了していない場合はワーカースレッドが実行中のため、ワールドを破棄できません。
+     * @return 時間内に完了した場合true
+     */
+    bool WaitForLoad(APLATEAUCityModelLoader& Loader, const double TimeoutSeconds, bool& bOutCancelCompleted) {
+        bOutCancelCompleted = true;
+        if (WaitForPhase(Loader, TimeoutSeconds))
+            return true;
+
+        Loader.Cancel();
+        bOutCancelCompleted = WaitForPhase(Loader, CancelTimeoutSeconds);
+        return false;
+    }
+
+    /**
+     * @brief 1つのメッシュコードについてインポートと出力を行います。
+     * @param OutFailedGmls 読み込みに失敗したGMLファイル名
+     * @param bOutTimedOut 読み込みが時間内に完了しなかった場合true
+     */
+    bool ConvertMeshCode(const FConvertOptions& Options, const FString& MeshCode, const FPLATEAUGeoReference& GeoReference,
+                         UPLATEAUImportSettings* ImportSettings, TArray<FString>& OutFailedGmls, bool& bOutTimedOut) {
+        UPackage* MapPackage = nullptr;
+        FString MapPackageName;
+        if (!Options.OutputMap.IsEmpty()) {
+            MapPackageName = Options.OutputMap + TEXT("_") + MeshCode;
+            MapPackage = CreatePackage(*MapPackageName);
+        }
+
+        UWorld* World = UWorld::CreateWorld(EWorldType::Editor, true,
+                                            MapPackage != nullptr ? FName(FPackageName::GetShortName(MapPackageName)) : NAME_None, MapPackage);
+        if (MapPackage != nullptr)
+            World->SetFlags(RF_Public | RF_Standalone);
+
+        const auto Loader = World->SpawnActor<APLATEAUCityModelLoader>();
+        Loader->Source = Options.Source;
+        Loader->MeshCodes = {MeshCode};
+        Loader->GeoReference = GeoReference;
+        Loader->GeoReference.UpdateNativeData();
+        Loader->ImportSettings = ImportSettings;
+        Loader->bImportFromServer = false;
+        Loader->bCopyGmlFiles = !Options.bNoCopy;
+        Loader->ClientPtr = std::make_shared<plateau::network::Client>("", "");
+        Loader->LoadAsync(false);
+        bool bCancelCompleted;
+        bOutTimedOut = !WaitForLoad(*Loader, Options.TimeoutSeconds, bCancelCompleted);
+        if (bOutTimedOut) {
+            UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Timed out loading %s after %.0f s"), *MeshCode, Options.TimeoutSeconds);
+            // 中断が完了していない場合、ワーカースレッドが参照しているためワールドは破棄しない
+            if (bCancelCompleted) {
+                GEngine->DestroyWorldContext(World);
+                World->DestroyWorld(false);
+                World->RemoveFromRoot();
+                CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+            }
+            return false;
+        }
+
+        OutFailedGmls = Loader->Status.FailedGmls;
+        bool bSucceeded = OutFailedGmls.Num() == 0;
+
+        if (!Options.ExportDir.IsEmpty()) {
+            const auto ExportPath = Options.ExportDir / MeshCode;
+            IFileManager::Get().MakeDirectory(*ExportPath, true);
+            for (TActorIterator<APLATEAUInstancedCityModel> It(World); It; ++It) {
+                if (!FPLATEAUMeshExporter().Export(ExportPath, *It, Options.ExportOptions)) {
+                    UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Failed to export %s"), *MeshCode);
+                    bSucceeded = false;
+                }
+            }
+        }
+
+        if (MapPackage != nullptr) {
+            // 読み込み用のアクタはマップに残さない
+            Loader->Destroy();
+
+            FSavePackageArgs SaveArgs;
+            SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+            SaveArgs.SaveFlags = SAVE_NoError;
+            const auto FileName = FPackageName::LongPackageNameToFilename(MapPackageName, FPackageName::GetMapPackageExtension());
+            if (!UPackage::SavePackage(MapPackage, World, *FileName, SaveArgs)) {
+                UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Failed to save %s"), *FileName);
+                bSucceeded = false;
+            }
+        }
+
+        GEngine->DestroyWorldContext(World);
+        World->DestroyWorld(false);
+        World->RemoveFromRoot();
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+        return bSucceeded;
+    }
+}
+
+UPLATEAUConvertDatasetCommandlet::UPLATEAUConvertDatasetCommandlet() {
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+    HelpDescription = TEXT("Imports a PLATEAU dataset without the editor UI and saves it as maps and/or exports it as model files.");
+    HelpUsage = TEXT("-run=PLATEAUConvertDataset -Source=<DatasetDir> (-OutputMap=/Game/Maps/<Name> | -ExportDir=<Dir>) ")
+        TEXT("[-MeshCodes=<a,b,...>] [-MeshCodesFile=<File>] [-ImportSettings=<Json>] [-Packages=bldg,tran,...] [-MinLod=] [-MaxLod=] [-Granularity=PerPrimaryFeatureObject] ")
+        TEXT("[-NoTextures] [-NoAttrInfo] [-NoCollision] [-NoCopy] [-ZoneID=9] [-ReferencePoint=X,Y,Z] [-Format=FBX|OBJ|GLTF] [-Binary] [-TransformType=Local|PlaneRect] [-CoordinateSystem=ENU|WUN|ESU|EUN] ")
+        TEXT("[-ShardCount=1] [-ShardIndex=0] [-Resume] [-StateDir=<Dir>] [-Timeout=3600]");
+}
+
+int32 UPLATEAUConvertDatasetCommandlet::Main(const FString& Params) {
+    FConvertOptions Options;
+    if (!ParseOptions(Params, Options)) {
+        UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Usage: %s"), *HelpUsage);
+        return 1;
+    }
+
+    const auto ImportSettings = CreateImportSettings(Options);
+    if (ImportSettings == nullptr)
+        return 1;
+
+    FPLATEAUGeoReference GeoReference;
+    GeoReference.ZoneID = Options.ZoneID;
+    TArray<FString> AllMeshCodes = Options.MeshCodes;
+    if (FPLATEAUDatasetArchive::IsArchivePath(Options.Source)) {
+        if (!GetArchiveMeshCodes(Options, AllMeshCodes))
+            return 1;
+    }
+    else {
+        try {
+            const auto DatasetAccessor = plateau::dataset::DatasetSource::createLocal(TCHAR_TO_UTF8(*Options.Source)).getAccessor();
+            if (AllMeshCodes.Num() == 0) {
+                for (const auto& MeshCode : DatasetAccessor->getMeshCodes()) {
+                    AllMeshCodes.Add(UTF8_TO_TCHAR(MeshCode.get().c_str()));
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Failed to open dataset %s: %s"), *Options.Source, UTF8_TO_TCHAR(e.what()));
+            return 1;
+        }
+    }
+    try {
+        SetReferencePoint(Options, AllMeshCodes, GeoReference);
+    }
+    catch (const std::exception& e) {
+        UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Failed to calculate reference point: %s"), UTF8_TO_TCHAR(e.what()));
+        return 1;
+    }
+
+    const auto ShardMeshCodes = GetShardMeshCodes(AllMeshCodes, Options.ShardCount, Options.ShardIndex);
+    IFileManager::Get().MakeDirectory(*Options.StateDir, true);
+    UE_LOG(LogPLATEAUConvertDataset, Display, TEXT("Shard %d/%d: %d of %d mesh codes. State: %s"),
+        Options.ShardIndex, Options.ShardCount, ShardMeshCodes.Num(), AllMeshCodes.Num(), *Options.StateDir);
+
+    int FailedCount = 0;
+    for (int i = 0; i < ShardMeshCodes.Num(); ++i) {
+        const auto& MeshCode = ShardMeshCodes[i];
+        const auto DoneFilePath = GetStateFilePath(Options, MeshCode, TEXT(".done"));
+        const auto FailedFilePath = GetStateFilePath(Options, MeshCode, TEXT(".failed"));
+        if (Options.bResume && FPaths::FileExists(DoneFilePath)) {
+            UE_LOG(LogPLATEAUConvertDataset, Display, TEXT("[%d/%d] %s: skipped (done)"), i + 1, ShardMeshCodes.Num(), *MeshCode);
+            continue;
+        }
+
+        const auto StartSeconds = FPlatformTime::Seconds();
+        TArray<FString> FailedGmls;
+        bool bTimedOut = false;
+        const auto bSucceeded = ConvertMeshCode(Options, MeshCode, GeoReference, ImportSettings, FailedGmls, bTimedOut);
+        const auto Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+        // 完了したメッシュコードを記録し、再実行時に再開できるようにする
+        IFileManager::Get().Delete(*FailedFilePath, false, false, true);
+        if (bSucceeded) {
+            FFileHelper::SaveStringToFile(FString::Printf(TEXT("%s\n%.2f\n"), *FDateTime::UtcNow().ToIso8601(), Seconds), *DoneFilePath);
+        }
+        else {
+            ++FailedCount;
+            FFileHelper::SaveStringToFile(FString::Join(FailedGmls, TEXT("\n")), *FailedFilePath);
+        }
+        UE_LOG(LogPLATEAUConvertDataset, Display, TEXT("[%d/%d] %s: %s (%.2f s)"),
+            i + 1, ShardMeshCodes.Num(), *MeshCode, bSucceeded ? TEXT("done") : bTimedOut ? TEXT("timed out") : TEXT("failed"), Seconds);
+
+        // 中断後も残る処理が後続のメッシュコードに影響しないよう、タイムアウトした時点で終了する
+        if (bTimedOut) {
+            ImportSettings->RemoveFromRoot();
+            UE_LOG(LogPLATEAUConvertDataset, Error, TEXT("Aborted after timeout. %d failed. Rerun with -Resume to continue."), FailedCount);
+            return 2;
+        }
+    }
+
+    ImportSettings->RemoveFromRoot();
+    UE_LOG(LogPLATEAUConvertDataset, Display, TEXT("Finished. %d failed."), FailedCount);
+    return FailedCount == 0 ? 0 : 1;
+}
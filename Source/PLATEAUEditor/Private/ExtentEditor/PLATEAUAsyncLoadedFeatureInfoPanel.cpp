@@ -14,6 +14,7 @@
 #include <plateau/dataset/i_dataset_accessor.h>
 
 #include "PLATEAUFeatureInfoDisplay.h"
+#include "Dataset/PLATEAUDatasetIndex.h"
 #include "Components/StaticMeshComponent.h"
 #include "StaticMeshAttributes.h"
 #include "Engine/StaticMeshActor.h"
@@ -197,11 +198,11 @@ void FPLATEAUAsyncLoadedFeatureInfoPanel::CreatePanelComponents(const TMap<Prede
     }
 }
 
-void FPLATEAUAsyncLoadedFeatureInfoPanel::LoadMaxLodAsync(const FPLATEAUFeatureInfoPanelInput& Input, const FBox& InBox) {
+void FPLATEAUAsyncLoadedFeatureInfoPanel::LoadMaxLodAsync(const FPLATEAUFeatureInfoPanelInput& Input, const FBox& InBox, const TSharedPtr<FPLATEAUDatasetIndex>& DatasetIndex) {
     Box = InBox;
     MaxLodTaskStatus = EPLATEAUFeatureInfoPanelStatus::Loading;
 
-    GetMaxLodTask = UE::Tasks::Launch(TEXT("GetMaxLODTask"), [Input]() mutable {
+    GetMaxLodTask = UE::Tasks::Launch(TEXT("GetMaxLODTask"), [Input, DatasetIndex]() mutable {
         TMap<PredefinedCityModelPackage, int> MaxLods;
 
         for (const auto& Entry : Input) {
@@ -210,8 +211,9 @@ void FPLATEAUAsyncLoadedFeatureInfoPanel::LoadMaxLodAsync(const FPLATEAUFeatureI
 
             int MaxLod = 0;
             for (auto& GmlFile : *Entry.Value) {
-                // GMLファイル内を検索して最大LODを取得
-                MaxLod = FMath::Max(GmlFile.getMaxLod(), MaxLod);
+                // GMLファイル内を検索して最大LODを取得(インデックスに記録済みの場合は検索しない)
+                const auto GmlMaxLod = DatasetIndex.IsValid() ? DatasetIndex->GetMaxLod(GmlFile) : GmlFile.getMaxLod();
+                MaxLod = FMath::Max(GmlMaxLod, MaxLod);
             }
 
             MaxLods.Add(Entry.Key, MaxLod);
@@ -54,8 +54,9 @@ public:
      *
      * @param Input GMLファイルの一覧
      * @param InBox パネルの表示範囲
+     * @param DatasetIndex 最大LODのキャッシュ。nullptrの場合は常にGMLファイルを検索します。
      */
-    void LoadMaxLodAsync(const FPLATEAUFeatureInfoPanelInput& Input, const FBox& InBox);
+    void LoadMaxLodAsync(const FPLATEAUFeatureInfoPanelInput& Input, const FBox& InBox, const TSharedPtr<class FPLATEAUDatasetIndex>& DatasetIndex = nullptr);
 
     /**
      * @brief アイコンコンポーネント追加
@@ -7,6 +7,7 @@
 
 #include "PLATEAUMeshCodeGizmo.h"
 #include "PLATEAUFeatureInfoDisplay.h"
+#include "Dataset/PLATEAUDatasetIndex.h"
 
 #include "EditorModeManager.h"
 #include "CanvasTypes.h"
@@ -62,9 +63,8 @@ void FPLATEAUExtentEditorViewportClient::Initialize(const std::shared_ptr<platea
         ExtentEditor->ResetAreaMeshCodeMap();
     }
 
-    // メッシュコードギズモ生成と選択状態復帰
-    auto GeoReference = ExtentEditor->GetGeoReference();
-    MeshCodeGizmos.Reset();
+    // 表示対象のメッシュコードを抽出
+    TArray<plateau::dataset::MeshCode> GizmoMeshCodes;
     for (const auto& MeshCode : MeshCodes) {
         // 2次メッシュ以下の次数は省く
         if (MeshCode.getLevel() <= 2)
@@ -80,8 +80,28 @@ void FPLATEAUExtentEditorViewportClient::Initialize(const std::shared_ptr<platea
             }
         }
 
+        GizmoMeshCodes.Add(MeshCode);
+    }
+
+    // 各メッシュコード範囲の端点を一括で平面直角座標系へ変換
+    TArray<FPLATEAUGeoCoordinate> Corners;
+    Corners.Reserve(GizmoMeshCodes.Num() * 2);
+    for (const auto& MeshCode : GizmoMeshCodes) {
+        const auto Extent = MeshCode.getExtent();
+        Corners.Add(FPLATEAUGeoCoordinate(Extent.min));
+        Corners.Add(FPLATEAUGeoCoordinate(Extent.max));
+    }
+    TArray<FVector> ProjectedCorners;
+    ProjectedCorners.SetNumUninitialized(Corners.Num());
+    auto GeoReference = ExtentEditor->GetGeoReference();
+    GeoReference.ProjectBatch(Corners, ProjectedCorners);
+
+    // メッシュコードギズモ生成と選択状態復帰
+    MeshCodeGizmos.Reset();
+    for (int32 i = 0; i < GizmoMeshCodes.Num(); ++i) {
+        const auto& MeshCode = GizmoMeshCodes[i];
         MeshCodeGizmos.AddDefaulted();
-        MeshCodeGizmos.Last().Init(MeshCode, GeoReference.GetData());
+        MeshCodeGizmos.Last().Init(MeshCode, ProjectedCorners[i * 2], ProjectedCorners[i * 2 + 1]);
         if (ExtentEditor->GetAreaMeshCodeMap().Contains(UTF8_TO_TCHAR(MeshCode.get().c_str()))) {
             MeshCodeGizmos.Last().SetbSelectedArray(ExtentEditor->GetAreaMeshCodeMap()[UTF8_TO_TCHAR(MeshCode.get().c_str())].GetbSelectedArray());
         }
@@ -183,7 +203,9 @@ void FPLATEAUExtentEditorViewportClient::DrawCanvas(FViewport& InViewport, FScen
     
     // 地物アイコン
     if (FeatureInfoDisplay == nullptr) {
-        FeatureInfoDisplay = MakeShared<FPLATEAUFeatureInfoDisplay>(ExtentEditorPtr.Pin().Get()->GetGeoReference(), SharedThis(this));
+        const auto ExtentEditor = ExtentEditorPtr.Pin();
+        const TSharedPtr<FPLATEAUDatasetIndex> DatasetIndex = ExtentEditor->IsImportFromServer() ? nullptr : FPLATEAUDatasetIndex::Get(ExtentEditor->GetSourcePath()).ToSharedPtr();
+        FeatureInfoDisplay = MakeShared<FPLATEAUFeatureInfoDisplay>(ExtentEditor->GetGeoReference(), SharedThis(this), DatasetIndex);
     }
 
     const int LoadingPanelCnt = FeatureInfoDisplay->CountLoadingPanels();
@@ -13,6 +13,7 @@
 #include <plateau/dataset/i_dataset_accessor.h>
 
 #include "PLATEAURuntime.h"
+#include "Dataset/PLATEAUDatasetIndex.h"
 #include "StaticMeshAttributes.h"
 #include "PLATEAUTextureLoader.h"
 #include "Materials/MaterialInstanceDynamic.h"
@@ -83,9 +84,11 @@ namespace {
 
 FPLATEAUFeatureInfoDisplay::FPLATEAUFeatureInfoDisplay(
     const FPLATEAUGeoReference& InGeoReference,
-    const TSharedPtr<FPLATEAUExtentEditorViewportClient> InViewportClient)
+    const TSharedPtr<FPLATEAUExtentEditorViewportClient> InViewportClient,
+    const TSharedPtr<FPLATEAUDatasetIndex> InDatasetIndex)
     : GeoReference(InGeoReference)
     , ViewportClient(InViewportClient)
+    , DatasetIndex(InDatasetIndex)
 {
     ShowLods.Reset();
     for (int Lod = 0; Lod <= plateau::Feature::MaxLod; ++Lod) {
@@ -95,7 +98,11 @@ FPLATEAUFeatureInfoDisplay::FPLATEAUFeatureInfoDisplay(
     InitializeMaterials();
 }
 
-FPLATEAUFeatureInfoDisplay::~FPLATEAUFeatureInfoDisplay() {}
+FPLATEAUFeatureInfoDisplay::~FPLATEAUFeatureInfoDisplay() {
+    // 計算済みの最大LODを次回以降の起動のために保存
+    if (DatasetIndex.IsValid())
+        DatasetIndex->Save();
+}
 
 bool FPLATEAUFeatureInfoDisplay::CreatePanelAsync(const FPLATEAUMeshCodeGizmo& MeshCodeGizmo, const IDatasetAccessor& InDatasetAccessor) {
     // 生成済みの場合はスキップ
@@ -116,7 +123,7 @@ bool FPLATEAUFeatureInfoDisplay::CreatePanelAsync(const FPLATEAUMeshCodeGizmo& M
     const auto RawTileMin = GeoReference.GetData().project(TileExtent.min);
     const FBox Box{FVector(RawTileMin.x, RawTileMin.y, RawTileMin.z), FVector(RawTileMax.x, RawTileMax.y, RawTileMax.z)};
 
-    AsyncLoadedTile->LoadMaxLodAsync(Input, Box);
+    AsyncLoadedTile->LoadMaxLodAsync(Input, Box, DatasetIndex);
 
     return true;
 }
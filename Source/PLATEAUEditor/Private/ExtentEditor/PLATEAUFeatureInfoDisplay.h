@@ -58,7 +58,11 @@ inline uint32 GetTypeHash(const FPLATEAUFeatureInfoMaterialKey& Key) {
  */
 class FPLATEAUFeatureInfoDisplay : public TSharedFromThis<FPLATEAUFeatureInfoDisplay> {
 public:
-    FPLATEAUFeatureInfoDisplay(const FPLATEAUGeoReference& InGeoReference, const TSharedPtr<class FPLATEAUExtentEditorViewportClient> InViewportClient);
+    /**
+     * @param InDatasetIndex 最大LODのキャッシュに使用するデータセットインデックス。nullptrの場合はキャッシュしません。
+     */
+    FPLATEAUFeatureInfoDisplay(const FPLATEAUGeoReference& InGeoReference, const TSharedPtr<class FPLATEAUExtentEditorViewportClient> InViewportClient,
+                               const TSharedPtr<class FPLATEAUDatasetIndex> InDatasetIndex = nullptr);
     ~FPLATEAUFeatureInfoDisplay();
 
     bool CreatePanelAsync(const FPLATEAUMeshCodeGizmo& MeshCodeGizmo, const plateau::dataset::IDatasetAccessor& InDatasetAccessor);
@@ -109,6 +113,7 @@ public:
 private:
     FPLATEAUGeoReference GeoReference;
     TWeakPtr<class FPLATEAUExtentEditorViewportClient> ViewportClient;
+    TSharedPtr<class FPLATEAUDatasetIndex> DatasetIndex;
 
     EPLATEAUFeatureInfoVisibility Visibility;
     TMap<FString, TSharedPtr<FPLATEAUAsyncLoadedFeatureInfoPanel>> AsyncLoadedPanels;
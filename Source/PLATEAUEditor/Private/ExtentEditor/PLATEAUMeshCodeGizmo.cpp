@@ -203,14 +203,18 @@ void FPLATEAUMeshCodeGizmo::Init(const plateau::dataset::MeshCode& InMeshCode, c
     const auto Extent = InMeshCode.getExtent();
     const auto RawMin = InGeoReference.project(Extent.min);
     const auto RawMax = InGeoReference.project(Extent.max);
+    Init(InMeshCode, FVector(RawMin.x, RawMin.y, RawMin.z), FVector(RawMax.x, RawMax.y, RawMax.z));
+}
+
+void FPLATEAUMeshCodeGizmo::Init(const plateau::dataset::MeshCode& InMeshCode, const FVector& ProjectedMin, const FVector& ProjectedMax) {
     MeshCode = InMeshCode;
     MeshCodeString = UTF8_TO_TCHAR(InMeshCode.get().c_str());
     Width = MaxX - MinX;
     Height = MaxY - MinY;
-    MinX = FGenericPlatformMath::Min(RawMin.x, RawMax.x);
-    MinY = FGenericPlatformMath::Min(RawMin.y, RawMax.y);
-    MaxX = FGenericPlatformMath::Max(RawMin.x, RawMax.x);
-    MaxY = FGenericPlatformMath::Max(RawMin.y, RawMax.y);
+    MinX = FGenericPlatformMath::Min(ProjectedMin.X, ProjectedMax.X);
+    MinY = FGenericPlatformMath::Min(ProjectedMin.Y, ProjectedMax.Y);
+    MaxX = FGenericPlatformMath::Max(ProjectedMin.X, ProjectedMax.X);
+    MaxY = FGenericPlatformMath::Max(ProjectedMin.Y, ProjectedMax.Y);
     LineThickness = 2.0f;
 
     const int NumAreaColumn = GetNumAreaColumnByMeshCode(MeshCode);
@@ -70,6 +70,11 @@ public:
      */
     void Init(const plateau::dataset::MeshCode& InMeshCode, const plateau::geometry::GeoReference& InGeoReference);
 
+    /**
+     * @brief 平面直角座標系へ変換済みのメッシュコード範囲の端点からインスタンスを初期化します。
+     */
+    void Init(const plateau::dataset::MeshCode& InMeshCode, const FVector& ProjectedMin, const FVector& ProjectedMax);
+
     /**
      * @brief マウス座標がエリア内であれば選択状態をトグル
      * @param X マウス座標X
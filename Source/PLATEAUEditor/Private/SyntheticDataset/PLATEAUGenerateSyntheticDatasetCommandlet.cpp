@@ -0,0 +1,48 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "SyntheticDataset/PLATEAUGenerateSyntheticDatasetCommandlet.h"
+#include "SyntheticDataset/PLATEAUSyntheticDatasetGenerator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPLATEAUSyntheticDataset, Log, All);
+
+UPLATEAUGenerateSyntheticDatasetCommandlet::UPLATEAUGenerateSyntheticDatasetCommandlet() {
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+    HelpDescription = TEXT("Generates a synthetic PLATEAU CityGML dataset for load testing.");
+    HelpUsage = TEXT("-run=PLATEAUGenerateSyntheticDataset -Output=<Dir> [-MeshCode=533926] [-ThirdMeshes=1] [-Buildings=100] [-Roads=10] [-Furniture=10] [-Vegetation=10] [-MaxLod=2] [-Seed=0] [-NoRelief] [-NoTextures]");
+}
+
+int32 UPLATEAUGenerateSyntheticDatasetCommandlet::Main(const FString& Params) {
+    FString OutputDir;
+    if (!FParse::Value(*Params, TEXT("Output="), OutputDir)) {
+        UE_LOG(LogPLATEAUSyntheticDataset, Error, TEXT("Usage: %s"), *HelpUsage);
+        return 1;
+    }
+
+    FPLATEAUSyntheticDatasetOptions Options;
+    FParse::Value(*Params, TEXT("MeshCode="), Options.SecondMeshCode);
+    FParse::Value(*Params, TEXT("ThirdMeshes="), Options.ThirdMeshCount);
+    FParse::Value(*Params, TEXT("Buildings="), Options.BuildingCount);
+    FParse::Value(*Params, TEXT("Roads="), Options.RoadCount);
+    FParse::Value(*Params, TEXT("Furniture="), Options.CityFurnitureCount);
+    FParse::Value(*Params, TEXT("Vegetation="), Options.VegetationCount);
+    FParse::Value(*Params, TEXT("ReliefGrid="), Options.ReliefGridCount);
+    FParse::Value(*Params, TEXT("MaxLod="), Options.MaxLod);
+    FParse::Value(*Params, TEXT("TextureSize="), Options.TextureSize);
+    FParse::Value(*Params, TEXT("Attributes="), Options.AttributeCount);
+    FParse::Value(*Params, TEXT("Seed="), Options.Seed);
+    // 起伏とテクスチャはFPLATEAUSyntheticDatasetOptionsの既定値と同じく既定で生成する
+    if (FParse::Param(*Params, TEXT("NoRelief")))
+        Options.bGenerateRelief = false;
+    if (FParse::Param(*Params, TEXT("NoTextures")))
+        Options.bGenerateTexture = false;
+
+    const auto StartSeconds = FPlatformTime::Seconds();
+    TArray<FString> GmlPaths;
+    const auto bSucceeded = FPLATEAUSyntheticDatasetGenerator::Generate(Options, OutputDir, GmlPaths);
+    UE_LOG(LogPLATEAUSyntheticDataset, Display, TEXT("Generated %d GML files in %s (%.2f s)"), GmlPaths.Num(), *OutputDir, FPlatformTime::Seconds() - StartSeconds);
+
+    return bSucceeded ? 0 : 1;
+}
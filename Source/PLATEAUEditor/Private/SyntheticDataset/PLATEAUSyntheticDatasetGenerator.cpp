@@ -0,0 +1,496 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "SyntheticDataset/PLATEAUSyntheticDatasetGenerator.h"
+
+#include <plateau/dataset/mesh_code.h>
+
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+
+namespace {
+    /**
+     * @brief 1度あたりのおおよその距離(m)
+     */
+    constexpr double MetersPerDegree = 111000.0;
+
+    //! LOD3の建築物の階高(m)
+    constexpr double FloorHeight = 3.5;
+
+    /**
+     * @brief 座標参照系(JGD2011 地理座標系 + 標高)
+     */
+    constexpr TCHAR SrsName[] = TEXT("http://www.opengis.net/def/crs/EPSG/0/6697");
+
+    constexpr TCHAR CityModelHeader[] =
+        TEXT("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n")
+        TEXT("<core:CityModel")
+        TEXT(" xmlns:core=\"http://www.opengis.net/citygml/2.0\"")
+        TEXT(" xmlns:gml=\"http://www.opengis.net/gml\"")
+        TEXT(" xmlns:xlink=\"http://www.w3.org/1999/xlink\"")
+        TEXT(" xmlns:gen=\"http://www.opengis.net/citygml/generics/2.0\"")
+        TEXT(" xmlns:app=\"http://www.opengis.net/citygml/appearance/2.0\"")
+        TEXT(" xmlns:bldg=\"http://www.opengis.net/citygml/building/2.0\"")
+        TEXT(" xmlns:tran=\"http://www.opengis.net/citygml/transportation/2.0\"")
+        TEXT(" xmlns:dem=\"http://www.opengis.net/citygml/relief/2.0\"")
+        TEXT(" xmlns:frn=\"http://www.opengis.net/citygml/cityfurniture/2.0\"")
+        TEXT(" xmlns:veg=\"http://www.opengis.net/citygml/vegetation/2.0\">\n");
+
+    /**
+     * @brief 緯度、経度、標高の順で表される座標です。
+     */
+    struct FGeoPosition {
+        double Latitude;
+        double Longitude;
+        double Height;
+    };
+
+    /**
+     * @brief 緯度経度の矩形範囲です。
+     */
+    struct FGeoRect {
+        double MinLatitude;
+        double MinLongitude;
+        double MaxLatitude;
+        double MaxLongitude;
+
+        double GetLatitudeSize() const { return MaxLatitude - MinLatitude; }
+        double GetLongitudeSize() const { return MaxLongitude - MinLongitude; }
+    };
+
+    /**
+     * @brief 1つのGMLファイルの内容を組み立てます。
+     */
+    class FGmlBuilder {
+    public:
+        FGmlBuilder(const FString& InIdPrefix, const FGeoRect& Extent)
+            : IdPrefix(InIdPrefix) {
+            Gml.Reserve(1024 * 1024);
+            Gml.Append(CityModelHeader);
+            Gml.Appendf(TEXT("<gml:boundedBy><gml:Envelope srsName=\"%s\" srsDimension=\"3\">"), SrsName);
+            Gml.Appendf(TEXT("<gml:lowerCorner>%.9f %.9f %.3f</gml:lowerCorner>"), Extent.MinLatitude, Extent.MinLongitude, 0.0);
+            Gml.Appendf(TEXT("<gml:upperCorner>%.9f %.9f %.3f</gml:upperCorner>"), Extent.MaxLatitude, Extent.MaxLongitude, 1000.0);
+            Gml.Append(TEXT("</gml:Envelope></gml:boundedBy>\n"));
+        }
+
+        FString NewId(const TCHAR* Kind) {
+            return FString::Printf(TEXT("%s_%s_%d"), *IdPrefix, Kind, ++IdCounter);
+        }
+
+        void Append(const FString& Text) {
+            Gml.Append(Text);
+        }
+
+        /**
+         * @brief 閉じたリング(始点は末尾に自動で追加)からポリゴンを追加します。
+         * @param bTextured trueの場合、テクスチャ座標を登録します。
+         */
+        void AppendPolygon(const TArray<FGeoPosition>& Ring, const bool bTextured = false) {
+            const auto PolygonId = NewId(TEXT("poly"));
+            const auto RingId = PolygonId + TEXT("_ring");
+            Gml.Appendf(TEXT("<gml:surfaceMember><gml:Polygon gml:id=\"%s\"><gml:exterior><gml:LinearRing gml:id=\"%s\"><gml:posList>"), *PolygonId, *RingId);
+            AppendPosList(Ring);
+            Gml.Append(TEXT("</gml:posList></gml:LinearRing></gml:exterior></gml:Polygon></gml:surfaceMember>\n"));
+
+            if (bTextured)
+                TexturedRings.Add({PolygonId, RingId});
+        }
+
+        void AppendMultiSurface(const TArray<TArray<FGeoPosition>>& Polygons, const bool bTextured = false) {
+            Gml.Appendf(TEXT("<gml:MultiSurface srsName=\"%s\" srsDimension=\"3\">\n"), SrsName);
+            for (const auto& Polygon : Polygons) {
+                AppendPolygon(Polygon, bTextured);
+            }
+            Gml.Append(TEXT("</gml:MultiSurface>\n"));
+        }
+
+        void AppendSolid(const TArray<TArray<FGeoPosition>>& Polygons) {
+            Gml.Appendf(TEXT("<gml:Solid srsName=\"%s\" srsDimension=\"3\"><gml:exterior><gml:CompositeSurface>\n"), SrsName);
+            for (const auto& Polygon : Polygons) {
+                AppendPolygon(Polygon);
+            }
+            Gml.Append(TEXT("</gml:CompositeSurface></gml:exterior></gml:Solid>\n"));
+        }
+
+        void AppendTriangle(const FGeoPosition& A, const FGeoPosition& B, const FGeoPosition& C) {
+            Gml.Append(TEXT("<gml:Triangle><gml:exterior><gml:LinearRing><gml:posList>"));
+            AppendPosList({A, B, C});
+            Gml.Append(TEXT("</gml:posList></gml:LinearRing></gml:exterior></gml:Triangle>\n"));
+        }
+
+        void AppendAttributes(FRandomStream& Random, const int AttributeCount) {
+            for (int i = 0; i < AttributeCount; ++i) {
+                switch (i % 3) {
+                case 0:
+                    Gml.Appendf(TEXT("<gen:stringAttribute name=\"attr_%d\"><gen:value>value_%d</gen:value></gen:stringAttribute>\n"), i, Random.RandRange(0, 9));
+                    break;
+                case 1:
+                    Gml.Appendf(TEXT("<gen:intAttribute name=\"attr_%d\"><gen:value>%d</gen:value></gen:intAttribute>\n"), i, Random.RandRange(0, 1000));
+                    break;
+                default:
+                    Gml.Appendf(TEXT("<gen:doubleAttribute name=\"attr_%d\"><gen:value>%.3f</gen:value></gen:doubleAttribute>\n"), i, Random.FRandRange(0, 100));
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @brief テクスチャ座標を登録したポリゴンに対してテクスチャを割り当てます。
+         */
+        void AppendAppearance(const FString& ImageUri) {
+            if (TexturedRings.IsEmpty())
+                return;
+
+            Gml.Append(TEXT("<app:appearanceMember><app:Appearance><app:theme>rgbTexture</app:theme><app:surfaceDataMember><app:ParameterizedTexture>\n"));
+            Gml.Appendf(TEXT("<app:imageURI>%s</app:imageURI><app:mimeType>image/png</app:mimeType>\n"), *ImageUri);
+            for (const auto& [PolygonId, RingId] : TexturedRings) {
+                Gml.Appendf(TEXT("<app:target uri=\"#%s\"><app:TexCoordList><app:textureCoordinates ring=\"#%s\">0 0 1 0 1 1 0 1 0 0</app:textureCoordinates></app:TexCoordList></app:target>\n"), *PolygonId, *RingId);
+            }
+            Gml.Append(TEXT("</app:ParameterizedTexture></app:surfaceDataMember></app:Appearance></app:appearanceMember>\n"));
+        }
+
+        bool Save(const FString& Path) {
+            Gml.Append(TEXT("</core:CityModel>\n"));
+            return FFileHelper::SaveStringToFile(Gml, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+        }
+
+    private:
+        FString IdPrefix;
+        FString Gml;
+        int IdCounter = 0;
+        TArray<TPair<FString, FString>> TexturedRings;
+
+        void AppendPosList(const TArray<FGeoPosition>& Ring) {
+            for (const auto& Position : Ring) {
+                Gml.Appendf(TEXT("%.9f %.9f %.3f "), Position.Latitude, Position.Longitude, Position.Height);
+            }
+            const auto& First = Ring[0];
+            Gml.Appendf(TEXT("%.9f %.9f %.3f"), First.Latitude, First.Longitude, First.Height);
+        }
+    };
+
+    FGeoRect GetMeshExtent(const FString& MeshCode) {
+        const auto Extent = plateau::dataset::MeshCode(TCHAR_TO_UTF8(*MeshCode)).getExtent();
+        return {Extent.min.latitude, Extent.min.longitude, Extent.max.latitude, Extent.max.longitude};
+    }
+
+    /**
+     * @brief 矩形の足元形状と高さから箱形状の各面を返します。面の順序は底面、上面、側面(4面)です。
+     */
+    TArray<TArray<FGeoPosition>> CreateBoxPolygons(const FGeoRect& Footprint, const double Bottom, const double Top) {
+        // 上から見て反時計回り
+        const TArray<TPair<double, double>> Corners = {
+            {Footprint.MinLatitude, Footprint.MinLongitude},
+            {Footprint.MinLatitude, Footprint.MaxLongitude},
+            {Footprint.MaxLatitude, Footprint.MaxLongitude},
+            {Footprint.MaxLatitude, Footprint.MinLongitude},
+        };
+
+        TArray<TArray<FGeoPosition>> Polygons;
+        auto& Ground = Polygons.AddDefaulted_GetRef();
+        for (int i = Corners.Num() - 1; i >= 0; --i) {
+            Ground.Add({Corners[i].Key, Corners[i].Value, Bottom});
+        }
+        auto& Roof = Polygons.AddDefaulted_GetRef();
+        for (const auto& [Latitude, Longitude] : Corners) {
+            Roof.Add({Latitude, Longitude, Top});
+        }
+        for (int i = 0; i < Corners.Num(); ++i) {
+            const auto& A = Corners[i];
+            const auto& B = Corners[(i + 1) % Corners.Num()];
+            Polygons.Add({
+                {A.Key, A.Value, Bottom},
+                {B.Key, B.Value, Bottom},
+                {B.Key, B.Value, Top},
+                {A.Key, A.Value, Top},
+            });
+        }
+        return Polygons;
+    }
+
+    /**
+     * @brief 壁面(CreateBoxPolygonsの側面)の各階に窓を表す矩形を返します。
+     * 壁面と重ならないよう、窓は壁面から外側に少しずらして配置します。
+     */
+    TArray<TArray<FGeoPosition>> CreateWindowPolygons(const FGeoRect& Footprint, const TArray<FGeoPosition>& Wall, const double Height) {
+        const auto& A = Wall[0];
+        const auto& B = Wall[1];
+        const double CenterLatitude = (Footprint.MinLatitude + Footprint.MaxLatitude) * 0.5;
+        const double CenterLongitude = (Footprint.MinLongitude + Footprint.MaxLongitude) * 0.5;
+        const double LongitudeScale = FMath::Cos(FMath::DegreesToRadians(CenterLatitude));
+
+        // 足元形状の中心から壁面の中点へ向かう方向に0.05mずらす
+        const double OutwardLatitude = (A.Latitude + B.Latitude) * 0.5 - CenterLatitude;
+        const double OutwardLongitude = (A.Longitude + B.Longitude) * 0.5 - CenterLongitude;
+        const double OutwardMeters = FMath::Sqrt(FMath::Square(OutwardLatitude * MetersPerDegree) + FMath::Square(OutwardLongitude * MetersPerDegree * LongitudeScale));
+        const double OffsetRatio = OutwardMeters > 0.0 ? 0.05 / OutwardMeters : 0.0;
+
+        const auto GetPosition = [&](const double T, const double Z) -> FGeoPosition {
+            return {
+                FMath::Lerp(A.Latitude, B.Latitude, T) + OutwardLatitude * OffsetRatio,
+                FMath::Lerp(A.Longitude, B.Longitude, T) + OutwardLongitude * OffsetRatio,
+                Z
+            };
+        };
+
+        TArray<TArray<FGeoPosition>> Windows;
+        const int FloorCount = FMath::Max(1, FMath::FloorToInt(Height / FloorHeight));
+        for (int Floor = 0; Floor < FloorCount; ++Floor) {
+            const double Bottom = Floor * FloorHeight + 1.0;
+            const double Top = FMath::Min(Bottom + 1.5, Height);
+            Windows.Add({GetPosition(0.3, Bottom), GetPosition(0.7, Bottom), GetPosition(0.7, Top), GetPosition(0.3, Top)});
+        }
+        return Windows;
+    }
+
+    /**
+     * @brief 3次メッシュ内に等間隔の格子を作成し、Index番目のセル内に指定サイズ(m)の矩形を返します。
+     */
+    FGeoRect GetCellFootprint(const FGeoRect& Extent, const int Index, const int Count, const double SizeInMeters) {
+        const int GridCount = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<double>(Count))));
+        const double CellLatitude = Extent.GetLatitudeSize() / GridCount;
+        const double CellLongitude = Extent.GetLongitudeSize() / GridCount;
+        const double CenterLatitude = Extent.MinLatitude + CellLatitude * (Index / GridCount + 0.5);
+        const double CenterLongitude = Extent.MinLongitude + CellLongitude * (Index % GridCount + 0.5);
+
+        // セルからはみ出さないように制限
+        const double HalfLatitude = FMath::Min(SizeInMeters / MetersPerDegree, CellLatitude * 0.8) * 0.5;
+        const double HalfLongitude = FMath::Min(SizeInMeters / (MetersPerDegree * FMath::Cos(FMath::DegreesToRadians(CenterLatitude))), CellLongitude * 0.8) * 0.5;
+        return {CenterLatitude - HalfLatitude, CenterLongitude - HalfLongitude, CenterLatitude + HalfLatitude, CenterLongitude + HalfLongitude};
+    }
+
+    bool WriteTexture(const FString& Path, const int Size, FRandomStream& Random) {
+        auto& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+        const auto ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+        if (!ImageWrapper.IsValid())
+            return false;
+
+        // 窓を模した格子模様
+        const FColor Base(Random.RandRange(120, 220), Random.RandRange(120, 220), Random.RandRange(120, 220));
+        const FColor Window(40, 60, 90);
+        TArray<FColor> Pixels;
+        Pixels.SetNumUninitialized(Size * Size);
+        for (int Y = 0; Y < Size; ++Y) {
+            for (int X = 0; X < Size; ++X) {
+                const bool bWindow = (X % 8) >= 2 && (X % 8) < 6 && (Y % 8) >= 2 && (Y % 8) < 6;
+                Pixels[Y * Size + X] = bWindow ? Window : Base;
+            }
+        }
+
+        if (!ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Size, Size, ERGBFormat::BGRA, 8))
+            return false;
+        return FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *Path);
+    }
+
+    FString GetGmlPath(const FString& UdxDir, const FString& MeshCode, const FString& Package) {
+        return UdxDir / Package / FString::Printf(TEXT("%s_%s_6697_op.gml"), *MeshCode, *Package);
+    }
+
+    bool GenerateBuildings(const FPLATEAUSyntheticDatasetOptions& Options, const FString& MeshCode, const FString& GmlPath, FRandomStream& Random) {
+        const auto Extent = GetMeshExtent(MeshCode);
+        FGmlBuilder Builder(MeshCode + TEXT("_bldg"), Extent);
+        const auto MaxLod = FMath::Clamp(Options.MaxLod, 1, 3);
+
+        for (int i = 0; i < Options.BuildingCount; ++i) {
+            const auto Footprint = GetCellFootprint(Extent, i, Options.BuildingCount, Random.FRandRange(10.0, 30.0));
+            const double Height = Random.FRandRange(5.0, 60.0);
+            const auto Polygons = CreateBoxPolygons(Footprint, 0.0, Height);
+
+            Builder.Append(FString::Printf(TEXT("<core:cityObjectMember><bldg:Building gml:id=\"%s\">\n"), *Builder.NewId(TEXT("bldg"))));
+            Builder.AppendAttributes(Random, Options.AttributeCount);
+            Builder.Append(FString::Printf(TEXT("<bldg:measuredHeight uom=\"m\">%.1f</bldg:measuredHeight>\n"), Height));
+
+            Builder.Append(TEXT("<bldg:lod1Solid>\n"));
+            Builder.AppendSolid(Polygons);
+            Builder.Append(TEXT("</bldg:lod1Solid>\n"));
+
+            // LOD2以上は境界面(地面、屋根、壁)ごとに出力し、LOD3では壁面に各階の窓(開口部)を加える
+            for (int Lod = 2; Lod <= MaxLod; ++Lod) {
+                const TArray<const TCHAR*> SurfaceTypes = {TEXT("GroundSurface"), TEXT("RoofSurface")};
+                for (int PolygonIndex = 0; PolygonIndex < Polygons.Num(); ++PolygonIndex) {
+                    const bool bWall = PolygonIndex >= SurfaceTypes.Num();
+                    const auto SurfaceType = bWall ? TEXT("WallSurface") : SurfaceTypes[PolygonIndex];
+                    const bool bTextured = Options.bGenerateTexture && bWall;
+                    Builder.Append(FString::Printf(TEXT("<bldg:boundedBy><bldg:%s gml:id=\"%s\"><bldg:lod%dMultiSurface>\n"), SurfaceType, *Builder.NewId(TEXT("surface")), Lod));
+                    Builder.AppendMultiSurface({Polygons[PolygonIndex]}, bTextured);
+                    Builder.Append(FString::Printf(TEXT("</bldg:lod%dMultiSurface>\n"), Lod));
+                    if (Lod >= 3 && bWall) {
+                        for (const auto& Window : CreateWindowPolygons(Footprint, Polygons[PolygonIndex], Height)) {
+                            Builder.Append(FString::Printf(TEXT("<bldg:opening><bldg:Window gml:id=\"%s\"><bldg:lod%dMultiSurface>\n"), *Builder.NewId(TEXT("window")), Lod));
+                            Builder.AppendMultiSurface({Window});
+                            Builder.Append(FString::Printf(TEXT("</bldg:lod%dMultiSurface></bldg:Window></bldg:opening>\n"), Lod));
+                        }
+                    }
+                    Builder.Append(FString::Printf(TEXT("</bldg:%s></bldg:boundedBy>\n"), SurfaceType));
+                }
+            }
+            Builder.Append(TEXT("</bldg:Building></core:cityObjectMember>\n"));
+        }
+
+        if (Options.bGenerateTexture && MaxLod >= 2) {
+            const auto AppearanceDirName = FPaths::GetBaseFilename(GmlPath).Replace(TEXT("_op"), TEXT("_appearance"));
+            const auto TextureFileName = AppearanceDirName / TEXT("tex_0.png");
+            if (!WriteTexture(FPaths::GetPath(GmlPath) / TextureFileName, Options.TextureSize, Random))
+                return false;
+            Builder.AppendAppearance(TextureFileName);
+        }
+        return Builder.Save(GmlPath);
+    }
+
+    bool GenerateRoads(const FPLATEAUSyntheticDatasetOptions& Options, const FString& MeshCode, const FString& GmlPath, FRandomStream& Random) {
+        const auto Extent = GetMeshExtent(MeshCode);
+        FGmlBuilder Builder(MeshCode + TEXT("_tran"), Extent);
+
+        // 東西方向の帯状の道路を南北に等間隔で配置
+        const double RoadWidth = 8.0 / MetersPerDegree;
+        for (int i = 0; i < Options.RoadCount; ++i) {
+            const double CenterLatitude = Extent.MinLatitude + Extent.GetLatitudeSize() * (i + 0.5) / Options.RoadCount;
+            const FGeoRect Rect = {CenterLatitude - RoadWidth * 0.5, Extent.MinLongitude, CenterLatitude + RoadWidth * 0.5, Extent.MaxLongitude};
+            const TArray<FGeoPosition> Ring = {
+                {Rect.MinLatitude, Rect.MinLongitude, 0.1},
+                {Rect.MinLatitude, Rect.MaxLongitude, 0.1},
+                {Rect.MaxLatitude, Rect.MaxLongitude, 0.1},
+                {Rect.MaxLatitude, Rect.MinLongitude, 0.1},
+            };
+
+            Builder.Append(FString::Printf(TEXT("<core:cityObjectMember><tran:Road gml:id=\"%s\">\n"), *Builder.NewId(TEXT("road"))));
+            Builder.AppendAttributes(Random, Options.AttributeCount);
+            Builder.Append(TEXT("<tran:lod1MultiSurface>\n"));
+            Builder.AppendMultiSurface({Ring});
+            Builder.Append(TEXT("</tran:lod1MultiSurface></tran:Road></core:cityObjectMember>\n"));
+        }
+        return Builder.Save(GmlPath);
+    }
+
+    /**
+     * @brief 小さな箱形状の地物(都市設備、植生)を生成します。
+     */
+    bool GenerateSmallObjects(const FPLATEAUSyntheticDatasetOptions& Options, const FString& MeshCode, const FString& GmlPath, FRandomStream& Random,
+                              const TCHAR* Namespace, const TCHAR* FeatureType, const int Count, const double Size, const double Height) {
+        const auto Extent = GetMeshExtent(MeshCode);
+        FGmlBuilder Builder(MeshCode + TEXT("_") + Namespace, Extent);
+        const auto MaxLod = FMath::Clamp(Options.MaxLod, 1, 3);
+
+        for (int i = 0; i < Count; ++i) {
+            // 建築物と重ならないようセルの角に配置
+            auto Footprint = GetCellFootprint(Extent, i, Count, Size);
+            const double Offset = (Extent.GetLatitudeSize() / FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<double>(Count))))) * 0.45;
+            Footprint.MinLatitude += Offset;
+            Footprint.MaxLatitude += Offset;
+
+            const double ObjectHeight = Height * Random.FRandRange(0.5, 1.5);
+            const auto Polygons = CreateBoxPolygons(Footprint, 0.0, ObjectHeight);
+
+            // LOD3は下部を細い支柱(幹)とし、上部の箱と合わせた形状とする
+            auto DetailedPolygons = CreateBoxPolygons(Footprint, ObjectHeight * 0.4, ObjectHeight);
+            const double PoleLatitude = Footprint.GetLatitudeSize() * 0.35;
+            const double PoleLongitude = Footprint.GetLongitudeSize() * 0.35;
+            const FGeoRect PoleFootprint = {Footprint.MinLatitude + PoleLatitude, Footprint.MinLongitude + PoleLongitude, Footprint.MaxLatitude - PoleLatitude, Footprint.MaxLongitude - PoleLongitude};
+            DetailedPolygons.Append(CreateBoxPolygons(PoleFootprint, 0.0, ObjectHeight * 0.4));
+
+            Builder.Append(FString::Printf(TEXT("<core:cityObjectMember><%s:%s gml:id=\"%s\">\n"), Namespace, FeatureType, *Builder.NewId(Namespace)));
+            Builder.AppendAttributes(Random, Options.AttributeCount);
+            for (int Lod = 1; Lod <= MaxLod; ++Lod) {
+                Builder.Append(FString::Printf(TEXT("<%s:lod%dGeometry>\n"), Namespace, Lod));
+                Builder.AppendMultiSurface(Lod >= 3 ? DetailedPolygons : Polygons);
+                Builder.Append(FString::Printf(TEXT("</%s:lod%dGeometry>\n"), Namespace, Lod));
+            }
+            Builder.Append(FString::Printf(TEXT("</%s:%s></core:cityObjectMember>\n"), Namespace, FeatureType));
+        }
+        return Builder.Save(GmlPath);
+    }
+
+    bool GenerateRelief(const FPLATEAUSyntheticDatasetOptions& Options, const FString& MeshCode, const FString& GmlPath) {
+        const auto Extent = GetMeshExtent(MeshCode);
+        FGmlBuilder Builder(MeshCode + TEXT("_dem"), Extent);
+        const int GridCount = FMath::Max(1, Options.ReliefGridCount);
+
+        const auto GetPosition = [&Extent, GridCount](const int X, const int Y) -> FGeoPosition {
+            const double Latitude = Extent.MinLatitude + Extent.GetLatitudeSize() * Y / GridCount;
+            const double Longitude = Extent.MinLongitude + Extent.GetLongitudeSize() * X / GridCount;
+            // 緩やかな起伏
+            const double Height = 5.0 + 3.0 * FMath::Sin(Latitude * 5000.0) * FMath::Cos(Longitude * 5000.0);
+            return {Latitude, Longitude, Height};
+        };
+
+        Builder.Append(FString::Printf(TEXT("<core:cityObjectMember><dem:ReliefFeature gml:id=\"%s\"><dem:lod>1</dem:lod>\n"), *Builder.NewId(TEXT("dem"))));
+        Builder.Append(FString::Printf(TEXT("<dem:reliefComponent><dem:TINRelief gml:id=\"%s\"><dem:lod>1</dem:lod><dem:tin>\n"), *Builder.NewId(TEXT("tin"))));
+        Builder.Append(FString::Printf(TEXT("<gml:TriangulatedSurface srsName=\"%s\" srsDimension=\"3\"><gml:trianglePatches>\n"), SrsName));
+        for (int Y = 0; Y < GridCount; ++Y) {
+            for (int X = 0; X < GridCount; ++X) {
+                const auto P00 = GetPosition(X, Y);
+                const auto P10 = GetPosition(X + 1, Y);
+                const auto P01 = GetPosition(X, Y + 1);
+                const auto P11 = GetPosition(X + 1, Y + 1);
+                Builder.AppendTriangle(P00, P10, P11);
+                Builder.AppendTriangle(P00, P11, P01);
+            }
+        }
+        Builder.Append(TEXT("</gml:trianglePatches></gml:TriangulatedSurface>\n"));
+        Builder.Append(TEXT("</dem:tin></dem:TINRelief></dem:reliefComponent></dem:ReliefFeature></core:cityObjectMember>\n"));
+        return Builder.Save(GmlPath);
+    }
+}
+
+TArray<FString> FPLATEAUSyntheticDatasetGenerator::GetThirdMeshCodes(const FPLATEAUSyntheticDatasetOptions& Options) {
+    TArray<FString> MeshCodes;
+    const int Count = FMath::Clamp(Options.ThirdMeshCount, 1, 100);
+    for (int i = 0; i < Count; ++i) {
+        // 3次メッシュコードは2次メッシュコード + 南北方向の番号 + 東西方向の番号
+        MeshCodes.Add(FString::Printf(TEXT("%s%d%d"), *Options.SecondMeshCode, i / 10, i % 10));
+    }
+    return MeshCodes;
+}
+
+bool FPLATEAUSyntheticDatasetGenerator::Generate(const FPLATEAUSyntheticDatasetOptions& Options, const FString& OutputDir, TArray<FString>& OutGmlPaths) {
+    if (!plateau::dataset::MeshCode(TCHAR_TO_UTF8(*(Options.SecondMeshCode + TEXT("00")))).isValid()) {
+        UE_LOG(LogTemp, Error, TEXT("Invalid second mesh code: %s"), *Options.SecondMeshCode);
+        return false;
+    }
+
+    const auto UdxDir = OutputDir / TEXT("udx");
+    for (const auto Package : {TEXT("bldg"), TEXT("tran"), TEXT("dem"), TEXT("frn"), TEXT("veg")}) {
+        IFileManager::Get().MakeDirectory(*(UdxDir / Package), true);
+    }
+
+    FRandomStream Random(Options.Seed);
+    bool bSucceeded = true;
+    const auto AddResult = [&OutGmlPaths, &bSucceeded](const FString& GmlPath, const bool bResult) {
+        if (!bResult) {
+            UE_LOG(LogTemp, Error, TEXT("Failed to write %s"), *GmlPath);
+            bSucceeded = false;
+            return;
+        }
+        OutGmlPaths.Add(GmlPath);
+    };
+
+    for (const auto& MeshCode : GetThirdMeshCodes(Options)) {
+        if (Options.BuildingCount > 0) {
+            const auto GmlPath = GetGmlPath(UdxDir, MeshCode, TEXT("bldg"));
+            if (Options.bGenerateTexture)
+                IFileManager::Get().MakeDirectory(*(FPaths::GetPath(GmlPath) / FPaths::GetBaseFilename(GmlPath).Replace(TEXT("_op"), TEXT("_appearance"))), true);
+            AddResult(GmlPath, GenerateBuildings(Options, MeshCode, GmlPath, Random));
+        }
+        if (Options.RoadCount > 0) {
+            const auto GmlPath = GetGmlPath(UdxDir, MeshCode, TEXT("tran"));
+            AddResult(GmlPath, GenerateRoads(Options, MeshCode, GmlPath, Random));
+        }
+        if (Options.CityFurnitureCount > 0) {
+            const auto GmlPath = GetGmlPath(UdxDir, MeshCode, TEXT("frn"));
+            AddResult(GmlPath, GenerateSmallObjects(Options, MeshCode, GmlPath, Random, TEXT("frn"), TEXT("CityFurniture"), Options.CityFurnitureCount, 0.5, 4.0));
+        }
+        if (Options.VegetationCount > 0) {
+            const auto GmlPath = GetGmlPath(UdxDir, MeshCode, TEXT("veg"));
+            AddResult(GmlPath, GenerateSmallObjects(Options, MeshCode, GmlPath, Random, TEXT("veg"), TEXT("SolitaryVegetationObject"), Options.VegetationCount, 3.0, 8.0));
+        }
+        if (Options.bGenerateRelief) {
+            const auto GmlPath = GetGmlPath(UdxDir, MeshCode, TEXT("dem"));
+            AddResult(GmlPath, GenerateRelief(Options, MeshCode, GmlPath));
+        }
+    }
+
+    return bSucceeded;
+}
@@ -0,0 +1,26 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PLATEAUConvertDatasetCommandlet.generated.h"
+
+/**
+ * @brief データセットのインポート、およびマップ保存またはモデル出力をエディタUI無しで一括実行します。
+ * メッシュコード単位で処理し、-ShardCount/-ShardIndexで複数プロセスに分割できます。
+ * 完了したメッシュコードは状態フォルダに記録され、-Resumeを指定すると再実行時にスキップされます。
+ * 1つのメッシュコードの読み込みが-Timeoutの秒数内に完了しない場合は中断し、終了コード2で終了します。
+ *
+ * 使用例:
+ * UnrealEditor-Cmd Project.uproject -run=PLATEAUConvertDataset -Source=/data/13100_tokyo23-ku -ExportDir=/out -Format=GLTF -ShardCount=8 -ShardIndex=0 -Resume -unattended -NullRHI
+ */
+UCLASS()
+class PLATEAUEDITOR_API UPLATEAUConvertDatasetCommandlet : public UCommandlet {
+    GENERATED_BODY()
+
+public:
+    UPLATEAUConvertDatasetCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,23 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PLATEAUGenerateSyntheticDatasetCommandlet.generated.h"
+
+/**
+ * @brief 合成CityGMLデータセットをコマンドラインから生成します。
+ * 使用例:
+ * UnrealEditor-Cmd.exe Project.uproject -run=PLATEAUGenerateSyntheticDataset -Output=D:/Synthetic -ThirdMeshes=4 -Buildings=1000 -MaxLod=2
+ * 起伏とテクスチャは既定で生成します。生成しない場合は-NoRelief、-NoTexturesを指定します。
+ */
+UCLASS()
+class PLATEAUEDITOR_API UPLATEAUGenerateSyntheticDatasetCommandlet : public UCommandlet {
+    GENERATED_BODY()
+
+public:
+    UPLATEAUGenerateSyntheticDatasetCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,59 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief 合成データセットの生成設定です。
+ */
+struct PLATEAUEDITOR_API FPLATEAUSyntheticDatasetOptions {
+    //! 生成範囲の2次メッシュコード(6桁)
+    FString SecondMeshCode = TEXT("533926");
+    //! 生成する3次メッシュの数(1～100)。2次メッシュ内で南西から順に割り当てられます。
+    int ThirdMeshCount = 1;
+
+    //! 3次メッシュあたりの建築物(bldg)数
+    int BuildingCount = 100;
+    //! 3次メッシュあたりの道路(tran)数
+    int RoadCount = 10;
+    //! 3次メッシュあたりの都市設備(frn)数
+    int CityFurnitureCount = 10;
+    //! 3次メッシュあたりの植生(veg)数
+    int VegetationCount = 10;
+    //! 起伏(dem)を生成するかどうか
+    bool bGenerateRelief = true;
+    //! 起伏のTINの分割数(一辺あたり)
+    int ReliefGridCount = 16;
+
+    //! 生成する最大LOD(1～3)。LOD3では建築物の壁面に各階の窓を、都市設備・植生に支柱(幹)を加えた形状を出力します。
+    int MaxLod = 2;
+    //! 建築物の壁面にテクスチャを付与するかどうか
+    bool bGenerateTexture = true;
+    //! 生成するテクスチャの一辺の画素数
+    int TextureSize = 64;
+    //! 地物あたりの汎用属性数
+    int AttributeCount = 4;
+
+    //! 乱数シード
+    int32 Seed = 0;
+};
+
+/**
+ * @brief 負荷テスト用に、PLATEAU形式のudxフォルダ構成を持つ合成CityGMLデータセットを生成します。
+ * 生成されたデータセットはDatasetSource::createLocalおよびAPLATEAUCityModelLoaderで読み込み可能です。
+ */
+class PLATEAUEDITOR_API FPLATEAUSyntheticDatasetGenerator {
+public:
+    /**
+     * @brief OutputDir以下にudxフォルダを作成し、合成データセットを生成します。
+     * @param OutGmlPaths 生成されたGMLファイルのパス
+     * @return 全てのファイルの書き出しに成功した場合true
+     */
+    static bool Generate(const FPLATEAUSyntheticDatasetOptions& Options, const FString& OutputDir, TArray<FString>& OutGmlPaths);
+
+    /**
+     * @brief 生成対象となる3次メッシュコードの一覧を返します。
+     */
+    static TArray<FString> GetThirdMeshCodes(const FPLATEAUSyntheticDatasetOptions& Options);
+};
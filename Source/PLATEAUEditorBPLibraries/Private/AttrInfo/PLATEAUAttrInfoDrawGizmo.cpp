@@ -2,11 +2,9 @@
 
 #include "AttrInfo/PLATEAUAttrInfoDrawGizmo.h"
 #include "Component/PLATEAUCityObjectGroup.h"
-#include "MeshDescription.h"
 #include "Components/LineBatchComponent.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "PhysicsEngine/BodySetup.h"
-#include "PhysicsEngine/PhysicsSettings.h"
+#include "StaticMeshResources.h"
 
 
 namespace {
@@ -16,141 +14,261 @@ namespace {
     constexpr bool GBPersistentLines = true;
     constexpr uint8 DepthPriority = SDPG_World;
 
+    //! キャッシュするコンポーネント数の上限
+    constexpr int32 MaxOutlineCacheNum = 256;
+
     /**
-     * @brief 対象のエッジデータ配列内に同じエッジが存在するか？
-     * @param EdgeDataArray チェック対象のエッジデータ配列
-     * @param CheckEdgeData チェック対象のエッジデータ
-     * @param ExistingIndex 同じエッジが存在したインデックス
-     * @return 同じエッジが存在したか否か？
+     * @brief 平面上の最小外接矩形を底面とするボックス(ローカル座標)
      */
-    bool IsExistingEdge(const TArray<FEdgeData> EdgeDataArray, const FEdgeData CheckEdgeData, int32& ExistingIndex) {
-        for (int32 i = 0; i < EdgeDataArray.Num(); i++) {
-            // 同じ頂点を持つエッジか？
-            if (EdgeDataArray[i].VertexPos0 == CheckEdgeData.VertexPos0 && EdgeDataArray[i].VertexPos1 == CheckEdgeData.VertexPos1 ||
-                EdgeDataArray[i].VertexPos0 == CheckEdgeData.VertexPos1 && EdgeDataArray[i].VertexPos1 == CheckEdgeData.VertexPos0) {
-                ExistingIndex = i;
-                return true;
-            }
-        }
-        return false;
-    }
+    struct FMinAreaBox {
+        FVector Center;
+        FRotator Rotation;
+        FVector Extent;
+    };
 
     /**
-     * @brief 入力されたメッシュのポリゴンから全ポリゴンを囲むエッジとなる頂点を求める    
-     * @param AtomicMeshDescription 最小地物のメッシュディスクリプション
-     * @return 全ポリゴンを囲むエッジとなる頂点情報を持つ構造体の配列
+     * @brief メッシュの頂点を座標で溶接した三角形と、都市オブジェクトごとの輪郭を保持するキャッシュ
      */
-    TArray<FVertexData> GetVertexDataPerimeterArray(const FMeshDescription* AtomicMeshDescription) {
-        TArray<FVertexData> VectorMapArray;
-        const auto PolygonCount = AtomicMeshDescription->Polygons().Num();
-        for (int32 i = 0; i < PolygonCount; i++) {
-            const auto& EdgeIdArray = AtomicMeshDescription->GetPolygonPerimeterEdges(i);
-            for (const auto& EdgeId : EdgeIdArray) {
-                // エッジの頂点は必ず２つある
-                for (int32 j = 0; j < 2; j++) {
-                    const auto& VertexId = AtomicMeshDescription->GetEdgeVertex(EdgeId, j);
-                    const auto& VertexPos = FVector(AtomicMeshDescription->GetVertexPosition(VertexId));
-                    bool ExistPos = false;
-                    for (const auto& VectorMap : VectorMapArray) {
-                        if (VectorMap.VertexID == VertexId || (VectorMap.VertexPos - VertexPos).Length() < DBL_EPSILON) {
-                            ExistPos = true;
-                            break;
-                        }
-                    }
-                    // 同じ頂点ID、同じ座標は追加しない
-                    if (!ExistPos) {
-                        VectorMapArray.Emplace(FVertexData(VertexId, VertexPos));
-                    }
-                }
-            }
+    struct FMeshOutlineCache {
+        TWeakObjectPtr<UStaticMesh> StaticMesh;
+        int32 LodIndex = INDEX_NONE;
+
+        //! 同じ座標の頂点を1つにまとめた頂点座標(ローカル座標)
+        TArray<FVector> Positions;
+        //! 都市オブジェクトインデックスごとの三角形(Positionsの要素番号)
+        TMap<FIntPoint, TArray<FIntVector>> Triangles;
+
+        //! 都市オブジェクトインデックスごとの輪郭
+        TMap<FIntPoint, TArray<FEdgeData>> Outlines;
+        //! メッシュ全体の輪郭
+        TOptional<TArray<FEdgeData>> MeshOutline;
+        TOptional<FMinAreaBox> Box;
+    };
+
+    /**
+     * @brief 描画用のLODの頂点を座標で溶接し、三角形をUVに格納された都市オブジェクトインデックスごとに分類します。
+     * 都市オブジェクトインデックスのUVを持たないメッシュの三角形はインデックス(0, 0)に分類されます。
+     */
+    void BuildMeshOutlineCache(const UStaticMesh* StaticMesh, const int32 LodIndex, FMeshOutlineCache& OutCache) {
+        const auto RenderData = StaticMesh->GetRenderData();
+        if (RenderData == nullptr || !RenderData->LODResources.IsValidIndex(LodIndex))
+            return;
+
+        const auto& LodResource = RenderData->LODResources[LodIndex];
+        const auto& PositionBuffer = LodResource.VertexBuffers.PositionVertexBuffer;
+        const auto& VertexBuffer = LodResource.VertexBuffers.StaticMeshVertexBuffer;
+        const auto Indices = LodResource.IndexBuffer.GetArrayView();
+        const auto CityObjectIndexUVChannel = UPLATEAUCityObjectGroup::GetCityObjectIndexUVChannel(VertexBuffer.GetNumTexCoords());
+        const auto bHasCityObjectIndex = CityObjectIndexUVChannel != INDEX_NONE && VertexBuffer.GetTexCoordData() != nullptr;
+
+        // UVや法線の境界で分割された頂点を同一視するため座標で溶接
+        const auto NumVertices = static_cast<int32>(PositionBuffer.GetNumVertices());
+        TArray<int32> WeldedIndices;
+        WeldedIndices.SetNumUninitialized(NumVertices);
+        TMap<FVector3f, int32> PositionToIndex;
+        PositionToIndex.Reserve(NumVertices);
+        for (int32 i = 0; i < NumVertices; ++i) {
+            const auto& Position = PositionBuffer.VertexPosition(i);
+            auto& WeldedIndex = PositionToIndex.FindOrAdd(Position, OutCache.Positions.Num());
+            if (WeldedIndex == OutCache.Positions.Num())
+                OutCache.Positions.Add(FVector(Position));
+            WeldedIndices[i] = WeldedIndex;
         }
-        // 頂点IDでソート
-        VectorMapArray.Sort([](const FVertexData& A, const FVertexData& B) { return A.VertexID < B.VertexID; });
 
-        return VectorMapArray;
+        for (int32 i = 0; i + 2 < Indices.Num(); i += 3) {
+            FIntPoint CityObjectIndex(0, 0);
+            if (bHasCityObjectIndex) {
+                const auto UV = VertexBuffer.GetVertexUV(Indices[i], CityObjectIndexUVChannel);
+                CityObjectIndex = FIntPoint(static_cast<int32>(UV.X), static_cast<int32>(UV.Y));
+            }
+            OutCache.Triangles.FindOrAdd(CityObjectIndex).Emplace(WeldedIndices[Indices[i]], WeldedIndices[Indices[i + 1]], WeldedIndices[Indices[i + 2]]);
+        }
     }
 
     /**
-     * @brief 入力された頂点座標から全ポリゴンを囲むエッジとなる頂点をエッジを結ぶ順番を考慮して求める    
-     * @param EdgeDataArray 対象のエッジデータ配列
-     * @return 全ポリゴンを囲むエッジとなる頂点情報を持つ構造体の配列
+     * @brief 三角形群の輪郭となるエッジを、エッジを結ぶ順番に並べて返します。
+     * 1つの三角形にのみ属するエッジを輪郭とし、始点から次のエッジをたどることでエッジ数に比例する時間で求めます。
+     * @param Positions 頂点座標
+     * @param TriangleGroups 対象の三角形群
      */
-    TArray<FEdgeData> GetEdgeDataPerimeterArray(const TArray<FEdgeData> EdgeDataArray) {
-        // 同じエッジは取り除く
-        TArray<FEdgeData> DistinctEdgeDataArray;
-        for (const auto& EdgeData : EdgeDataArray) {
-            if (int32 ExistingIndex; IsExistingEdge(DistinctEdgeDataArray, EdgeData, ExistingIndex)) {
-                DistinctEdgeDataArray.RemoveAt(ExistingIndex);
-            } else {
-                DistinctEdgeDataArray.Emplace(EdgeData);
+    TArray<FEdgeData> ExtractOutline(const TArray<FVector>& Positions, const TArray<const TArray<FIntVector>*>& TriangleGroups) {
+        // 向きを無視したエッジごとに、属する三角形の数と最初に現れた向きを記録
+        struct FEdgeCount {
+            int32 Count;
+            int32 From;
+            int32 To;
+        };
+        TMap<uint64, FEdgeCount> EdgeCounts;
+        for (const auto Triangles : TriangleGroups) {
+            EdgeCounts.Reserve(EdgeCounts.Num() + Triangles->Num() * 3);
+            for (const auto& Triangle : *Triangles) {
+                for (int32 i = 0; i < 3; ++i) {
+                    const auto From = Triangle[i];
+                    const auto To = Triangle[(i + 1) % 3];
+                    if (From == To)
+                        continue;
+
+                    const auto Key = static_cast<uint64>(FMath::Min(From, To)) << 32 | static_cast<uint32>(FMath::Max(From, To));
+                    if (auto EdgeCount = EdgeCounts.Find(Key))
+                        ++EdgeCount->Count;
+                    else
+                        EdgeCounts.Add(Key, {1, From, To});
+                }
             }
         }
 
-        // エッジ同士を結ぶ順番にソート
-        for (int32 i = 0; i < DistinctEdgeDataArray.Num(); i++) {
-            for (int32 j = 0; j < DistinctEdgeDataArray.Num(); j++) {
-                // 自分自身との比較は行わない
-                if (DistinctEdgeDataArray[i].VertexPos0 == DistinctEdgeDataArray[j].VertexPos0 && DistinctEdgeDataArray[i].VertexPos1 == DistinctEdgeDataArray[j].VertexPos1)
-                    continue;
-
-                // エッジの結び先か？
-                if (DistinctEdgeDataArray[i].VertexPos1 == DistinctEdgeDataArray[j].VertexPos0) {
-                    int32 SwapIndex = i + 1;
-                    if (DistinctEdgeDataArray.Num() <= SwapIndex)
-                        SwapIndex = 0;
-
-                    DistinctEdgeDataArray.Swap(SwapIndex, j);
-                    break;
+        // 輪郭のエッジを始点ごとに分類
+        TArray<FIntPoint> BoundaryEdges;
+        TMultiMap<int32, int32> EdgesByFrom;
+        for (const auto& [Key, EdgeCount] : EdgeCounts) {
+            if (EdgeCount.Count != 1)
+                continue;
+            EdgesByFrom.Add(EdgeCount.From, BoundaryEdges.Num());
+            BoundaryEdges.Emplace(EdgeCount.From, EdgeCount.To);
+        }
+
+        // 未使用のエッジから終点を始点とするエッジを順にたどる
+        TArray<FEdgeData> Outline;
+        Outline.Reserve(BoundaryEdges.Num());
+        TBitArray<> Visited(false, BoundaryEdges.Num());
+        for (int32 Start = 0; Start < BoundaryEdges.Num(); ++Start) {
+            auto Current = Start;
+            while (Current != INDEX_NONE && !Visited[Current]) {
+                Visited[Current] = true;
+                const auto& Edge = BoundaryEdges[Current];
+                Outline.Emplace(Positions[Edge.X], Positions[Edge.Y]);
+
+                Current = INDEX_NONE;
+                for (auto It = EdgesByFrom.CreateConstKeyIterator(Edge.Y); It; ++It) {
+                    if (!Visited[It.Value()]) {
+                        Current = It.Value();
+                        break;
+                    }
                 }
             }
         }
+        return Outline;
+    }
+
+    /**
+     * @brief コンポーネントの輪郭キャッシュを取得します。スタティックメッシュやLODが変わった場合は作り直します。
+     * ゲームスレッドから呼び出してください。
+     */
+    FMeshOutlineCache* FindOrBuildOutlineCache(const UStaticMeshComponent* StaticMeshComponent, const int32 LodIndex) {
+        static TMap<TWeakObjectPtr<const UStaticMeshComponent>, FMeshOutlineCache> OutlineCaches;
+
+        const auto StaticMesh = StaticMeshComponent->GetStaticMesh();
+        if (StaticMesh == nullptr || StaticMesh->GetRenderData() == nullptr || StaticMesh->GetRenderData()->LODResources.Num() == 0)
+            return nullptr;
 
-        return DistinctEdgeDataArray;
+        const auto ClampedLodIndex = FMath::Clamp(LodIndex, 0, StaticMesh->GetRenderData()->LODResources.Num() - 1);
+        if (const auto Cache = OutlineCaches.Find(StaticMeshComponent); Cache != nullptr && Cache->StaticMesh.Get() == StaticMesh && Cache->LodIndex == ClampedLodIndex)
+            return Cache;
+
+        if (MaxOutlineCacheNum <= OutlineCaches.Num())
+            OutlineCaches.Reset();
+
+        auto& Cache = OutlineCaches.Add(StaticMeshComponent);
+        Cache.StaticMesh = StaticMesh;
+        Cache.LodIndex = ClampedLodIndex;
+        BuildMeshOutlineCache(StaticMesh, ClampedLodIndex, Cache);
+        return &Cache;
     }
 
     /**
-     * @brief 入力されたMeshDescriptionから全ての頂点を求める    
-     * @return メッシュの全頂点
+     * @brief 都市オブジェクトの輪郭を取得します。
      */
-    TArray<FVertexData> GetVertexDataArray(const FMeshDescription* MeshDescription) {
-        TArray<FVertexData> VectorMapArray;
-        const auto PolygonCount = MeshDescription->Polygons().Num();
-        for (int32 i = 0; i < PolygonCount; i++) {
-            const auto& EdgeIdArray = MeshDescription->GetPolygonPerimeterEdges(i);
-            for (const auto& EdgeId : EdgeIdArray) {
-                // エッジの頂点は必ず２つある
-                for (int32 j = 0; j < 2; j++) {
-                    const auto& VertexId = MeshDescription->GetEdgeVertex(EdgeId, j);
-                    VectorMapArray.Emplace(FVertexData(VertexId, FVector(MeshDescription->GetVertexPosition(VertexId))));
-                }
+    const TArray<FEdgeData>& GetCityObjectOutline(FMeshOutlineCache& Cache, const FIntPoint& CityObjectIndex) {
+        if (const auto Outline = Cache.Outlines.Find(CityObjectIndex))
+            return *Outline;
+
+        TArray<const TArray<FIntVector>*> TriangleGroups;
+        if (const auto Triangles = Cache.Triangles.Find(CityObjectIndex))
+            TriangleGroups.Add(Triangles);
+        return Cache.Outlines.Add(CityObjectIndex, ExtractOutline(Cache.Positions, TriangleGroups));
+    }
+
+    /**
+     * @brief メッシュ全体の輪郭を取得します。
+     */
+    const TArray<FEdgeData>& GetMeshOutline(FMeshOutlineCache& Cache) {
+        if (!Cache.MeshOutline.IsSet()) {
+            TArray<const TArray<FIntVector>*> TriangleGroups;
+            for (const auto& [CityObjectIndex, Triangles] : Cache.Triangles) {
+                TriangleGroups.Add(&Triangles);
             }
+            Cache.MeshOutline = ExtractOutline(Cache.Positions, TriangleGroups);
         }
-
-        return VectorMapArray;
+        return Cache.MeshOutline.GetValue();
     }
 
     /**
      * @brief Z軸の最大最小値取得
-     * @param VectorMapArray 頂点情報を格納したマップ
-     * @param MinValue Z軸の最大値
-     * @param MaxValue Z軸の最小値
+     * @param Positions 頂点座標
+     * @param MinValue Z軸の最小値
+     * @param MaxValue Z軸の最大値
      */
-    void GetMinMaxZ(const TArray<FVertexData>& VectorMapArray, int32& MinValue, int32& MaxValue) {
-        if (VectorMapArray.Num() <= 0) {
+    void GetMinMaxZ(const TArray<FVector>& Positions, double& MinValue, double& MaxValue) {
+        if (Positions.Num() <= 0) {
             MinValue = 0;
             MaxValue = 0;
             return;
         }
 
-        double MinZ = VectorMapArray[0].VertexPos.Z;
-        double MaxZ = VectorMapArray[0].VertexPos.Z;
-        const auto InVertsNum = VectorMapArray.Num();
-        for (int32 i = 1; i < InVertsNum; i++) {
-            MinZ = std::min(MinZ, VectorMapArray[i].VertexPos.Z);
-            MaxZ = std::max(MaxZ, VectorMapArray[i].VertexPos.Z);
+        MinValue = Positions[0].Z;
+        MaxValue = Positions[0].Z;
+        for (int32 i = 1; i < Positions.Num(); i++) {
+            MinValue = FMath::Min(MinValue, Positions[i].Z);
+            MaxValue = FMath::Max(MaxValue, Positions[i].Z);
+        }
+    }
+
+    /**
+     * @brief 頂点を平面に投影した最小外接矩形を底面とし、高さ方向に頂点を包むボックスを求める
+     */
+    FMinAreaBox ComputeMinAreaBox(const TArray<FVector>& Positions) {
+        TArray<FVector> PlanarPositions;
+        PlanarPositions.Reserve(Positions.Num());
+        for (const auto& Position : Positions) {
+            PlanarPositions.Emplace(Position.X, Position.Y, 0);
         }
-        MinValue = MinZ;
-        MaxValue = MaxZ;
+
+        FMinAreaBox Box;
+        Box.Rotation = FRotator::ZeroRotator;
+        float RectLengthX = 0;
+        float RectLengthY = 0;
+        UKismetMathLibrary::MinAreaRectangle(nullptr, PlanarPositions, FVector(0, 0, 1), Box.Center, Box.Rotation, RectLengthX, RectLengthY);
+        double MinZ;
+        double MaxZ;
+        GetMinMaxZ(Positions, MinZ, MaxZ);
+        Box.Center.Z = MinZ + (MaxZ - MinZ) * 0.5;
+        Box.Extent = FVector(RectLengthX, RectLengthY, MaxZ - MinZ) * 0.5;
+        return Box;
+    }
+
+    /**
+     * @brief ボックスと、その上面に属性情報を描画
+     */
+    void DrawBoxWithAttrInfo(const UWorld* World, const FMinAreaBox& Box, const FTransform& Transform, const FString& DrawString) {
+        const auto Center = Transform.TransformPosition(Box.Center);
+        const auto Rotation = Transform.GetRotation() * Box.Rotation.Quaternion();
+        const auto Extent = Box.Extent * Transform.GetScale3D().GetAbs();
+        DrawDebugBox(World, Center, Extent, Rotation, FColor::Magenta, GBPersistentLines, DrawLineLifeTime, DepthPriority, DrawLineThickness);
+        DrawDebugString(World, Center + Rotation.RotateVector(FVector(0, 0, Extent.Z)), DrawString, nullptr, FColor::Magenta, -1);
+    }
+
+    /**
+     * @brief 属性情報の表示用文字列を取得
+     */
+    FString GetAttrInfoString(const FPLATEAUCityObject& CityObject) {
+        FString AttrInfoString;
+        for (const auto& AttributeMap : CityObject.Attributes.AttributeMap) {
+            if (AttributeMap.Value.Type == EPLATEAUAttributeType::String) {
+                AttrInfoString = FString::Format(TEXT("Key: {0}, Value: {1}"), {AttributeMap.Key, AttributeMap.Value.StringValue});
+                break;
+            }
+        }
+        return FString::Format(TEXT("{0}\n{1}"), {CityObject.GmlID, AttrInfoString});
     }
 
     /**
@@ -172,69 +290,24 @@ namespace {
     }
 
     /**
-     * @brief レイキャストヒットしたメッシュ内で指定UVと同じUVを持つエッジを重複なしで全て取得
-     * @param HitResult レイキャストヒット結果
-     * @param UV 取得したい頂点のUV
-     * @param UVChannel 対象のUVチャンネル
-     * @param LodIndex メッシュのLOD
-     * @return 指定UVと同じUVを持つエッジ配列
+     * @brief 輪郭をまとめて描画し、輪郭の中心に属性情報を描画
      */
-    TArray<FEdgeData> GetEdgesByUV(const FHitResult& HitResult, const FVector2D& UV, const int32 UVChannel = 3, const int32 LodIndex = 0) {
-        if (!UPhysicsSettings::Get()->bSupportUVFromHitResults) {
-            UE_LOG(LogTemp, Warning, TEXT("Calling FindCollisionUV but 'Support UV From Hit Results' is not enabled in project settings. This is required for finding UV for collision results."));
-            return TArray<FEdgeData>();
-        }
-
-        const auto& HitPrimitiveComponent = HitResult.Component.Get();
-        if (HitPrimitiveComponent == nullptr) {
-            UE_LOG(LogTemp, Error, TEXT("HitPrimitiveComponent == nullptr"));
-            return TArray<FEdgeData>();
-        }
-
-        const auto& StaticMeshComponent = Cast<UStaticMeshComponent>(HitPrimitiveComponent);
-        if (StaticMeshComponent == nullptr || StaticMeshComponent->GetStaticMesh() == nullptr) {
-            UE_LOG(LogTemp, Error, TEXT("StaticMeshComponent == nullptr or StaticMeshComponent->GetStaticMesh() == nullptr"));
-            return TArray<FEdgeData>();
-        }
-
-        const auto& BodySetup = HitPrimitiveComponent->GetBodySetup();
-        if (BodySetup == nullptr) {
-            UE_LOG(LogTemp, Error, TEXT("BodySetup == nullptr"));
-            return TArray<FEdgeData>();
-        }
+    void DrawOutlineWithAttrInfo(const UWorld* World, const TArray<FEdgeData>& Outline, const FTransform& Transform, const FString& DrawString) {
+        if (Outline.Num() == 0)
+            return;
 
-        TArray<FEdgeData> EdgeDataArray;
-        const auto& StaticMesh = StaticMeshComponent->GetStaticMesh();
-        const auto& [IndexBuffer, VertPositions, VertUVs] = BodySetup->UVInfo;
-        for (int32 FaceIndex = 0; FaceIndex < StaticMesh->GetNumTriangles(LodIndex); ++FaceIndex) {
-            if (VertUVs.IsValidIndex(UVChannel) && IndexBuffer.IsValidIndex(FaceIndex * 3 + 2)) {
-                const int32 Index0 = IndexBuffer[FaceIndex * 3 + 0];
-                const int32 Index1 = IndexBuffer[FaceIndex * 3 + 1];
-                const int32 Index2 = IndexBuffer[FaceIndex * 3 + 2];
-
-                FVector Pos0 = VertPositions[Index0];
-                FVector Pos1 = VertPositions[Index1];
-                FVector Pos2 = VertPositions[Index2];
-
-                FVector2D UV0 = VertUVs[UVChannel][Index0];
-                FVector2D UV1 = VertUVs[UVChannel][Index1];
-                FVector2D UV2 = VertUVs[UVChannel][Index2];
-
-                // Find barycentric coords
-                // 第一引数に自身の頂点を与えることで必ず同じBaryCoordsが得られるようにしている（FaceIndexによってのみUVが変化する）
-                const FVector BaryCoords = FMath::ComputeBaryCentric2D(Pos0, Pos0, Pos1, Pos2);
-                // Use to blend UVs
-                const auto& TargetUV = BaryCoords.X * UV0 + BaryCoords.Y * UV1 + BaryCoords.Z * UV2;
-                // 同じUVを持つ頂点取得
-                if (static_cast<int32>(TargetUV.X) == static_cast<int32>(UV.X) && static_cast<int32>(TargetUV.Y) == static_cast<int32>(UV.Y)) {
-                    EdgeDataArray.Emplace(Pos0, Pos1);
-                    EdgeDataArray.Emplace(Pos1, Pos2);
-                    EdgeDataArray.Emplace(Pos2, Pos0);
-                }
-            }
+        TArray<FBatchedLine> Lines;
+        Lines.Reserve(Outline.Num());
+        FVector SumVertPos = FVector::ZeroVector;
+        for (const auto& Edge : Outline) {
+            const auto VertexPos0 = Transform.TransformPosition(Edge.VertexPos0);
+            Lines.Emplace(VertexPos0, Transform.TransformPosition(Edge.VertexPos1), FColor::Green, DrawLineLifeTime, DrawLineThickness, DepthPriority);
+            SumVertPos += VertexPos0;
         }
+        if (ULineBatchComponent* const LineBatch = GetDebugLineBatch(World, GBPersistentLines, DrawLineLifeTime, false))
+            LineBatch->DrawLines(Lines);
 
-        return EdgeDataArray;
+        DrawDebugString(World, SumVertPos / Outline.Num(), DrawString, nullptr, FColor::Green, -1);
     }
 }
 
@@ -251,74 +324,31 @@ void UPLATEAUAttrInfoDrawGizmo::DrawAttrInfo(const UWorld* WorldContextObject, c
         return;
     }
 
-    // 親の頂点座標を平面座標として全て取得
-    const auto& StaticMesh = StaticMeshComponent->GetStaticMesh();
-    const auto& MeshDescription = StaticMesh->GetMeshDescription(LodIndex);
-    const auto& VectorMapArray = GetVertexDataArray(MeshDescription);
-    TArray<FVector> ParentVerticesArray;
-    for (const auto& VectorMap : VectorMapArray) {
-        auto VertexPos = VectorMap.VertexPos;
-        VertexPos.Z = 0;
-        ParentVerticesArray.Add(VertexPos);
+    const auto Cache = FindOrBuildOutlineCache(StaticMeshComponent, LodIndex);
+    if (Cache == nullptr) {
+        UE_LOG(LogTemp, Error, TEXT("Failed to get render data: %s"), *StaticMeshComponent->GetName());
+        return;
     }
 
-    FVector OutRectCenter;
-    FRotator OutRectRotation = FRotator::ZeroRotator;
-    float OutRectLengthX;
-    float OutRectLengthY;
-    UKismetMathLibrary::MinAreaRectangle(nullptr, ParentVerticesArray, FVector(0, 0, 1), OutRectCenter, OutRectRotation, OutRectLengthX, OutRectLengthY);
-    const auto& WorldLocation = StaticMeshComponent->GetComponentLocation();
-    int32 MinZ;
-    int32 MaxZ;
-    GetMinMaxZ(VectorMapArray, MinZ, MaxZ);
-    OutRectCenter.Z = MinZ + (MaxZ - MinZ) * 0.5 + WorldLocation.Z;
-    
-    // 親のバウンディングボックス描画
-    DrawDebugBox(World, OutRectCenter, FVector(OutRectLengthX, OutRectLengthY, MaxZ - MinZ) * 0.5, OutRectRotation.Quaternion(),
-                 FColor::Magenta, GBPersistentLines, DrawLineLifeTime, DepthPriority, DrawLineThickness);
-
-    // 親の属性情報表示
+    // 親のバウンディングボックスと属性情報描画
+    if (!Cache->Box.IsSet())
+        Cache->Box = ComputeMinAreaBox(Cache->Positions);
+
+    const auto& Transform = StaticMeshComponent->GetComponentTransform();
     const auto& CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(StaticMeshComponent);
-    if (CityObjectGroup != nullptr) {
-        const auto& [GmlID, CityObjectIndex, Type, Attributes, Children] = CityObjectGroup->GetPrimaryCityObjectByRaycast(HitResult);
-    OutRectCenter.Z = MaxZ + WorldLocation.Z;
-        FString AttrInfoString;
-        for (const auto& AttributeMap : Attributes.AttributeMap) {
-            if (AttributeMap.Value.Type == EPLATEAUAttributeType::String) {
-                AttrInfoString = FString::Format(TEXT("Key: {0}, Value: {1}"), {AttributeMap.Key, AttributeMap.Value.StringValue});
-                break;
-            }
-        }
-        const FString DrawString = FString::Format(TEXT("{0}\n{1}"), {GmlID, AttrInfoString});
-        DrawDebugString(World, OutRectCenter, DrawString, nullptr, FColor::Magenta, -1);        
-    }
+    const auto PrimaryAttrInfo = CityObjectGroup != nullptr ? GetAttrInfoString(CityObjectGroup->GetPrimaryCityObjectByRaycast(HitResult)) : FString();
+    DrawBoxWithAttrInfo(World, Cache->Box.GetValue(), Transform, PrimaryAttrInfo);
 
-    // 子のバウンディングボックス描画
-    FVector2d UV;
-    UPLATEAUCityObjectGroup::FindCollisionUV(HitResult, UV);
-    const auto& ChildEdgeArray = GetEdgesByUV(HitResult, UV);
-    const auto& EdgePerimeterArray = GetEdgeDataPerimeterArray(ChildEdgeArray);
-    ULineBatchComponent* const LineBatch = GetDebugLineBatch(World, GBPersistentLines, DrawLineLifeTime, false);
-    for (int32 i = 0; i < EdgePerimeterArray.Num(); i++) {
-        LineBatch->DrawLine(EdgePerimeterArray[i].VertexPos0, EdgePerimeterArray[i].VertexPos1, FColor::Green, DepthPriority, DrawLineThickness, DrawLineLifeTime);
-    }
-    
-    // 子の属性情報表示
-    const auto& [GmlID, CityObjectIndex, Type, Attributes, Children] = CityObjectGroup->GetAtomicCityObjectByRaycast(HitResult);
-    FString AttrInfoString;
-    for (const auto& AttributeMap : Attributes.AttributeMap) {
-        if (AttributeMap.Value.Type == EPLATEAUAttributeType::String) {
-            AttrInfoString = FString::Format(TEXT("Key: {0}, Value: {1}"), {AttributeMap.Key, AttributeMap.Value.StringValue});
-            break;
-        }
-    }
-    FVector SumVertPos;
-    for (int32 i = 0; i < EdgePerimeterArray.Num(); i++) {
-        SumVertPos += EdgePerimeterArray[i].VertexPos0;
-    }
-    SumVertPos /= EdgePerimeterArray.Num();
-    const FString DrawString = FString::Format(TEXT("{0}\n{1}"), {GmlID, AttrInfoString});
-    DrawDebugString(World, SumVertPos + WorldLocation, DrawString, nullptr, FColor::Green, -1);    
+    if (CityObjectGroup == nullptr)
+        return;
+
+    // 子の輪郭と属性情報描画
+    FPLATEAUCityObjectIndex CityObjectIndex;
+    if (!CityObjectGroup->FindCityObjectIndexByRaycast(HitResult, CityObjectIndex))
+        return;
+
+    const auto& Outline = GetCityObjectOutline(*Cache, FIntPoint(CityObjectIndex.PrimaryIndex, CityObjectIndex.AtomicIndex));
+    DrawOutlineWithAttrInfo(World, Outline, Transform, GetAttrInfoString(CityObjectGroup->GetAtomicCityObjectByRaycast(HitResult)));
 }
 
 void UPLATEAUAttrInfoDrawGizmo::DrawAttrInfoWithChildSceneComponents(const UWorld* WorldContextObject, const FHitResult& HitResult, const TArray<USceneComponent*> ChildSceneComponents, const int32 LodIndex) {
@@ -338,78 +368,30 @@ void UPLATEAUAttrInfoDrawGizmo::DrawAttrInfoWithChildSceneComponents(const UWorl
         UE_LOG(LogTemp, Error, TEXT("StaticMeshComponent == nullptr or StaticMeshComponent->GetStaticMesh() == nullptr"));
         return;
     }
-    
-    // 子の頂点座標を平面座標として全て取得
-    TArray<FVector> ChildVerticesArray;
-    TArray<FVertexData> ChildrenVectorMap;
+
+    // 子の頂点座標を全て取得
+    TArray<FVector> ChildPositions;
     for (const auto& ChildSceneComponent : ChildSceneComponents) {
-        if (const auto& ChildStaticMeshComponent = Cast<UStaticMeshComponent>(ChildSceneComponent)) {
-            const auto& MeshDescription = ChildStaticMeshComponent->GetStaticMesh()->GetMeshDescription(0);
-            const auto& VectorMapArray = GetVertexDataArray(MeshDescription);
-            ChildrenVectorMap.Append(VectorMapArray);
-            for (const auto& VectorMap : VectorMapArray) {
-                auto VertexPos = VectorMap.VertexPos;
-                VertexPos.Z = 0;
-                ChildVerticesArray.Add(VertexPos);
-            }
-        }
+        const auto& ChildStaticMeshComponent = Cast<UStaticMeshComponent>(ChildSceneComponent);
+        if (ChildStaticMeshComponent == nullptr)
+            continue;
+
+        if (const auto ChildCache = FindOrBuildOutlineCache(ChildStaticMeshComponent, 0))
+            ChildPositions.Append(ChildCache->Positions);
     }
 
-    FVector OutRectCenter;
-    FRotator OutRectRotation;
-    float OutRectLengthX;
-    float OutRectLengthY;
-    UKismetMathLibrary::MinAreaRectangle(nullptr, ChildVerticesArray, FVector(0, 0, 1), OutRectCenter, OutRectRotation, OutRectLengthX, OutRectLengthY);
-    const auto& WorldLocation = StaticMeshComponent->GetComponentLocation();
-    int32 MinZ;
-    int32 MaxZ;
-    GetMinMaxZ(ChildrenVectorMap, MinZ, MaxZ);
-    OutRectCenter.Z = MinZ + (MaxZ - MinZ) * 0.5 + WorldLocation.Z;
-
-    // 親のバウンディングボックス描画
-    DrawDebugBox(World, OutRectCenter, FVector(OutRectLengthX, OutRectLengthY, MaxZ - MinZ) * 0.5, OutRectRotation.Quaternion(),
-                 FColor::Magenta, GBPersistentLines, DrawLineLifeTime, DepthPriority, DrawLineThickness);
-
-    // 親の属性情報表示
+    // 親のバウンディングボックスと属性情報描画
+    const auto& Transform = StaticMeshComponent->GetComponentTransform();
     const auto& CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(StaticMeshComponent);
-    if (CityObjectGroup != nullptr) {
-        const auto& [GmlID, CityObjectIndex, Type, Attributes, Children] = CityObjectGroup->GetPrimaryCityObjectByRaycast(HitResult);
-        OutRectCenter.Z = MaxZ + WorldLocation.Z;
-        FString AttrInfoString;
-        for (const auto& AttributeMap : Attributes.AttributeMap) {
-            if (AttributeMap.Value.Type == EPLATEAUAttributeType::String) {
-                AttrInfoString = FString::Format(TEXT("Key: {0}, Value: {1}"), {AttributeMap.Key, AttributeMap.Value.StringValue});
-                break;
-            }
-        }
-        const FString DrawString = FString::Format(TEXT("{0}\n{1}"), {GmlID, AttrInfoString});
-        DrawDebugString(World, OutRectCenter, DrawString, nullptr, FColor::Magenta, -1);
-    }
+    const auto PrimaryAttrInfo = CityObjectGroup != nullptr ? GetAttrInfoString(CityObjectGroup->GetPrimaryCityObjectByRaycast(HitResult)) : FString();
+    DrawBoxWithAttrInfo(World, ComputeMinAreaBox(ChildPositions), Transform, PrimaryAttrInfo);
 
-    // 子のバウンディングボックス描画
-    const auto& VertexDataPerimeterArray = GetVertexDataPerimeterArray(StaticMeshComponent->GetStaticMesh()->GetMeshDescription(LodIndex));
-    const auto InVertsNum = VertexDataPerimeterArray.Num();
-    ULineBatchComponent* const LineBatch = GetDebugLineBatch(World, GBPersistentLines, DrawLineLifeTime, false);
-    for (int32 Vert0 = InVertsNum - 1, Vert1 = 0; Vert1 < InVertsNum; Vert0 = Vert1++) {
-        LineBatch->DrawLine(VertexDataPerimeterArray[Vert0].VertexPos, VertexDataPerimeterArray[Vert1].VertexPos, FColor::Green, DepthPriority, DrawLineThickness, DrawLineLifeTime);
-    }
+    // 子の輪郭と属性情報描画
+    const auto Cache = FindOrBuildOutlineCache(StaticMeshComponent, LodIndex);
+    if (Cache == nullptr || CityObjectGroup == nullptr)
+        return;
 
-    // 子の属性情報表示
-    const auto& [GmlID, CityObjectIndex, Type, Attributes, Children] = CityObjectGroup->GetAtomicCityObjectByRaycast(HitResult);
-    FString AttrInfoString;
-    for (const auto& AttributeMap : Attributes.AttributeMap) {
-        if (AttributeMap.Value.Type == EPLATEAUAttributeType::String) {
-            AttrInfoString = FString::Format(TEXT("Key: {0}, Value: {1}"), {AttributeMap.Key, AttributeMap.Value.StringValue});
-            break;
-        }
-    }
-    FVector SumVertPos;
-    for (int32 Vert0 = 0; Vert0 < InVertsNum; Vert0++) {
-        SumVertPos += VertexDataPerimeterArray[Vert0].VertexPos;
-    }
-    SumVertPos /= InVertsNum;
-    const FString DrawString = FString::Format(TEXT("{0}\n{1}"), {GmlID, AttrInfoString});
-    DrawDebugString(World, SumVertPos + WorldLocation, DrawString, nullptr, FColor::Green, -1);
+    DrawOutlineWithAttrInfo(World, GetMeshOutline(*Cache), Transform, GetAttrInfoString(CityObjectGroup->GetAtomicCityObjectByRaycast(HitResult)));
 }
 
 UStaticMeshComponent* UPLATEAUAttrInfoDrawGizmo::GetParentStaticMeshComponent(USceneComponent* SceneComponent) {
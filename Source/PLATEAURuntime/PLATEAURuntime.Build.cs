@@ -54,7 +54,6 @@ public class PLATEAURuntime : ModuleRules
             }
         );
 
-
         DynamicallyLoadedModuleNames.AddRange(
             new string[]
             {
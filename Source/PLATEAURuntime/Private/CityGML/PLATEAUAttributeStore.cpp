@@ -0,0 +1,164 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "CityGML/PLATEAUAttributeStore.h"
+
+#include "CityGML/PLATEAUAttributeValue.h"
+#include "CityGML/PLATEAUCityObject.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+
+namespace {
+    double ParseNumber(const FString& Value) {
+        double Number;
+        return LexTryParseString(Number, *Value) ? Number : TNumericLimits<double>::QuietNaN();
+    }
+
+    /**
+     * @brief 値を比較します。両方が数値の場合は数値として、それ以外は文字列として比較します。
+     */
+    bool Compare(const FString& Value, const double Number, const FPLATEAUAttributeCondition& Condition, const double ConditionNumber) {
+        const auto bNumeric = !FMath::IsNaN(Number) && !FMath::IsNaN(ConditionNumber);
+        const auto Order = bNumeric
+            ? (Number < ConditionNumber ? -1 : Number > ConditionNumber ? 1 : 0)
+            : Value.Compare(Condition.Value, ESearchCase::CaseSensitive);
+
+        switch (Condition.Operator) {
+        case EPLATEAUAttributeOperator::Equal:
+            return Order == 0;
+        case EPLATEAUAttributeOperator::NotEqual:
+            return Order != 0;
+        case EPLATEAUAttributeOperator::Less:
+            return Order < 0;
+        case EPLATEAUAttributeOperator::LessOrEqual:
+            return Order <= 0;
+        case EPLATEAUAttributeOperator::Greater:
+            return Order > 0;
+        case EPLATEAUAttributeOperator::GreaterOrEqual:
+            return Order >= 0;
+        default:
+            return true;
+        }
+    }
+}
+
+void FPLATEAUAttributeStore::FColumn::Add(const int32 Row, const FString& Value) {
+    auto ValueId = DictionaryIds.FindRef(Value, INDEX_NONE);
+    if (ValueId == INDEX_NONE) {
+        ValueId = Dictionary.Add(Value);
+        DictionaryNumbers.Add(ParseNumber(Value));
+        DictionaryIds.Add(Value, ValueId);
+    }
+    Rows.Add(Row);
+    ValueIds.Add(ValueId);
+}
+
+void FPLATEAUAttributeStore::Build(const TArray<UPLATEAUCityObjectGroup*>& InComponents) {
+    Components.Reset();
+    RowComponents.Reset();
+    RowGmlIDs.Reset();
+    Columns.Reset();
+
+    for (const auto Component : InComponents) {
+        const auto ComponentIndex = Components.Add(Component);
+
+        // 最小地物単位では子の都市オブジェクトは子コンポーネントにも含まれるため、主要地物のみを対象とする
+        const auto bHasOutsideChildren = Component->GetAttachChildren().ContainsByPredicate([](const USceneComponent* Child) {
+            return Child != nullptr && Child->IsA<UPLATEAUCityObjectGroup>();
+        });
+
+        const auto AddRow = [this, ComponentIndex](const FPLATEAUCityObject& CityObject) {
+            const auto Row = RowGmlIDs.Add(CityObject.GmlID);
+            RowComponents.Add(ComponentIndex);
+            AddAttributes(Row, CityObject.Attributes, FString());
+        };
+        for (const auto& CityObject : Component->GetAllRootCityObjects()) {
+            AddRow(CityObject);
+            if (bHasOutsideChildren)
+                continue;
+
+            for (const auto& Child : CityObject.Children) {
+                AddRow(Child);
+            }
+        }
+    }
+}
+
+void FPLATEAUAttributeStore::AddAttributes(const int32 Row, const FPLATEAUAttributeMap& Attributes, const FString& KeyPrefix) {
+    for (const auto& [Key, Value] : Attributes.AttributeMap) {
+        const auto Path = KeyPrefix + Key;
+        if (Value.Type == EPLATEAUAttributeType::AttributeSets) {
+            if (Value.Attributes.IsValid())
+                AddAttributes(Row, *Value.Attributes, Path + TEXT("/"));
+            continue;
+        }
+        Columns.FindOrAdd(Path).Add(Row, Value.StringValue);
+    }
+}
+
+bool FPLATEAUAttributeStore::IsUpToDate(const TArray<UPLATEAUCityObjectGroup*>& InComponents) const {
+    if (InComponents.Num() != Components.Num())
+        return false;
+
+    for (int32 i = 0; i < Components.Num(); ++i) {
+        if (Components[i].Get() != InComponents[i])
+            return false;
+    }
+    return true;
+}
+
+TBitArray<> FPLATEAUAttributeStore::Evaluate(const TArray<FPLATEAUAttributeCondition>& Conditions) const {
+    TBitArray<> Result(true, GetNumRows());
+    TBitArray<> ConditionRows;
+    for (const auto& Condition : Conditions) {
+        ConditionRows.Init(false, GetNumRows());
+        EvaluateCondition(Condition, ConditionRows);
+        Result.CombineWithBitwiseAND(ConditionRows, EBitwiseOperatorFlags::MaintainSize);
+    }
+    return Result;
+}
+
+void FPLATEAUAttributeStore::EvaluateCondition(const FPLATEAUAttributeCondition& Condition, TBitArray<>& OutRows) const {
+    // キーは構築時に展開済みのため、分割や入れ子の探索は不要
+    const auto Column = Columns.Find(Condition.Key);
+    if (Column == nullptr)
+        return;
+
+    if (Condition.Operator == EPLATEAUAttributeOperator::Exists) {
+        for (const auto Row : Column->Rows) {
+            OutRows[Row] = true;
+        }
+        return;
+    }
+
+    // 条件は値の種類ごとに1度だけ評価
+    const auto ConditionNumber = ParseNumber(Condition.Value);
+    TArray<bool> ValueMatches;
+    ValueMatches.SetNumUninitialized(Column->Dictionary.Num());
+    for (int32 i = 0; i < Column->Dictionary.Num(); ++i) {
+        ValueMatches[i] = Compare(Column->Dictionary[i], Column->DictionaryNumbers[i], Condition, ConditionNumber);
+    }
+
+    const auto Rows = Column->Rows.GetData();
+    const auto ValueIds = Column->ValueIds.GetData();
+    for (int32 i = 0; i < Column->Rows.Num(); ++i) {
+        if (ValueMatches[ValueIds[i]])
+            OutRows[Rows[i]] = true;
+    }
+}
+
+FPLATEAUAttributeQueryResult FPLATEAUAttributeStore::Query(const TArray<FPLATEAUAttributeCondition>& Conditions) const {
+    FPLATEAUAttributeQueryResult Result;
+    const auto Rows = Evaluate(Conditions);
+    for (TConstSetBitIterator<> It(Rows); It; ++It) {
+        const auto Row = It.GetIndex();
+        Result.GmlIDs.Add(RowGmlIDs[Row]);
+        if (const auto Component = Components[RowComponents[Row]].Get())
+            Result.Components.Add(Component);
+    }
+    return Result;
+}
+
+TArray<FString> FPLATEAUAttributeStore::GetKeys() const {
+    TArray<FString> Keys;
+    Columns.GetKeys(Keys);
+    return Keys;
+}
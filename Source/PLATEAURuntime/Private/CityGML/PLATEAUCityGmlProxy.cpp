@@ -2,6 +2,8 @@
 
 #include "CityGML/PLATEAUCityGmlProxy.h"
 #include "CityGML/PLATEAUCityModel.h"
+#include "Dataset/PLATEAUDatasetArchive.h"
+#include "Dataset/PLATEAUGmlReader.h"
 
 #include <citygml/citygml.h>
 #include <Misc/Paths.h>
@@ -50,16 +52,25 @@ std::shared_ptr<const citygml::CityModel> UPLATEAUCityGmlProxy::Load(const FPLAT
     if (SubFolderName.FindChar('_', Index))
         SubFolderName = SubFolderName.LeftChop(SubFolderName.Len() - Index);
 
-    const auto FullGmlPath =
-        FPaths::ProjectContentDir() +
-        "PLATEAU/Datasets/" +
-        GmlInfo.DatasetName +
-        "/udx/" +
-        SubFolderName + "/" +
-        GmlInfo.GmlName;
+    // コピーせずにインポートした場合はインポート元のフォルダ、zipファイルから読み込む
+    const auto RelativeGmlPath = TEXT("udx/") + SubFolderName + TEXT("/") + GmlInfo.GmlName;
+    FString FullGmlPath;
+    if (GmlInfo.DatasetSourcePath.IsEmpty()) {
+        FullGmlPath = FPaths::ProjectContentDir() + "PLATEAU/Datasets/" + GmlInfo.DatasetName + "/" + RelativeGmlPath;
+    }
+    else if (FPLATEAUDatasetArchive::IsArchivePath(GmlInfo.DatasetSourcePath)) {
+        const auto Archive = FPLATEAUDatasetArchive::Get(GmlInfo.DatasetSourcePath);
+        if (Archive.IsValid())
+            FullGmlPath = Archive->FindFileBySuffix(RelativeGmlPath);
+    }
+    else {
+        FullGmlPath = GmlInfo.DatasetSourcePath / RelativeGmlPath;
+    }
+
     std::shared_ptr<const citygml::CityModel> CityModelData;
     try {
-        CityModelData = citygml::load(TCHAR_TO_UTF8(*FullGmlPath), params);
+        if (!FullGmlPath.IsEmpty())
+            CityModelData = FPLATEAUGmlReader::Load(FullGmlPath, params);
     }
     catch (...) {
     }
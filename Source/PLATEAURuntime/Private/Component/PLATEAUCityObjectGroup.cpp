@@ -3,6 +3,11 @@
 #include "PLATEAUMeshExporter.h"
 #include "PLATEAUCityModelLoader.h"
 #include "CityGML/PLATEAUCityObject.h"
+#include "Component/PLATEAUCityObjectLookup.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+#include "StaticMeshResources.h"
+#include "Materials/MaterialInstanceDynamic.h"
 #include "PhysicsEngine/BodySetup.h"
 #include "PhysicsEngine/PhysicsSettings.h"
 #include <citygml/cityobject.h>
@@ -231,7 +236,7 @@ namespace {
     }
 }
 
-void UPLATEAUCityObjectGroup::FindCollisionUV(const FHitResult& HitResult, FVector2D& UV, const int32 UVChannel) {
+void UPLATEAUCityObjectGroup::FindCollisionUV(const FHitResult& HitResult, FVector2D& UV, int32 UVChannel) {
     if (!UPhysicsSettings::Get()->bSupportUVFromHitResults) {
         UE_LOG(LogTemp, Warning, TEXT("Calling FindCollisionUV but 'Support UV From Hit Results' is not enabled in project settings. This is required for finding UV for collision results."));
         return;
@@ -256,6 +261,8 @@ void UPLATEAUCityObjectGroup::FindCollisionUV(const FHitResult& HitResult, FVect
     }
 
     const auto& [IndexBuffer, VertPositions, VertUVs] = BodySetup->UVInfo;
+    if (UVChannel == INDEX_NONE)
+        UVChannel = GetCityObjectIndexUVChannel(VertUVs.Num());
     if (VertUVs.IsValidIndex(UVChannel) && IndexBuffer.IsValidIndex(HitResult.FaceIndex * 3 + 2)) {
         const int32 Index0 = IndexBuffer[HitResult.FaceIndex * 3 + 0];
         const int32 Index1 = IndexBuffer[HitResult.FaceIndex * 3 + 1];
@@ -278,8 +285,10 @@ void UPLATEAUCityObjectGroup::FindCollisionUV(const FHitResult& HitResult, FVect
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject, const plateau::polygonMesh::MeshGranularity& Granularity) {
+    SetSerializedCityObjects(CreateSerializedCityObjects(InNode, InCityObject), Granularity);
+}
 
-    SetMeshGranularity(Granularity);
+FString UPLATEAUCityObjectGroup::CreateSerializedCityObjects(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject) {
     const TSharedPtr<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
     // 親はなし
     JsonRootObject->SetStringField(plateau::CityObjectGroup::OutsideParentFieldName, "");
@@ -297,13 +306,19 @@ void UPLATEAUCityObjectGroup::SerializeCityObject(const plateau::polygonMesh::No
     JsonRootObject->SetArrayField(plateau::CityObjectGroup::CityObjectsFieldName, CityObjectsJsonArray);
 
     // Json書き出し
-    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SerializedCityObjects);
+    FString OutSerializedCityObjects;
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutSerializedCityObjects);
     FJsonSerializer::Serialize(JsonRootObject.ToSharedRef(), Writer);
+    return OutSerializedCityObjects;
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const FLoadInputData& InLoadInputData, const std::shared_ptr<const citygml::CityModel> InCityModel) {
+    const auto Granularity = InLoadInputData.ExtractOptions.mesh_granularity;
+    SetSerializedCityObjects(CreateSerializedCityObjects(InNodeName, InMesh, Granularity, InCityModel), Granularity);
+}
 
-    SetMeshGranularity(InLoadInputData.ExtractOptions.mesh_granularity);
+FString UPLATEAUCityObjectGroup::CreateSerializedCityObjects(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh,
+                                                             const plateau::polygonMesh::MeshGranularity Granularity, const std::shared_ptr<const citygml::CityModel> InCityModel) {
     const auto& CityObjectList = InMesh.getCityObjectList();
     const std::vector<plateau::polygonMesh::CityObjectIndex> CityObjectIndices = *CityObjectList.getAllKeys();
     const TSharedPtr<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
@@ -312,7 +327,7 @@ void UPLATEAUCityObjectGroup::SerializeCityObject(const std::string& InNodeName,
     JsonRootObject->SetArrayField(plateau::CityObjectGroup::OutsideChildrenFieldName, {});
 
     // 最小地物単位の親を求める（主要地物のIDを設定）
-    if (plateau::polygonMesh::MeshGranularity::PerAtomicFeatureObject == InLoadInputData.ExtractOptions.mesh_granularity) {
+    if (plateau::polygonMesh::MeshGranularity::PerAtomicFeatureObject == Granularity) {
         for (const auto& CityObjectIndex : CityObjectIndices) {
             const auto& AtomicGmlId = CityObjectList.getAtomicGmlID(CityObjectIndex);
             if (AtomicGmlId != InNodeName) {
@@ -321,7 +336,7 @@ void UPLATEAUCityObjectGroup::SerializeCityObject(const std::string& InNodeName,
         }
     }
 
-    if (plateau::polygonMesh::MeshGranularity::PerCityModelArea == InLoadInputData.ExtractOptions.mesh_granularity) {
+    if (plateau::polygonMesh::MeshGranularity::PerCityModelArea == Granularity) {
         // 地域単位
         TArray<TSharedPtr<FJsonValue>> CityObjectJsonArray;
         TSharedPtr<FJsonObject> CityJsonObjectParent = MakeShareable(new FJsonObject);
@@ -359,7 +374,7 @@ void UPLATEAUCityObjectGroup::SerializeCityObject(const std::string& InNodeName,
             TArray<TSharedPtr<FJsonValue>> CityObjectJsonArray;
             CityObjectJsonArray.Emplace(MakeShared<FJsonValueObject>(CityJsonObjectParent));
 
-            if (plateau::polygonMesh::MeshGranularity::PerPrimaryFeatureObject == InLoadInputData.ExtractOptions.mesh_granularity) {
+            if (plateau::polygonMesh::MeshGranularity::PerPrimaryFeatureObject == Granularity) {
                 TArray<TSharedPtr<FJsonValue>> CityObjectsChildrenJsonArray;
                 for (const auto& CityObjectIndex : CityObjectIndices) {
                     const auto& AtomicGmlId = CityObjectList.getAtomicGmlID(CityObjectIndex);
@@ -379,8 +394,15 @@ void UPLATEAUCityObjectGroup::SerializeCityObject(const std::string& InNodeName,
         }
     }
 
-    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SerializedCityObjects);
+    FString OutSerializedCityObjects;
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutSerializedCityObjects);
     FJsonSerializer::Serialize(JsonRootObject.ToSharedRef(), Writer);
+    return OutSerializedCityObjects;
+}
+
+void UPLATEAUCityObjectGroup::SetSerializedCityObjects(FString&& InSerializedCityObjects, const plateau::polygonMesh::MeshGranularity& Granularity) {
+    SetMeshGranularity(Granularity);
+    SerializedCityObjects = MoveTemp(InSerializedCityObjects);
 }
 
 void UPLATEAUCityObjectGroup::SerializeCityObject(const plateau::polygonMesh::Node& InNode, const FPLATEAUCityObject& InCityObject, const plateau::granularityConvert::ConvertGranularity& Granularity) {
@@ -522,10 +544,11 @@ FPLATEAUCityObject UPLATEAUCityObjectGroup::GetPrimaryCityObjectByRaycast(const
     }
 
     if (OutsideParent.IsEmpty()) {
-        FVector2d UV;
-        FindCollisionUV(HitResult, UV);
-        UV.Y = -1;
-        return GetCityObjectByUV(UV);
+        FPLATEAUCityObjectIndex Index;
+        if (!FindCityObjectIndexByRaycast(HitResult, Index))
+            return FPLATEAUCityObject();
+        Index.AtomicIndex = -1;
+        return GetCityObjectByIndex(Index);
     }
 
     // 親を探す
@@ -542,9 +565,69 @@ FPLATEAUCityObject UPLATEAUCityObjectGroup::GetPrimaryCityObjectByRaycast(const
 }
 
 FPLATEAUCityObject UPLATEAUCityObjectGroup::GetAtomicCityObjectByRaycast(const FHitResult& HitResult) {
-    FVector2d UV;
-    FindCollisionUV(HitResult, UV);
-    return GetCityObjectByUV(UV);
+    FPLATEAUCityObjectIndex Index;
+    if (!FindCityObjectIndexByRaycast(HitResult, Index))
+        return FPLATEAUCityObject();
+    return GetCityObjectByIndex(Index);
+}
+
+bool UPLATEAUCityObjectGroup::UpdateTriangleCityObjectIndices() {
+    TriangleCityObjectSlots.Empty();
+    TriangleCityObjectIndexPalette.Empty();
+
+    const auto StaticMesh = GetStaticMesh();
+    const auto RenderData = StaticMesh != nullptr ? StaticMesh->GetRenderData() : nullptr;
+    if (RenderData == nullptr || RenderData->LODResources.Num() == 0)
+        return false;
+
+    // UStaticMesh::GetPhysicsTriMeshDataと同じLOD、セクション順で三角形を列挙し、コリジョンの三角形番号と対応させる
+    const auto LodIndex = FMath::Clamp(StaticMesh->LODForCollision, 0, RenderData->LODResources.Num() - 1);
+    const auto& LodResource = RenderData->LODResources[LodIndex];
+    const auto& VertexBuffer = LodResource.VertexBuffers.StaticMeshVertexBuffer;
+    const auto Indices = LodResource.IndexBuffer.GetArrayView();
+    const auto CityObjectIndexUVChannel = GetCityObjectIndexUVChannel(VertexBuffer.GetNumTexCoords());
+    if (CityObjectIndexUVChannel == INDEX_NONE || VertexBuffer.GetTexCoordData() == nullptr || Indices.Num() == 0)
+        return false;
+
+    // 同じ都市オブジェクトの三角形が大半を占めるため、インデックス自体は重複なしで保持
+    TMap<FIntPoint, int32> Slots;
+    for (const auto& Section : LodResource.Sections) {
+        if (!Section.bEnableCollision)
+            continue;
+
+        for (uint32 TriangleIndex = 0; TriangleIndex < Section.NumTriangles; ++TriangleIndex) {
+            const auto UV = VertexBuffer.GetVertexUV(Indices[Section.FirstIndex + TriangleIndex * 3], CityObjectIndexUVChannel);
+            const FIntPoint Index(static_cast<int32>(UV.X), static_cast<int32>(UV.Y));
+            const auto Slot = Slots.FindOrAdd(Index, TriangleCityObjectIndexPalette.Num());
+            if (Slot == TriangleCityObjectIndexPalette.Num())
+                TriangleCityObjectIndexPalette.Emplace(Index.X, Index.Y);
+            TriangleCityObjectSlots.Add(Slot);
+        }
+    }
+    return TriangleCityObjectSlots.Num() > 0;
+}
+
+bool UPLATEAUCityObjectGroup::FindCityObjectIndexByRaycast(const FHitResult& HitResult, FPLATEAUCityObjectIndex& OutIndex) {
+    // インデックス表を持たない既存のコンポーネントは可能であればその場で構築し、できなければUVから取得
+    if (TriangleCityObjectSlots.Num() == 0 && !UpdateTriangleCityObjectIndices()) {
+        FVector2D UV = FVector2D::ZeroVector;
+        FindCollisionUV(HitResult, UV);
+        OutIndex = FPLATEAUCityObjectIndex(static_cast<int32>(UV.X), static_cast<int32>(UV.Y));
+        return true;
+    }
+
+    // 非表示の都市オブジェクトを除いたコリジョンでは三角形番号が詰められている
+    auto FaceIndex = HitResult.FaceIndex;
+    if (CityObjectFilterBodySetup != nullptr && CityObjectFilterFaceMap.Num() > 0)
+        FaceIndex = CityObjectFilterFaceMap.IsValidIndex(FaceIndex) ? CityObjectFilterFaceMap[FaceIndex] : INDEX_NONE;
+
+    if (!TriangleCityObjectSlots.IsValidIndex(FaceIndex)) {
+        UE_LOG(LogTemp, Error, TEXT("Invalid face index %d: %s"), HitResult.FaceIndex, *GetName());
+        return false;
+    }
+
+    OutIndex = TriangleCityObjectIndexPalette[TriangleCityObjectSlots[FaceIndex]];
+    return true;
 }
 
 FPLATEAUCityObject UPLATEAUCityObjectGroup::GetCityObjectByUV(const FVector2d& UV) {
@@ -617,6 +700,13 @@ TArray<FPLATEAUCityObject> UPLATEAUCityObjectGroup::GetAllRootCityObjects() {
 const plateau::granularityConvert::ConvertGranularity UPLATEAUCityObjectGroup::GetConvertGranularity() {
     return static_cast<plateau::granularityConvert::ConvertGranularity>(MeshGranularityIntValue);
 }
+
+EPLATEAUVertexFormat UPLATEAUCityObjectGroup::GetVertexFormat() const {
+    const auto StaticMesh = GetStaticMesh();
+    if (StaticMesh != nullptr && StaticMesh->GetNumUVChannels(0) == 2)
+        return EPLATEAUVertexFormat::Compact;
+    return EPLATEAUVertexFormat::Standard;
+}
 /*
 const plateau::polygonMesh::MeshGranularity UPLATEAUCityObjectGroup::GetMeshGranularity() {
     if (MeshGranularityIntValue >= 4)
@@ -631,4 +721,269 @@ void UPLATEAUCityObjectGroup::SetConvertGranularity(const plateau::granularityCo
 
 void UPLATEAUCityObjectGroup::SetMeshGranularity(const plateau::polygonMesh::MeshGranularity Granularity) {
     MeshGranularityIntValue = (int)Granularity;
-}
\ No newline at end of file
+}
+
+bool UPLATEAUCityObjectGroup::UpdateCityObjectLookup(TFunctionRef<void(const FPLATEAUCityObject& CityObject, FColor& LookupValue)> UpdateFunc) {
+    // 子を含む全ての都市オブジェクトとテクセル座標を列挙し、テクスチャサイズを決定
+    const auto CityObjects = GetAllRootCityObjects();
+    TArray<TPair<const FPLATEAUCityObject*, FIntPoint>> Texels;
+    FIntPoint Size(1, 1);
+    const auto AddTexel = [&Texels, &Size](const FPLATEAUCityObject& CityObject) {
+        FIntPoint Texel;
+        if (!FPLATEAUCityObjectLookup::TryGetTexel(CityObject.CityObjectIndex, Texel))
+            return;
+        Texels.Emplace(&CityObject, Texel);
+        Size = Size.ComponentMax(Texel + FIntPoint(1, 1));
+    };
+    for (const auto& CityObject : CityObjects) {
+        AddTexel(CityObject);
+        for (const auto& Child : CityObject.Children) {
+            AddTexel(Child);
+        }
+    }
+
+    // サイズが変わる場合は既存の値を引き継いで再確保(既定値は白、可視)
+    if (Size != CityObjectLookupSize) {
+        TArray<FColor> Pixels;
+        Pixels.Init(FColor::White, Size.X * Size.Y);
+        for (int32 Y = 0; Y < FMath::Min(Size.Y, CityObjectLookupSize.Y); ++Y) {
+            for (int32 X = 0; X < FMath::Min(Size.X, CityObjectLookupSize.X); ++X) {
+                Pixels[Y * Size.X + X] = CityObjectLookupPixels[Y * CityObjectLookupSize.X + X];
+            }
+        }
+        CityObjectLookupPixels = MoveTemp(Pixels);
+        CityObjectLookupSize = Size;
+    }
+
+    for (const auto& [CityObject, Texel] : Texels) {
+        UpdateFunc(*CityObject, CityObjectLookupPixels[Texel.Y * Size.X + Texel.X]);
+    }
+
+    CityObjectLookupTexture = FPLATEAUCityObjectLookup::UpdateTexture(CityObjectLookupTexture, CityObjectLookupSize, CityObjectLookupPixels, this);
+    if (CityObjectLookupTexture == nullptr) {
+        ResetCityObjectLookup();
+        return false;
+    }
+    return ApplyCityObjectLookupMaterials();
+}
+
+void UPLATEAUCityObjectGroup::SetCityObjectClassColorEnabled(const bool bEnabled) {
+    bCityObjectClassColorEnabled = bEnabled;
+    if (HasCityObjectLookup())
+        ApplyCityObjectLookupMaterials();
+}
+
+void UPLATEAUCityObjectGroup::ResetCityObjectLookup() {
+    for (int32 i = 0; i < CityObjectLookupOriginalMaterials.Num(); ++i) {
+        SetMaterial(i, CityObjectLookupOriginalMaterials[i]);
+    }
+    CityObjectLookupOriginalMaterials.Empty();
+    CityObjectLookupPixels.Empty();
+    CityObjectLookupSize = FIntPoint::ZeroValue;
+    CityObjectLookupTexture = nullptr;
+    bCityObjectClassColorEnabled = false;
+    UpdateCityObjectFilterCollision();
+}
+
+void UPLATEAUCityObjectGroup::OnRegister() {
+    Super::OnRegister();
+
+    // ルックアップテクスチャは保存されないため再生成
+    if (HasCityObjectLookup() && CityObjectLookupTexture == nullptr) {
+        CityObjectLookupTexture = FPLATEAUCityObjectLookup::UpdateTexture(nullptr, CityObjectLookupSize, CityObjectLookupPixels, this);
+        if (CityObjectLookupTexture != nullptr)
+            ApplyCityObjectLookupMaterials();
+    }
+}
+
+bool UPLATEAUCityObjectGroup::ApplyCityObjectLookupMaterials() {
+    const auto StaticMesh = GetStaticMesh();
+    const auto UVChannel = GetCityObjectIndexUVChannel(StaticMesh != nullptr ? StaticMesh->GetNumUVChannels(0) : 0);
+    if (UVChannel == INDEX_NONE)
+        return false;
+
+    const auto BaseMaterial = FPLATEAUCityObjectLookup::GetBaseMaterial(UVChannel);
+    if (BaseMaterial == nullptr)
+        return false;
+
+    if (CityObjectLookupOriginalMaterials.Num() == 0) {
+        for (const auto Material : GetMaterials()) {
+            CityObjectLookupOriginalMaterials.Add(Material);
+        }
+    }
+
+    TArray<FString> UnsupportedMaterialNames;
+    for (int32 i = 0; i < GetNumMaterials(); ++i) {
+        const auto Original = CityObjectLookupOriginalMaterials.IsValidIndex(i) ? CityObjectLookupOriginalMaterials[i].Get() : nullptr;
+        auto DynMaterial = Cast<UMaterialInstanceDynamic>(GetMaterial(i));
+        if (DynMaterial == nullptr || DynMaterial == Original || (DynMaterial->Parent != BaseMaterial && DynMaterial->Parent != Original)) {
+            // ユーザー指定やFallback等のマテリアルは見た目を維持するため置き換えない
+            DynMaterial = FPLATEAUCityObjectLookup::CreateMaterial(Original, UVChannel, this);
+            if (DynMaterial == nullptr) {
+                UnsupportedMaterialNames.Add(GetNameSafe(Original));
+                continue;
+            }
+            SetMaterial(i, DynMaterial);
+        }
+
+        DynMaterial->SetTextureParameterValue(FPLATEAUCityObjectLookup::LookupTextureParameterName, CityObjectLookupTexture);
+        DynMaterial->SetVectorParameterValue(FPLATEAUCityObjectLookup::LookupSizeParameterName,
+            FLinearColor(CityObjectLookupSize.X, CityObjectLookupSize.Y, 0, 0));
+        DynMaterial->SetScalarParameterValue(FPLATEAUCityObjectLookup::ClassColorWeightParameterName,
+            bCityObjectClassColorEnabled ? 1.0f : 0.0f);
+    }
+
+    if (UnsupportedMaterialNames.Num() > 0) {
+        UE_LOG(LogTemp, Warning, TEXT("%s: Materials without the %s parameter keep hidden city objects visible: %s"),
+            *GetName(), *FPLATEAUCityObjectLookup::LookupTextureParameterName.ToString(), *FString::Join(UnsupportedMaterialNames, TEXT(", ")));
+    }
+    return true;
+}
+
+bool UPLATEAUCityObjectGroup::SetCityObjectVisibility(TFunctionRef<bool(const FPLATEAUCityObject& CityObject)> IsVisible, const bool bKeepHidden) {
+    bool bAnyHidden = bKeepHidden && HasHiddenCityObjects();
+    for (const auto& CityObject : GetAllRootCityObjects()) {
+        bAnyHidden |= !IsVisible(CityObject);
+        for (const auto& Child : CityObject.Children) {
+            bAnyHidden |= !IsVisible(Child);
+        }
+    }
+
+    // 全て可視で分類色も使用しない場合はルックアップ自体が不要
+    if (!bAnyHidden && !bCityObjectClassColorEnabled) {
+        if (HasCityObjectLookup())
+            ResetCityObjectLookup();
+        return true;
+    }
+
+    bool bAnyVisible = false;
+    bool bVisibilityChanged = false;
+    const auto bApplied = UpdateCityObjectLookup([&](const FPLATEAUCityObject& CityObject, FColor& LookupValue) {
+        const uint8 Alpha = (!bKeepHidden || LookupValue.A != 0) && IsVisible(CityObject) ? 255 : 0;
+        bVisibilityChanged |= LookupValue.A != Alpha;
+        bAnyVisible |= Alpha != 0;
+        LookupValue.A = Alpha;
+    });
+    if (!bApplied)
+        return true;
+
+    if (bVisibilityChanged)
+        UpdateCityObjectFilterCollision();
+    return bAnyVisible;
+}
+
+bool UPLATEAUCityObjectGroup::HasHiddenCityObjects() const {
+    return CityObjectLookupPixels.ContainsByPredicate([](const FColor& Pixel) {
+        return Pixel.A == 0;
+    });
+}
+
+bool UPLATEAUCityObjectGroup::IsCityObjectHidden(const FVector2D& CityObjectIndexUV) const {
+    return IsCityObjectHidden(FPLATEAUCityObjectIndex(static_cast<int32>(CityObjectIndexUV.X), static_cast<int32>(CityObjectIndexUV.Y)));
+}
+
+bool UPLATEAUCityObjectGroup::IsCityObjectHidden(const FPLATEAUCityObjectIndex& Index) const {
+    FIntPoint Texel;
+    if (!FPLATEAUCityObjectLookup::TryGetTexel(Index, Texel) || Texel.X >= CityObjectLookupSize.X || Texel.Y >= CityObjectLookupSize.Y)
+        return false;
+
+    return CityObjectLookupPixels[Texel.Y * CityObjectLookupSize.X + Texel.X].A == 0;
+}
+
+void UPLATEAUCityObjectGroup::UpdateCityObjectFilterCollision() {
+    // 複雑コリジョンを使用している場合のみ三角形単位で除外(バウンディングボックスのコリジョンはそのまま)
+    const auto MeshBodySetup = GetStaticMesh() != nullptr ? GetStaticMesh()->GetBodySetup() : nullptr;
+    const auto bUseFilter = HasHiddenCityObjects() && MeshBodySetup != nullptr
+        && MeshBodySetup->CollisionTraceFlag == ECollisionTraceFlag::CTF_UseComplexAsSimple
+        && ContainsPhysicsTriMeshData(true);
+    if (!bUseFilter) {
+        PendingCityObjectFilterBodySetup = nullptr;
+        CityObjectFilterFaceMap.Empty();
+        if (CityObjectFilterBodySetup != nullptr) {
+            CityObjectFilterBodySetup = nullptr;
+            RecreatePhysicsState();
+        }
+        return;
+    }
+
+    // クッキング中も現在のコリジョンを使い続けるため、新しいBodySetupを作成して完了後に置き換える
+    const auto BodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+    BodySetup->BodySetupGuid = FGuid::NewGuid();
+    BodySetup->bGenerateMirroredCollision = false;
+    BodySetup->bDoubleSidedGeometry = MeshBodySetup->bDoubleSidedGeometry;
+    BodySetup->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
+    PendingCityObjectFilterBodySetup = BodySetup;
+    const auto FaceMap = MakeShared<TArray<int32>>();
+    BodySetup->CreatePhysicsMeshesAsync(FOnAsyncPhysicsCookFinished::CreateWeakLambda(this, [this, BodySetup, FaceMap](bool bSuccess) {
+        // 後続の更新で置き換えられている場合は破棄
+        if (PendingCityObjectFilterBodySetup != BodySetup)
+            return;
+
+        PendingCityObjectFilterBodySetup = nullptr;
+        if (!bSuccess) {
+            UE_LOG(LogTemp, Warning, TEXT("Failed to cook filtered collision: %s"), *GetName());
+            return;
+        }
+        CityObjectFilterBodySetup = BodySetup;
+        CityObjectFilterFaceMap = MoveTemp(*FaceMap);
+        RecreatePhysicsState();
+    }));
+
+    // 三角形データはCreatePhysicsMeshesAsync内でGetPhysicsTriMeshDataから同期的に取得される
+    *FaceMap = MoveTemp(PendingCityObjectFilterFaceMap);
+}
+
+UBodySetup* UPLATEAUCityObjectGroup::GetBodySetup() {
+    if (CityObjectFilterBodySetup != nullptr)
+        return CityObjectFilterBodySetup;
+
+    return Super::GetBodySetup();
+}
+
+bool UPLATEAUCityObjectGroup::GetPhysicsTriMeshData(FTriMeshCollisionData* CollisionData, bool InUseAllTriData) {
+    PendingCityObjectFilterFaceMap.Empty();
+
+    const auto StaticMesh = GetStaticMesh();
+    if (StaticMesh == nullptr || !StaticMesh->GetPhysicsTriMeshData(CollisionData, InUseAllTriData))
+        return false;
+
+    // 三角形ごとのインデックス表、または都市オブジェクトインデックスのUVが無い場合は除外できない
+    const auto bUseTriangleTable = !InUseAllTriData && TriangleCityObjectSlots.Num() == CollisionData->Indices.Num();
+    const auto CityObjectIndexUVChannel = GetCityObjectIndexUVChannel(CollisionData->UVs.Num());
+    if (!bUseTriangleTable && CityObjectIndexUVChannel == INDEX_NONE) {
+        UE_LOG(LogTemp, Warning, TEXT("City object indices of collision triangles are not available. Hidden city objects are not excluded from collision: %s"), *GetName());
+        return true;
+    }
+
+    TArray<bool> HiddenSlots;
+    if (bUseTriangleTable) {
+        for (const auto& Index : TriangleCityObjectIndexPalette) {
+            HiddenSlots.Add(IsCityObjectHidden(Index));
+        }
+    }
+
+    const auto bHasMaterialIndices = CollisionData->MaterialIndices.Num() == CollisionData->Indices.Num();
+    TArray<FTriIndices> Indices;
+    TArray<uint16> MaterialIndices;
+    for (int32 i = 0; i < CollisionData->Indices.Num(); ++i) {
+        const auto& Triangle = CollisionData->Indices[i];
+        const auto bHidden = bUseTriangleTable
+            ? HiddenSlots[TriangleCityObjectSlots[i]]
+            : IsCityObjectHidden(CollisionData->UVs[CityObjectIndexUVChannel][Triangle.v0]);
+        if (bHidden)
+            continue;
+
+        Indices.Add(Triangle);
+        PendingCityObjectFilterFaceMap.Add(i);
+        if (bHasMaterialIndices)
+            MaterialIndices.Add(CollisionData->MaterialIndices[i]);
+    }
+    CollisionData->Indices = MoveTemp(Indices);
+    CollisionData->MaterialIndices = MoveTemp(MaterialIndices);
+    return true;
+}
+
+bool UPLATEAUCityObjectGroup::ContainsPhysicsTriMeshData(bool InUseAllTriData) const {
+    const auto StaticMesh = GetStaticMesh();
+    return StaticMesh != nullptr && StaticMesh->ContainsPhysicsTriMeshData(InUseAllTriData);
+}
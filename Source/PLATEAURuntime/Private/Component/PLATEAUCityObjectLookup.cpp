@@ -0,0 +1,222 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Component/PLATEAUCityObjectLookup.h"
+
+#include "CityGML/PLATEAUCityObject.h"
+#include "Engine/Texture2D.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "RHI.h"
+#include "TextureResource.h"
+
+#if WITH_EDITOR
+#include "Materials/MaterialExpressionAdd.h"
+#include "Materials/MaterialExpressionAppendVector.h"
+#include "Materials/MaterialExpressionComponentMask.h"
+#include "Materials/MaterialExpressionConstant2Vector.h"
+#include "Materials/MaterialExpressionDivide.h"
+#include "Materials/MaterialExpressionLinearInterpolate.h"
+#include "Materials/MaterialExpressionMultiply.h"
+#include "Materials/MaterialExpressionScalarParameter.h"
+#include "Materials/MaterialExpressionTextureCoordinate.h"
+#include "Materials/MaterialExpressionTextureSampleParameter2D.h"
+#include "Materials/MaterialExpressionVectorParameter.h"
+#endif
+
+const FName FPLATEAUCityObjectLookup::LookupTextureParameterName = TEXT("LookupTexture");
+const FName FPLATEAUCityObjectLookup::LookupSizeParameterName = TEXT("LookupSize");
+const FName FPLATEAUCityObjectLookup::ClassColorWeightParameterName = TEXT("ClassColorWeight");
+const FString FPLATEAUCityObjectLookup::BaseMaterialPackageName = TEXT("/PLATEAU-SDK-for-Unreal/Materials/PLATEAUCityObjectLookupMaterial");
+
+namespace {
+    const TCHAR* DefaultTexturePath = TEXT("/Engine/EngineResources/WhiteSquareTexture.WhiteSquareTexture");
+    //! 共有マテリアルで置き換え可能なSDKの既定マテリアル(テクスチャ * 基本色のみ)
+    const TCHAR* SDKDefaultMaterialPath = TEXT("/PLATEAU-SDK-for-Unreal/Materials/DefaultMaterial.DefaultMaterial");
+
+#if WITH_EDITOR
+    template<typename ExpressionType>
+    ExpressionType* AddExpression(UMaterial* Material) {
+        const auto Expression = NewObject<ExpressionType>(Material);
+        Material->GetExpressionCollection().AddExpression(Expression);
+        return Expression;
+    }
+
+    UMaterialExpressionComponentMask* AddComponentMask(UMaterial* Material, UMaterialExpression* Input, const bool R, const bool G, const bool B, const bool A) {
+        const auto Mask = AddExpression<UMaterialExpressionComponentMask>(Material);
+        Mask->Input.Connect(0, Input);
+        Mask->R = R;
+        Mask->G = G;
+        Mask->B = B;
+        Mask->A = A;
+        return Mask;
+    }
+
+    /**
+     * @brief ルックアップテクスチャを参照する共有マテリアルのノードを構築します。
+     * BaseColor = lerp(Texture * BaseColor, Lookup.rgb, ClassColorWeight), OpacityMask = Lookup.a
+     */
+    void BuildBaseMaterial(UMaterial* Material, const int32 UVChannel) {
+        const auto DefaultTexture = LoadObject<UTexture>(nullptr, DefaultTexturePath);
+
+        Material->BlendMode = BLEND_Masked;
+        Material->TwoSided = false;
+
+        // ルックアップUV = (Index.y + 1.5, Index.x + 0.5) / LookupSize
+        const auto CityObjectIndexUV = AddExpression<UMaterialExpressionTextureCoordinate>(Material);
+        CityObjectIndexUV->CoordinateIndex = UVChannel;
+        const auto Swizzle = AddExpression<UMaterialExpressionAppendVector>(Material);
+        Swizzle->A.Connect(0, AddComponentMask(Material, CityObjectIndexUV, false, true, false, false));
+        Swizzle->B.Connect(0, AddComponentMask(Material, CityObjectIndexUV, true, false, false, false));
+        const auto TexelCenter = AddExpression<UMaterialExpressionConstant2Vector>(Material);
+        TexelCenter->R = 1.5f;
+        TexelCenter->G = 0.5f;
+        const auto Texel = AddExpression<UMaterialExpressionAdd>(Material);
+        Texel->A.Connect(0, Swizzle);
+        Texel->B.Connect(0, TexelCenter);
+        const auto LookupSize = AddExpression<UMaterialExpressionVectorParameter>(Material);
+        LookupSize->ParameterName = FPLATEAUCityObjectLookup::LookupSizeParameterName;
+        LookupSize->DefaultValue = FLinearColor(1, 1, 0, 0);
+        const auto LookupUV = AddExpression<UMaterialExpressionDivide>(Material);
+        LookupUV->A.Connect(0, Texel);
+        LookupUV->B.Connect(0, AddComponentMask(Material, LookupSize, true, true, false, false));
+
+        const auto Lookup = AddExpression<UMaterialExpressionTextureSampleParameter2D>(Material);
+        Lookup->ParameterName = FPLATEAUCityObjectLookup::LookupTextureParameterName;
+        Lookup->Texture = DefaultTexture;
+        Lookup->SamplerType = SAMPLERTYPE_Color;
+        Lookup->Coordinates.Connect(0, LookupUV);
+
+        // 元の見た目(メッシュローダーのマテリアルと同じパラメータ名)
+        const auto BaseTexture = AddExpression<UMaterialExpressionTextureSampleParameter2D>(Material);
+        BaseTexture->ParameterName = TEXT("Texture");
+        BaseTexture->Texture = DefaultTexture;
+        BaseTexture->SamplerType = SAMPLERTYPE_Color;
+        const auto BaseColor = AddExpression<UMaterialExpressionVectorParameter>(Material);
+        BaseColor->ParameterName = TEXT("BaseColor");
+        BaseColor->DefaultValue = FLinearColor::White;
+        const auto OriginalColor = AddExpression<UMaterialExpressionMultiply>(Material);
+        OriginalColor->A.Connect(0, BaseTexture);
+        OriginalColor->B.Connect(0, AddComponentMask(Material, BaseColor, true, true, true, false));
+
+        const auto ClassColorWeight = AddExpression<UMaterialExpressionScalarParameter>(Material);
+        ClassColorWeight->ParameterName = FPLATEAUCityObjectLookup::ClassColorWeightParameterName;
+        ClassColorWeight->DefaultValue = 0.0f;
+        const auto Color = AddExpression<UMaterialExpressionLinearInterpolate>(Material);
+        Color->A.Connect(0, OriginalColor);
+        Color->B.Connect(0, Lookup);
+        Color->Alpha.Connect(0, ClassColorWeight);
+
+        const auto EditorOnlyData = Material->GetEditorOnlyData();
+        EditorOnlyData->BaseColor.Connect(0, Color);
+        // TextureSampleの出力4番がアルファ
+        EditorOnlyData->OpacityMask.Connect(4, Lookup);
+    }
+
+    /**
+     * @brief プラグインのコンテンツに共有マテリアルが無い場合に、保存しない一時的なマテリアルを生成します。
+     * プロジェクトのコンテンツは変更せず、同じUVチャンネルのマテリアルはエディタの終了まで使い回します。
+     */
+    UMaterial* GetOrCreateTransientBaseMaterial(const FString& PackageName, const int32 UVChannel) {
+        static TMap<int32, UMaterial*> TransientMaterials;
+        if (const auto Material = TransientMaterials.FindRef(UVChannel))
+            return Material;
+
+        UE_LOG(LogTemp, Warning, TEXT("City object lookup material is not found in the plugin content: %s. A transient material is used instead."), *PackageName);
+        const auto Material = NewObject<UMaterial>(GetTransientPackage(),
+            MakeUniqueObjectName(GetTransientPackage(), UMaterial::StaticClass(), *FPackageName::GetShortName(PackageName)), RF_Transient);
+        Material->PreEditChange(nullptr);
+        BuildBaseMaterial(Material, UVChannel);
+        Material->PostEditChange();
+        Material->AddToRoot();
+        TransientMaterials.Add(UVChannel, Material);
+        return Material;
+    }
+#endif
+}
+
+UMaterialInterface* FPLATEAUCityObjectLookup::GetBaseMaterial(const int32 UVChannel) {
+    // 既存のアセット(UV4)の名前は変更しない
+    const auto PackageName = UVChannel == 3 ? BaseMaterialPackageName : FString::Printf(TEXT("%s_UV%d"), *BaseMaterialPackageName, UVChannel + 1);
+    const auto ObjectPath = PackageName + TEXT(".") + FPackageName::GetShortName(PackageName);
+    if (const auto Material = LoadObject<UMaterialInterface>(nullptr, *ObjectPath, nullptr, LOAD_NoWarn))
+        return Material;
+
+#if WITH_EDITOR
+    return GetOrCreateTransientBaseMaterial(PackageName, UVChannel);
+#else
+    UE_LOG(LogTemp, Error, TEXT("City object lookup material is not found: %s"), *ObjectPath);
+    return nullptr;
+#endif
+}
+
+UMaterialInstanceDynamic* FPLATEAUCityObjectLookup::CreateMaterial(UMaterialInterface* Original, const int32 UVChannel, UObject* Outer) {
+    // ルックアップに対応したマテリアルは見た目をそのまま維持
+    UTexture* LookupTexture;
+    if (Original != nullptr && Original->GetTextureParameterValue(FHashedMaterialParameterInfo(LookupTextureParameterName), LookupTexture))
+        return UMaterialInstanceDynamic::Create(Original, Outer);
+
+    // 共有マテリアルと同じ見た目になるSDKの既定マテリアル以外は置き換えない
+    const auto OriginalBase = Original != nullptr ? Original->GetMaterial() : nullptr;
+    if (Original != nullptr && (OriginalBase == nullptr || OriginalBase->GetPathName() != SDKDefaultMaterialPath))
+        return nullptr;
+
+    const auto BaseMaterial = GetBaseMaterial(UVChannel);
+    if (BaseMaterial == nullptr)
+        return nullptr;
+
+    const auto DynMaterial = UMaterialInstanceDynamic::Create(BaseMaterial, Outer);
+    if (Original != nullptr) {
+        UTexture* Texture;
+        if (Original->GetTextureParameterValue(FHashedMaterialParameterInfo(TEXT("Texture")), Texture))
+            DynMaterial->SetTextureParameterValue(TEXT("Texture"), Texture);
+        FLinearColor BaseColor;
+        if (Original->GetVectorParameterValue(FHashedMaterialParameterInfo(TEXT("BaseColor")), BaseColor))
+            DynMaterial->SetVectorParameterValue(TEXT("BaseColor"), BaseColor);
+    }
+    return DynMaterial;
+}
+
+bool FPLATEAUCityObjectLookup::TryGetTexel(const FPLATEAUCityObjectIndex& Index, FIntPoint& OutTexel) {
+    if (Index.PrimaryIndex < 0 || Index.AtomicIndex < -1)
+        return false;
+
+    OutTexel = FIntPoint(Index.AtomicIndex + 1, Index.PrimaryIndex);
+    return true;
+}
+
+UTexture2D* FPLATEAUCityObjectLookup::UpdateTexture(UTexture2D* Texture, const FIntPoint& Size, const TArray<FColor>& Pixels, UObject* Outer) {
+    check(Pixels.Num() == Size.X * Size.Y);
+
+    const auto MaxDimension = static_cast<int32>(GetMax2DTextureDimension());
+    if (Size.X <= 0 || Size.Y <= 0 || Size.X > MaxDimension || Size.Y > MaxDimension) {
+        UE_LOG(LogTemp, Error, TEXT("City object lookup texture size (%d, %d) exceeds the limit %d."), Size.X, Size.Y, MaxDimension);
+        return nullptr;
+    }
+
+    // サイズが変わらない場合はテクセルのみ更新
+    if (Texture != nullptr && Texture->GetSizeX() == Size.X && Texture->GetSizeY() == Size.Y && Texture->GetResource() != nullptr) {
+        const auto Region = new FUpdateTextureRegion2D(0, 0, 0, 0, Size.X, Size.Y);
+        const auto Data = new TArray<FColor>(Pixels);
+        Texture->UpdateTextureRegions(0, 1, Region, Size.X * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(Data->GetData()),
+            [Data](uint8*, const FUpdateTextureRegion2D* InRegion) {
+                delete Data;
+                delete InRegion;
+            });
+        return Texture;
+    }
+
+    const auto NewTexture = UTexture2D::CreateTransient(Size.X, Size.Y, PF_B8G8R8A8, NAME_None);
+    NewTexture->Rename(nullptr, Outer, REN_DontCreateRedirectors | REN_NonTransactional);
+    NewTexture->Filter = TF_Nearest;
+    NewTexture->AddressX = TA_Clamp;
+    NewTexture->AddressY = TA_Clamp;
+    NewTexture->SRGB = true;
+    NewTexture->NeverStream = true;
+
+    auto& Mip = NewTexture->GetPlatformData()->Mips[0];
+    void* MipData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+    FMemory::Memcpy(MipData, Pixels.GetData(), Pixels.Num() * sizeof(FColor));
+    Mip.BulkData.Unlock();
+    NewTexture->UpdateResource();
+    return NewTexture;
+}
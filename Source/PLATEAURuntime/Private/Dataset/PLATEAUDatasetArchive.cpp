@@ -0,0 +1,401 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Dataset/PLATEAUDatasetArchive.h"
+
+#include <plateau/dataset/i_dataset_accessor.h>
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace {
+    const FString ArchiveExtension = TEXT(".zip");
+    const FString UdxFolderName = TEXT("udx");
+
+    FCriticalSection ArchivesSection;
+    TMap<FString, TSharedPtr<FPLATEAUDatasetArchive>> Archives;
+
+    /**
+     * @brief アーカイブ内のパスからudx直下のフォルダ名を取得します。udx以下のGMLファイルでない場合falseを返します。
+     */
+    bool TryGetUdxSubFolderName(const FString& EntryName, FString& OutSubFolderName) {
+        if (!EntryName.EndsWith(TEXT(".gml"), ESearchCase::IgnoreCase))
+            return false;
+
+        TArray<FString> Sections;
+        EntryName.ParseIntoArray(Sections, TEXT("/"), true);
+        // {...}/udx/{フォルダ名}/{GMLファイル名}
+        if (Sections.Num() < 3 || Sections[Sections.Num() - 3] != UdxFolderName)
+            return false;
+
+        OutSubFolderName = Sections[Sections.Num() - 2];
+        return true;
+    }
+
+    FString GetGmlMeshCode(const FString& EntryName) {
+        FString MeshCode;
+        FPaths::GetCleanFilename(EntryName).Split(TEXT("_"), &MeshCode, nullptr);
+        return MeshCode;
+    }
+
+    namespace Zip {
+        constexpr uint32 LocalFileHeaderSignature = 0x04034b50;
+        constexpr uint32 CentralDirectoryHeaderSignature = 0x02014b50;
+        constexpr uint32 EndOfCentralDirectorySignature = 0x06054b50;
+        constexpr uint32 Zip64EndOfCentralDirectorySignature = 0x06064b50;
+        constexpr uint32 Zip64EndOfCentralDirectoryLocatorSignature = 0x07064b50;
+        constexpr uint16 Zip64ExtraFieldId = 0x0001;
+
+        constexpr int32 LocalFileHeaderSize = 30;
+        constexpr int32 CentralDirectoryHeaderSize = 46;
+        constexpr int32 EndOfCentralDirectorySize = 22;
+        constexpr int32 Zip64EndOfCentralDirectorySize = 56;
+        constexpr int32 Zip64EndOfCentralDirectoryLocatorSize = 20;
+        constexpr int32 MaxCommentSize = 0xFFFF;
+
+        constexpr uint16 MethodStored = 0;
+        constexpr uint16 MethodDeflated = 8;
+        constexpr uint16 FlagEncrypted = 0x0001;
+
+        //! zipのフィールドはリトルエンディアン
+        template <typename ValueType>
+        ValueType Read(const uint8* Data) {
+            ValueType Value;
+            FMemory::Memcpy(&Value, Data, sizeof(ValueType));
+            return Value;
+        }
+
+        bool ReadAt(IFileHandle& FileHandle, const int64 Offset, uint8* Data, const int64 Size) {
+            return FileHandle.Seek(Offset) && FileHandle.Read(Data, Size);
+        }
+    }
+}
+
+FPLATEAUDatasetArchive::FPLATEAUDatasetArchive(const FString& InArchivePath)
+    : ArchivePath(FPaths::ConvertRelativePathToFull(InArchivePath)) {
+    FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*ArchivePath));
+    if (!FileHandle.IsValid()) {
+        UE_LOG(LogTemp, Error, TEXT("Failed to open dataset archive: %s"), *ArchivePath);
+        return;
+    }
+
+    if (!ReadCentralDirectory()) {
+        UE_LOG(LogTemp, Error, TEXT("Invalid dataset archive: %s"), *ArchivePath);
+        FileHandle.Reset();
+        EntryNames.Empty();
+        Entries.Empty();
+    }
+}
+
+FPLATEAUDatasetArchive::~FPLATEAUDatasetArchive() = default;
+
+bool FPLATEAUDatasetArchive::IsArchivePath(const FString& Path) {
+    FString ArchivePath, EntryName;
+    return Path.EndsWith(ArchiveExtension, ESearchCase::IgnoreCase) || SplitVirtualPath(Path, ArchivePath, EntryName);
+}
+
+bool FPLATEAUDatasetArchive::SplitVirtualPath(const FString& VirtualPath, FString& OutArchivePath, FString& OutEntryName) {
+    auto NormalizedPath = VirtualPath;
+    NormalizedPath.ReplaceCharInline(TEXT('\\'), TEXT('/'));
+
+    const auto Separator = ArchiveExtension + TEXT("/");
+    const auto Index = NormalizedPath.Find(Separator, ESearchCase::IgnoreCase);
+    if (Index == INDEX_NONE)
+        return false;
+
+    OutArchivePath = NormalizedPath.Left(Index + ArchiveExtension.Len());
+    OutEntryName = NormalizedPath.RightChop(Index + Separator.Len());
+    return true;
+}
+
+TSharedPtr<FPLATEAUDatasetArchive> FPLATEAUDatasetArchive::Get(const FString& ArchivePath) {
+    const auto Key = FPaths::ConvertRelativePathToFull(ArchivePath);
+
+    FScopeLock Lock(&ArchivesSection);
+    if (const auto Archive = Archives.Find(Key))
+        return *Archive;
+
+    const auto Archive = MakeShared<FPLATEAUDatasetArchive>(Key);
+    if (!Archive->IsValid())
+        return nullptr;
+
+    return Archives.Add(Key, Archive);
+}
+
+void FPLATEAUDatasetArchive::Release(const FString& ArchivePath) {
+    FString VirtualArchivePath, EntryName;
+    const auto Key = FPaths::ConvertRelativePathToFull(SplitVirtualPath(ArchivePath, VirtualArchivePath, EntryName) ? VirtualArchivePath : ArchivePath);
+
+    FScopeLock Lock(&ArchivesSection);
+    Archives.Remove(Key);
+}
+
+bool FPLATEAUDatasetArchive::LoadFileToArray(const FString& Path, TArray<uint8>& OutData) {
+    FString ArchivePath, EntryName;
+    if (!SplitVirtualPath(Path, ArchivePath, EntryName))
+        return FFileHelper::LoadFileToArray(OutData, *Path);
+
+    const auto Archive = Get(ArchivePath);
+    return Archive.IsValid() && Archive->ReadFile(EntryName, OutData);
+}
+
+bool FPLATEAUDatasetArchive::LoadFileToArray(const FString& Path, TArray64<uint8>& OutData) {
+    FString ArchivePath, EntryName;
+    if (!SplitVirtualPath(Path, ArchivePath, EntryName))
+        return FFileHelper::LoadFileToArray(OutData, *Path);
+
+    const auto Archive = Get(ArchivePath);
+    return Archive.IsValid() && Archive->ReadFile(EntryName, OutData);
+}
+
+int64 FPLATEAUDatasetArchive::GetFileSize(const FString& Path) {
+    FString ArchivePath, EntryName;
+    if (!SplitVirtualPath(Path, ArchivePath, EntryName))
+        return IFileManager::Get().FileSize(*Path);
+
+    const auto Archive = Get(ArchivePath);
+    return Archive.IsValid() ? Archive->GetEntrySize(EntryName) : -1;
+}
+
+bool FPLATEAUDatasetArchive::IsValid() const {
+    return FileHandle.IsValid();
+}
+
+TArray<FString> FPLATEAUDatasetArchive::FindGmlFiles(const TArray<FString>& MeshCodes, const plateau::dataset::PredefinedCityModelPackage Package) const {
+    TArray<FString> GmlFiles;
+    for (const auto& EntryName : EntryNames) {
+        FString SubFolderName;
+        if (!TryGetUdxSubFolderName(EntryName, SubFolderName))
+            continue;
+
+        if (plateau::dataset::UdxSubFolder::getPackage(TCHAR_TO_UTF8(*SubFolderName)) != Package)
+            continue;
+
+        // 地域メッシュコードは上位の桁が一致する場合に包含関係にある
+        const auto GmlMeshCode = GetGmlMeshCode(EntryName);
+        const auto bMatched = GmlMeshCode.IsEmpty() || MeshCodes.ContainsByPredicate([&GmlMeshCode](const FString& MeshCode) {
+            return MeshCode.StartsWith(GmlMeshCode) || GmlMeshCode.StartsWith(MeshCode);
+        });
+        if (bMatched)
+            GmlFiles.Add(MakeVirtualPath(EntryName));
+    }
+    return GmlFiles;
+}
+
+TSet<FString> FPLATEAUDatasetArchive::GetMeshCodes() const {
+    TSet<FString> MeshCodes;
+    for (const auto& EntryName : EntryNames) {
+        FString SubFolderName;
+        if (!TryGetUdxSubFolderName(EntryName, SubFolderName))
+            continue;
+
+        const auto MeshCode = GetGmlMeshCode(EntryName);
+        if (!MeshCode.IsEmpty())
+            MeshCodes.Add(MeshCode);
+    }
+    return MeshCodes;
+}
+
+FString FPLATEAUDatasetArchive::FindFileBySuffix(const FString& Suffix) const {
+    auto NormalizedSuffix = Suffix;
+    NormalizedSuffix.ReplaceCharInline(TEXT('\\'), TEXT('/'));
+    for (const auto& EntryName : EntryNames) {
+        if (EntryName.EndsWith(NormalizedSuffix, ESearchCase::IgnoreCase))
+            return MakeVirtualPath(EntryName);
+    }
+    return TEXT("");
+}
+
+bool FPLATEAUDatasetArchive::ReadFile(const FString& EntryName, TArray<uint8>& OutData) const {
+    const auto Entry = Entries.Find(EntryName);
+    if (Entry != nullptr && Entry->UncompressedSize > MAX_int32) {
+        UE_LOG(LogTemp, Error, TEXT("%s in %s is too large to read into a 32-bit array"), *EntryName, *ArchivePath);
+        return false;
+    }
+
+    return ReadEntry(EntryName, [&OutData](const int64 Size) {
+        OutData.SetNumUninitialized(static_cast<int32>(Size));
+        return OutData.GetData();
+    });
+}
+
+bool FPLATEAUDatasetArchive::ReadFile(const FString& EntryName, TArray64<uint8>& OutData) const {
+    return ReadEntry(EntryName, [&OutData](const int64 Size) {
+        OutData.SetNumUninitialized(Size);
+        return OutData.GetData();
+    });
+}
+
+int64 FPLATEAUDatasetArchive::GetEntrySize(const FString& EntryName) const {
+    const auto Entry = Entries.Find(EntryName);
+    return Entry != nullptr ? Entry->UncompressedSize : -1;
+}
+
+bool FPLATEAUDatasetArchive::ReadCentralDirectory() {
+    const auto FileSize = FileHandle->Size();
+    if (FileSize < Zip::EndOfCentralDirectorySize)
+        return false;
+
+    // 終端レコードは末尾のコメント(最大64KB)の直前にあるため後方から探す
+    const auto TailSize = static_cast<int32>(FMath::Min<int64>(FileSize, Zip::EndOfCentralDirectorySize + Zip::MaxCommentSize));
+    TArray<uint8> Tail;
+    Tail.SetNumUninitialized(TailSize);
+    if (!Zip::ReadAt(*FileHandle, FileSize - TailSize, Tail.GetData(), TailSize))
+        return false;
+
+    int32 EndIndex = TailSize - Zip::EndOfCentralDirectorySize;
+    while (EndIndex >= 0 && Zip::Read<uint32>(&Tail[EndIndex]) != Zip::EndOfCentralDirectorySignature) {
+        --EndIndex;
+    }
+    if (EndIndex < 0)
+        return false;
+
+    const uint8* End = &Tail[EndIndex];
+    int64 NumEntries = Zip::Read<uint16>(End + 10);
+    int64 CentralDirectorySize = Zip::Read<uint32>(End + 12);
+    int64 CentralDirectoryOffset = Zip::Read<uint32>(End + 16);
+
+    // 4GB以上またはエントリ数が65535以上の場合はZIP64の終端レコードを参照
+    const auto EndOffset = FileSize - TailSize + EndIndex;
+    uint8 Locator[Zip::Zip64EndOfCentralDirectoryLocatorSize];
+    if (EndOffset >= Zip::Zip64EndOfCentralDirectoryLocatorSize
+        && Zip::ReadAt(*FileHandle, EndOffset - Zip::Zip64EndOfCentralDirectoryLocatorSize, Locator, sizeof(Locator))
+        && Zip::Read<uint32>(Locator) == Zip::Zip64EndOfCentralDirectoryLocatorSignature) {
+        uint8 Zip64End[Zip::Zip64EndOfCentralDirectorySize];
+        if (!Zip::ReadAt(*FileHandle, Zip::Read<int64>(Locator + 8), Zip64End, sizeof(Zip64End))
+            || Zip::Read<uint32>(Zip64End) != Zip::Zip64EndOfCentralDirectorySignature)
+            return false;
+
+        NumEntries = Zip::Read<int64>(Zip64End + 32);
+        CentralDirectorySize = Zip::Read<int64>(Zip64End + 40);
+        CentralDirectoryOffset = Zip::Read<int64>(Zip64End + 48);
+    }
+
+    if (CentralDirectoryOffset < 0 || CentralDirectorySize < 0 || CentralDirectoryOffset + CentralDirectorySize > FileSize)
+        return false;
+
+    TArray64<uint8> CentralDirectory;
+    CentralDirectory.SetNumUninitialized(CentralDirectorySize);
+    if (!Zip::ReadAt(*FileHandle, CentralDirectoryOffset, CentralDirectory.GetData(), CentralDirectorySize))
+        return false;
+
+    int64 Offset = 0;
+    for (int64 i = 0; i < NumEntries; ++i) {
+        if (Offset + Zip::CentralDirectoryHeaderSize > CentralDirectory.Num())
+            return false;
+
+        const uint8* Header = &CentralDirectory[Offset];
+        if (Zip::Read<uint32>(Header) != Zip::CentralDirectoryHeaderSignature)
+            return false;
+
+        const auto Flags = Zip::Read<uint16>(Header + 8);
+        const auto NameLength = Zip::Read<uint16>(Header + 28);
+        const auto ExtraLength = Zip::Read<uint16>(Header + 30);
+        const auto CommentLength = Zip::Read<uint16>(Header + 32);
+        const auto HeaderSize = Zip::CentralDirectoryHeaderSize + NameLength + ExtraLength + CommentLength;
+        if (Offset + HeaderSize > CentralDirectory.Num())
+            return false;
+        Offset += HeaderSize;
+
+        FEntry Entry;
+        Entry.CompressionMethod = Zip::Read<uint16>(Header + 10);
+        Entry.CompressedSize = Zip::Read<uint32>(Header + 20);
+        Entry.UncompressedSize = Zip::Read<uint32>(Header + 24);
+        Entry.LocalHeaderOffset = Zip::Read<uint32>(Header + 42);
+
+        // 32bitに収まらない値はZIP64拡張フィールドに展開後サイズ、圧縮サイズ、ローカルヘッダ位置の順で格納される
+        const uint8* Name = Header + Zip::CentralDirectoryHeaderSize;
+        const uint8* Extra = Name + NameLength;
+        for (const uint8* Field = Extra; Field + 4 <= Extra + ExtraLength;) {
+            const auto FieldId = Zip::Read<uint16>(Field);
+            const auto FieldSize = Zip::Read<uint16>(Field + 2);
+            if (FieldId == Zip::Zip64ExtraFieldId) {
+                const uint8* Value = Field + 4;
+                const uint8* ValueEnd = FMath::Min(Value + FieldSize, Extra + ExtraLength);
+                for (auto Target : {&Entry.UncompressedSize, &Entry.CompressedSize, &Entry.LocalHeaderOffset}) {
+                    if (*Target != MAX_uint32 || Value + sizeof(int64) > ValueEnd)
+                        continue;
+                    *Target = Zip::Read<int64>(Value);
+                    Value += sizeof(int64);
+                }
+            }
+            Field += 4 + FieldSize;
+        }
+
+        const FUTF8ToTCHAR NameConverter(reinterpret_cast<const ANSICHAR*>(Name), NameLength);
+        auto EntryName = FString(NameConverter.Length(), NameConverter.Get());
+        EntryName.ReplaceCharInline(TEXT('\\'), TEXT('/'));
+
+        // ディレクトリは対象外
+        if (EntryName.EndsWith(TEXT("/")))
+            continue;
+        if ((Flags & Zip::FlagEncrypted) != 0) {
+            UE_LOG(LogTemp, Warning, TEXT("Encrypted entry is not supported: %s in %s"), *EntryName, *ArchivePath);
+            continue;
+        }
+
+        EntryNames.Add(EntryName);
+        Entries.Add(EntryName, Entry);
+    }
+    return true;
+}
+
+bool FPLATEAUDatasetArchive::ReadEntry(const FString& EntryName, const TFunctionRef<uint8*(int64 Size)> Allocate) const {
+    const auto Entry = Entries.Find(EntryName);
+    if (!FileHandle.IsValid() || Entry == nullptr) {
+        UE_LOG(LogTemp, Error, TEXT("Failed to read %s in %s"), *EntryName, *ArchivePath);
+        return false;
+    }
+    if (Entry->CompressionMethod != Zip::MethodStored && Entry->CompressionMethod != Zip::MethodDeflated) {
+        UE_LOG(LogTemp, Error, TEXT("Unsupported compression method %d: %s in %s"), Entry->CompressionMethod, *EntryName, *ArchivePath);
+        return false;
+    }
+
+    // ファイルハンドルを共有するため読み込みのみ排他し、展開は排他せずに行う
+    TArray64<uint8> CompressedData;
+    {
+        FScopeLock Lock(&FileHandleSection);
+        uint8 LocalHeader[Zip::LocalFileHeaderSize];
+        if (!Zip::ReadAt(*FileHandle, Entry->LocalHeaderOffset, LocalHeader, sizeof(LocalHeader))
+            || Zip::Read<uint32>(LocalHeader) != Zip::LocalFileHeaderSignature) {
+            UE_LOG(LogTemp, Error, TEXT("Invalid local file header: %s in %s"), *EntryName, *ArchivePath);
+            return false;
+        }
+
+        const auto DataOffset = Entry->LocalHeaderOffset + Zip::LocalFileHeaderSize + Zip::Read<uint16>(LocalHeader + 26) + Zip::Read<uint16>(LocalHeader + 28);
+
+        // 無圧縮の場合は出力先に直接読み込む
+        if (Entry->CompressionMethod == Zip::MethodStored) {
+            if (!Zip::ReadAt(*FileHandle, DataOffset, Allocate(Entry->UncompressedSize), Entry->UncompressedSize)) {
+                UE_LOG(LogTemp, Error, TEXT("Failed to read %s in %s"), *EntryName, *ArchivePath);
+                return false;
+            }
+            return true;
+        }
+
+        CompressedData.SetNumUninitialized(Entry->CompressedSize);
+        if (!Zip::ReadAt(*FileHandle, DataOffset, CompressedData.GetData(), Entry->CompressedSize)) {
+            UE_LOG(LogTemp, Error, TEXT("Failed to read %s in %s"), *EntryName, *ArchivePath);
+            return false;
+        }
+    }
+
+    if (Entry->CompressedSize > MAX_int32 || Entry->UncompressedSize > MAX_int32) {
+        UE_LOG(LogTemp, Error, TEXT("%s in %s is too large to inflate"), *EntryName, *ArchivePath);
+        return false;
+    }
+
+    // Deflateはヘッダ無しのため負のウィンドウサイズを指定
+    if (!FCompression::UncompressMemory(NAME_Zlib, Allocate(Entry->UncompressedSize), static_cast<int32>(Entry->UncompressedSize),
+        CompressedData.GetData(), static_cast<int32>(Entry->CompressedSize), COMPRESS_NoFlags, -DEFAULT_ZLIB_BIT_WINDOW)) {
+        UE_LOG(LogTemp, Error, TEXT("Failed to inflate %s in %s"), *EntryName, *ArchivePath);
+        return false;
+    }
+    return true;
+}
+
+FString FPLATEAUDatasetArchive::MakeVirtualPath(const FString& EntryName) const {
+    return ArchivePath / EntryName;
+}
@@ -0,0 +1,170 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Dataset/PLATEAUDatasetIndex.h"
+
+#include <plateau/dataset/gml_file.h>
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace {
+    namespace Field {
+        const FString Version = TEXT("version");
+        const FString Entries = TEXT("entries");
+        const FString Path = TEXT("path");
+        const FString MeshCode = TEXT("meshCode");
+        const FString Package = TEXT("package");
+        const FString MaxLod = TEXT("maxLod");
+        const FString FileSize = TEXT("size");
+        const FString ModificationTime = TEXT("mtime");
+    }
+
+    //! インデックスの形式を変更した場合は値を増やしてください
+    constexpr int IndexVersion = 1;
+
+    FCriticalSection IndicesSection;
+    TMap<FString, TSharedRef<FPLATEAUDatasetIndex>> Indices;
+}
+
+FPLATEAUDatasetIndex::FPLATEAUDatasetIndex(const FString& InSourcePath)
+    : SourcePath(NormalizePath(InSourcePath))
+    , bDirty(false) {
+    IndexFilePath = FPaths::ProjectSavedDir() / TEXT("PLATEAU/DatasetIndex") / (FMD5::HashAnsiString(*SourcePath) + TEXT(".json"));
+    Load();
+}
+
+TSharedRef<FPLATEAUDatasetIndex> FPLATEAUDatasetIndex::Get(const FString& SourcePath) {
+    const auto Key = NormalizePath(SourcePath);
+
+    FScopeLock Lock(&IndicesSection);
+    if (const auto Index = Indices.Find(Key))
+        return *Index;
+
+    return Indices.Add(Key, MakeShared<FPLATEAUDatasetIndex>(Key));
+}
+
+int FPLATEAUDatasetIndex::GetMaxLod(plateau::dataset::GmlFile& GmlFile) {
+    const auto GmlPath = NormalizePath(UTF8_TO_TCHAR(GmlFile.getPath().c_str()));
+
+    int MaxLod;
+    if (TryGetCachedMaxLod(GmlPath, MaxLod))
+        return MaxLod;
+
+    // GMLファイル内を検索して最大LODを取得
+    MaxLod = GmlFile.getMaxLod();
+
+    Register(GmlFile);
+    FScopeLock Lock(&EntriesSection);
+    if (auto* Entry = Entries.Find(GmlPath)) {
+        Entry->MaxLod = MaxLod;
+        bDirty = true;
+    }
+    return MaxLod;
+}
+
+bool FPLATEAUDatasetIndex::TryGetCachedMaxLod(const FString& GmlPath, int& OutMaxLod) const {
+    const auto Key = NormalizePath(GmlPath);
+    const auto StatData = IFileManager::Get().GetStatData(*Key);
+    if (!StatData.bIsValid)
+        return false;
+
+    FScopeLock Lock(&EntriesSection);
+    const auto Entry = Entries.Find(Key);
+    if (Entry == nullptr || Entry->MaxLod < 0 || !IsUpToDate(*Entry, StatData))
+        return false;
+
+    OutMaxLod = Entry->MaxLod;
+    return true;
+}
+
+void FPLATEAUDatasetIndex::Register(const plateau::dataset::GmlFile& GmlFile) {
+    const auto GmlPath = NormalizePath(UTF8_TO_TCHAR(GmlFile.getPath().c_str()));
+    const auto StatData = IFileManager::Get().GetStatData(*GmlPath);
+    if (!StatData.bIsValid)
+        return;
+
+    FScopeLock Lock(&EntriesSection);
+    auto& Entry = Entries.FindOrAdd(GmlPath);
+    if (IsUpToDate(Entry, StatData))
+        return;
+
+    Entry.MeshCode = UTF8_TO_TCHAR(GmlFile.getMeshCode().get().c_str());
+    Entry.Package = static_cast<uint32>(GmlFile.getPackage());
+    Entry.MaxLod = -1;
+    Entry.FileSize = StatData.FileSize;
+    Entry.ModificationTime = StatData.ModificationTime;
+    bDirty = true;
+}
+
+void FPLATEAUDatasetIndex::Save() {
+    const TSharedPtr<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
+    {
+        FScopeLock Lock(&EntriesSection);
+        if (!bDirty)
+            return;
+
+        TArray<TSharedPtr<FJsonValue>> EntriesJsonArray;
+        for (const auto& [GmlPath, Entry] : Entries) {
+            const TSharedPtr<FJsonObject> EntryJsonObject = MakeShareable(new FJsonObject);
+            EntryJsonObject->SetStringField(Field::Path, GmlPath);
+            EntryJsonObject->SetStringField(Field::MeshCode, Entry.MeshCode);
+            EntryJsonObject->SetNumberField(Field::Package, Entry.Package);
+            EntryJsonObject->SetNumberField(Field::MaxLod, Entry.MaxLod);
+            EntryJsonObject->SetStringField(Field::FileSize, FString::Printf(TEXT("%lld"), Entry.FileSize));
+            EntryJsonObject->SetStringField(Field::ModificationTime, FString::Printf(TEXT("%lld"), Entry.ModificationTime.GetTicks()));
+            EntriesJsonArray.Emplace(MakeShared<FJsonValueObject>(EntryJsonObject));
+        }
+        JsonRootObject->SetNumberField(Field::Version, IndexVersion);
+        JsonRootObject->SetArrayField(Field::Entries, EntriesJsonArray);
+        bDirty = false;
+    }
+
+    FString SerializedIndex;
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SerializedIndex);
+    FJsonSerializer::Serialize(JsonRootObject.ToSharedRef(), Writer);
+    if (!FFileHelper::SaveStringToFile(SerializedIndex, *IndexFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+        UE_LOG(LogTemp, Warning, TEXT("Failed to save dataset index: %s"), *IndexFilePath);
+}
+
+FString FPLATEAUDatasetIndex::NormalizePath(const FString& Path) {
+    auto NormalizedPath = FPaths::ConvertRelativePathToFull(Path);
+    FPaths::NormalizeFilename(NormalizedPath);
+    return NormalizedPath;
+}
+
+bool FPLATEAUDatasetIndex::IsUpToDate(const FPLATEAUDatasetIndexEntry& Entry, const FFileStatData& StatData) {
+    return Entry.FileSize == StatData.FileSize && Entry.ModificationTime == StatData.ModificationTime;
+}
+
+void FPLATEAUDatasetIndex::Load() {
+    FString SerializedIndex;
+    if (!FFileHelper::LoadFileToString(SerializedIndex, *IndexFilePath))
+        return;
+
+    TSharedPtr<FJsonObject> JsonRootObject;
+    const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(SerializedIndex);
+    if (!FJsonSerializer::Deserialize(JsonReader, JsonRootObject) || !JsonRootObject.IsValid())
+        return;
+
+    // 形式が異なるインデックスは破棄して再作成
+    if (JsonRootObject->GetIntegerField(Field::Version) != IndexVersion)
+        return;
+
+    for (const auto& EntryJsonValue : JsonRootObject->GetArrayField(Field::Entries)) {
+        const auto& EntryJsonObject = EntryJsonValue->AsObject();
+        FPLATEAUDatasetIndexEntry Entry;
+        Entry.MeshCode = EntryJsonObject->GetStringField(Field::MeshCode);
+        Entry.Package = EntryJsonObject->GetIntegerField(Field::Package);
+        Entry.MaxLod = EntryJsonObject->GetIntegerField(Field::MaxLod);
+        LexFromString(Entry.FileSize, *EntryJsonObject->GetStringField(Field::FileSize));
+        int64 Ticks;
+        LexFromString(Ticks, *EntryJsonObject->GetStringField(Field::ModificationTime));
+        Entry.ModificationTime = FDateTime(Ticks);
+        Entries.Add(EntryJsonObject->GetStringField(Field::Path), Entry);
+    }
+}
@@ -0,0 +1,91 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Dataset/PLATEAUGmlReader.h"
+
+#include <istream>
+#include <streambuf>
+
+#include <citygml/citygml.h>
+#include <citygml/citymodel.h>
+
+#include "Dataset/PLATEAUDatasetArchive.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+
+namespace {
+    /**
+     * @brief メモリ上のバイト列を読み取り専用のstd::streambufとして扱います。
+     */
+    class FMemoryStreamBuffer : public std::streambuf {
+    public:
+        FMemoryStreamBuffer(const uint8* Data, const int64 Size) {
+            const auto Begin = reinterpret_cast<char*>(const_cast<uint8*>(Data));
+            setg(Begin, Begin, Begin + Size);
+        }
+
+    protected:
+        virtual pos_type seekoff(const off_type Offset, const std::ios_base::seekdir Direction, const std::ios_base::openmode Mode) override {
+            char* Target;
+            switch (Direction) {
+            case std::ios_base::beg:
+                Target = eback() + Offset;
+                break;
+            case std::ios_base::cur:
+                Target = gptr() + Offset;
+                break;
+            default:
+                Target = egptr() + Offset;
+                break;
+            }
+            if (Target < eback() || Target > egptr())
+                return pos_type(off_type(-1));
+
+            setg(eback(), Target, egptr());
+            return pos_type(Target - eback());
+        }
+
+        virtual pos_type seekpos(const pos_type Position, const std::ios_base::openmode Mode) override {
+            return seekoff(off_type(Position), std::ios_base::beg, Mode);
+        }
+    };
+
+    std::shared_ptr<const citygml::CityModel> LoadFromMemory(
+        const uint8* Data, const int64 Size, const FString& GmlPath,
+        const citygml::ParserParams& Params, const std::shared_ptr<citygml::CityGMLLogger>& Logger) {
+        FMemoryStreamBuffer Buffer(Data, Size);
+        std::istream Stream(&Buffer);
+        const auto CityModel = citygml::load(Stream, Params, Logger);
+
+        // ストリームから読み込んだ場合はGMLパスが設定されないため、テクスチャパス解決用に設定
+        if (CityModel != nullptr)
+            std::const_pointer_cast<citygml::CityModel>(CityModel)->setGmlPath(TCHAR_TO_UTF8(*GmlPath));
+
+        return CityModel;
+    }
+}
+
+std::shared_ptr<const citygml::CityModel> FPLATEAUGmlReader::Load(
+    const FString& GmlPath, const citygml::ParserParams& Params,
+    const std::shared_ptr<citygml::CityGMLLogger>& Logger) {
+    // zipアーカイブ内のGMLはメモリ上に展開
+    FString ArchivePath, EntryName;
+    if (FPLATEAUDatasetArchive::SplitVirtualPath(GmlPath, ArchivePath, EntryName)) {
+        TArray64<uint8> Data;
+        if (!FPLATEAUDatasetArchive::LoadFileToArray(GmlPath, Data))
+            return nullptr;
+
+        return LoadFromMemory(Data.GetData(), Data.Num(), GmlPath, Params, Logger);
+    }
+
+    // 大きなGMLはメモリマップして読み込む
+    auto& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const auto FileSize = PlatformFile.FileSize(*GmlPath);
+    if (FileSize >= MemoryMapThresholdBytes) {
+        const TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*GmlPath));
+        const TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile.IsValid() ? MappedFile->MapRegion(0, FileSize) : nullptr);
+        if (MappedRegion.IsValid())
+            return LoadFromMemory(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize(), GmlPath, Params, Logger);
+    }
+
+    return citygml::load(TCHAR_TO_UTF8(*GmlPath), Params, Logger);
+}
@@ -0,0 +1,87 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutoGranularity.h"
+
+#include <citygml/citymodel.h>
+#include <citygml/cityobject.h>
+#include <citygml/geometry.h>
+#include <citygml/polygon.h>
+#include <plateau/polygon_mesh/mesh_extract_options.h>
+
+namespace {
+    /**
+     * @brief ジオメトリを子ジオメトリを含めて集計し、三角形を含むLODのビットマスクと三角形数を加算します。
+     */
+    void CountGeometry(const citygml::Geometry& Geometry, const int32 MinLod, const int32 MaxLod, uint32& OutLodMask, int64& OutTriangleCount) {
+        const auto Lod = static_cast<int32>(Geometry.getLOD());
+        if (Lod >= MinLod && Lod <= MaxLod && Lod < 32) {
+            int64 TriangleCount = 0;
+            for (unsigned int i = 0; i < Geometry.getPolygonsCount(); ++i) {
+                TriangleCount += Geometry.getPolygon(i)->getIndices().size() / 3;
+            }
+            if (TriangleCount > 0) {
+                OutLodMask |= 1u << Lod;
+                OutTriangleCount += TriangleCount;
+            }
+        }
+
+        for (unsigned int i = 0; i < Geometry.getGeometriesCount(); ++i) {
+            CountGeometry(Geometry.getGeometry(i), MinLod, MaxLod, OutLodMask, OutTriangleCount);
+        }
+    }
+}
+
+FPLATEAUCityModelMeshStats FPLATEAUAutoGranularity::CountMeshes(const citygml::CityModel& CityModel, const int32 MinLod, const int32 MaxLod) {
+    FPLATEAUCityModelMeshStats Stats;
+    uint32 AllLodMask = 0;
+    TArray<const citygml::CityObject*> Stack;
+    for (unsigned int i = 0; i < CityModel.getNumRootCityObjects(); ++i) {
+        // 主要地物単位のメッシュは子を含めたいずれかのジオメトリを持つLODごとに生成される
+        uint32 PrimaryLodMask = 0;
+        Stack.Add(&CityModel.getRootCityObject(i));
+        while (Stack.Num() > 0) {
+            const auto CityObject = Stack.Pop(false);
+
+            // 最小地物単位のメッシュは自身のジオメトリを持つLODごとに生成される
+            uint32 LodMask = 0;
+            for (unsigned int j = 0; j < CityObject->getGeometriesCount(); ++j) {
+                CountGeometry(CityObject->getGeometry(j), MinLod, MaxLod, LodMask, Stats.TriangleCount);
+            }
+            Stats.AtomicMeshCount += FMath::CountBits(LodMask);
+            PrimaryLodMask |= LodMask;
+
+            for (unsigned int j = 0; j < CityObject->getChildCityObjectsCount(); ++j) {
+                Stack.Add(&CityObject->getChildCityObject(j));
+            }
+        }
+        Stats.PrimaryMeshCount += FMath::CountBits(PrimaryLodMask);
+        AllLodMask |= PrimaryLodMask;
+    }
+    Stats.LodCount = FMath::CountBits(AllLodMask);
+    return Stats;
+}
+
+void FPLATEAUAutoGranularity::Resolve(const FPLATEAUCityModelMeshStats& Stats, const FPLATEAUAutoGranularityBudget& Budget,
+                                      plateau::polygonMesh::MeshExtractOptions& OutExtractOptions) {
+    using plateau::polygonMesh::MeshGranularity;
+
+    // 目標に収まる場合は、カリングや属性情報の取得で有利な細かい粒度を優先
+    const auto MaxDrawCalls = FMath::Max(Budget.MaxDrawCalls, 1);
+    if (Stats.AtomicMeshCount <= MaxDrawCalls) {
+        OutExtractOptions.mesh_granularity = MeshGranularity::PerAtomicFeatureObject;
+        return;
+    }
+    if (Stats.PrimaryMeshCount <= MaxDrawCalls) {
+        OutExtractOptions.mesh_granularity = MeshGranularity::PerPrimaryFeatureObject;
+        return;
+    }
+
+    // 地域単位ではLODごとにグリッド数の2乗のメッシュが生成されるため、ドローコールの上限を超えない範囲で
+    // メッシュ1つあたりの三角形数が目安以下となる分割数を選ぶ
+    const auto LodCount = FMath::Max(Stats.LodCount, 1);
+    const auto MaxGridCount = FMath::Max(FMath::FloorToInt(FMath::Sqrt(static_cast<double>(MaxDrawCalls) / LodCount)), 1);
+    const auto TrianglesPerLod = static_cast<double>(Stats.TriangleCount) / LodCount;
+    const auto RequiredGridCount = FMath::CeilToInt(FMath::Sqrt(TrianglesPerLod / FMath::Max(Budget.MaxTrianglesPerMesh, 1)));
+    OutExtractOptions.mesh_granularity = MeshGranularity::PerCityModelArea;
+    OutExtractOptions.grid_count_of_side = FMath::Clamp(RequiredGridCount, 1, MaxGridCount);
+}
@@ -7,13 +7,23 @@
 #include "PLATEAUInstancedCityModel.h"
 #include "plateau/dataset/dataset_source.h"
 #include "plateau/dataset/city_model_package.h"
+#include "plateau/dataset/gml_file.h"
 #include "plateau/polygon_mesh/mesh_extractor.h"
 #include "plateau/polygon_mesh/mesh_extract_options.h"
 #include "PLATEAUMeshLoader.h"
 #include "citygml/citygml.h"
+#include <optional>
 #include "Kismet/GameplayStatics.h"
+#include "HAL/FileManager.h"
 #include "Reconstruct/PLATEAUMeshLoaderForLandscape.h"
 #include "Component/PLATEAUSceneComponent.h"
+#include "Dataset/PLATEAUDatasetIndex.h"
+#include "Dataset/PLATEAUDatasetArchive.h"
+#include "Dataset/PLATEAUGmlReader.h"
+#include "PLATEAUImportStats.h"
+#include "PLATEAUTextureAtlas.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeExit.h"
 
 
 #define LOCTEXT_NAMESPACE "PLATEAUCityModelLoader"
@@ -21,34 +31,161 @@
 using namespace plateau::udx;
 using namespace plateau::polygonMesh;
 
+namespace {
+    // キャンセル確認、進捗通知の間隔(秒)
+    constexpr float CancelPollingIntervalSeconds = 0.05f;
+    constexpr float StatusPollingIntervalSeconds = 0.1f;
+
+    // GMLごとの進捗における各段階の開始位置
+    constexpr float ParseProgressBegin = 0.1f;
+    constexpr float ExtractProgressBegin = 0.4f;
+    constexpr float LoadModelProgressBegin = 0.6f;
+
+    // 推定進捗の上限(推定が外れた場合に完了と誤認させないため)
+    constexpr float MaxEstimatedProgress = 0.95f;
+
+    // 計測結果の出力前に非同期のコリジョンクッキング等の完了を待つ最大時間(秒)
+    constexpr double MaxRunningStageWaitSeconds = 300.0;
+
+    /**
+     * @brief libplateauのパース、メッシュ抽出は進捗を通知しないため、完了済みのGMLから計測した処理速度を元に進捗を推定します。
+     * 実際の進捗ではなく経過時間からの外挿であるため、UI上でも推定値として表示してください。
+     */
+    class FThroughputEstimator {
+    public:
+        explicit FThroughputEstimator(const double InDefaultUnitsPerSecond)
+            : DefaultUnitsPerSecond(InDefaultUnitsPerSecond) {
+        }
+
+        void Record(const double Units, const double Seconds) {
+            FScopeLock Lock(&Section);
+            TotalUnits += Units;
+            TotalSeconds += Seconds;
+        }
+
+        float Estimate(const double Units, const double ElapsedSeconds) const {
+            FScopeLock Lock(&Section);
+            const auto UnitsPerSecond = TotalSeconds > 0.0 ? TotalUnits / TotalSeconds : DefaultUnitsPerSecond;
+            const auto ExpectedSeconds = FMath::Max(Units / UnitsPerSecond, UE_DOUBLE_SMALL_NUMBER);
+            return FMath::Min(static_cast<float>(ElapsedSeconds / ExpectedSeconds), MaxEstimatedProgress);
+        }
+
+    private:
+        double DefaultUnitsPerSecond;
+        double TotalUnits = 0.0;
+        double TotalSeconds = 0.0;
+        mutable FCriticalSection Section;
+    };
+}
+
+
+/**
+ * @brief キャンセル時に完了を待たずに結果を破棄した処理を、対象のGMLファイル名ごとに保持します。
+ * 処理は入力を値またはスマートポインタで保持するため、ローダーが破棄された後も安全に完了します。
+ */
+class FPLATEAUAbandonedTasks {
+public:
+    template <typename ResultType>
+    void Add(const FString& GmlName, TFuture<ResultType>&& InFuture) {
+        FScopeLock Lock(&Section);
+        Tasks.Add(GmlName, [Future = MoveTemp(InFuture)](const FTimespan& Timeout) {
+            return Future.WaitFor(Timeout);
+        });
+    }
+
+    /**
+     * @brief 完了済みの処理を取り除き、実行中の処理の数を返します。
+     */
+    int32 GetNum() {
+        FScopeLock Lock(&Section);
+        RemoveCompleted();
+        return Tasks.Num();
+    }
+
+    /**
+     * @brief 指定したGMLファイルに対する処理の終了を待ちます。他のGMLファイルに対する処理は待ちません。
+     */
+    void Wait(const FString& GmlName) {
+        for (bool bFirst = true;; bFirst = false) {
+            {
+                FScopeLock Lock(&Section);
+                RemoveCompleted();
+                if (!Tasks.Contains(GmlName))
+                    return;
+            }
+            if (bFirst)
+                UE_LOG(LogTemp, Log, TEXT("Waiting for abandoned tasks of %s"), *GmlName);
+            FPlatformProcess::Sleep(CancelPollingIntervalSeconds);
+        }
+    }
+
+private:
+    TMultiMap<FString, TUniqueFunction<bool(const FTimespan&)>> Tasks;
+    FCriticalSection Section;
+
+    void RemoveCompleted() {
+        for (auto It = Tasks.CreateIterator(); It; ++It) {
+            if (It.Value()(FTimespan::Zero()))
+                It.RemoveCurrent();
+        }
+    }
+};
+
 
 class FCityModelLoaderImpl {
 public:
     static TArray<FLoadInputData> PrepareInputData(
         const UPLATEAUImportSettings* ImportSettings, const FString& Source,
         const TArray<FString>& MeshCodes, FPLATEAUGeoReference& GeoReference, const bool bImportFromServer, const plateau::network::Client ClientRef) {
+        // zipアーカイブの場合はlibplateauのデータセットを介さずにアーカイブ内を検索
+        const auto bFromArchive = !bImportFromServer && FPLATEAUDatasetArchive::IsArchivePath(Source);
+        const auto Archive = bFromArchive ? FPLATEAUDatasetArchive::Get(Source) : nullptr;
+        if (bFromArchive && !Archive.IsValid())
+            return {};
+
         // ファイル検索
-        const auto DatasetSource = LoadDataset(bImportFromServer, Source, ClientRef);
+        std::optional<plateau::dataset::DatasetSource> DatasetSource;
+        if (!bFromArchive)
+            DatasetSource.emplace(LoadDataset(bImportFromServer, Source, ClientRef));
         TArray<FLoadInputData> LoadInputDataArray;
+        const TSharedPtr<FPLATEAUDatasetIndex> DatasetIndex = bImportFromServer || bFromArchive ? nullptr : FPLATEAUDatasetIndex::Get(Source).ToSharedPtr();
 
         for (const auto& Package : UPLATEAUImportSettings::GetAllPackages()) {
             const auto Settings = ImportSettings->GetFeatureSettings(Package);
             if (!Settings.bImport)
                 continue;
 
-            std::vector<plateau::dataset::MeshCode> RawMeshCodes;
-            for (const auto& MeshCode : MeshCodes) {
-                RawMeshCodes.emplace_back(TCHAR_TO_UTF8(*MeshCode));
+            TArray<FString> GmlPaths;
+            if (bFromArchive) {
+                GmlPaths = Archive->FindGmlFiles(MeshCodes, Package);
             }
+            else {
+                std::vector<plateau::dataset::MeshCode> RawMeshCodes;
+                for (const auto& MeshCode : MeshCodes) {
+                    RawMeshCodes.emplace_back(TCHAR_TO_UTF8(*MeshCode));
+                }
+
+                const auto GmlFiles =
+                    DatasetSource->getAccessor()
+                    ->filterByMeshCodes(RawMeshCodes)
+                    ->getGmlFiles(Package);
 
-            const auto GmlFiles =
-                DatasetSource.getAccessor()
-                ->filterByMeshCodes(RawMeshCodes)
-                ->getGmlFiles(Package);
+                for (const auto& GmlFile : *GmlFiles) {
+                    if (DatasetIndex.IsValid()) {
+                        DatasetIndex->Register(GmlFile);
 
-            for (const auto& GmlFile : *GmlFiles) {
+                        // 最大LODが記録済みでインポート対象のLODを含まないGMLはスキップ
+                        int CachedMaxLod;
+                        if (DatasetIndex->TryGetCachedMaxLod(UTF8_TO_TCHAR(GmlFile.getPath().c_str()), CachedMaxLod) && CachedMaxLod < Settings.MinLod)
+                            continue;
+                    }
+                    GmlPaths.Add(UTF8_TO_TCHAR(GmlFile.getPath().c_str()));
+                }
+            }
+
+            for (const auto& GmlPath : GmlPaths) {
                 auto& LoadInputData = LoadInputDataArray.AddDefaulted_GetRef();
-                LoadInputData.GmlPath = UTF8_TO_TCHAR(GmlFile.getPath().c_str());
+                LoadInputData.GmlPath = GmlPath;
 
                 // メッシュコードからインポート範囲に変換
                 for (const auto& MeshCode : MeshCodes) {
@@ -58,6 +195,17 @@ public:
 
                 LoadInputData.bIncludeAttrInfo = Settings.bIncludeAttrInfo;
                 LoadInputData.FallbackMaterial = Settings.FallbackMaterial;
+                LoadInputData.CollisionComplexity = Settings.bSetCollider ? Settings.CollisionComplexity : EPLATEAUCollisionComplexity::None;
+                LoadInputData.bDeferCollisionCooking = Settings.bDeferCollisionCooking;
+                LoadInputData.VertexFormat = Settings.VertexFormat;
+                if (Settings.bWeldVertices)
+                    LoadInputData.WeldCreaseAngle = Settings.CreaseAngle;
+                if (Settings.MeshGranularity == EPLATEAUMeshGranularity::Auto) {
+                    FPLATEAUAutoGranularityBudget Budget;
+                    Budget.MaxDrawCalls = Settings.TargetDrawCallsPerGml;
+                    Budget.MaxTrianglesPerMesh = Settings.MaxTrianglesPerMesh;
+                    LoadInputData.AutoGranularityBudget = Budget;
+                }
                 auto& ExtractOptions = LoadInputData.ExtractOptions;
                 ExtractOptions.reference_point = GeoReference.GetData().getReferencePoint();
                 ExtractOptions.mesh_axes = plateau::geometry::CoordinateSystem::ESU;
@@ -66,7 +214,8 @@ public:
                 ExtractOptions.max_lod = Settings.MaxLod;
                 ExtractOptions.min_lod = Settings.MinLod;
                 ExtractOptions.export_appearance = Settings.bImportTexture;
-                ExtractOptions.enable_texture_packing = Settings.bEnableTexturePacking;
+                // テクスチャの結合は共通ライブラリではなく、抽出後にFPLATEAUTextureAtlasで並列に行う
+                ExtractOptions.enable_texture_packing = false;
                 ExtractOptions.attach_map_tile = Settings.bAttachMapTile;
 
                 // strcpyは非推奨という警告が出ますが、共通ライブラリを利用するために必要と思われるので警告を抑制します。
@@ -77,18 +226,10 @@ public:
 #pragma warning(pop)
                 ExtractOptions.map_tile_zoom_level = Settings.ZoomLevel;
 
-                switch (Settings.TexturePackingResolution) {
-                case EPLATEAUTexturePackingResolution::H2048W2048:
-                    ExtractOptions.texture_packing_resolution = 2048;
-                    break;
-                case EPLATEAUTexturePackingResolution::H4096W4096:
-                    ExtractOptions.texture_packing_resolution = 4096;
-                    break;
-                case EPLATEAUTexturePackingResolution::H8192W8192:
-                    ExtractOptions.texture_packing_resolution = 8192;
-                    break;
-                }
-                ExtractOptions.grid_count_of_side = 10;
+                ExtractOptions.texture_packing_resolution = FPLATEAUTextureAtlas::GetPageSize(Settings.TexturePackingResolution);
+                if (Settings.bImportTexture && Settings.bEnableTexturePacking)
+                    LoadInputData.TexturePackingPageSize = ExtractOptions.texture_packing_resolution;
+                ExtractOptions.grid_count_of_side = FMath::Max(Settings.GridCountOfSide, 1);
                 ExtractOptions.unit_scale = 0.01f;
                 if (Package == plateau::dataset::PredefinedCityModelPackage::Relief || Package == plateau::dataset::PredefinedCityModelPackage::DisasterRisk) {
                     ExtractOptions.exclude_city_object_outside_extent = false;
@@ -100,6 +241,10 @@ public:
                 }
             }
         }
+
+        if (DatasetIndex.IsValid())
+            DatasetIndex->Save();
+
         return LoadInputDataArray;
     }
 
@@ -112,7 +257,26 @@ public:
         }
     }
 
-    static FString CopyGmlFile(const FString& Source, const FString& GmlPath, const bool bImportFromServer) {
+    /**
+     * @brief GMLファイルをコピーせずにインポート元から直接読み込むかどうかを返します。
+     */
+    static bool ShouldReadInPlace(const FString& Source, const bool bImportFromServer, const bool bCopyGmlFiles) {
+        if (bImportFromServer)
+            return false;
+        return !bCopyGmlFiles || FPLATEAUDatasetArchive::IsArchivePath(Source);
+    }
+
+    /**
+     * @brief インポート元のパスからデータセット名を取得します。
+     */
+    static FString GetDatasetName(const FString& Source) {
+        auto SourcePath = Source;
+        FPaths::NormalizeDirectoryName(SourcePath);
+        return FPaths::GetBaseFilename(SourcePath);
+    }
+
+    static FString CopyGmlFile(const FString& Source, const FString& GmlPath, const bool bImportFromServer, FPLATEAUGmlLoadStats* LoadStats = nullptr) {
+        PLATEAU_IMPORT_STAGE_SCOPE(LoadStats, Copy);
         const auto Destination = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()) + "PLATEAU/Datasets";
 
         // ファイルコピー
@@ -130,14 +294,15 @@ public:
         }
     }
 
-    static std::shared_ptr<const citygml::CityModel> ParseCityGml(const FString& GmlPath) {
+    static std::shared_ptr<const citygml::CityModel> ParseCityGml(const FString& GmlPath, FPLATEAUGmlLoadStats* LoadStats = nullptr) {
+        PLATEAU_IMPORT_STAGE_SCOPE(LoadStats, Parse);
         std::shared_ptr<const citygml::CityModel> CityModel = nullptr;
         try {
             citygml::ParserParams ParserParams;
             ParserParams.tesselate = true;
             const auto Logger = std::make_shared<PLATEAUDllLoggerUnreal>(
                 citygml::CityGMLLogger::LOGLEVEL::LL_INFO);
-            CityModel = citygml::load(TCHAR_TO_UTF8(*GmlPath), ParserParams, Logger->GetLogger());
+            CityModel = FPLATEAUGmlReader::Load(GmlPath, ParserParams, Logger->GetLogger());
         }
         catch (std::exception& e) {
             UE_LOG(LogTemp, Error, TEXT("Error parsing gml file. Path=%s, What=%s"), *GmlPath, e.what());
@@ -149,6 +314,52 @@ public:
         return CityModel;
     }
 
+    /**
+     * @brief 中断できない処理を専用のスレッドで実行し、キャンセルされるか完了するまで待機します。
+     * キャンセルされた場合は処理の完了を待たずに戻り、処理はスレッドの優先度を下げてAbandonedTasksに登録され結果は破棄されます。
+     * スレッドプールを使用しないため、破棄した処理が後続のインポートの処理を妨げません。
+     * @param GmlName 処理対象のGMLファイル名
+     * @param Units 処理量(進捗推定用)
+     * @param OnProgress 待機中に経過時間から外挿した推定進捗(0～1)を引数に呼ばれます。
+     */
+    template <typename ResultType>
+    static TOptional<ResultType> RunCancelable(
+        TUniqueFunction<ResultType()> Work, const FString& GmlName, TAtomic<bool>* bCanceled, FPLATEAUAbandonedTasks& AbandonedTasks,
+        FThroughputEstimator& Estimator, const double Units, const TFunction<void(float)>& OnProgress) {
+        struct FWorkerThread {
+            FCriticalSection Section;
+            FRunnableThread* Thread = nullptr;
+        };
+        const auto Worker = MakeShared<FWorkerThread, ESPMode::ThreadSafe>();
+
+        const auto StartSeconds = FPlatformTime::Seconds();
+        auto Future = Async(EAsyncExecution::Thread, [Work = MoveTemp(Work), Worker]() mutable {
+            {
+                FScopeLock Lock(&Worker->Section);
+                Worker->Thread = FRunnableThread::GetRunnableThread();
+            }
+            ON_SCOPE_EXIT {
+                FScopeLock Lock(&Worker->Section);
+                Worker->Thread = nullptr;
+            };
+            return Work();
+        });
+        while (!Future.WaitFor(FTimespan::FromSeconds(CancelPollingIntervalSeconds))) {
+            if (bCanceled->Load(EMemoryOrder::Relaxed)) {
+                {
+                    FScopeLock Lock(&Worker->Section);
+                    if (Worker->Thread != nullptr)
+                        Worker->Thread->SetThreadPriority(TPri_Lowest);
+                }
+                AbandonedTasks.Add(GmlName, MoveTemp(Future));
+                return {};
+            }
+            OnProgress(Estimator.Estimate(Units, FPlatformTime::Seconds() - StartSeconds));
+        }
+        Estimator.Record(Units, FPlatformTime::Seconds() - StartSeconds);
+        return Future.Get();
+    }
+
     static USceneComponent* CreateComponentInGameThread(
         AActor* Actor, const FString& Name) {
         USceneComponent* Component;
@@ -175,13 +386,65 @@ public:
         return Component;
     }
 
+    /**
+     * @brief 分割モードに応じてGMLファイルが属するセルのメッシュコードを返します。
+     * PerGmlの場合はGMLファイル自体のメッシュコードを返します。メッシュコードが取得できない場合は空文字列を返します。
+     */
+    static FString GetStreamingCellMeshCode(const EPLATEAUCityModelSplitMode SplitMode, const FString& GmlPath) {
+        auto MeshCode = plateau::dataset::GmlFile(TCHAR_TO_UTF8(*GmlPath)).getMeshCode();
+        if (!MeshCode.isValid())
+            return TEXT("");
+
+        switch (SplitMode) {
+        case EPLATEAUCityModelSplitMode::PerSecondMeshCode:
+            MeshCode = MeshCode.asSecond();
+            break;
+        case EPLATEAUCityModelSplitMode::PerThirdMeshCode:
+            while (MeshCode.getLevel() > 3)
+                MeshCode.upper();
+            break;
+        default:
+            break;
+        }
+        return UTF8_TO_TCHAR(MeshCode.get().c_str());
+    }
+
+    /**
+     * @brief 分割モードに応じてGMLファイルが属するセル名を返します。
+     */
+    static FString GetStreamingCellName(const EPLATEAUCityModelSplitMode SplitMode, const FString& GmlPath) {
+        if (SplitMode == EPLATEAUCityModelSplitMode::PerGml)
+            return FPaths::GetBaseFilename(GmlPath);
+
+        const auto CellMeshCode = GetStreamingCellMeshCode(SplitMode, GmlPath);
+        // メッシュコードを持たないGMLはGML単位のセルとする
+        return CellMeshCode.IsEmpty() ? FPaths::GetBaseFilename(GmlPath) : CellMeshCode;
+    }
+
+    /**
+     * @brief インポート対象のメッシュコードのうち、セルのメッシュコードと重なるものを返します。
+     */
+    static TArray<FString> GetMeshCodesInCell(const TArray<FString>& MeshCodes, const FString& CellMeshCode) {
+        if (CellMeshCode.IsEmpty())
+            return MeshCodes;
+
+        TArray<FString> MeshCodesInCell;
+        for (const auto& MeshCode : MeshCodes) {
+            // メッシュコードは上位メッシュのコードを接頭辞に持つ
+            if (MeshCode.StartsWith(CellMeshCode) || CellMeshCode.StartsWith(MeshCode))
+                MeshCodesInCell.Add(MeshCode);
+        }
+        return MeshCodesInCell;
+    }
+
 private:
     FCriticalSection SynchronizationObject;
 
 };
 
 
-APLATEAUCityModelLoader::APLATEAUCityModelLoader() {
+APLATEAUCityModelLoader::APLATEAUCityModelLoader()
+    : AbandonedTasks(MakeShared<FPLATEAUAbandonedTasks>()) {
     PrimaryActorTick.bCanEverTick = false;
     bCanceled.Store(false, EMemoryOrder::Relaxed);
     Phase = ECityModelLoadingPhase::Idle;
@@ -218,6 +481,16 @@ namespace {
         GEngine->BroadcastLevelActorListChanged();
 #endif
     }
+
+    APLATEAUInstancedCityModel* SpawnCityModel(APLATEAUCityModelLoader& Loader, const TArray<FString>& MeshCodes) {
+        APLATEAUInstancedCityModel* ModelActor = Loader.GetWorld()->SpawnActor<APLATEAUInstancedCityModel>();
+        CreateRootComponent(*ModelActor);
+
+        ModelActor->GeoReference = Loader.GeoReference;
+        ModelActor->MeshCodes = MeshCodes;
+        ModelActor->Loader = &Loader;
+        return ModelActor;
+    }
 }
 
 void APLATEAUCityModelLoader::LoadModel() {
@@ -229,23 +502,39 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
 
     Phase = ECityModelLoadingPhase::Start;
     bCanceled.Exchange(false);
+    Status.GmlReports.Reset();
+    Status.ReportPath.Reset();
 
     // アクター生成
-    APLATEAUInstancedCityModel* ModelActor = GetWorld()->SpawnActor<APLATEAUInstancedCityModel>();
-    CreateRootComponent(*ModelActor);
-
-    ModelActor->GeoReference = GeoReference;
-    ModelActor->MeshCodes = MeshCodes;
-    ModelActor->Loader = this;
+    // 分割インポートの場合はインポート対象のGMLが確定してからセルごとに生成
+    // 追加インポートの場合は既存のアクタに読み込む
+    APLATEAUInstancedCityModel* ModelActor = nullptr;
+    const bool bIncremental = TargetCityModel != nullptr;
+    if (bIncremental) {
+        ModelActor = TargetCityModel;
+        GeoReference = TargetCityModel->GeoReference;
+
+        // 追加インポートは対象アクタ1つに読み込むため分割しない
+        if (SplitMode != EPLATEAUCityModelSplitMode::None)
+            UE_LOG(LogTemp, Warning, TEXT("SplitMode is ignored for incremental import into %s"), *TargetCityModel->GetActorLabel());
+    }
+    else if (SplitMode == EPLATEAUCityModelSplitMode::None) {
+        ModelActor = SpawnCityModel(*this, MeshCodes);
+    }
 
     Async(EAsyncExecution::Thread,
         [
             ModelActor,
+                bIncremental,
+                TargetDatasetName = bIncremental ? TargetCityModel->DatasetName : FString(),
+                SplitMode = bIncremental ? EPLATEAUCityModelSplitMode::None : SplitMode,
+                RuntimeGrid = RuntimeGrid,
                 Source = Source,
                 MeshCodes = MeshCodes,
                 GeoReference = GeoReference,
                 ImportSettings = ImportSettings,
                 bImportFromServer = bImportFromServer,
+                bReadInPlace = FCityModelLoaderImpl::ShouldReadInPlace(Source, bImportFromServer, bCopyGmlFiles),
                 Client = *ClientPtr,
                 OwnerLoader = TWeakObjectPtr<APLATEAUCityModelLoader>(this),
                 bAutomationTest = bAutomationTest,
@@ -255,12 +544,40 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                 ImportGmlProgressDelegate = ImportGmlProgressDelegate,
                 ImportFailedGmlFileDelegate = ImportFailedGmlFileDelegate,
                 ImportFinishedDelegate = ImportFinishedDelegate,
-                LoadMeshSection = &LoadMeshSection
+                LoadMeshSection = &LoadMeshSection,
+                AbandonedTasks = AbandonedTasks.ToSharedRef()
         ]() mutable {
 
                 auto LoadInputDataArray = FCityModelLoaderImpl::PrepareInputData(
                     ImportSettings, Source, MeshCodes, GeoReference, bImportFromServer, Client);
 
+                // 追加インポートの場合は既存のGMLファイルとの差分を取る
+                // 破棄するのは今回インポート対象のパッケージのうち範囲外となったGMLファイルのみとし、対象外のパッケージは維持する
+                if (bIncremental) {
+                    TSet<FString> RequestedGmlNames;
+                    for (const auto& LoadInputData : LoadInputDataArray) {
+                        RequestedGmlNames.Add(FPaths::GetBaseFilename(LoadInputData.GmlPath));
+                    }
+
+                    TSet<FString> LoadedGmlNames;
+                    ExecuteInGameThread(OwnerLoader,
+                        [ModelActor, &RequestedGmlNames, &LoadedGmlNames, &MeshCodes, &ImportSettings](auto Loader) {
+                            LoadedGmlNames = ModelActor->GetLoadedGmlNames();
+                            TSet<FString> RemovedGmlNames;
+                            for (const auto& GmlName : LoadedGmlNames.Difference(RequestedGmlNames)) {
+                                const auto Package = plateau::dataset::GmlFile(TCHAR_TO_UTF8(*(GmlName + TEXT(".gml")))).getPackage();
+                                if (ImportSettings->GetFeatureSettings(Package).bImport)
+                                    RemovedGmlNames.Add(GmlName);
+                            }
+                            ModelActor->RemoveGmlComponents(RemovedGmlNames);
+                            ModelActor->MeshCodes = MeshCodes;
+                        });
+
+                    LoadInputDataArray.RemoveAll([&LoadedGmlNames](const FLoadInputData& LoadInputData) {
+                        return LoadedGmlNames.Contains(FPaths::GetBaseFilename(LoadInputData.GmlPath));
+                    });
+                }
+
                 TArray<FString> GmlFiles;
                 for (const auto& LoadInputData : LoadInputDataArray) {
                     const auto GmlName = FPaths::GetCleanFilename(LoadInputData.GmlPath);
@@ -277,12 +594,64 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                         Loader->Status.TotalGmlCount = GmlCount;
                     });
 
+                // 各GMLの読み込み先となる3D都市モデルアクタ
+                TArray<APLATEAUInstancedCityModel*> ModelActors;
+                ModelActors.Init(ModelActor, LoadInputDataArray.Num());
+                if (SplitMode != EPLATEAUCityModelSplitMode::None) {
+                    TArray<FString> CellNames;
+                    TMap<FString, FString> CellNameToMeshCode;
+                    for (const auto& LoadInputData : LoadInputDataArray) {
+                        const auto CellName = FCityModelLoaderImpl::GetStreamingCellName(SplitMode, LoadInputData.GmlPath);
+                        CellNames.Add(CellName);
+                        CellNameToMeshCode.Add(CellName, FCityModelLoaderImpl::GetStreamingCellMeshCode(SplitMode, LoadInputData.GmlPath));
+                    }
+
+                    TMap<FString, APLATEAUInstancedCityModel*> CellModelActors;
+                    const auto StreamingGroupId = FGuid::NewGuid();
+                    ExecuteInGameThread(OwnerLoader,
+                        [&CellNameToMeshCode, &CellModelActors, &MeshCodes, &RuntimeGrid, &StreamingGroupId](auto Loader) {
+                            for (const auto& [CellName, CellMeshCode] : CellNameToMeshCode) {
+                                const auto CellModelActor = SpawnCityModel(*Loader, FCityModelLoaderImpl::GetMeshCodesInCell(MeshCodes, CellMeshCode));
+                                CellModelActor->StreamingCellName = CellName;
+                                CellModelActor->StreamingGroupId = StreamingGroupId;
+
+                                // ローダーへのハード参照はセルと共にローダーを読み込ませるため、IDで同一のインポートを判定する
+                                CellModelActor->Loader = nullptr;
+
+                                // World Partitionのストリーミング対象とする
+                                CellModelActor->SetIsSpatiallyLoaded(true);
+                                if (!RuntimeGrid.IsNone())
+                                    CellModelActor->SetRuntimeGrid(RuntimeGrid);
+                                CellModelActors.Add(CellName, CellModelActor);
+                            }
+                        });
+
+                    for (int i = 0; i < CellNames.Num(); ++i) {
+                        ModelActors[i] = CellModelActors.FindRef(CellNames[i]);
+                    }
+                }
+
+                // 同じアクタに読み込むGML間でマテリアル、テクスチャを共有
+                TArray<TSharedPtr<FPLATEAUMaterialCache>> MaterialCaches;
+                ExecuteInGameThread(OwnerLoader,
+                    [&ModelActors, &MaterialCaches](auto Loader) {
+                        for (const auto CellModelActor : ModelActors) {
+                            MaterialCaches.Add(CellModelActor != nullptr ? CellModelActor->GetMaterialCache() : nullptr);
+                        }
+                    });
+
                 TArray<TFuture<bool>> Futures;
                 TArray<FString> GmlNames;
+                TArray<TSharedPtr<FPLATEAUGmlLoadStats>> LoadStatsArray;
 
                 bool bHasDatasetNameSet = false;
+                FString LoadedDatasetName = TargetDatasetName;
                 FCriticalSection SetDatasetNameSection;
 
+                // パースはGMLのバイト数、メッシュ抽出はルート都市オブジェクト数を処理量として進捗を推定
+                FThroughputEstimator ParseThroughput(20.0 * 1024.0 * 1024.0);
+                FThroughputEstimator ExtractThroughput(2000.0);
+
                 for (int Index = 0; Index < LoadInputDataArray.Num(); ++Index) {
                     if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
                         FFunctionGraphTask::CreateAndDispatchWhenReady(
@@ -313,7 +682,7 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                                     });
                             }
                             return CurrentLoadingGmls.Num() < 4;
-                        }, 3);
+                        }, StatusPollingIntervalSeconds);
 
                     if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
                         FFunctionGraphTask::CreateAndDispatchWhenReady(
@@ -329,12 +698,22 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                         }, TStatId(), nullptr, ENamedThreads::GameThread);
 
                     FLoadInputData InputData = LoadInputDataArray[Index];
-                    const auto CopiedGmlPath = FCityModelLoaderImpl::CopyGmlFile(Source, InputData.GmlPath, bImportFromServer);
                     const auto GmlName = FPaths::GetCleanFilename(InputData.GmlPath);
+                    InputData.LoadStats = MakeShared<FPLATEAUGmlLoadStats>(GmlName);
+                    LoadStatsArray.Add(InputData.LoadStats);
+                    InputData.MaterialCache = MaterialCaches.IsValidIndex(Index) ? MaterialCaches[Index] : nullptr;
+                    InputData.bReuseExistingTextures = bIncremental;
+
+                    // 前回キャンセルされた同じGMLファイルのパース、メッシュ抽出が残っている場合は、コピーで上書きしないよう終了を待つ
+                    AbandonedTasks->Wait(GmlName);
+                    const auto CopiedGmlPath = bReadInPlace
+                        ? InputData.GmlPath
+                        : FCityModelLoaderImpl::CopyGmlFile(Source, InputData.GmlPath, bImportFromServer, InputData.LoadStats.Get());
 
                     {
                         FScopeLock Lock(&SetDatasetNameSection);
-                        if (!bHasDatasetNameSet) {
+                        // 追加インポートの場合は既存のデータセット名、アクタ名を維持する
+                        if (!bHasDatasetNameSet && !bIncremental) {
                             bHasDatasetNameSet = true;
 
                             // データセット名をGMLファイルパスから取得
@@ -352,11 +731,28 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                             }
                             DatasetName = DatasetName.Left(FMath::Min(FirstSlashIndex, FirstBackSlashIndex));
 
+                            // コピーしない場合はインポート元のフォルダ名、zipファイル名とする
+                            if (bReadInPlace)
+                                DatasetName = FCityModelLoaderImpl::GetDatasetName(Source);
+                            LoadedDatasetName = DatasetName;
+
                             // 3D都市モデルアクタにデータセット名を登録
                             FFunctionGraphTask::CreateAndDispatchWhenReady(
-                                [ModelActor, DatasetName]() {
-                                    ModelActor->DatasetName = DatasetName;
-                                    ModelActor->SetActorLabel(DatasetName);
+                                [ModelActors, DatasetName, DatasetSourcePath = bReadInPlace ? Source : FString()]() {
+                                    for (const auto CellModelActor : TSet<APLATEAUInstancedCityModel*>(ModelActors)) {
+                                        if (CellModelActor == nullptr)
+                                            continue;
+
+                                        CellModelActor->DatasetName = DatasetName;
+                                        CellModelActor->DatasetSourcePath = DatasetSourcePath;
+                                        if (CellModelActor->StreamingCellName.IsEmpty()) {
+                                            CellModelActor->SetActorLabel(DatasetName);
+                                        }
+                                        else {
+                                            CellModelActor->SetActorLabel(DatasetName + TEXT("_") + CellModelActor->StreamingCellName);
+                                            CellModelActor->SetFolderPath(FName(DatasetName));
+                                        }
+                                    }
                                 }, TStatId(), nullptr, ENamedThreads::GameThread);
                         }
                     }
@@ -364,51 +760,105 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                     if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
                         FFunctionGraphTask::CreateAndDispatchWhenReady(
                             [Index, ImportGmlProgressDelegate] {
-                                ImportGmlProgressDelegate.Broadcast(Index, 0.25, LOCTEXT("Cancel", "キャンセルされました"));
+                                ImportGmlProgressDelegate.Broadcast(Index, ParseProgressBegin, LOCTEXT("Cancel", "キャンセルされました"));
                             }, TStatId(), nullptr, ENamedThreads::GameThread);
                         continue;
                     }
 
                     FFunctionGraphTask::CreateAndDispatchWhenReady(
                         [Index, ImportGmlProgressDelegate] {
-                            ImportGmlProgressDelegate.Broadcast(Index, 0.25, LOCTEXT("ParseCityGml", "CityGMLパース中..."));
+                            ImportGmlProgressDelegate.Broadcast(Index, ParseProgressBegin, LOCTEXT("ParseCityGml", "CityGMLパース中..."));
                         }, TStatId(), nullptr, ENamedThreads::GameThread);
 
                     // TODO: fldでgml名被る
                     GmlNames.Add(GmlName);
                     Futures.Add(Async(EAsyncExecution::Thread,
-                        [InputData, &LoadInputDataArray, Source, ModelActor, GmlName, OwnerLoader,
-                        CopiedGmlPath, &LoadMeshSection, bAutomationTest, &bCanceledRef, Index, ImportGmlProgressDelegate, ImportFailedGmlFileDelegate] {
+                        [InputData, &LoadInputDataArray, Source, ModelActor = ModelActors[Index], GmlName, OwnerLoader,
+                        CopiedGmlPath, &LoadMeshSection, bAutomationTest, &bCanceledRef, Index, ImportGmlProgressDelegate, ImportFailedGmlFileDelegate,
+                        &ParseThroughput, &ExtractThroughput, &AbandonedTasks] {
 
                             if (bCanceledRef->Load(EMemoryOrder::Relaxed))
                                 return false;
 
-                            const auto CityModel = FCityModelLoaderImpl::ParseCityGml(CopiedGmlPath);
+                            const auto BroadcastProgress = [Index, ImportGmlProgressDelegate](const float Progress, const FText& Text) {
+                                FFunctionGraphTask::CreateAndDispatchWhenReady(
+                                    [Index, ImportGmlProgressDelegate, Progress, Text] {
+                                        ImportGmlProgressDelegate.Broadcast(Index, Progress, Text);
+                                    }, TStatId(), nullptr, ENamedThreads::GameThread);
+                            };
+
+                            // パース処理自体は中断できないため、キャンセル時は結果を待たずに破棄
+                            // zipアーカイブ内のファイルは展開後のサイズを使用
+                            const auto RawGmlFileSize = FPLATEAUDatasetArchive::GetFileSize(CopiedGmlPath);
+                            const auto GmlFileSize = static_cast<double>(RawGmlFileSize > 0 ? RawGmlFileSize : 1024 * 1024);
+                            const auto ParseResult = FCityModelLoaderImpl::RunCancelable<std::shared_ptr<const citygml::CityModel>>(
+                                [CopiedGmlPath, LoadStats = InputData.LoadStats] {
+                                    return FCityModelLoaderImpl::ParseCityGml(CopiedGmlPath, LoadStats.Get());
+                                },
+                                GmlName, bCanceledRef, *AbandonedTasks, ParseThroughput, GmlFileSize,
+                                [&BroadcastProgress](const float Progress) {
+                                    BroadcastProgress(FMath::Lerp(ParseProgressBegin, ExtractProgressBegin, Progress), LOCTEXT("ParseCityGmlEstimated", "CityGMLパース中(進捗は推定)..."));
+                                });
+                            if (!ParseResult.IsSet()) {
+                                BroadcastProgress(ParseProgressBegin, LOCTEXT("Cancel", "キャンセルされました"));
+                                return false;
+                            }
+
+                            const auto CityModel = ParseResult.GetValue();
                             if (CityModel == nullptr) {
                                 ExecuteInGameThread(OwnerLoader,
-                                    [GmlName, Index, ImportFailedGmlFileDelegate](auto Loader) {
+                                    [GmlName, Index, ImportFailedGmlFileDelegate, Report = InputData.LoadStats->ToReport(false)](auto Loader) {
                                         ++Loader->Status.LoadedGmlCount;
                                         Loader->Status.LoadingGmls.Remove(GmlName);
                                         Loader->Status.FailedGmls.Add(GmlName);
+                                        Loader->Status.GmlReports.Add(Report);
                                         ImportFailedGmlFileDelegate.Broadcast(Index);
                                     });
                                 return false;
                             }
 
                             if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
-                                FFunctionGraphTask::CreateAndDispatchWhenReady(
-                                    [Index, ImportGmlProgressDelegate] {
-                                        ImportGmlProgressDelegate.Broadcast(Index, 0.5, LOCTEXT("Cancel", "キャンセルされました"));
-                                    }, TStatId(), nullptr, ENamedThreads::GameThread);
+                                BroadcastProgress(ExtractProgressBegin, LOCTEXT("Cancel", "キャンセルされました"));
                                 return false;
                             }
 
-                            FFunctionGraphTask::CreateAndDispatchWhenReady(
-                                [Index, ImportGmlProgressDelegate] {
-                                    ImportGmlProgressDelegate.Broadcast(Index, 0.5, LOCTEXT("MeshExtractorExtract", "ポリゴンメッシュ変換中..."));
-                                }, TStatId(), nullptr, ENamedThreads::GameThread);
+                            BroadcastProgress(ExtractProgressBegin, LOCTEXT("MeshExtractorExtract", "ポリゴンメッシュ変換中..."));
+
+                            // 自動粒度の場合はパース結果のメッシュ数、三角形数から粒度を決定
+                            auto ResolvedInputData = InputData;
+                            if (InputData.AutoGranularityBudget.IsSet()) {
+                                auto& ExtractOptions = ResolvedInputData.ExtractOptions;
+                                const auto MeshStats = FPLATEAUAutoGranularity::CountMeshes(*CityModel, ExtractOptions.min_lod, ExtractOptions.max_lod);
+                                FPLATEAUAutoGranularity::Resolve(MeshStats, InputData.AutoGranularityBudget.GetValue(), ExtractOptions);
+                                UE_LOG(LogTemp, Log, TEXT("Auto granularity for %s: %d (atomic: %lld, primary: %lld, triangles: %lld, grid: %d)"),
+                                    *GmlName, static_cast<int32>(ExtractOptions.mesh_granularity), MeshStats.AtomicMeshCount, MeshStats.PrimaryMeshCount,
+                                    MeshStats.TriangleCount, ExtractOptions.grid_count_of_side);
+                            }
 
-                            const auto Model = MeshExtractor::extractInExtents(*CityModel, InputData.ExtractOptions, InputData.Extents);
+                            const auto ExtractResult = FCityModelLoaderImpl::RunCancelable<std::shared_ptr<plateau::polygonMesh::Model>>(
+                                [CityModel, ExtractOptions = ResolvedInputData.ExtractOptions, Extents = InputData.Extents, LoadStats = InputData.LoadStats] {
+                                    PLATEAU_IMPORT_STAGE_SCOPE(LoadStats.Get(), Extract);
+                                    return MeshExtractor::extractInExtents(*CityModel, ExtractOptions, Extents);
+                                },
+                                GmlName, bCanceledRef, *AbandonedTasks, ExtractThroughput, FMath::Max<double>(CityModel->getNumRootCityObjects(), 1),
+                                [&BroadcastProgress](const float Progress) {
+                                    BroadcastProgress(FMath::Lerp(ExtractProgressBegin, LoadModelProgressBegin, Progress), LOCTEXT("MeshExtractorExtractEstimated", "ポリゴンメッシュ変換中(進捗は推定)..."));
+                                });
+                            if (!ExtractResult.IsSet()) {
+                                BroadcastProgress(ExtractProgressBegin, LOCTEXT("Cancel", "キャンセルされました"));
+                                return false;
+                            }
+                            const auto Model = ExtractResult.GetValue();
+
+                            if (InputData.TexturePackingPageSize.IsSet() && !bCanceledRef->Load(EMemoryOrder::Relaxed)) {
+                                BroadcastProgress(LoadModelProgressBegin, LOCTEXT("TexturePacking", "テクスチャ結合中..."));
+                                PLATEAU_IMPORT_STAGE_SCOPE(InputData.LoadStats.Get(), TexturePacking);
+                                FPLATEAUTextureAtlasOptions AtlasOptions;
+                                AtlasOptions.PageSize = InputData.TexturePackingPageSize.GetValue();
+                                AtlasOptions.OutputDirectory = FPLATEAUTextureAtlas::GetDefaultOutputDirectory();
+                                AtlasOptions.NamePrefix = FString::Printf(TEXT("Atlas_%s"), *FPaths::GetBaseFilename(GmlName));
+                                FPLATEAUTextureAtlas::Pack(*Model, AtlasOptions);
+                            }
 
                             // 各GMLについて親Componentを作成
                             // コンポーネントは拡張子無しgml名に設定
@@ -416,30 +866,39 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                             const auto GmlRootComponent = FCityModelLoaderImpl::CreateComponentInGameThread(ModelActor, GmlRootComponentName);
 
                             if (bCanceledRef->Load(EMemoryOrder::Relaxed)) {
-                                FFunctionGraphTask::CreateAndDispatchWhenReady(
-                                    [Index, ImportGmlProgressDelegate] {
-                                        ImportGmlProgressDelegate.Broadcast(Index, 0.75, LOCTEXT("Cancel", "キャンセルされました"));
-                                    }, TStatId(), nullptr, ENamedThreads::GameThread);
+                                BroadcastProgress(LoadModelProgressBegin, LOCTEXT("Cancel", "キャンセルされました"));
                                 return false;
                             }
 
-                            FFunctionGraphTask::CreateAndDispatchWhenReady(
-                                [Index, ImportGmlProgressDelegate] {
-                                    ImportGmlProgressDelegate.Broadcast(Index, 0.75, LOCTEXT("LoadModel", "ワールドに読み込み中..."));
-                                }, TStatId(), nullptr, ENamedThreads::GameThread);
+                            BroadcastProgress(LoadModelProgressBegin, LOCTEXT("LoadModel", "ワールドに読み込み中..."));
 
                             {
                                 FScopeLock Lock(LoadMeshSection);
-                                FPLATEAUMeshLoader(bAutomationTest).LoadModel(ModelActor, GmlRootComponent, Model, InputData, CityModel, bCanceledRef);
+                                double LastBroadcastSeconds = 0.0;
+                                FPLATEAUMeshLoader(bAutomationTest).LoadModel(ModelActor, GmlRootComponent, Model, ResolvedInputData, CityModel, bCanceledRef,
+                                    [&BroadcastProgress, &LastBroadcastSeconds](const int32 LoadedNodeCount, const int32 TotalNodeCount) {
+                                        // 通知が多すぎるとゲームスレッドを圧迫するため間引く
+                                        const auto CurrentSeconds = FPlatformTime::Seconds();
+                                        if (CurrentSeconds - LastBroadcastSeconds < StatusPollingIntervalSeconds)
+                                            return;
+                                        LastBroadcastSeconds = CurrentSeconds;
+                                        const auto Progress = static_cast<float>(LoadedNodeCount) / FMath::Max(TotalNodeCount, 1);
+                                        BroadcastProgress(FMath::Lerp(LoadModelProgressBegin, 1.0f, Progress), LOCTEXT("LoadModel", "ワールドに読み込み中..."));
+                                    });
                             }
 
+                            ExecuteInGameThread(OwnerLoader,
+                                [Report = InputData.LoadStats->ToReport(!bCanceledRef->Load(EMemoryOrder::Relaxed))](auto Loader) {
+                                    Loader->Status.GmlReports.Add(Report);
+                                });
+
                             FFunctionGraphTask::CreateAndDispatchWhenReady(
                                 [bCanceledRef, Index, ImportGmlProgressDelegate] {
                                     if (!bCanceledRef->Load(EMemoryOrder::Relaxed)) {
                                         ImportGmlProgressDelegate.Broadcast(Index, 1.0, LOCTEXT("Finish", "完了"));
                                     }
                                     else {
-                                        ImportGmlProgressDelegate.Broadcast(Index, 0.75, LOCTEXT("Cancel", "キャンセルされました"));
+                                        ImportGmlProgressDelegate.Broadcast(Index, LoadModelProgressBegin, LOCTEXT("Cancel", "キャンセルされました"));
                                     }
                                 }, TStatId(), nullptr, ENamedThreads::GameThread);
 
@@ -467,7 +926,49 @@ void APLATEAUCityModelLoader::LoadAsync(const bool bAutomationTest) {
                         }
 
                         return CurrentLoadingGmls.Num() == 0;
-                    }, 3);
+                    }, StatusPollingIntervalSeconds);
+
+                // 読み込みが完了したzipアーカイブを閉じる(属性情報の参照等で必要になった場合は再度開かれる)
+                if (!bImportFromServer && FPLATEAUDatasetArchive::IsArchivePath(Source))
+                    FPLATEAUDatasetArchive::Release(Source);
+
+                // GMLの読み込み完了後も続く非同期の処理(コリジョンクッキング)の完了を待ち、その時間を計測結果に反映する
+                const auto WaitStartSeconds = FPlatformTime::Seconds();
+                FGenericPlatformProcess::ConditionalSleep(
+                    [&LoadStatsArray, &bCanceledRef, WaitStartSeconds] {
+                        if (bCanceledRef->Load(EMemoryOrder::Relaxed) || FPlatformTime::Seconds() - WaitStartSeconds > MaxRunningStageWaitSeconds)
+                            return true;
+                        return !LoadStatsArray.ContainsByPredicate([](const TSharedPtr<FPLATEAUGmlLoadStats>& LoadStats) {
+                            return LoadStats->HasRunningStages();
+                        });
+                    }, StatusPollingIntervalSeconds);
+
+                // 計測結果を出力
+                TArray<FPLATEAUGmlLoadReport> GmlReports;
+                const auto ReportPath = FPLATEAUImportReportWriter::GetDefaultBaseFilePath(LoadedDatasetName);
+                ExecuteInGameThread(OwnerLoader,
+                    [&GmlReports, &ReportPath, &LoadStatsArray](auto Loader) {
+                        for (auto& Report : Loader->Status.GmlReports) {
+                            const auto LoadStats = LoadStatsArray.FindByPredicate([&Report](const TSharedPtr<FPLATEAUGmlLoadStats>& Stats) {
+                                return Stats->GetGmlName() == Report.GmlName;
+                            });
+                            if (LoadStats != nullptr)
+                                (*LoadStats)->UpdateStageSeconds(Report);
+                        }
+                        GmlReports = Loader->Status.GmlReports;
+                        Loader->Status.ReportPath = ReportPath;
+                    });
+                if (GmlReports.Num() > 0 && FPLATEAUImportReportWriter::Write(GmlReports, ReportPath))
+                    UE_LOG(LogTemp, Log, TEXT("Import report: %s"), *ReportPath);
+
+                // キャンセルにより破棄した処理は優先度を下げて実行を続けるため、終了を待たずに完了とする
+                const auto NumAbandonedTasks = AbandonedTasks->GetNum();
+                ExecuteInGameThread(OwnerLoader,
+                    [NumAbandonedTasks](auto Loader) {
+                        Loader->Status.AbandonedTaskCount = NumAbandonedTasks;
+                    });
+                if (NumAbandonedTasks > 0)
+                    UE_LOG(LogTemp, Log, TEXT("%d abandoned tasks are still running at low priority"), NumAbandonedTasks);
 
                 *Phase = ECityModelLoadingPhase::Finished;
                 FFunctionGraphTask::CreateAndDispatchWhenReady(
@@ -551,6 +1052,15 @@ void APLATEAUCityModelLoader::BeginPlay() {
     Super::BeginPlay();
 }
 
+void APLATEAUCityModelLoader::BeginDestroy() {
+    // 破棄した処理は自身の入力を保持しているため、ゲームスレッドを止めずに通知のみ行う
+    if (AbandonedTasks.IsValid()) {
+        if (const auto NumAbandonedTasks = AbandonedTasks->GetNum(); NumAbandonedTasks > 0)
+            UE_LOG(LogTemp, Warning, TEXT("%s is destroyed while %d abandoned tasks are still running"), *GetName(), NumAbandonedTasks);
+    }
+    Super::BeginDestroy();
+}
+
 void APLATEAUCityModelLoader::Tick(float DeltaTime) {
     Super::Tick(DeltaTime);
 }
@@ -3,6 +3,8 @@
 
 #include "PLATEAUGeometry.h"
 
+#include "Async/ParallelFor.h"
+
 /**** GeoCoordinate ****/
 
 FPLATEAUGeoCoordinate::FPLATEAUGeoCoordinate() : Latitude(0), Longitude(0), Height(0) {}
@@ -85,6 +87,74 @@ void FPLATEAUGeoReference::UpdateNativeData() {
     Data.setZoneID(ZoneID);
 }
 
+namespace {
+    //! 一括変換で1スレッドが処理する要素数。これ以下の要素数は単一スレッドで処理します。
+    constexpr int32 BatchChunkSize = 16 * 1024;
+
+    template<typename FuncType>
+    void ParallelForChunks(const int32 Num, FuncType&& Func) {
+        const int32 NumChunks = FMath::DivideAndRoundUp(Num, BatchChunkSize);
+        ParallelFor(NumChunks, [&Func, Num](const int32 ChunkIndex) {
+            const int32 Begin = ChunkIndex * BatchChunkSize;
+            Func(Begin, FMath::Min(Begin + BatchChunkSize, Num));
+        }, NumChunks <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+    }
+}
+
+void FPLATEAUGeoReference::ProjectBatch(TConstArrayView<FPLATEAUGeoCoordinate> InCoordinates, TArrayView<FVector> OutPoints) {
+    check(InCoordinates.Num() == OutPoints.Num());
+
+    const auto& NativeData = GetData();
+    ParallelForChunks(InCoordinates.Num(), [&](const int32 Begin, const int32 End) {
+        for (int32 i = Begin; i < End; ++i) {
+            const auto NativePoint = NativeData.project(InCoordinates[i].GetNativeData());
+            OutPoints[i] = FVector(NativePoint.x, NativePoint.y, NativePoint.z);
+        }
+    });
+}
+
+void FPLATEAUGeoReference::UnprojectBatch(TConstArrayView<FVector> InPoints, TArrayView<FPLATEAUGeoCoordinate> OutCoordinates) {
+    check(InPoints.Num() == OutCoordinates.Num());
+
+    const auto& NativeData = GetData();
+    ParallelForChunks(InPoints.Num(), [&](const int32 Begin, const int32 End) {
+        for (int32 i = Begin; i < End; ++i) {
+            OutCoordinates[i] = NativeData.unproject(TVec3d(InPoints[i].X, InPoints[i].Y, InPoints[i].Z));
+        }
+    });
+}
+
+void FPLATEAUGeoReference::ConvertAxisBatch(
+    const plateau::geometry::CoordinateSystem From, const plateau::geometry::CoordinateSystem To,
+    TConstArrayView<FVector3f> InPoints, TArrayView<FVector3d> OutPoints,
+    const FVector3d& Offset, const double Scale) {
+    check(InPoints.Num() == OutPoints.Num());
+
+    // 各基底ベクトルの変換結果から変換行列(列ベクトル)を求め、スケールも含める
+    double Matrix[3][3];
+    for (int Column = 0; Column < 3; ++Column) {
+        TVec3d Basis(0, 0, 0);
+        Basis.xyz[Column] = 1.0;
+        const auto Converted = plateau::geometry::GeoReference::convertAxisFromENUTo(
+            To, plateau::geometry::GeoReference::convertAxisToENU(From, Basis));
+        for (int Row = 0; Row < 3; ++Row) {
+            Matrix[Row][Column] = Converted.xyz[Row] * Scale;
+        }
+    }
+
+    ParallelForChunks(InPoints.Num(), [&](const int32 Begin, const int32 End) {
+        for (int32 i = Begin; i < End; ++i) {
+            const double X = InPoints[i].X + Offset.X;
+            const double Y = InPoints[i].Y + Offset.Y;
+            const double Z = InPoints[i].Z + Offset.Z;
+            OutPoints[i] = FVector3d(
+                Matrix[0][0] * X + Matrix[0][1] * Y + Matrix[0][2] * Z,
+                Matrix[1][0] * X + Matrix[1][1] * Y + Matrix[1][2] * Z,
+                Matrix[2][0] * X + Matrix[2][1] * Y + Matrix[2][2] * Z);
+        }
+    });
+}
+
 FPLATEAUGeoCoordinate UPLATEAUGeoReferenceBlueprintLibrary::Unproject(FPLATEAUGeoReference& GeoReference,
     const FVector& Point) {
     const TVec3d NativePoint(Point.X, Point.Y, Point.Z);
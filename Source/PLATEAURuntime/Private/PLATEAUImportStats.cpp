@@ -0,0 +1,170 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUImportStats.h"
+
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_STAT(STAT_PLATEAUImport_Copy);
+DEFINE_STAT(STAT_PLATEAUImport_Parse);
+DEFINE_STAT(STAT_PLATEAUImport_Extract);
+DEFINE_STAT(STAT_PLATEAUImport_ConvertMesh);
+DEFINE_STAT(STAT_PLATEAUImport_ComponentSetup);
+DEFINE_STAT(STAT_PLATEAUImport_TextureLoad);
+DEFINE_STAT(STAT_PLATEAUImport_MaterialCreation);
+DEFINE_STAT(STAT_PLATEAUImport_BatchBuild);
+DEFINE_STAT(STAT_PLATEAUImport_Collision);
+DEFINE_STAT(STAT_PLATEAUImport_SerializeAttributes);
+DEFINE_STAT(STAT_PLATEAUImport_TexturePacking);
+
+UE_TRACE_CHANNEL_DEFINE(PLATEAUImportChannel);
+
+namespace {
+    constexpr double BytesPerMegaByte = 1024.0 * 1024.0;
+
+    FString GetStageName(const EPLATEAUImportStage Stage) {
+        return StaticEnum<EPLATEAUImportStage>()->GetNameStringByValue(static_cast<int64>(Stage));
+    }
+
+    /**
+     * @brief CSVのフィールドとして出力できるよう、区切り文字、引用符、改行を含む場合は引用符で囲みます。
+     */
+    FString EscapeCsvField(const FString& Value) {
+        if (!Value.Contains(TEXT(",")) && !Value.Contains(TEXT("\"")) && !Value.Contains(TEXT("\n")) && !Value.Contains(TEXT("\r")))
+            return Value;
+        return TEXT("\"") + Value.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+    }
+}
+
+FPLATEAUGmlLoadStats::FPLATEAUGmlLoadStats(const FString& InGmlName)
+    : GmlName(InGmlName), StartSeconds(FPlatformTime::Seconds()) {
+}
+
+void FPLATEAUGmlLoadStats::BeginStage(const EPLATEAUImportStage Stage) {
+    FScopeLock Lock(&Section);
+    const auto Index = static_cast<int32>(Stage);
+    if (RunningCounts[Index]++ == 0)
+        RunningStartSeconds[Index] = FPlatformTime::Seconds();
+}
+
+void FPLATEAUGmlLoadStats::EndStage(const EPLATEAUImportStage Stage, const double Seconds) {
+    FScopeLock Lock(&Section);
+    const auto Index = static_cast<int32>(Stage);
+    StageSeconds[Index] += Seconds;
+    if (RunningCounts[Index] > 0 && --RunningCounts[Index] == 0)
+        StageWallSeconds[Index] += FPlatformTime::Seconds() - RunningStartSeconds[Index];
+}
+
+void FPLATEAUGmlLoadStats::AddTriangleCount(const int64 Count) {
+    FScopeLock Lock(&Section);
+    TriangleCount += Count;
+}
+
+void FPLATEAUGmlLoadStats::AddTextureBytes(const int64 Bytes) {
+    FScopeLock Lock(&Section);
+    TextureBytes += Bytes;
+}
+
+bool FPLATEAUGmlLoadStats::HasRunningStages() const {
+    FScopeLock Lock(&Section);
+    for (const auto RunningCount : RunningCounts) {
+        if (RunningCount > 0)
+            return true;
+    }
+    return false;
+}
+
+FPLATEAUGmlLoadReport FPLATEAUGmlLoadStats::ToReport(const bool bSucceeded) const {
+    FPLATEAUGmlLoadReport Report;
+    Report.GmlName = GmlName;
+    Report.bSucceeded = bSucceeded;
+    UpdateStageSeconds(Report);
+
+    FScopeLock Lock(&Section);
+    Report.TotalSeconds = FPlatformTime::Seconds() - StartSeconds;
+    Report.TriangleCount = TriangleCount;
+    Report.TextureBytes = TextureBytes;
+    Report.ProcessPeakUsedPhysicalMB = FPlatformMemory::GetStats().PeakUsedPhysical / BytesPerMegaByte;
+    return Report;
+}
+
+void FPLATEAUGmlLoadStats::UpdateStageSeconds(FPLATEAUGmlLoadReport& Report) const {
+    FScopeLock Lock(&Section);
+    const auto CurrentSeconds = FPlatformTime::Seconds();
+    Report.StageSeconds.SetNumZeroed(StageCount);
+    Report.StageWallSeconds.SetNumZeroed(StageCount);
+    for (int32 i = 0; i < StageCount; ++i) {
+        Report.StageSeconds[i] = StageSeconds[i];
+        // 実行中の処理は現在までの経過時間を含める
+        Report.StageWallSeconds[i] = StageWallSeconds[i] + (RunningCounts[i] > 0 ? CurrentSeconds - RunningStartSeconds[i] : 0.0);
+    }
+}
+
+bool FPLATEAUImportReportWriter::Write(const TArray<FPLATEAUGmlLoadReport>& Reports, const FString& BaseFilePath) {
+    constexpr int32 StageCount = static_cast<int32>(EPLATEAUImportStage::Count);
+
+    // CSV (段階ごとに、並列実行分を合計した所要時間と経過時間を出力)
+    FString Csv = TEXT("GmlName,Succeeded");
+    for (int32 i = 0; i < StageCount; ++i) {
+        const auto StageName = GetStageName(static_cast<EPLATEAUImportStage>(i));
+        Csv += FString::Printf(TEXT(",%sCpuSumSeconds,%sWallSeconds"), *StageName, *StageName);
+    }
+    Csv += TEXT(",TotalSeconds,TriangleCount,TextureBytes,ProcessPeakUsedPhysicalMB\n");
+    double ProcessPeakUsedPhysicalMB = 0.0;
+    for (const auto& Report : Reports) {
+        Csv += FString::Printf(TEXT("%s,%d"), *EscapeCsvField(Report.GmlName), Report.bSucceeded ? 1 : 0);
+        for (int32 i = 0; i < StageCount; ++i) {
+            const auto Stage = static_cast<EPLATEAUImportStage>(i);
+            Csv += FString::Printf(TEXT(",%.6f,%.6f"), Report.GetStageSeconds(Stage), Report.GetStageWallSeconds(Stage));
+        }
+        Csv += FString::Printf(TEXT(",%.6f,%lld,%lld,%.1f\n"), Report.TotalSeconds, Report.TriangleCount, Report.TextureBytes, Report.ProcessPeakUsedPhysicalMB);
+        ProcessPeakUsedPhysicalMB = FMath::Max(ProcessPeakUsedPhysicalMB, Report.ProcessPeakUsedPhysicalMB);
+    }
+
+    // JSON
+    TArray<TSharedPtr<FJsonValue>> GmlsJsonArray;
+    for (const auto& Report : Reports) {
+        const TSharedPtr<FJsonObject> GmlJsonObject = MakeShareable(new FJsonObject);
+        GmlJsonObject->SetStringField(TEXT("gmlName"), Report.GmlName);
+        GmlJsonObject->SetBoolField(TEXT("succeeded"), Report.bSucceeded);
+        const TSharedPtr<FJsonObject> CpuSumJsonObject = MakeShareable(new FJsonObject);
+        const TSharedPtr<FJsonObject> WallJsonObject = MakeShareable(new FJsonObject);
+        for (int32 i = 0; i < StageCount; ++i) {
+            const auto Stage = static_cast<EPLATEAUImportStage>(i);
+            CpuSumJsonObject->SetNumberField(GetStageName(Stage), Report.GetStageSeconds(Stage));
+            WallJsonObject->SetNumberField(GetStageName(Stage), Report.GetStageWallSeconds(Stage));
+        }
+        GmlJsonObject->SetObjectField(TEXT("stageCpuSumSeconds"), CpuSumJsonObject);
+        GmlJsonObject->SetObjectField(TEXT("stageWallSeconds"), WallJsonObject);
+        GmlJsonObject->SetNumberField(TEXT("totalSeconds"), Report.TotalSeconds);
+        GmlJsonObject->SetNumberField(TEXT("triangleCount"), Report.TriangleCount);
+        GmlJsonObject->SetNumberField(TEXT("textureBytes"), Report.TextureBytes);
+        GmlsJsonArray.Emplace(MakeShared<FJsonValueObject>(GmlJsonObject));
+    }
+    const TSharedPtr<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
+    JsonRootObject->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+    // ピークメモリはプロセス全体の値であり、GMLごとには分離できないため全体で1つだけ出力する
+    JsonRootObject->SetNumberField(TEXT("processPeakUsedPhysicalMB"), ProcessPeakUsedPhysicalMB);
+    JsonRootObject->SetArrayField(TEXT("gmls"), GmlsJsonArray);
+
+    FString Json;
+    const auto Writer = TJsonWriterFactory<>::Create(&Json);
+    if (!FJsonSerializer::Serialize(JsonRootObject.ToSharedRef(), Writer))
+        return false;
+
+    const auto bCsvSaved = FFileHelper::SaveStringToFile(Csv, *(BaseFilePath + TEXT(".csv")), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    const auto bJsonSaved = FFileHelper::SaveStringToFile(Json, *(BaseFilePath + TEXT(".json")), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    if (!bCsvSaved || !bJsonSaved) {
+        UE_LOG(LogTemp, Error, TEXT("Failed to write import report: %s"), *BaseFilePath);
+        return false;
+    }
+    return true;
+}
+
+FString FPLATEAUImportReportWriter::GetDefaultBaseFilePath(const FString& DatasetName) {
+    const auto FileName = FString::Printf(TEXT("%s_%s"), DatasetName.IsEmpty() ? TEXT("Import") : *DatasetName, *FDateTime::Now().ToString());
+    return FPaths::ProjectSavedDir() / TEXT("PLATEAU/ImportReports") / FPaths::MakeValidFileName(FileName);
+}
@@ -18,6 +18,16 @@
 #include <Reconstruct/PLATEAUMeshLoaderForLandscapeMesh.h>
 #include <Reconstruct/PLATEAUModelAlignLand.h>
 #include "Tasks/Pipe.h"
+#include "EngineUtils.h"
+#include "Materials/MaterialInstance.h"
+#include <PLATEAUTextureAtlas.h>
+
+#if WITH_EDITOR
+#include "EditorFramework/AssetImportData.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionActorDesc.h"
+#include "WorldPartition/WorldPartitionHelpers.h"
+#endif
 
 using namespace UE::Tasks;
 using namespace plateau::granularityConvert;
@@ -58,6 +68,14 @@ namespace {
         }
     }
 
+    /**
+     * @brief 都市オブジェクトの種類がフィルタリングで表示対象かどうかを返します。
+     */
+    bool IsFeatureTypeEnabled(const FPLATEAUCityObject& CityObject, const citygml::CityObject::CityObjectsType InCityObjectType) {
+        const int64 CityObjectType = UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(CityObject.Type);
+        return (static_cast<int64>(InCityObjectType) & CityObjectType) != 0;
+    }
+
     /**
      * @brief 対象コンポーネントとその子コンポーネントのコリジョン設定変更
      * @param ParentComponent コリジョン設定変更対象コンポーネント
@@ -85,6 +103,45 @@ namespace {
             }
         }
     }
+
+    /**
+     * @brief 都市オブジェクトが表示対象でない場合、コンポーネントを非表示にします。
+     * 結合されたメッシュは都市オブジェクト単位で非表示にし、主要地物が非表示の場合はその子も非表示にします。
+     * @param IsEnabled 都市オブジェクトが表示対象かどうかを返す関数
+     * @param bKeepHidden trueの場合、既に非表示の都市オブジェクトは非表示のままとする
+     */
+    void FilterCityObjectGroup(UPLATEAUCityObjectGroup* CityObjGrp, TFunctionRef<bool(const FPLATEAUCityObject& CityObject)> IsEnabled, const bool bKeepHidden = false) {
+        const auto ObjList = CityObjGrp->GetAllRootCityObjects();
+        if (ObjList.Num() == 0)
+            return;
+
+        // 子を別コンポーネントに持たない場合、子はこのメッシュに結合されている
+        const auto bHasMergedChildren = CityObjGrp->OutsideChildren.Num() == 0 && ObjList.ContainsByPredicate([](const FPLATEAUCityObject& CityObject) {
+            return CityObject.Children.Num() > 0;
+        });
+        if (ObjList.Num() == 1 && !bHasMergedChildren) {
+            if (IsEnabled(ObjList[0]))
+                return;
+
+            ApplyCollisionResponseBlockToChannel(CityObjGrp, false);
+            CityObjGrp->SetVisibility(false);
+            return;
+        }
+
+        TSet<int32> HiddenPrimaryIndices;
+        for (const auto& CityObject : ObjList) {
+            if (!IsEnabled(CityObject))
+                HiddenPrimaryIndices.Add(CityObject.CityObjectIndex.PrimaryIndex);
+        }
+        const auto bAnyVisible = CityObjGrp->SetCityObjectVisibility([&HiddenPrimaryIndices, &IsEnabled](const FPLATEAUCityObject& CityObject) {
+            return IsEnabled(CityObject) && !HiddenPrimaryIndices.Contains(CityObject.CityObjectIndex.PrimaryIndex);
+        }, bKeepHidden);
+        if (bAnyVisible)
+            return;
+
+        ApplyCollisionResponseBlockToChannel(CityObjGrp, false);
+        CityObjGrp->SetVisibility(false);
+    }
 }
 
 FString APLATEAUInstancedCityModel::GetOriginalComponentName(const USceneComponent* const InComponent) {
@@ -135,6 +192,7 @@ double APLATEAUInstancedCityModel::GetLongitude() {
 FPLATEAUCityObjectInfo APLATEAUInstancedCityModel::GetCityObjectInfo(USceneComponent* Component) {
     FPLATEAUCityObjectInfo Result;
     Result.DatasetName = DatasetName;
+    Result.DatasetSourcePath = DatasetSourcePath;
 
     if (Component == nullptr)
         return Result;
@@ -164,6 +222,74 @@ TArray<FPLATEAUCityObject>& APLATEAUInstancedCityModel::GetAllRootCityObjects()
     return RootCityObjects;
 }
 
+TArray<APLATEAUInstancedCityModel*> APLATEAUInstancedCityModel::GetStreamingCellCityModels() const {
+    TArray<APLATEAUInstancedCityModel*> CityModels;
+    if (StreamingCellName.IsEmpty() || !StreamingGroupId.IsValid() || GetWorld() == nullptr) {
+        CityModels.Add(const_cast<APLATEAUInstancedCityModel*>(this));
+        return CityModels;
+    }
+
+    // 同じインポートで生成された読み込み済みのセルを収集
+    for (TActorIterator<APLATEAUInstancedCityModel> It(GetWorld()); It; ++It) {
+        if (It->StreamingGroupId == StreamingGroupId)
+            CityModels.Add(*It);
+    }
+    return CityModels;
+}
+
+int32 APLATEAUInstancedCityModel::GetUnloadedStreamingCellCount() const {
+    int32 Count = 0;
+#if WITH_EDITOR
+    if (StreamingCellName.IsEmpty() || GetWorld() == nullptr)
+        return Count;
+
+    const auto WorldPartition = GetWorld()->GetWorldPartition();
+    if (WorldPartition == nullptr)
+        return Count;
+
+    const auto LabelPrefix = DatasetName + TEXT("_");
+    FWorldPartitionHelpers::ForEachActorDesc<APLATEAUInstancedCityModel>(WorldPartition, [&Count, &LabelPrefix](const FWorldPartitionActorDesc* ActorDesc) {
+        if (!ActorDesc->IsLoaded() && ActorDesc->GetActorLabel().ToString().StartsWith(LabelPrefix))
+            ++Count;
+        return true;
+    });
+#endif
+    return Count;
+}
+
+TSet<FString> APLATEAUInstancedCityModel::GetLoadedGmlNames() const {
+    TSet<FString> GmlNames;
+    for (const auto& GmlComponent : GetGmlComponents()) {
+        GmlNames.Add(GmlComponent->GetName());
+    }
+    return GmlNames;
+}
+
+void APLATEAUInstancedCityModel::RemoveGmlComponents(const TSet<FString>& GmlNames) {
+    // イテレーション中に破棄しないようコピー
+    const auto GmlComponents = TArray<USceneComponent*>(GetGmlComponents());
+    for (const auto& GmlComponent : GmlComponents) {
+        if (!GmlNames.Contains(GmlComponent->GetName()))
+            continue;
+
+        TArray<USceneComponent*> ChildComponents;
+        GmlComponent->GetChildrenComponents(true, ChildComponents);
+        for (const auto& ChildComponent : ChildComponents) {
+            ChildComponent->DestroyComponent();
+        }
+        CityObjectTypeCache.Remove(GetGmlFileName(GmlComponent));
+        GmlComponent->DestroyComponent();
+    }
+    RootCityObjects.Reset();
+    AttributeStore.Reset();
+}
+
+TSharedPtr<FPLATEAUMaterialCache> APLATEAUInstancedCityModel::GetMaterialCache() {
+    if (!MaterialCache.IsValid())
+        MaterialCache = MakeShared<FPLATEAUMaterialCache>();
+    return MaterialCache;
+}
+
 void APLATEAUInstancedCityModel::FilterLowLods(const USceneComponent* const InGmlComponent, const int MinLod, const int MaxLod) {
     const TArray<USceneComponent*>& AttachedLodChildren = InGmlComponent->GetAttachChildren();
 
@@ -313,17 +439,9 @@ APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByFeatureTypes(con
                 if (!FeatureComponent->IsA(UPLATEAUCityObjectGroup::StaticClass()))
                     continue;
 
-                const auto CityObjGrp = StaticCast<UPLATEAUCityObjectGroup*>(FeatureComponent);
-                const auto ObjList = CityObjGrp->GetAllRootCityObjects();
-                if (ObjList.Num() != 1)
-                    continue;
-
-                const int64 CityObjectType = UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(ObjList[0].Type);
-                if (static_cast<int64>(InCityObjectType) & CityObjectType) 
-                    continue;
-
-                ApplyCollisionResponseBlockToChannel(FeatureComponent, false);
-                FeatureComponent->SetVisibility(false);
+                FilterCityObjectGroup(StaticCast<UPLATEAUCityObjectGroup*>(FeatureComponent), [InCityObjectType](const FPLATEAUCityObject& CityObject) {
+                    return IsFeatureTypeEnabled(CityObject, InCityObjectType);
+                });
             }
         }
     }  
@@ -331,32 +449,112 @@ APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByFeatureTypes(con
     return this;
 }
 
+TSharedPtr<FPLATEAUAttributeStore> APLATEAUInstancedCityModel::GetAttributeStore() {
+    TArray<UPLATEAUCityObjectGroup*> CityObjectGroups;
+    GetComponents<UPLATEAUCityObjectGroup>(CityObjectGroups);
+    if (!AttributeStore.IsValid() || !AttributeStore->IsUpToDate(CityObjectGroups)) {
+        AttributeStore = MakeShared<FPLATEAUAttributeStore>();
+        AttributeStore->Build(CityObjectGroups);
+    }
+    return AttributeStore;
+}
+
+FPLATEAUAttributeQueryResult APLATEAUInstancedCityModel::QueryCityObjectsByAttributes(const TArray<FPLATEAUAttributeCondition>& Conditions) {
+    return GetAttributeStore()->Query(Conditions);
+}
+
+APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByAttributes(const TArray<FPLATEAUAttributeCondition>& Conditions) {
+    bIsFiltering = true;
+    const auto Result = QueryCityObjectsByAttributes(Conditions);
+    TArray<UPLATEAUCityObjectGroup*> CityObjectGroups;
+    GetComponents<UPLATEAUCityObjectGroup>(CityObjectGroups);
+    for (const auto& CityObjGrp : CityObjectGroups) {
+        //この時点で不可視状態ならLodフィルタリングで不可視化されたことになるので無視
+        if (!CityObjGrp->IsVisible())
+            continue;
+
+        // 主要地物が条件を満たす場合はその最小地物も条件を満たすものとして扱う。
+        // 最小地物のみを持つコンポーネントは親の主要地物のGmlIDで判定する
+        const auto bParentMatched = !CityObjGrp->OutsideParent.IsEmpty() && Result.GmlIDs.Contains(CityObjGrp->OutsideParent);
+        TSet<int32> MatchedPrimaryIndices;
+        for (const auto& CityObject : CityObjGrp->GetAllRootCityObjects()) {
+            if (Result.GmlIDs.Contains(CityObject.GmlID))
+                MatchedPrimaryIndices.Add(CityObject.CityObjectIndex.PrimaryIndex);
+        }
+        FilterCityObjectGroup(CityObjGrp, [&Result, &MatchedPrimaryIndices, bParentMatched](const FPLATEAUCityObject& CityObject) {
+            return bParentMatched
+                || Result.GmlIDs.Contains(CityObject.GmlID)
+                || MatchedPrimaryIndices.Contains(CityObject.CityObjectIndex.PrimaryIndex);
+        }, true);
+    }
+    bIsFiltering = false;
+    return this;
+}
+
 APLATEAUInstancedCityModel* APLATEAUInstancedCityModel::FilterByFeatureTypesLegacy(const citygml::CityObject::CityObjectsType InCityObjectType) {
     bIsFiltering = true;
+
+    // 種類が未登録のGMLのみパースする
+    TArray<FPLATEAUCityObjectInfo> UncachedGmlInfos;
+    for (const auto& GmlComponent : GetGmlComponents()) {
+        // BillboardComponentを無視
+        if (GmlComponent.GetName().Contains("BillboardComponent"))
+            continue;
+
+        // 起伏は重いため意図的に除外
+        const auto Package = GetCityModelPackage(GmlComponent);
+        if (Package == plateau::dataset::PredefinedCityModelPackage::Relief)
+            continue;
+
+        const auto GmlName = GetGmlFileName(GmlComponent);
+        if (CityObjectTypeCache.Contains(GmlName))
+            continue;
+
+        FPLATEAUCityObjectInfo GmlInfo;
+        GmlInfo.DatasetName = DatasetName;
+        GmlInfo.DatasetSourcePath = DatasetSourcePath;
+        GmlInfo.GmlName = GmlName;
+        UncachedGmlInfos.Add(GmlInfo);
+    }
+
+    // 全て登録済みであればCityGMLを読まずにフィルタリング
+    if (UncachedGmlInfos.Num() == 0) {
+        FilterByFeatureTypesInternal(InCityObjectType);
+        bIsFiltering = false;
+        return this;
+    }
+
     Launch(
         TEXT("ParseGmlsTask"),
-        [this, InCityObjectType, GmlComponents = GetGmlComponents()] {
-            // 処理が重いため先にCityGMLのパースを行って内部的にキャッシュしておく。
-            for (const auto& GmlComponent : GmlComponents) {
-                // BillboardComponentを無視
-                if (GmlComponent.GetName().Contains("BillboardComponent"))
-                    continue;
-
-                // 起伏は重いため意図的に除外
-                const auto Package = GetCityModelPackage(GmlComponent);
-                if (Package == plateau::dataset::PredefinedCityModelPackage::Relief)
+        [this, InCityObjectType, UncachedGmlInfos] {
+            // 処理が重いためバックグラウンドでCityGMLをパースし、都市オブジェクトの種類のみを抽出する。
+            TMap<FString, TMap<FString, int64>> GmlCityObjectTypes;
+            for (const auto& GmlInfo : UncachedGmlInfos) {
+                const auto CityModel = UPLATEAUCityGmlProxy::Load(GmlInfo);
+                if (CityModel == nullptr) {
+                    UE_LOG(LogTemp, Error, TEXT("Invalid Dataset or Gml : %s, %s"), *GmlInfo.DatasetName, *GmlInfo.GmlName);
                     continue;
+                }
 
-                FPLATEAUCityObjectInfo GmlInfo;
-                GmlInfo.DatasetName = DatasetName;
-                GmlInfo.GmlName = GetGmlFileName(GmlComponent);
-                const auto CityModel = UPLATEAUCityGmlProxy::Load(GmlInfo);
+                auto& CityObjectTypes = GmlCityObjectTypes.Add(GmlInfo.GmlName);
+                TArray<const citygml::CityObject*> CityObjectStack;
+                for (const auto RootCityObject : CityModel->getRootCityObjects()) {
+                    CityObjectStack.Add(RootCityObject);
+                }
+                while (0 < CityObjectStack.Num()) {
+                    const auto CityObject = CityObjectStack.Pop(/*bAllowShrinking=*/ false);
+                    CityObjectTypes.Add(UTF8_TO_TCHAR(CityObject->getId().c_str()), static_cast<int64>(CityObject->getType()));
+                    for (unsigned int i = 0; i < CityObject->getChildCityObjectsCount(); ++i) {
+                        CityObjectStack.Add(&CityObject->getChildCityObject(i));
+                    }
+                }
             }
 
-            // フィルタリング実行。スレッドセーフでない関数を使用するためメインスレッドで実行する。
+            // キャッシュ登録とフィルタリング実行。スレッドセーフでない関数を使用するためメインスレッドで実行する。
             const auto GameThreadTask =
                 FFunctionGraphTask::CreateAndDispatchWhenReady(
-                    [this, InCityObjectType] {
+                    [this, InCityObjectType, &GmlCityObjectTypes] {
+                        CityObjectTypeCache.Append(MoveTemp(GmlCityObjectTypes));
                         FilterByFeatureTypesInternal(InCityObjectType);
                     }, TStatId(), nullptr, ENamedThreads::GameThread);
             GameThreadTask->Wait();
@@ -415,6 +613,34 @@ bool APLATEAUInstancedCityModel::HasAttributeInfo() {
         });
 }
 
+void APLATEAUInstancedCityModel::DeleteUnusedTextureAtlases() {
+#if WITH_EDITOR
+    // アトラス画像はテクスチャアセットのソースファイルとして参照される
+    TSet<FString> UsedFileNames;
+    TArray<UPLATEAUCityObjectGroup*> CityObjectGroups;
+    GetComponents<UPLATEAUCityObjectGroup>(CityObjectGroups);
+    for (const auto& CityObjectGroup : CityObjectGroups) {
+        for (int32 i = 0; i < CityObjectGroup->GetNumMaterials(); ++i) {
+            // ルックアップマテリアル等の親マテリアルのテクスチャも参照として扱う
+            for (auto MaterialInstance = Cast<UMaterialInstance>(CityObjectGroup->GetMaterial(i)); MaterialInstance != nullptr;
+                 MaterialInstance = Cast<UMaterialInstance>(MaterialInstance->Parent)) {
+                for (const auto& TextureParameterValue : MaterialInstance->TextureParameterValues) {
+                    const auto Texture = TextureParameterValue.ParameterValue;
+                    if (Texture == nullptr || Texture->AssetImportData == nullptr)
+                        continue;
+                    for (const auto& SourceFile : Texture->AssetImportData->GetSourceData().SourceFiles) {
+                        UsedFileNames.Add(FPaths::GetCleanFilename(SourceFile.RelativeFilename));
+                    }
+                }
+            }
+        }
+    }
+
+    FPLATEAUTextureAtlas::DeleteUnusedPages(FPLATEAUTextureAtlas::GetDefaultOutputDirectory(),
+        FPLATEAUModelReconstruct::GetTextureAtlasNamePrefix(*this), UsedFileNames);
+#endif
+}
+
 void APLATEAUInstancedCityModel::FilterByFeatureTypesInternal(const citygml::CityObject::CityObjectsType InCityObjectType) {
     for (const auto& GmlComponent : GetRootComponent()->GetAttachChildren()) {
         // BillboardComponentを無視
@@ -426,6 +652,12 @@ void APLATEAUInstancedCityModel::FilterByFeatureTypesInternal(const citygml::Cit
         if (Package == plateau::dataset::PredefinedCityModelPackage::Relief)
             continue;
 
+        const auto CityObjectTypes = CityObjectTypeCache.Find(GetGmlFileName(GmlComponent));
+        if (CityObjectTypes == nullptr) {
+            UE_LOG(LogTemp, Error, TEXT("City object types are not cached : %s"), *GetGmlFileName(GmlComponent));
+            continue;
+        }
+
         for (const auto& LodComponent : GmlComponent->GetAttachChildren()) {
             TArray<USceneComponent*> FeatureComponents;
             LodComponent->GetChildrenComponents(true, FeatureComponents);
@@ -445,24 +677,13 @@ void APLATEAUInstancedCityModel::FilterByFeatureTypesInternal(const citygml::Cit
                 if (FeatureID.Contains("BillboardComponent"))
                     continue;
 
-                FPLATEAUCityObjectInfo GmlInfo;
-                GmlInfo.DatasetName = DatasetName;
-                GmlInfo.GmlName = GetGmlFileName(GmlComponent);
-                const auto CityModel = UPLATEAUCityGmlProxy::Load(GmlInfo);
-
-                if (CityModel == nullptr) {
-                    UE_LOG(LogTemp, Error, TEXT("Invalid Dataset or Gml : %s, %s"), *GmlInfo.DatasetName, *GmlInfo.GmlName);
-                    continue;
-                }
-
-                const auto CityObject = CityModel->getCityObjectById(TCHAR_TO_UTF8(*FeatureID));
-                if (CityObject == nullptr) {
+                const auto CityObjectType = CityObjectTypes->Find(FeatureID);
+                if (CityObjectType == nullptr) {
                     UE_LOG(LogTemp, Error, TEXT("Invalid ID : %s"), *FeatureID);
                     continue;
                 }
 
-                const auto CityObjectType = CityObject->getType();
-                if (static_cast<uint64_t>(InCityObjectType & CityObjectType))
+                if (static_cast<int64>(InCityObjectType) & *CityObjectType)
                     continue;
 
                 ApplyCollisionResponseBlockToChannel(FeatureComponent, false);
@@ -472,16 +693,26 @@ void APLATEAUInstancedCityModel::FilterByFeatureTypesInternal(const citygml::Cit
     }
 }
 
-TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ReconstructModel(const TArray<USceneComponent*> TargetComponents, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal)  {
+TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ReconstructModel(const TArray<USceneComponent*> TargetComponents, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal,
+                                                                            const TOptional<EPLATEAUTexturePackingResolution> TexturePacking)  {
 
     UE_LOG(LogTemp, Log, TEXT("ReconstructModel: %d %d %s"), TargetComponents.Num(), static_cast<int>(ReconstructType), bDestroyOriginal ? TEXT("True") : TEXT("False"));
-    TTask<TArray<USceneComponent*>> ReconstructModelTask = Launch(TEXT("ReconstructModelTask"), [this, TargetComponents, ReconstructType, bDestroyOriginal] {       
+    if (!FPLATEAUModelReconstruct::IsValidReconstructType(ReconstructType)) {
+        UE_LOG(LogTemp, Error, TEXT("ReconstructModel: Auto granularity is only available on import."));
+        return Launch(TEXT("ReconstructModelTask"), [] { return TArray<USceneComponent*>(); });
+    }
+    TTask<TArray<USceneComponent*>> ReconstructModelTask = Launch(TEXT("ReconstructModelTask"), [this, TargetComponents, ReconstructType, bDestroyOriginal, TexturePacking] {       
         FPLATEAUModelReconstruct ModelReconstruct(this, FPLATEAUModelReconstruct::GetConvertGranularityFromReconstructType(ReconstructType));
+        if (TexturePacking.IsSet())
+            ModelReconstruct.SetTexturePacking(TexturePacking.GetValue());
         const auto& TargetCityObjects = ModelReconstruct.GetUPLATEAUCityObjectGroupsFromSceneComponents(TargetComponents);
         auto Task = ReconstructTask(ModelReconstruct, TargetCityObjects, bDestroyOriginal);
         AddNested(Task);
         Task.Wait();
-        FFunctionGraphTask::CreateAndDispatchWhenReady([&]() {
+        FFunctionGraphTask::CreateAndDispatchWhenReady([&, TexturePacking]() {
+            if (TexturePacking.IsSet())
+                DeleteUnusedTextureAtlases();
+
             //終了イベント通知
             OnReconstructFinished.Broadcast();
             }, TStatId(), NULL, ENamedThreads::GameThread);
@@ -491,9 +722,53 @@ TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ReconstructModel(con
     return ReconstructModelTask;
 }
 
+TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::PackTextures(const TArray<USceneComponent*> TargetComponents, const EPLATEAUTexturePackingResolution Resolution, bool bDestroyOriginal) {
+
+    UE_LOG(LogTemp, Log, TEXT("PackTextures: %d %d %s"), TargetComponents.Num(), static_cast<int>(Resolution), bDestroyOriginal ? TEXT("True") : TEXT("False"));
+    TTask<TArray<USceneComponent*>> PackTexturesTask = Launch(TEXT("PackTexturesTask"), [this, TargetComponents, Resolution, bDestroyOriginal] {
+
+        FPLATEAUModelReconstruct ModelReconstruct;
+        const auto& TargetCityObjects = ModelReconstruct.GetUPLATEAUCityObjectGroupsFromSceneComponents(TargetComponents);
+
+        //粒度を変えないよう、粒度ごとにターゲットを取得して実行
+        TArray<USceneComponent*> JoinedResults;
+        TArray<ConvertGranularity> GranularityList{
+            ConvertGranularity::PerAtomicFeatureObject,
+            ConvertGranularity::PerPrimaryFeatureObject,
+            ConvertGranularity::PerCityModelArea,
+            ConvertGranularity::MaterialInPrimary
+        };
+        for (const auto& Granularity : GranularityList) {
+            const auto& Targets = ModelReconstruct.FilterComponentsByConvertGranularity(TargetCityObjects, Granularity);
+            if (Targets.Num() > 0) {
+                FPLATEAUModelReconstruct GranularityReconstruct(this, Granularity);
+                GranularityReconstruct.SetTexturePacking(Resolution);
+                auto GranularityTask = ReconstructTask(GranularityReconstruct, Targets, bDestroyOriginal);
+                AddNested(GranularityTask);
+                GranularityTask.Wait();
+                JoinedResults.Append(GranularityTask.GetResult());
+            }
+        }
+
+        FFunctionGraphTask::CreateAndDispatchWhenReady([&]() {
+            DeleteUnusedTextureAtlases();
+
+            //終了イベント通知
+            OnReconstructFinished.Broadcast();
+            }, TStatId(), NULL, ENamedThreads::GameThread);
+
+        return JoinedResults;
+    });
+    return PackTexturesTask;
+}
+
 TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ClassifyModel(const TArray<USceneComponent*> TargetComponents, TMap<EPLATEAUCityObjectsType, UMaterialInterface*> Materials, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal) {
     
     UE_LOG(LogTemp, Log, TEXT("ClassifyModelByType: %d %d %s"), TargetComponents.Num(), static_cast<int>(ReconstructType), bDestroyOriginal ? TEXT("True") : TEXT("False"));
+    if (!FPLATEAUModelReconstruct::IsValidReconstructType(ReconstructType)) {
+        UE_LOG(LogTemp, Error, TEXT("ClassifyModelByType: Auto granularity is only available on import."));
+        return Launch(TEXT("ClassifyModelByTypeTask"), [] { return TArray<USceneComponent*>(); });
+    }
     TTask<TArray<USceneComponent*>> ClassifyModelByTypeTask = Launch(TEXT("ClassifyModelByTypeTask"), [&, this, TargetComponents, bDestroyOriginal, Materials, ReconstructType] {
 
         FPLATEAUModelClassificationByType ModelClassification(this, Materials);
@@ -515,6 +790,10 @@ TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ClassifyModel(const
 UE::Tasks::TTask<TArray<USceneComponent*>> APLATEAUInstancedCityModel::ClassifyModel(const TArray<USceneComponent*> TargetComponents, const FString AttributeKey, TMap<FString, UMaterialInterface*> Materials, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal) {
     
     UE_LOG(LogTemp, Log, TEXT("ClassifyModelByAttr: %d %d %s"), TargetComponents.Num(), static_cast<int>(ReconstructType), bDestroyOriginal ? TEXT("True") : TEXT("False"));
+    if (!FPLATEAUModelReconstruct::IsValidReconstructType(ReconstructType)) {
+        UE_LOG(LogTemp, Error, TEXT("ClassifyModelByAttr: Auto granularity is only available on import."));
+        return Launch(TEXT("ClassifyModelByAttrTask"), [] { return TArray<USceneComponent*>(); });
+    }
     TTask<TArray<USceneComponent*>> ClassifyModelByAttrTask = Launch(TEXT("ClassifyModelByAttrTask"), [&, this, TargetComponents, AttributeKey, bDestroyOriginal, Materials, ReconstructType] {
 
         FPLATEAUModelClassificationByAttribute ModelClassification(this, AttributeKey, Materials);
@@ -605,11 +884,15 @@ UE::Tasks::FTask APLATEAUInstancedCityModel::CreateLandscape(const TArray<UScene
         FPLATEAUMeshExporter MeshExporter;
         std::shared_ptr<plateau::polygonMesh::Model> smodel = MeshExporter.CreateModelFromComponents(this, TargetCityObjects, ExtOptions);
 
-        auto Results = Landscape.CreateHeightMap(smodel, Param);
+        // 統合する場合はハイトマップの大きさが決まるため、以降はその大きさを使用
+        FPLATEAULandscapeParam LandscapeParam = Param;
+        auto Results = LandscapeParam.UnifiedLandscape
+            ? Landscape.CreateUnifiedHeightMap(smodel, LandscapeParam)
+            : Landscape.CreateHeightMap(smodel, LandscapeParam);
 
         // 高さを地形に揃える (LOD3Roadの場合は、ResultのHeightmap書き換え)
-        if (Param.AlignLand || Param.InvertRoadLod3) {
-            const auto& AlignedComponents = AlignLand(Results, Param, bDestroyOriginal);
+        if (LandscapeParam.AlignLand || LandscapeParam.InvertRoadLod3) {
+            const auto& AlignedComponents = AlignLand(Results, LandscapeParam, bDestroyOriginal);
             FFunctionGraphTask::CreateAndDispatchWhenReady([&, AlignedComponents, bDestroyOriginal]() {
                 // Align コンポーネント削除
                 DestroyOrHideComponents(AlignedComponents, bDestroyOriginal);
@@ -618,23 +901,32 @@ UE::Tasks::FTask APLATEAUInstancedCityModel::CreateLandscape(const TArray<UScene
 
         for (const auto Result : Results) {
             //　平滑化Mesh / Landscape生成
-            if (Param.ConvertTerrain) {
-                if (!Param.ConvertToLandscape) {
+            if (LandscapeParam.ConvertTerrain) {
+                if (!LandscapeParam.ConvertToLandscape) {
                     //平滑化Mesh生成
                     FPLATEAUMeshLoaderForLandscapeMesh MeshLoader;
-                    MeshLoader.CreateMeshFromHeightMap(*this, Param.TextureWidth, Param.TextureHeight, Result.Min, Result.Max, Result.MinUV, Result.MaxUV, Result.Data->data(), Result.NodeName);
+                    MeshLoader.CreateMeshFromHeightMap(*this, LandscapeParam.TextureWidth, LandscapeParam.TextureHeight, Result.Min, Result.Max, Result.MinUV, Result.MaxUV, Result.Data->data(), Result.NodeName,
+                        LandscapeParam.MeshMaxError, LandscapeParam.MeshChunkSizeQuads, LandscapeParam.UnifiedLandscape ? Result.TexturePath : FString());
                 }
                 else {
                     //Landscape生成
                     TArray<uint16> HeightData(Result.Data->data(), Result.Data->size());
                     //LandScape  
                     FFunctionGraphTask::CreateAndDispatchWhenReady(
-                        [&, HeightData, Result, Param ] {
-                            auto LandActor = Landscape.CreateLandScape(GetWorld(), Param.NumSubsections, Param.SubsectionSizeQuads,
-                            Param.ComponentCountX, Param.ComponentCountY,
-                            Param.TextureWidth, Param.TextureHeight,
-                            Result.Min, Result.Max, Result.MinUV, Result.MaxUV, Result.TexturePath, HeightData, Result.NodeName);
-                            Landscape.CreateLandScapeReference(LandActor, this, Result.NodeName);
+                        [&, HeightData, Result, LandscapeParam] {
+                            auto LandActor = Landscape.CreateLandScape(GetWorld(), LandscapeParam.NumSubsections, LandscapeParam.SubsectionSizeQuads,
+                            LandscapeParam.ComponentCountX, LandscapeParam.ComponentCountY,
+                            LandscapeParam.TextureWidth, LandscapeParam.TextureHeight,
+                            Result.Min, Result.Max, Result.MinUV, Result.MaxUV, Result.TexturePath, HeightData, Result.NodeName,
+                            LandscapeParam.UnifiedLandscape ? LandscapeParam.StreamingGridSize : 0);
+                            if (Result.SourceNodeNames.Num() > 0) {
+                                // 統合した場合はすべての元の地形から参照する
+                                for (const auto& SourceNodeName : Result.SourceNodeNames) {
+                                    Landscape.CreateLandScapeReference(LandActor, this, SourceNodeName);
+                                }
+                            } else {
+                                Landscape.CreateLandScapeReference(LandActor, this, Result.NodeName);
+                            }
                         }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
                 }
             }
@@ -643,7 +935,7 @@ UE::Tasks::FTask APLATEAUInstancedCityModel::CreateLandscape(const TArray<UScene
         FFunctionGraphTask::CreateAndDispatchWhenReady([&, TargetCityObjects, bDestroyOriginal, Results]() {
 
             // Landscape コンポーネント削除
-            if (Param.ConvertTerrain)
+            if (LandscapeParam.ConvertTerrain)
                 DestroyOrHideComponents(TargetCityObjects, bDestroyOriginal);
 
             //終了イベント通知
@@ -6,6 +6,7 @@
 #include "plateau/mesh_writer/fbx_writer.h"
 #include "PLATEAUExportSettings.h"
 #include "PLATEAUInstancedCityModel.h"
+#include "Component/PLATEAUCityObjectGroup.h"
 #include "plateau/polygon_mesh/model.h"
 #include "plateau/polygon_mesh/node.h"
 #include "plateau/polygon_mesh/mesh.h"
@@ -64,6 +65,13 @@ namespace {
 bool FPLATEAUMeshExporter::Export(const FString ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option) {
     ModelNames.Empty();
     TargetActor = ModelActor;
+
+    // 分割インポートで未読み込みのセルがある場合はGMLが欠落するため出力しない
+    if (const auto UnloadedCellCount = ModelActor->GetUnloadedStreamingCellCount(); UnloadedCellCount > 0) {
+        UE_LOG(LogTemp, Error, TEXT("%d streaming cells of %s are not loaded. Load all cells before exporting."), UnloadedCellCount, *ModelActor->DatasetName);
+        return false;
+    }
+
     switch (Option.FileFormat) {
     case EMeshFileFormat::OBJ:
         return ExportAsOBJ(ExportPath, ModelActor, Option);
@@ -154,14 +162,17 @@ bool FPLATEAUMeshExporter::ExportAsGLTF(const FString& ExportPath, APLATEAUInsta
 
 TArray<std::shared_ptr<plateau::polygonMesh::Model>> FPLATEAUMeshExporter::CreateModelFromActor(APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions Option) {
     TArray<std::shared_ptr<plateau::polygonMesh::Model>> ModelArray;
-    const auto RootComponent = ModelActor->GetRootComponent();
-    const auto Components = RootComponent->GetAttachChildren();
-    for (int i = 0; i < Components.Num(); i++) {
-        //BillboardComponentなるコンポーネントがついていることがあるので無視
-        if (Components[i]->GetName().Contains("BillboardComponent")) continue;
-
-        ModelArray.Add(CreateModel(Components[i], Option));
-        ModelNames.Add(APLATEAUInstancedCityModel::GetOriginalComponentName(Components[i]));
+    // インポート時に分割された場合は同一のインポートで生成された全てのアクタのGMLを出力(GMLは1つのアクタにのみ属する)
+    for (const auto CellModelActor : ModelActor->GetStreamingCellCityModels()) {
+        const auto RootComponent = CellModelActor->GetRootComponent();
+        const auto Components = RootComponent->GetAttachChildren();
+        for (int i = 0; i < Components.Num(); i++) {
+            //BillboardComponentなるコンポーネントがついていることがあるので無視
+            if (Components[i]->GetName().Contains("BillboardComponent")) continue;
+
+            ModelArray.Add(CreateModel(Components[i], Option));
+            ModelNames.Add(APLATEAUInstancedCityModel::GetOriginalComponentName(Components[i]));
+        }
     }
     return ModelArray;
 }
@@ -211,28 +222,27 @@ void FPLATEAUMeshExporter::CreateMesh(plateau::polygonMesh::Mesh& OutMesh, UScen
         UV1.push_back(TVec2f(UV.X, 1.0f - UV.Y));
     }
 
-    //UV4
+    //UV4(頂点レイアウトによらず都市オブジェクトインデックスを格納したUVチャンネルから取得)
+    const auto CityObjectIndexUVChannel = UPLATEAUCityObjectGroup::GetCityObjectIndexUVChannel(InVertices.GetNumTexCoords());
     for (uint32 i = 0; i < InVertices.GetNumVertices(); ++i) {
-        const FVector2f& UV = InVertices.GetVertexUV(i, 3);
+        const FVector2f UV = CityObjectIndexUVChannel != INDEX_NONE ? InVertices.GetVertexUV(i, CityObjectIndexUVChannel) : FVector2f::ZeroVector;
         UV4.push_back(TVec2f(UV.X, UV.Y));
     }
 
-    auto GeoRef = TargetActor->GeoReference.GetData();
-    for (uint32 i = 0; i < RenderMesh.VertexBuffers.PositionVertexBuffer.GetNumVertices(); i++) {
-        const auto VertexPosition = RenderMesh.VertexBuffers.PositionVertexBuffer.VertexPosition(i);
-        TVec3d Vertex;
-        if (Option.TransformType == EMeshTransformType::PlaneRect)
-            Vertex = TVec3d(VertexPosition.X + ReferencePoint.X, VertexPosition.Y + ReferencePoint.Y, VertexPosition.Z + ReferencePoint.Z);
-        else
-            Vertex = TVec3d(VertexPosition.X, VertexPosition.Y, VertexPosition.Z);
-        Vertex = GeoRef.convertAxisToENU(plateau::geometry::CoordinateSystem::ESU, Vertex);
-        Vertex = GeoRef.convertAxisFromENUTo(StaticCast<plateau::geometry::CoordinateSystem>(Option.CoordinateSystem), Vertex);
-
+    // 座標軸変換は全頂点に対して一括で行う
+    const auto& PositionBuffer = RenderMesh.VertexBuffers.PositionVertexBuffer;
+    const auto NumVertices = PositionBuffer.GetNumVertices();
+    if (0 < NumVertices) {
+        const TConstArrayView<FVector3f> Positions(&PositionBuffer.VertexPosition(0), NumVertices);
+        const auto Offset = Option.TransformType == EMeshTransformType::PlaneRect ? FVector3d(ReferencePoint) : FVector3d::ZeroVector;
         // glTFの場合はm単位で出力
-        if (Option.FileFormat == EMeshFileFormat::GLTF)
-            Vertex = TVec3d(Vertex.x * 0.01f, Vertex.y * 0.01f, Vertex.z * 0.01f);
+        const auto Scale = Option.FileFormat == EMeshFileFormat::GLTF ? 0.01 : 1.0;
 
-        Vertices.push_back(Vertex);
+        static_assert(sizeof(TVec3d) == sizeof(FVector3d), "TVec3d and FVector3d must have the same layout.");
+        Vertices.resize(NumVertices);
+        FPLATEAUGeoReference::ConvertAxisBatch(
+            plateau::geometry::CoordinateSystem::ESU, StaticCast<plateau::geometry::CoordinateSystem>(Option.CoordinateSystem),
+            Positions, TArrayView<FVector3d>(reinterpret_cast<FVector3d*>(Vertices.data()), NumVertices), Offset, Scale);
     }
 
     bool invertMesh = (Option.CoordinateSystem == ECoordinateSystem::EUN || Option.CoordinateSystem == ECoordinateSystem::ESU);
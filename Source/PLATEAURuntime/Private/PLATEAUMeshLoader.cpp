@@ -15,6 +15,8 @@
 #include "Materials/Material.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Component/PLATEAUStaticMeshComponent.h"
+#include "PLATEAUImportStats.h"
+#include "Async/ParallelFor.h"
 
 #if WITH_EDITOR
 #include "EditorFramework/AssetImportData.h"
@@ -73,7 +75,7 @@ FORCEINLINE uint32 GetTypeHash(const FSubMeshMaterialSet& Value) {
     HashArray.Add(FCrc::MemCrc32(&Value.Transparency, sizeof(float)));
     HashArray.Add(FCrc::MemCrc32(&Value.Ambient, sizeof(float)));
     HashArray.Add(FCrc::MemCrc32(&Value.isSmooth, sizeof(bool)));
-    HashArray.Add(FCrc::MemCrc32(&Value.TexturePath, sizeof(FString)));
+    HashArray.Add(GetTypeHash(Value.TexturePath));
     HashArray.Add(FCrc::MemCrc32(&Value.GameMaterialID, sizeof(int)));
     uint32 Hash = 0;
     for (auto h : HashArray) {
@@ -125,14 +127,111 @@ namespace {
         }
     }
 
+    /**
+     * @brief 頂点を共有する面の法線を面積で重み付けして平均します。
+     * 面の角度差がCreaseAngleを超える面と、都市オブジェクトが異なる面は平均に含めません。
+     * UVの境界では頂点インスタンスの属性が異なるため、StaticMeshのビルド時に頂点が分割されます。
+     * @param Triangles 3つごとに1つの三角形を表す頂点インスタンス(巻き順反転前)
+     */
+    void ComputeWeldedNormals(FStaticMeshAttributes& Attributes, const TArray<FVertexInstanceID>& Triangles, bool InvertNormal,
+        const float CreaseAngle, const int32 CityObjectIndexUVChannel) {
+        const auto Normals = Attributes.GetVertexInstanceNormals();
+        const auto InstanceVertices = Attributes.GetVertexInstanceVertexIndices();
+        const auto Vertices = Attributes.GetVertexPositions();
+        const auto UVs = Attributes.GetVertexInstanceUVs();
+
+        const auto NumFaces = Triangles.Num() / 3;
+        TArray<FVector3f> FaceNormals;
+        FaceNormals.SetNumUninitialized(NumFaces);
+        TArray<FVector3f> UnitFaceNormals;
+        UnitFaceNormals.SetNumUninitialized(NumFaces);
+
+        // 頂点ごとの隣接面をCSR形式で保持
+        TArray<int32> FaceOffsets;
+        FaceOffsets.SetNumZeroed(Vertices.GetNumElements() + 1);
+        for (int32 FaceIndex = 0; FaceIndex < NumFaces; ++FaceIndex) {
+            FVector3f VertexPositions[3];
+            for (int32 i = 0; i < 3; ++i) {
+                const auto VertexID = InstanceVertices[Triangles[FaceIndex * 3 + i]];
+                VertexPositions[i] = Vertices[VertexID];
+                ++FaceOffsets[VertexID.GetValue() + 1];
+            }
+
+            // ComputeNormalsと同じ向き。正規化しないことで面積による重み付けとする
+            FaceNormals[FaceIndex] = InvertNormal ?
+                FVector3f::CrossProduct((VertexPositions[0] - VertexPositions[1]),
+                    (VertexPositions[0] - VertexPositions[2])) :
+                FVector3f::CrossProduct((VertexPositions[0] - VertexPositions[2]),
+                    (VertexPositions[0] - VertexPositions[1]));
+            UnitFaceNormals[FaceIndex] = FaceNormals[FaceIndex].GetSafeNormal();
+        }
+        for (int32 i = 1; i < FaceOffsets.Num(); ++i) {
+            FaceOffsets[i] += FaceOffsets[i - 1];
+        }
+        TArray<int32> VertexFaces;
+        VertexFaces.SetNumUninitialized(NumFaces * 3);
+        TArray<int32> FaceCursors(FaceOffsets);
+        for (int32 FaceIndex = 0; FaceIndex < NumFaces; ++FaceIndex) {
+            for (int32 i = 0; i < 3; ++i) {
+                const auto VertexID = InstanceVertices[Triangles[FaceIndex * 3 + i]];
+                VertexFaces[FaceCursors[VertexID.GetValue()]++] = FaceIndex;
+            }
+        }
+
+        const auto CosCreaseAngle = FMath::Cos(FMath::DegreesToRadians(CreaseAngle));
+        for (int32 FaceIndex = 0; FaceIndex < NumFaces; ++FaceIndex) {
+            const auto CityObjectIndex = UVs.Get(Triangles[FaceIndex * 3], CityObjectIndexUVChannel);
+            for (int32 i = 0; i < 3; ++i) {
+                const auto VertexInstanceID = Triangles[FaceIndex * 3 + i];
+                const auto VertexID = InstanceVertices[VertexInstanceID].GetValue();
+
+                FVector3f Normal = FVector3f::ZeroVector;
+                for (int32 j = FaceOffsets[VertexID]; j < FaceOffsets[VertexID + 1]; ++j) {
+                    const auto AdjacentFace = VertexFaces[j];
+                    if (AdjacentFace != FaceIndex) {
+                        if (FVector3f::DotProduct(UnitFaceNormals[AdjacentFace], UnitFaceNormals[FaceIndex]) < CosCreaseAngle)
+                            continue;
+                        if (UVs.Get(Triangles[AdjacentFace * 3], CityObjectIndexUVChannel) != CityObjectIndex)
+                            continue;
+                    }
+                    Normal += FaceNormals[AdjacentFace];
+                }
+                Normals[VertexInstanceID] = Normal.GetSafeNormal(UE_SMALL_NUMBER, UnitFaceNormals[FaceIndex]);
+            }
+        }
+    }
+
+    /**
+     * @brief 頂点レイアウトにおいて都市オブジェクトインデックスを格納するUVチャンネルを取得します。
+     * インデックスは常に最後のUVチャンネルに格納されます。
+     */
+    int32 GetCityObjectIndexUVChannel(const EPLATEAUVertexFormat VertexFormat) {
+        return VertexFormat == EPLATEAUVertexFormat::Compact ? 1 : 3;
+    }
+
+    /**
+     * @brief 都市オブジェクトインデックスが16bit浮動小数点数で正確に表せない場合trueを返します。
+     */
+    bool RequiresFullPrecisionUVs(const plateau::polygonMesh::Mesh& InMesh) {
+        // 半精度浮動小数点数の仮数部は11bitのため、2048までの整数は正確に表せる
+        constexpr float MaxHalfPrecisionInteger = 2048.0f;
+        for (const auto& UV : InMesh.getUV4()) {
+            if (FMath::Abs(UV.x) > MaxHalfPrecisionInteger || FMath::Abs(UV.y) > MaxHalfPrecisionInteger)
+                return true;
+        }
+        return false;
+    }
+
     bool ConvertMesh(const plateau::polygonMesh::Mesh& InMesh, FMeshDescription& OutMeshDescription,
-        TArray<FSubMeshMaterialSet>& SubMeshMaterialSets, bool InvertNormal, bool MergeTriangles) {
+        TArray<FSubMeshMaterialSet>& SubMeshMaterialSets, bool InvertNormal, bool MergeTriangles, const EPLATEAUVertexFormat VertexFormat,
+        const TOptional<float>& WeldCreaseAngle) {
         FStaticMeshAttributes Attributes(OutMeshDescription);
 
-        // UVチャンネル数を3に設定
+        // UVチャンネル数を頂点レイアウトに合わせて設定
+        const auto CityObjectIndexUVChannel = GetCityObjectIndexUVChannel(VertexFormat);
         const auto VertexInstanceUVs = Attributes.GetVertexInstanceUVs();
-        if (VertexInstanceUVs.GetNumChannels() < 4) {
-            VertexInstanceUVs.SetNumChannels(4);
+        if (VertexInstanceUVs.GetNumChannels() != CityObjectIndexUVChannel + 1) {
+            VertexInstanceUVs.SetNumChannels(CityObjectIndexUVChannel + 1);
         }
 
         const auto& InVertices = InMesh.getVertices();
@@ -147,14 +246,31 @@ namespace {
         OutMeshDescription.ReserveNewVertexInstances(VertexCount);
         OutMeshDescription.ReserveNewEdges(VertexCount);
 
+        // 溶接する場合は同じ座標の頂点を1つにまとめる
+        const auto bWeldVertices = WeldCreaseAngle.IsSet();
         const auto VertexPositions = Attributes.GetVertexPositions();
+        TArray<FVertexID> InVertexIDs;
+        InVertexIDs.Reserve(InVertices.size());
+        TMap<FVector3f, FVertexID> PositionToVertexID;
         for (const auto& Vertex : InVertices) {
+            const FVector3f Position(Vertex.x, Vertex.y, Vertex.z);
+            if (bWeldVertices) {
+                if (const auto Found = PositionToVertexID.Find(Position)) {
+                    InVertexIDs.Add(*Found);
+                    continue;
+                }
+            }
             const auto VertexID = OutMeshDescription.CreateVertex();
-            VertexPositions[VertexID] = FVector3f(Vertex.x, Vertex.y, Vertex.z);
+            VertexPositions[VertexID] = Position;
+            InVertexIDs.Add(VertexID);
+            if (bWeldVertices)
+                PositionToVertexID.Add(Position, VertexID);
         }
 
         // 頂点の再利用を防ぐため使用済みの頂点を保持
-        TSet<unsigned> UsedVertexIDs;
+        TSet<FVertexID> UsedVertexIDs;
+        // 溶接する場合の法線計算用の三角形
+        TArray<FVertexInstanceID> WeldedTriangles;
 
         for (const auto& SubMesh : InMesh.getSubMeshes()) {
             const auto& TexturePath = SubMesh.getTexturePath();
@@ -199,10 +315,10 @@ namespace {
             const auto& EndIndex = SubMesh.getEndIndex();
             TArray<FVertexInstanceID> VertexInstanceIDs;
             for (int InIndexIndex = StartIndex; InIndexIndex <= EndIndex; ++InIndexIndex) {
-                auto VertexID = InIndices[InIndexIndex];
+                auto VertexID = InVertexIDs[InIndices[InIndexIndex]];
 
                 // 頂点が使用済みの場合は複製
-                if (UsedVertexIDs.Contains(VertexID) && !MergeTriangles) {
+                if (UsedVertexIDs.Contains(VertexID) && !MergeTriangles && !bWeldVertices) {
                     const auto NewVertexID = OutMeshDescription.CreateVertex();
                     VertexPositions[NewVertexID] = VertexPositions[VertexID];
                     VertexID = NewVertexID;
@@ -217,7 +333,7 @@ namespace {
                 
                 const auto InUV4 = InMesh.getUV4()[InIndices[InIndexIndex]];
                 const auto UV4 = FVector2f(InUV4.x, InUV4.y);
-                VertexInstanceUVs.Set(NewVertexInstanceID, 3, UV4);
+                VertexInstanceUVs.Set(NewVertexInstanceID, CityObjectIndexUVChannel, UV4);
 
                 UsedVertexIDs.Add(VertexID);
             }
@@ -231,6 +347,16 @@ namespace {
                 FMemory::Memcpy(VertexInstanceIDsCache.GetData(), VertexInstanceIDs.GetData() + TriangleIndex * 3,
                     sizeof(FVertexInstanceID) * 3);
 
+                if (bWeldVertices) {
+                    // 溶接により縮退した三角形は生成しない
+                    const auto V0 = OutMeshDescription.GetVertexInstanceVertex(VertexInstanceIDsCache[0]);
+                    const auto V1 = OutMeshDescription.GetVertexInstanceVertex(VertexInstanceIDsCache[1]);
+                    const auto V2 = OutMeshDescription.GetVertexInstanceVertex(VertexInstanceIDsCache[2]);
+                    if (V0 == V1 || V1 == V2 || V2 == V0)
+                        continue;
+                    WeldedTriangles.Append(VertexInstanceIDsCache);
+                }
+
                 if (InvertNormal) {
                     // Invert winding order for triangles
                     VertexInstanceIDsCache.Swap(0, 2);
@@ -245,7 +371,10 @@ namespace {
             }
         }
 
-        ComputeNormals(Attributes, InvertNormal);
+        if (bWeldVertices)
+            ComputeWeldedNormals(Attributes, WeldedTriangles, InvertNormal, WeldCreaseAngle.GetValue(), CityObjectIndexUVChannel);
+        else
+            ComputeNormals(Attributes, InvertNormal);
 
         //Compact the MeshDescription, if there was visibility mask or some bounding box clip, it need to be compacted so the sparse array are from 0 to n with no invalid data in between. 
         FElementIDRemappings ElementIDRemappings;
@@ -254,7 +383,32 @@ namespace {
         return OutMeshDescription.Polygons().Num() > 0;
     }
 
-    UStaticMesh* CreateStaticMesh(const plateau::polygonMesh::Mesh& InMesh, UObject* InOuter, FName Name) {
+    /**
+     * @brief コリジョンの種類に応じてStaticMeshのBodySetupを設定します。
+     */
+    void SetupCollision(UStaticMesh& Mesh, const EPLATEAUCollisionComplexity CollisionComplexity) {
+        if (CollisionComplexity == EPLATEAUCollisionComplexity::None)
+            return;
+
+        Mesh.CreateBodySetup();
+        const auto BodySetup = Mesh.GetBodySetup();
+        if (CollisionComplexity == EPLATEAUCollisionComplexity::Complex) {
+            BodySetup->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
+            return;
+        }
+
+        // バウンディングボックスを単純コリジョンとして使用し、三角形単位のクッキングを行わない
+        const auto Bounds = Mesh.GetBoundingBox();
+        FKBoxElem BoxElem(Bounds.GetSize().X, Bounds.GetSize().Y, Bounds.GetSize().Z);
+        BoxElem.Center = Bounds.GetCenter();
+        BodySetup->RemoveSimpleCollision();
+        BodySetup->AggGeom.BoxElems.Add(BoxElem);
+        BodySetup->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseSimpleAsComplex;
+        BodySetup->bNeverNeedsCookedCollisionData = true;
+        BodySetup->InvalidatePhysicsData();
+    }
+
+    UStaticMesh* CreateStaticMesh(const plateau::polygonMesh::Mesh& InMesh, UObject* InOuter, FName Name, const EPLATEAUVertexFormat VertexFormat) {
         const auto StaticMesh = NewObject<UStaticMesh>(InOuter, Name);
 
         StaticMesh->InitResources();
@@ -263,7 +417,8 @@ namespace {
 
         // Set it to use textured lightmaps. Note that Build Lighting will do the error-checking (texcoordindex exists for all LODs, etc).
         StaticMesh->SetLightMapResolution(64);
-        StaticMesh->SetLightMapCoordinateIndex(1);
+        // コンパクトな頂点レイアウトはライトマップ用のUVチャンネルを持たないため、テクスチャ座標を使用
+        StaticMesh->SetLightMapCoordinateIndex(VertexFormat == EPLATEAUVertexFormat::Compact ? 0 : 1);
 #if WITH_EDITOR
         FStaticMeshSourceModel& SrcModel = StaticMesh->AddSourceModel();
         /*Don't allow the engine to recalculate normals*/
@@ -271,13 +426,39 @@ namespace {
         SrcModel.BuildSettings.bRecomputeTangents = false;
         SrcModel.BuildSettings.bRemoveDegenerates = false;
         SrcModel.BuildSettings.bUseHighPrecisionTangentBasis = false;
-        SrcModel.BuildSettings.bUseFullPrecisionUVs = false;
+        SrcModel.BuildSettings.bUseFullPrecisionUVs = RequiresFullPrecisionUVs(InMesh);
         SrcModel.BuildSettings.bBuildReversedIndexBuffer = false;
 #endif
         return StaticMesh;
     }
 }
 
+UMaterialInstanceDynamic* FPLATEAUMaterialCache::FindMaterial(const FSubMeshMaterialSet& Key) const {
+    const auto Material = Materials.Find(Key);
+    return Material != nullptr ? Material->Get() : nullptr;
+}
+
+void FPLATEAUMaterialCache::AddMaterial(const FSubMeshMaterialSet& Key, UMaterialInstanceDynamic* Material) {
+    Materials.Add(Key, Material);
+}
+
+bool FPLATEAUMaterialCache::TryGetTexture(const FString& TexturePath, UTexture2D*& OutTexture) const {
+    const auto Texture = Textures.Find(TexturePath);
+    if (Texture == nullptr)
+        return false;
+
+    // 破棄されたテクスチャは未読み込みとして扱う
+    if (!Texture->IsExplicitlyNull() && !Texture->IsValid())
+        return false;
+
+    OutTexture = Texture->Get();
+    return true;
+}
+
+void FPLATEAUMaterialCache::AddTexture(const FString& TexturePath, UTexture2D* Texture) {
+    Textures.Add(TexturePath, Texture);
+}
+
 USceneComponent* FPLATEAUMeshLoader::FindChildComponentWithOriginalName(USceneComponent* ParentComponent, const FString& OriginalName) {
     for (const auto& Component : ParentComponent->GetAttachChildren()) {
         const auto TargetName = APLATEAUInstancedCityModel::GetOriginalComponentName(Component);
@@ -298,14 +479,32 @@ FString FPLATEAUMeshLoader::MakeUniqueGmlObjectName(AActor* Actor, UClass* Class
 void FPLATEAUMeshLoader::LoadModel(AActor* ModelActor, USceneComponent* ParentComponent,
     const std::shared_ptr<plateau::polygonMesh::Model> Model,
     const FLoadInputData& LoadInputData,
-    const std::shared_ptr<const citygml::CityModel> CityModel, TAtomic<bool>* bCanceled) {
+    const std::shared_ptr<const citygml::CityModel> CityModel, TAtomic<bool>* bCanceled,
+    TFunction<void(int32, int32)> OnNodeLoaded) {
     UE_LOG(LogTemp, Log, TEXT("LoadModel: %s %d"), *FString(Model->debugString().c_str()), Model->getAllMeshes().size());
 
     UE_LOG(LogTemp, Log, TEXT("Model->getRootNodeCount(): %d"), Model->getRootNodeCount());
     LastCreatedComponents.Empty();
     this->PathToTexture = FPathToTexture();
+
+    // 進捗通知用に全ノード数を数える
+    bCanceledRef = bCanceled;
+    OnNodeLoadedCallback = MoveTemp(OnNodeLoaded);
+    LoadedNodeCount = 0;
+    TotalNodeCount = 0;
+    TFunction<void(const plateau::polygonMesh::Node&)> CountNodes = [this, &CountNodes](const plateau::polygonMesh::Node& Node) {
+        ++TotalNodeCount;
+        for (int i = 0; i < Node.getChildCount(); ++i)
+            CountNodes(Node.getChildAt(i));
+    };
+    for (int i = 0; i < Model->getRootNodeCount(); i++)
+        CountNodes(Model->getRootNodeAt(i));
+
+    // 属性情報のシリアライズはゲームスレッドでのコンポーネント生成前に済ませておく
+    PrepareSerializedCityObjects(*Model, LoadInputData, CityModel);
+
     for (int i = 0; i < Model->getRootNodeCount(); i++) {
-        if (bCanceled->Load(EMemoryOrder::Relaxed))
+        if (IsCanceled())
             break;
 
         LoadNodeRecursive(ParentComponent, Model->getRootNodeAt(i), LoadInputData, CityModel, *ModelActor);
@@ -313,13 +512,18 @@ void FPLATEAUMeshLoader::LoadModel(AActor* ModelActor, USceneComponent* ParentCo
         // メッシュをワールド内にビルド
         const auto CopiedStaticMeshes = StaticMeshes;
         FFunctionGraphTask::CreateAndDispatchWhenReady(
-            [CopiedStaticMeshes, &bCanceled]() {
+            [CopiedStaticMeshes, &bCanceled, LoadStats = LoadInputData.LoadStats.Get()]() {
+                PLATEAU_IMPORT_STAGE_SCOPE(LoadStats, BatchBuild);
                 UStaticMesh::BatchBuild(CopiedStaticMeshes, true, [&bCanceled](UStaticMesh* mesh) {
                     return bCanceled->Load(EMemoryOrder::Relaxed);
                     });
             }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
         StaticMeshes.Reset();
     }
+    bCanceledRef = nullptr;
+    OnNodeLoadedCallback = nullptr;
+    PreparedNodeCityObjects.Reset();
+    PreparedMeshCityObjects.Reset();
 
     // 最大LOD以外の形状を非表示化
     FFunctionGraphTask::CreateAndDispatchWhenReady(
@@ -328,13 +532,65 @@ void FPLATEAUMeshLoader::LoadModel(AActor* ModelActor, USceneComponent* ParentCo
         }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
 }
 
+void FPLATEAUMeshLoader::PrepareSerializedCityObjects(const plateau::polygonMesh::Model& Model, const FLoadInputData& LoadInputData,
+                                                      const std::shared_ptr<const citygml::CityModel> CityModel) {
+    PreparedNodeCityObjects.Reset();
+    PreparedMeshCityObjects.Reset();
+    if (!LoadInputData.bIncludeAttrInfo || CityModel == nullptr)
+        return;
+
+    PLATEAU_IMPORT_STAGE_SCOPE(LoadInputData.LoadStats.Get(), SerializeAttributes);
+
+    TArray<const plateau::polygonMesh::Node*> Nodes;
+    TArray<const plateau::polygonMesh::Node*> Stack;
+    for (int i = 0; i < Model.getRootNodeCount(); i++)
+        Stack.Add(&Model.getRootNodeAt(i));
+    while (Stack.Num() > 0) {
+        const auto Node = Stack.Pop(false);
+        Nodes.Add(Node);
+        for (int i = 0; i < Node->getChildCount(); i++)
+            Stack.Add(&Node->getChildAt(i));
+    }
+
+    // LoadNode, GetStaticMeshComponentForConditionでUPLATEAUCityObjectGroupが作成されるノードのみが対象
+    const auto Granularity = LoadInputData.ExtractOptions.mesh_granularity;
+    TArray<FString> SerializedCityObjects;
+    SerializedCityObjects.SetNum(Nodes.Num());
+    ParallelFor(Nodes.Num(), [&Nodes, &SerializedCityObjects, &CityModel, Granularity](const int32 Index) {
+        const auto& Node = *Nodes[Index];
+        if (const auto Mesh = Node.getMesh()) {
+            if (Mesh->getVertices().size() > 0)
+                SerializedCityObjects[Index] = UPLATEAUCityObjectGroup::CreateSerializedCityObjects(Node.getName(), *Mesh, Granularity, CityModel);
+        } else if (const auto CityObject = CityModel->getCityObjectById(Node.getName())) {
+            SerializedCityObjects[Index] = UPLATEAUCityObjectGroup::CreateSerializedCityObjects(Node, CityObject);
+        }
+    });
+
+    for (int32 i = 0; i < Nodes.Num(); ++i) {
+        if (SerializedCityObjects[i].IsEmpty())
+            continue;
+
+        if (const auto Mesh = Nodes[i]->getMesh())
+            PreparedMeshCityObjects.Add(Mesh, MoveTemp(SerializedCityObjects[i]));
+        else
+            PreparedNodeCityObjects.Add(Nodes[i], MoveTemp(SerializedCityObjects[i]));
+    }
+}
+
 void FPLATEAUMeshLoader::LoadNodeRecursive(
     USceneComponent* InParentComponent,
     const plateau::polygonMesh::Node& InNode,
     const FLoadInputData& InLoadInputData,
     const std::shared_ptr<const citygml::CityModel> InCityModel,
     AActor& InActor) {
+    if (IsCanceled())
+        return;
+
     const auto Component = LoadNode(InParentComponent, InNode, InLoadInputData, InCityModel, InActor);
+    ++LoadedNodeCount;
+    if (OnNodeLoadedCallback)
+        OnNodeLoadedCallback(LoadedNodeCount, TotalNodeCount);
+
     const size_t ChildNodeCount = InNode.getChildCount();
     for (int i = 0; i < ChildNodeCount; i++) {
         const auto& TargetNode = InNode.getChildAt(i);
@@ -359,8 +615,11 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
         FFunctionGraphTask::CreateAndDispatchWhenReady(
             [this, &LoadInputData, &InNodeName, &InMesh, &CityModel, &Component, &Actor, &StaticMesh, &MeshDescription,
             &NodeName]() {
+                PLATEAU_IMPORT_STAGE_SCOPE(LoadInputData.LoadStats.Get(), ComponentSetup);
 
                 Component = GetStaticMeshComponentForCondition(Actor, NAME_None, InNodeName, InMesh, LoadInputData, CityModel);
+                if (const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Component))
+                    CityObjectGroup->CollisionComplexity = LoadInputData.CollisionComplexity;
                 if (bAutomationTest) {
                     Component->Mobility = EComponentMobility::Movable;
                 }
@@ -368,7 +627,7 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
                     Component->Mobility = EComponentMobility::Static;
                 }
                 // StaticMesh作成
-                StaticMesh = CreateStaticMesh(InMesh, Component, FName(NodeName));
+                StaticMesh = CreateStaticMesh(InMesh, Component, FName(NodeName), LoadInputData.VertexFormat);
 #if WITH_EDITOR
                 Component->bVisualizeComponent = true;
                 MeshDescription = StaticMesh->CreateMeshDescription(0);
@@ -376,8 +635,14 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
             }, TStatId(), nullptr, ENamedThreads::GameThread)->Wait();
     }
 
-    ConvertMesh(InMesh, *MeshDescription, SubMeshMaterialSets, InvertMeshNormal(), MergeTriangles());
-    ModifyMeshDescription(*MeshDescription);
+    {
+        PLATEAU_IMPORT_STAGE_SCOPE(LoadInputData.LoadStats.Get(), ConvertMesh);
+        ConvertMesh(InMesh, *MeshDescription, SubMeshMaterialSets, InvertMeshNormal(), MergeTriangles(), LoadInputData.VertexFormat,
+            LoadInputData.WeldCreaseAngle);
+        ModifyMeshDescription(*MeshDescription);
+    }
+    if (LoadInputData.LoadStats.IsValid())
+        LoadInputData.LoadStats->AddTriangleCount(InMesh.getIndices().size() / 3);
 
 #if WITH_EDITOR
     FFunctionGraphTask::CreateAndDispatchWhenReady(
@@ -388,17 +653,46 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
         StaticMeshes.Add(StaticMesh);
 #if WITH_EDITOR
         StaticMesh->OnPostMeshBuild().AddLambda(
-            [Component](UStaticMesh* Mesh) {
+            [Component, CollisionComplexity = LoadInputData.CollisionComplexity, bDeferCollisionCooking = LoadInputData.bDeferCollisionCooking,
+                LoadStats = LoadInputData.LoadStats](UStaticMesh* Mesh) {
                 if (Component == nullptr)
                     return;
+
+                PLATEAU_IMPORT_STAGE_SCOPE(LoadStats.Get(), Collision);
+
+                // クッキング完了までコリジョンを無効化し、物理状態の生成(同期クッキング)を避ける
+                const auto bDeferCooking = bDeferCollisionCooking && CollisionComplexity == EPLATEAUCollisionComplexity::Complex;
+                const auto CollisionEnabled = Component->GetCollisionEnabled();
+                if (bDeferCooking || CollisionComplexity == EPLATEAUCollisionComplexity::None)
+                    Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
                 // Runtime用にSetStaticMeshを行う際にMobilityを適切な値に変更
                 Component->SetMobility(EComponentMobility::Type::Stationary);
                 Component->SetStaticMesh(Mesh);
                 Component->SetMobility(EComponentMobility::Type::Static);
 
                 // Collision情報設定
-                Mesh->CreateBodySetup();
-                Mesh->GetBodySetup()->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
+                SetupCollision(*Mesh, CollisionComplexity);
+
+                // レイキャストで都市オブジェクトを特定するための三角形ごとのインデックス表
+                if (const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Component); CityObjectGroup != nullptr && CollisionComplexity == EPLATEAUCollisionComplexity::Complex)
+                    CityObjectGroup->UpdateTriangleCityObjectIndices();
+
+                if (bDeferCooking) {
+                    // 非同期クッキングの完了までをコリジョン設定の段階として計測する
+                    if (LoadStats.IsValid())
+                        LoadStats->BeginStage(EPLATEAUImportStage::Collision);
+                    Mesh->GetBodySetup()->CreatePhysicsMeshesAsync(FOnAsyncPhysicsCookFinished::CreateLambda(
+                        [WeakComponent = TWeakObjectPtr<UStaticMeshComponent>(Component), CollisionEnabled, LoadStats, CookStartSeconds = FPlatformTime::Seconds()](bool bSuccess) {
+                            if (LoadStats.IsValid())
+                                LoadStats->EndStage(EPLATEAUImportStage::Collision, FPlatformTime::Seconds() - CookStartSeconds);
+                            if (!WeakComponent.IsValid())
+                                return;
+                            if (!bSuccess)
+                                UE_LOG(LogTemp, Warning, TEXT("Failed to cook collision: %s"), *WeakComponent->GetName());
+                            WeakComponent->SetCollisionEnabled(CollisionEnabled);
+                        }));
+                }
             });
 
         const FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([&StaticMesh] {
@@ -419,6 +713,11 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
             [&SubMeshMaterialSets, this, &Component, &StaticMesh, &MeshDescription, &Actor, &ParentComponent, &ComponentRef, &LoadInputData, NodeName] {
                 for (const auto& SubMeshValue : SubMeshMaterialSets) {
                     UMaterialInstanceDynamic** SharedMatPtr = CachedMaterials.Find(SubMeshValue);
+                    if (SharedMatPtr == nullptr && UseCachedMaterial() && LoadInputData.MaterialCache.IsValid()) {
+                        // 同じ3D都市モデル内の他のGMLで作成済みのマテリアルを使い回す
+                        if (const auto CachedMaterial = LoadInputData.MaterialCache->FindMaterial(SubMeshValue))
+                            SharedMatPtr = &CachedMaterials.Add(SubMeshValue, CachedMaterial);
+                    }
                     if (SharedMatPtr == nullptr) {
                         // マテリアル作成
                         UMaterialInstanceDynamic* DynMaterial;
@@ -433,19 +732,32 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
                             {
                                 Texture = PathToTexture[TexturePath]; // nullptrの場合もあります。
                             }
+                            else if (LoadInputData.MaterialCache.IsValid() && LoadInputData.MaterialCache->TryGetTexture(TexturePath, Texture))
+                            {
+                                PathToTexture.Add(TexturePath, Texture);
+                            }
                             else // テクスチャ未ロードの場合、ロードします。
                             {
-                                Texture = FPLATEAUTextureLoader::Load(TexturePath, OverwriteTexture());
+                                PLATEAU_IMPORT_STAGE_SCOPE(LoadInputData.LoadStats.Get(), TextureLoad);
+                                // 追加インポート時は既存のテクスチャアセットを上書きせずに使い回します。
+                                Texture = FPLATEAUTextureLoader::Load(TexturePath, OverwriteTexture() && !LoadInputData.bReuseExistingTextures);
                                 // なければnullptrを返します。
                                 PathToTexture.Add(TexturePath, Texture);
+                                if (LoadInputData.MaterialCache.IsValid())
+                                    LoadInputData.MaterialCache->AddTexture(TexturePath, Texture);
+                                if (Texture != nullptr && LoadInputData.LoadStats.IsValid())
+                                    LoadInputData.LoadStats->AddTextureBytes(Texture->CalcTextureMemorySizeEnum(TMC_AllMips));
                             }
                         }
 
-                        DynMaterial = GetMaterialForSubMesh(SubMeshValue, Component, LoadInputData, Texture, NodeName);
+                        {
+                            PLATEAU_IMPORT_STAGE_SCOPE(LoadInputData.LoadStats.Get(), MaterialCreation);
+                            DynMaterial = GetMaterialForSubMesh(SubMeshValue, Component, LoadInputData, Texture, NodeName);
 
-                        //Textureが存在する場合
-                        if (Texture != nullptr)
-                            DynMaterial->SetTextureParameterValue("Texture", Cast<UTexture>(Texture));
+                            //Textureが存在する場合
+                            if (Texture != nullptr)
+                                DynMaterial->SetTextureParameterValue("Texture", Cast<UTexture>(Texture));
+                        }
 
                         DynMaterial->TwoSided = false;
                         StaticMesh->AddMaterial(DynMaterial);
@@ -453,6 +765,8 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
                         if (UseCachedMaterial()) {
                             //Materialをキャッシュに保存
                             CachedMaterials.Add(SubMeshValue, DynMaterial);
+                            if (LoadInputData.MaterialCache.IsValid())
+                                LoadInputData.MaterialCache->AddMaterial(SubMeshValue, DynMaterial);
                         }
 
                         //SubMeshのPolygonGroupIDとMeshDescriptionのPolygonGroupIDの整合性チェック
@@ -470,6 +784,7 @@ UStaticMeshComponent* FPLATEAUMeshLoader::CreateStaticMeshComponent(AActor& Acto
                 }
 
                 // 名前設定、ヒエラルキー設定など
+                PLATEAU_IMPORT_STAGE_SCOPE(LoadInputData.LoadStats.Get(), ComponentSetup);
                 Component->DepthPriorityGroup = SDPG_World;
                 const FString NewUniqueName = 
                     MakeUniqueGmlObjectName(&Actor, UPLATEAUCityObjectGroup::StaticClass(),
@@ -495,7 +810,10 @@ UStaticMeshComponent* FPLATEAUMeshLoader::GetStaticMeshComponentForCondition(AAc
     const FLoadInputData& LoadInputData, const std::shared_ptr <const citygml::CityModel> CityModel) {
     if (LoadInputData.bIncludeAttrInfo) {
         const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
-        PLATEAUCityObjectGroup->SerializeCityObject(InNodeName, InMesh, LoadInputData, CityModel);
+        if (const auto SerializedCityObjects = PreparedMeshCityObjects.Find(&InMesh))
+            PLATEAUCityObjectGroup->SetSerializedCityObjects(MoveTemp(*SerializedCityObjects), LoadInputData.ExtractOptions.mesh_granularity);
+        else
+            PLATEAUCityObjectGroup->SerializeCityObject(InNodeName, InMesh, LoadInputData, CityModel);
         return PLATEAUCityObjectGroup;
     }
     //return NewObject<UStaticMeshComponent>(&Actor, NAME_None);
@@ -586,7 +904,10 @@ USceneComponent* FPLATEAUMeshLoader::LoadNode(USceneComponent* ParentComponent,
             if (CityObject != nullptr && LoadInputData.bIncludeAttrInfo) {
                 StaticClass = UPLATEAUCityObjectGroup::StaticClass();
                 const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
-                PLATEAUCityObjectGroup->SerializeCityObject(Node, CityObject, LoadInputData.ExtractOptions.mesh_granularity);
+                if (const auto SerializedCityObjects = PreparedNodeCityObjects.Find(&Node))
+                    PLATEAUCityObjectGroup->SetSerializedCityObjects(MoveTemp(*SerializedCityObjects), LoadInputData.ExtractOptions.mesh_granularity);
+                else
+                    PLATEAUCityObjectGroup->SerializeCityObject(Node, CityObject, LoadInputData.ExtractOptions.mesh_granularity);
                 Comp = PLATEAUCityObjectGroup;
             }
             else {
@@ -0,0 +1,439 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUTextureAtlas.h"
+
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "PLATEAUImportSettings.h"
+#include "PLATEAUTextureLoader.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Tasks/Task.h"
+
+#include <plateau/polygon_mesh/model.h>
+
+namespace {
+    //! 0～1の範囲外とみなさないUVの誤差
+    constexpr float UVTolerance = 0.001f;
+
+    struct FSourceTexture {
+        FString Path;
+        bool bPackable = true;
+        //! アトラス上の幅・高さ(ページに収まるよう縮小した後の大きさ)
+        int32 Width = 0;
+        int32 Height = 0;
+        int32 Page = INDEX_NONE;
+        //! 余白を含む矩形の左上の位置
+        FIntPoint Position = FIntPoint::ZeroValue;
+        //! 圧縮されたままの画像ファイルの内容(ファイルの読み込みを1度にするため転写まで保持)
+        TArray64<uint8> Compressed;
+        //! 画像ファイルの内容のCRC。アトラス画像の名前に使用します。
+        uint32 Crc = 0;
+    };
+
+    bool IsContainedIn(const FIntRect& Inner, const FIntRect& Outer) {
+        return Inner.Min.X >= Outer.Min.X && Inner.Min.Y >= Outer.Min.Y
+            && Inner.Max.X <= Outer.Max.X && Inner.Max.Y <= Outer.Max.Y;
+    }
+
+    bool Overlaps(const FIntRect& A, const FIntRect& B) {
+        return A.Min.X < B.Max.X && A.Max.X > B.Min.X
+            && A.Min.Y < B.Max.Y && A.Max.Y > B.Min.Y;
+    }
+
+    /**
+     * @brief 画像を縦横半分に縮小します(2x2画素の平均)
+     */
+    void Downsample(TArray64<uint8>& Pixels, int32& Width, int32& Height) {
+        const int32 NewWidth = FMath::Max(Width / 2, 1);
+        const int32 NewHeight = FMath::Max(Height / 2, 1);
+        TArray64<uint8> Result;
+        Result.SetNumUninitialized(static_cast<int64>(NewWidth) * NewHeight * 4);
+        for (int32 y = 0; y < NewHeight; ++y) {
+            const auto Row0 = Pixels.GetData() + static_cast<int64>(FMath::Min(y * 2, Height - 1)) * Width * 4;
+            const auto Row1 = Pixels.GetData() + static_cast<int64>(FMath::Min(y * 2 + 1, Height - 1)) * Width * 4;
+            auto Dst = Result.GetData() + static_cast<int64>(y) * NewWidth * 4;
+            for (int32 x = 0; x < NewWidth; ++x) {
+                const int32 X0 = FMath::Min(x * 2, Width - 1) * 4;
+                const int32 X1 = FMath::Min(x * 2 + 1, Width - 1) * 4;
+                for (int32 c = 0; c < 4; ++c) {
+                    Dst[x * 4 + c] = static_cast<uint8>((Row0[X0 + c] + Row0[X1 + c] + Row1[X0 + c] + Row1[X1 + c] + 2) / 4);
+                }
+            }
+        }
+        Pixels = MoveTemp(Result);
+        Width = NewWidth;
+        Height = NewHeight;
+    }
+
+    /**
+     * @brief 画像をページに転写し、周囲の余白を端の画素の複製で埋めます。
+     */
+    void Blit(const TArray64<uint8>& Pixels, const FSourceTexture& Source, TArray64<uint8>& PagePixels, const int32 PageWidth, const int32 Padding) {
+        const int64 RowBytes = static_cast<int64>(Source.Width) * 4;
+        for (int32 y = -Padding; y < Source.Height + Padding; ++y) {
+            const auto SrcRow = Pixels.GetData() + FMath::Clamp(y, 0, Source.Height - 1) * RowBytes;
+            const auto DstRow = PagePixels.GetData()
+                + (static_cast<int64>(Source.Position.Y + Padding + y) * PageWidth + Source.Position.X + Padding) * 4;
+            FMemory::Memcpy(DstRow, SrcRow, RowBytes);
+            for (int32 x = 1; x <= Padding; ++x) {
+                FMemory::Memcpy(DstRow - x * 4, SrcRow, 4);
+                FMemory::Memcpy(DstRow + RowBytes + (x - 1) * 4, SrcRow + RowBytes - 4, 4);
+            }
+        }
+    }
+}
+
+FPLATEAURectPacker::FPLATEAURectPacker(const int32 InPageWidth, const int32 InPageHeight)
+    : PageWidth(InPageWidth)
+    , PageHeight(InPageHeight) {
+}
+
+bool FPLATEAURectPacker::Insert(const int32 Width, const int32 Height, int32& OutPage, FIntPoint& OutPosition) {
+    if (Width <= 0 || Height <= 0 || Width > PageWidth || Height > PageHeight)
+        return false;
+
+    // 全ページの空き領域のうち、短辺方向の余りが最も小さい位置に配置
+    int32 BestShortSide = MAX_int32;
+    int32 BestLongSide = MAX_int32;
+    OutPage = INDEX_NONE;
+    for (int32 i = 0; i < Pages.Num(); ++i) {
+        FIntPoint Position;
+        int32 ShortSide, LongSide;
+        if (!FindPosition(Pages[i], Width, Height, Position, ShortSide, LongSide))
+            continue;
+        if (ShortSide < BestShortSide || (ShortSide == BestShortSide && LongSide < BestLongSide)) {
+            BestShortSide = ShortSide;
+            BestLongSide = LongSide;
+            OutPage = i;
+            OutPosition = Position;
+        }
+    }
+
+    if (OutPage == INDEX_NONE) {
+        OutPage = Pages.AddDefaulted();
+        Pages[OutPage].FreeRects.Add(FIntRect(0, 0, PageWidth, PageHeight));
+        OutPosition = FIntPoint::ZeroValue;
+    }
+
+    PlaceRect(Pages[OutPage], FIntRect(OutPosition, OutPosition + FIntPoint(Width, Height)));
+    return true;
+}
+
+double FPLATEAURectPacker::GetOccupancy() const {
+    if (Pages.Num() == 0)
+        return 0.0;
+
+    int64 UsedArea = 0;
+    for (const auto& Page : Pages) {
+        UsedArea += Page.UsedArea;
+    }
+    return static_cast<double>(UsedArea) / (static_cast<double>(PageWidth) * PageHeight * Pages.Num());
+}
+
+bool FPLATEAURectPacker::FindPosition(const FPage& Page, const int32 Width, const int32 Height, FIntPoint& OutPosition, int32& OutShortSide, int32& OutLongSide) const {
+    bool bFound = false;
+    OutShortSide = MAX_int32;
+    OutLongSide = MAX_int32;
+    for (const auto& FreeRect : Page.FreeRects) {
+        const int32 LeftoverX = FreeRect.Width() - Width;
+        const int32 LeftoverY = FreeRect.Height() - Height;
+        if (LeftoverX < 0 || LeftoverY < 0)
+            continue;
+
+        const int32 ShortSide = FMath::Min(LeftoverX, LeftoverY);
+        const int32 LongSide = FMath::Max(LeftoverX, LeftoverY);
+        if (ShortSide < OutShortSide || (ShortSide == OutShortSide && LongSide < OutLongSide)) {
+            OutShortSide = ShortSide;
+            OutLongSide = LongSide;
+            OutPosition = FreeRect.Min;
+            bFound = true;
+        }
+    }
+    return bFound;
+}
+
+void FPLATEAURectPacker::PlaceRect(FPage& Page, const FIntRect& Rect) {
+    // 配置した矩形と重なる空き領域を、重ならない最大4つの矩形に分割
+    TArray<FIntRect> SplitRects;
+    for (int32 i = Page.FreeRects.Num() - 1; i >= 0; --i) {
+        const FIntRect FreeRect = Page.FreeRects[i];
+        if (!Overlaps(FreeRect, Rect))
+            continue;
+
+        Page.FreeRects.RemoveAtSwap(i, 1, false);
+        if (Rect.Min.X > FreeRect.Min.X)
+            SplitRects.Add(FIntRect(FreeRect.Min.X, FreeRect.Min.Y, Rect.Min.X, FreeRect.Max.Y));
+        if (Rect.Max.X < FreeRect.Max.X)
+            SplitRects.Add(FIntRect(Rect.Max.X, FreeRect.Min.Y, FreeRect.Max.X, FreeRect.Max.Y));
+        if (Rect.Min.Y > FreeRect.Min.Y)
+            SplitRects.Add(FIntRect(FreeRect.Min.X, FreeRect.Min.Y, FreeRect.Max.X, Rect.Min.Y));
+        if (Rect.Max.Y < FreeRect.Max.Y)
+            SplitRects.Add(FIntRect(FreeRect.Min.X, Rect.Max.Y, FreeRect.Max.X, FreeRect.Max.Y));
+    }
+
+    // 他の空き領域に含まれる矩形は不要なため除外
+    for (int32 i = SplitRects.Num() - 1; i >= 0; --i) {
+        bool bContained = false;
+        for (int32 j = 0; j < SplitRects.Num() && !bContained; ++j) {
+            bContained = i != j && IsContainedIn(SplitRects[i], SplitRects[j]) && (SplitRects[i] != SplitRects[j] || i > j);
+        }
+        for (int32 j = 0; j < Page.FreeRects.Num() && !bContained; ++j) {
+            bContained = IsContainedIn(SplitRects[i], Page.FreeRects[j]);
+        }
+        if (bContained)
+            SplitRects.RemoveAt(i, 1, false);
+    }
+    Page.FreeRects.RemoveAllSwap([&SplitRects](const FIntRect& FreeRect) {
+        return SplitRects.ContainsByPredicate([&FreeRect](const FIntRect& SplitRect) {
+            return IsContainedIn(FreeRect, SplitRect);
+        });
+    });
+    Page.FreeRects.Append(SplitRects);
+
+    Page.UsedArea += Rect.Area();
+    Page.UsedExtent = Page.UsedExtent.ComponentMax(Rect.Max);
+}
+
+FPLATEAUTextureAtlasResult FPLATEAUTextureAtlas::Pack(plateau::polygonMesh::Model& Model, const FPLATEAUTextureAtlasOptions& Options) {
+    FPLATEAUTextureAtlasResult Result;
+    const auto Meshes = Model.getAllMeshes();
+
+    // テクスチャの種類を集め、UVが0～1の範囲外となるテクスチャは繰り返しを含むため対象外とする
+    TArray<FSourceTexture> Sources;
+    TMap<FString, int32> SourceIds;
+    for (const auto Mesh : Meshes) {
+        const auto& Indices = Mesh->getIndices();
+        const auto& UV1 = Mesh->getUV1();
+        for (const auto& SubMesh : Mesh->getSubMeshes()) {
+            if (SubMesh.getTexturePath().empty())
+                continue;
+
+            const FString TexturePath = UTF8_TO_TCHAR(SubMesh.getTexturePath().c_str());
+            auto SourceId = SourceIds.FindRef(TexturePath, INDEX_NONE);
+            if (SourceId == INDEX_NONE) {
+                SourceId = Sources.AddDefaulted();
+                Sources[SourceId].Path = TexturePath;
+                // フォールバックマテリアルが割り当てられるテクスチャは対象外
+                Sources[SourceId].bPackable = UPLATEAUImportSettings::GetFallbackMaterialNameFromDiffuseTextureName(FPaths::GetCleanFilename(TexturePath)).IsEmpty();
+                SourceIds.Add(TexturePath, SourceId);
+            }
+
+            auto& Source = Sources[SourceId];
+            for (auto i = SubMesh.getStartIndex(); i <= SubMesh.getEndIndex() && Source.bPackable; ++i) {
+                if (Indices[i] >= UV1.size()) {
+                    Source.bPackable = false;
+                    break;
+                }
+                const auto& UV = UV1[Indices[i]];
+                Source.bPackable = UV.x >= -UVTolerance && UV.x <= 1.0f + UVTolerance
+                    && UV.y >= -UVTolerance && UV.y <= 1.0f + UVTolerance;
+            }
+        }
+    }
+    Result.NumSourceTextures = Sources.Num();
+
+    // 画像ファイルを読み込んでヘッダから大きさを取得し、ページに収まらないものは縮小後の大きさとする
+    const int32 Padding = FMath::Max(Options.Padding, 0);
+    const int32 MaxTextureSize = Options.PageSize - Padding * 2;
+    ParallelFor(Sources.Num(), [&Sources, MaxTextureSize](const int32 Index) {
+        auto& Source = Sources[Index];
+        if (!Source.bPackable)
+            return;
+
+        if (MaxTextureSize <= 0 || !FPLATEAUTextureLoader::LoadCompressedImage(Source.Path, Source.Compressed, Source.Width, Source.Height)) {
+            Source.bPackable = false;
+            Source.Compressed.Empty();
+            return;
+        }
+        Source.Crc = FCrc::MemCrc32(Source.Compressed.GetData(), static_cast<int32>(Source.Compressed.Num()));
+        while (Source.Width > MaxTextureSize || Source.Height > MaxTextureSize) {
+            Source.Width = FMath::Max(Source.Width / 2, 1);
+            Source.Height = FMath::Max(Source.Height / 2, 1);
+        }
+    });
+
+    // 大きい順に配置すると充填率が上がる
+    TArray<int32> PackOrder;
+    for (int32 i = 0; i < Sources.Num(); ++i) {
+        if (Sources[i].bPackable)
+            PackOrder.Add(i);
+    }
+    if (PackOrder.Num() < 2)
+        return Result;
+
+    PackOrder.Sort([&Sources](const int32 A, const int32 B) {
+        const auto& SourceA = Sources[A];
+        const auto& SourceB = Sources[B];
+        const auto MaxSideA = FMath::Max(SourceA.Width, SourceA.Height);
+        const auto MaxSideB = FMath::Max(SourceB.Width, SourceB.Height);
+        if (MaxSideA != MaxSideB)
+            return MaxSideA > MaxSideB;
+        return SourceA.Width * SourceA.Height > SourceB.Width * SourceB.Height;
+    });
+
+    FPLATEAURectPacker Packer(Options.PageSize, Options.PageSize);
+    TArray<TArray<int32>> PageSources;
+    for (const auto SourceId : PackOrder) {
+        auto& Source = Sources[SourceId];
+        if (!Packer.Insert(Source.Width + Padding * 2, Source.Height + Padding * 2, Source.Page, Source.Position)) {
+            Source.Compressed.Empty();
+            continue;
+        }
+        if (PageSources.Num() <= Source.Page)
+            PageSources.SetNum(Source.Page + 1);
+        PageSources[Source.Page].Add(SourceId);
+    }
+
+    // ページは配置済みの範囲を含む2の累乗の大きさに切り詰める
+    TArray<FIntPoint> PageSizes;
+    for (int32 Page = 0; Page < Packer.GetNumPages(); ++Page) {
+        const auto Extent = Packer.GetUsedExtent(Page);
+        PageSizes.Add(FIntPoint(
+            FMath::Min(static_cast<int32>(FMath::RoundUpToPowerOfTwo(Extent.X)), Options.PageSize),
+            FMath::Min(static_cast<int32>(FMath::RoundUpToPowerOfTwo(Extent.Y)), Options.PageSize)));
+    }
+
+    // 入力が同じ場合は同じ名前とし、同じ内容のアトラス画像を重複して出力しない
+    FString AtlasKey = FString::Printf(TEXT("%d_%d"), Options.PageSize, Padding);
+    for (const auto SourceId : PackOrder) {
+        const auto& Source = Sources[SourceId];
+        if (Source.Page == INDEX_NONE)
+            continue;
+        AtlasKey += FString::Printf(TEXT("|%s_%08x_%dx%d_%d_%d_%d"), *Source.Path, Source.Crc, Source.Width, Source.Height,
+            Source.Page, Source.Position.X, Source.Position.Y);
+    }
+    const auto AtlasId = FString::Printf(TEXT("%016llx"), CityHash64(reinterpret_cast<const char*>(*AtlasKey), AtlasKey.Len() * sizeof(TCHAR)));
+
+    IFileManager::Get().MakeDirectory(*Options.OutputDirectory, true);
+    for (int32 Page = 0; Page < PageSizes.Num(); ++Page) {
+        Result.PagePaths.Add(Options.OutputDirectory / FString::Printf(TEXT("%s_%s_%d.png"), *Options.NamePrefix, *AtlasId, Page));
+    }
+
+    // ページごとに画像の展開・縮小・転写を並列に行い、PNGへのエンコードは次のページの転写と並行して行う
+    IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+    TArray<UE::Tasks::TTask<bool>> SaveTasks;
+    for (int32 Page = 0; Page < PageSizes.Num(); ++Page) {
+        const auto PageSize = PageSizes[Page];
+        TArray64<uint8> PagePixels;
+        PagePixels.SetNumZeroed(static_cast<int64>(PageSize.X) * PageSize.Y * 4);
+
+        ParallelFor(PageSources[Page].Num(), [&, Page](const int32 Index) {
+            auto& Source = Sources[PageSources[Page][Index]];
+            TArray64<uint8> Pixels;
+            int32 Width, Height;
+            const auto bDecompressed = FPLATEAUTextureLoader::DecompressImage(Source.Compressed, Pixels, Width, Height);
+            Source.Compressed.Empty();
+            if (!bDecompressed) {
+                Source.Page = INDEX_NONE;
+                return;
+            }
+            while (Width > Source.Width || Height > Source.Height) {
+                Downsample(Pixels, Width, Height);
+            }
+            if (Width != Source.Width || Height != Source.Height) {
+                Source.Page = INDEX_NONE;
+                return;
+            }
+            Blit(Pixels, Source, PagePixels, PageSize.X, Padding);
+        });
+
+        SaveTasks.Add(UE::Tasks::Launch(TEXT("SaveTextureAtlasTask"), [&ImageWrapperModule, PagePixels = MoveTemp(PagePixels), PageSize, PagePath = Result.PagePaths[Page]] {
+            const auto ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+            if (!ImageWrapper->SetRaw(PagePixels.GetData(), PagePixels.Num(), PageSize.X, PageSize.Y, ERGBFormat::BGRA, 8))
+                return false;
+            return FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *PagePath);
+        }));
+    }
+
+    for (int32 Page = 0; Page < SaveTasks.Num(); ++Page) {
+        if (SaveTasks[Page].GetResult())
+            continue;
+
+        UE_LOG(LogTemp, Error, TEXT("Failed to save texture atlas : %s"), *Result.PagePaths[Page]);
+        for (const auto SourceId : PageSources[Page]) {
+            Sources[SourceId].Page = INDEX_NONE;
+        }
+    }
+
+    // UVをアトラス上の位置に書き換え、サブメッシュのテクスチャをアトラスに置き換える
+    TArray<std::string> PagePathsUtf8;
+    for (const auto& PagePath : Result.PagePaths) {
+        PagePathsUtf8.Add(TCHAR_TO_UTF8(*PagePath));
+    }
+    ParallelFor(static_cast<int32>(Meshes.size()), [&](const int32 MeshIndex) {
+        auto& Mesh = *Meshes[MeshIndex];
+        const auto& Indices = Mesh.getIndices();
+        auto& UV1 = Mesh.getUV1();
+        TBitArray<> Remapped(false, static_cast<int32>(UV1.size()));
+        for (auto& SubMesh : Mesh.getSubMeshes()) {
+            if (SubMesh.getTexturePath().empty())
+                continue;
+
+            const auto SourceId = SourceIds.Find(UTF8_TO_TCHAR(SubMesh.getTexturePath().c_str()));
+            if (SourceId == nullptr || Sources[*SourceId].Page == INDEX_NONE)
+                continue;
+
+            const auto& Source = Sources[*SourceId];
+            const auto PageSize = PageSizes[Source.Page];
+            const float OffsetX = Source.Position.X + Padding;
+            const float OffsetY = Source.Position.Y + Padding;
+            for (auto i = SubMesh.getStartIndex(); i <= SubMesh.getEndIndex(); ++i) {
+                const auto VertexIndex = Indices[i];
+                if (Remapped[VertexIndex])
+                    continue;
+                Remapped[VertexIndex] = true;
+
+                // UVのVは画像の下端が0のため、画像の行方向に反転して変換
+                auto& UV = UV1[VertexIndex];
+                const auto U = FMath::Clamp(UV.x, 0.0f, 1.0f);
+                const auto V = FMath::Clamp(UV.y, 0.0f, 1.0f);
+                UV.x = (OffsetX + U * Source.Width) / PageSize.X;
+                UV.y = 1.0f - (OffsetY + (1.0f - V) * Source.Height) / PageSize.Y;
+            }
+            SubMesh.setTexturePath(PagePathsUtf8[Source.Page]);
+        }
+    });
+
+    for (const auto& Source : Sources) {
+        if (Source.Page != INDEX_NONE)
+            ++Result.NumPackedTextures;
+    }
+    UE_LOG(LogTemp, Log, TEXT("TextureAtlas: %d / %d textures packed into %d pages (occupancy %.1f%%)"),
+        Result.NumPackedTextures, Result.NumSourceTextures, Result.PagePaths.Num(), Packer.GetOccupancy() * 100.0);
+    return Result;
+}
+
+int32 FPLATEAUTextureAtlas::DeleteUnusedPages(const FString& OutputDirectory, const FString& NamePrefix, const TSet<FString>& UsedFileNames) {
+    TArray<FString> FileNames;
+    IFileManager::Get().FindFiles(FileNames, *(OutputDirectory / NamePrefix + TEXT("_*.png")), true, false);
+
+    int32 NumDeleted = 0;
+    for (const auto& FileName : FileNames) {
+        if (UsedFileNames.Contains(FileName))
+            continue;
+        if (IFileManager::Get().Delete(*(OutputDirectory / FileName)))
+            ++NumDeleted;
+    }
+    if (NumDeleted > 0)
+        UE_LOG(LogTemp, Log, TEXT("TextureAtlas: Deleted %d unused pages : %s_*"), NumDeleted, *NamePrefix);
+    return NumDeleted;
+}
+
+FString FPLATEAUTextureAtlas::GetDefaultOutputDirectory() {
+    return IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*(FPaths::ProjectContentDir() + FString("PLATEAU/Atlases")));
+}
+
+int32 FPLATEAUTextureAtlas::GetPageSize(const EPLATEAUTexturePackingResolution Resolution) {
+    switch (Resolution) {
+    case EPLATEAUTexturePackingResolution::H2048W2048:
+        return 2048;
+    case EPLATEAUTexturePackingResolution::H8192W8192:
+        return 8192;
+    default:
+        return 4096;
+    }
+}
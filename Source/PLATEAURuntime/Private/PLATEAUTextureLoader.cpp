@@ -10,6 +10,7 @@
 #include "Engine/Texture2D.h"
 #include "Misc/FileHelper.h"
 #include "TextureResource.h"
+#include "Dataset/PLATEAUDatasetArchive.h"
 #include <filesystem>
 
 #if WITH_EDITOR
@@ -21,35 +22,51 @@ DECLARE_STATS_GROUP(TEXT("PLATEAUTextureLoader"), STATGROUP_PLATEAUTextureLoader
 DECLARE_CYCLE_STAT(TEXT("Texture.UpdateResource"), STAT_Texture_UpdateResource, STATGROUP_PLATEAUTextureLoader);
 
 namespace {
-    bool TryLoadAndUncompressImageFile(const FString& TexturePath,
-        TArray64<uint8>& OutUncompressedData, int32& OutWidth, int32& OutHeight, EPixelFormat& OutPixelFormat) {
+    bool TryLoadFile(const FString& TexturePath, TArray64<uint8>& OutBuffer) {
         if (TexturePath.IsEmpty()) {
             UE_LOG(LogTemp, Error, TEXT("Failed to load texture : path is empty."));
             return false;
         }
 
-        IImageWrapperModule& ImageWrapperModule = FModuleManager::Get().LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
-
-        TArray64<uint8> Buffer;
-        if (!FFileHelper::LoadFileToArray(Buffer, *TexturePath)) {
+        // zipアーカイブ内のテクスチャは展開せずに読み込む
+        if (!FPLATEAUDatasetArchive::LoadFileToArray(TexturePath, OutBuffer)) {
             UE_LOG(LogTemp, Error, TEXT("Failed to load texture file : %s"), *TexturePath);
             return false;
         }
+        return true;
+    }
+
+    TSharedPtr<IImageWrapper> TryCreateImageWrapper(const TArray64<uint8>& Buffer, const FString& TexturePath) {
+        IImageWrapperModule& ImageWrapperModule = FModuleManager::Get().LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
 
         const EImageFormat Format = ImageWrapperModule.DetectImageFormat(Buffer.GetData(), Buffer.Num());
 
         if (Format == EImageFormat::Invalid) {
             UE_LOG(LogTemp, Error, TEXT("Failed to load texture : Texture format is invalid : %s"), *TexturePath);
-            return false;
+            return nullptr;
         }
 
         const auto ImageWrapper = ImageWrapperModule.CreateImageWrapper(Format);
 
         if (!ImageWrapper->SetCompressed((void*)Buffer.GetData(), Buffer.Num())) {
             UE_LOG(LogTemp, Error, TEXT("Failed to load texture : Could not set compressed : %s"), *TexturePath);
-            return false;
+            return nullptr;
         }
+        return ImageWrapper;
+    }
 
+    TSharedPtr<IImageWrapper> TryLoadImageFile(const FString& TexturePath) {
+        TArray64<uint8> Buffer;
+        if (!TryLoadFile(TexturePath, Buffer))
+            return nullptr;
+        return TryCreateImageWrapper(Buffer, TexturePath);
+    }
+
+    bool TryLoadAndUncompressImageFile(const FString& TexturePath,
+        TArray64<uint8>& OutUncompressedData, int32& OutWidth, int32& OutHeight, EPixelFormat& OutPixelFormat) {
+        const auto ImageWrapper = TryLoadImageFile(TexturePath);
+        if (!ImageWrapper.IsValid())
+            return false;
 
         ERGBFormat RGBFormat;
         const int32 BitDepth = ImageWrapper->GetBitDepth();
@@ -264,6 +281,27 @@ UTexture2D* FPLATEAUTextureLoader::Load(const FString& TexturePath_SlashOrBackSl
     return NewTexture;
 }
 
+bool FPLATEAUTextureLoader::LoadCompressedImage(const FString& TexturePath, TArray64<uint8>& OutCompressed, int32& OutWidth, int32& OutHeight) {
+    if (!TryLoadFile(TexturePath, OutCompressed))
+        return false;
+
+    const auto ImageWrapper = TryCreateImageWrapper(OutCompressed, TexturePath);
+    if (!ImageWrapper.IsValid() || ImageWrapper->GetBitDepth() != 8)
+        return false;
+    OutWidth = ImageWrapper->GetWidth();
+    OutHeight = ImageWrapper->GetHeight();
+    return true;
+}
+
+bool FPLATEAUTextureLoader::DecompressImage(const TArray64<uint8>& Compressed, TArray64<uint8>& OutPixels, int32& OutWidth, int32& OutHeight) {
+    const auto ImageWrapper = TryCreateImageWrapper(Compressed, FString());
+    if (!ImageWrapper.IsValid() || ImageWrapper->GetBitDepth() != 8)
+        return false;
+    OutWidth = ImageWrapper->GetWidth();
+    OutHeight = ImageWrapper->GetHeight();
+    return ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, OutPixels);
+}
+
 UTexture2D* FPLATEAUTextureLoader::LoadTransient(const FString& TexturePath) {
     int32 Width, Height;
     EPixelFormat PixelFormat;
@@ -102,6 +102,8 @@ USceneComponent* FPLATEAUMeshLoaderCloneComponent::ReloadNode(USceneComponent* P
                 false,
                 nullptr
             };
+            LoadInputData.VertexFormat = OriginalComponent->GetVertexFormat();
+            LoadInputData.CollisionComplexity = OriginalComponent->CollisionComplexity;
             return CreateStaticMeshComponent(Actor, *OriginalParentComponent, *Node.getMesh(), LoadInputData, nullptr,
                 Node.getName());
         }
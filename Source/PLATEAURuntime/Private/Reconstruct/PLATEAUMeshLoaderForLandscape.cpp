@@ -12,6 +12,128 @@
 #include "StaticMeshAttributes.h"
 #include "Component/PLATEAULandscapeRefComponent.h"
 #include "Landscape.h"
+#include "PLATEAUTextureLoader.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include <plateau/polygon_mesh/model.h>
+
+namespace {
+    //! 統合ハイトマップをラスタライズするタイルの1辺の格子数
+    constexpr int32 UnifiedTileSize = 256;
+    //! 統合ハイトマップの1辺の最大の格子点数(Landscapeの推奨サイズの上限)
+    constexpr int32 MaxUnifiedHeightMapSize = 8129;
+
+    //! 0～1の範囲外とみなさないUVの誤差
+    constexpr float UVTolerance = 0.001f;
+
+    /**
+     * @brief UVを0～1に収めます。
+     * 地形の端(UVが0または1)の格子点が反対側の端のテクセルを参照しないよう、誤差の範囲内は切り詰め、明らかに範囲外の場合のみ繰り返します。
+     */
+    float NormalizeUV(const float Value) {
+        if (Value >= -UVTolerance && Value <= 1.0f + UVTolerance)
+            return FMath::Clamp(Value, 0.0f, 1.0f);
+        return FMath::Frac(Value);
+    }
+
+    /**
+     * @brief 同じテクスチャを持つ地形の三角形です。
+     */
+    struct FReliefTriangles {
+        FString TexturePath;
+        //! 三角形ごとに3つの頂点
+        TArray<FVector3d> Positions;
+        TArray<FVector2f> UVs;
+    };
+
+    void CollectReliefTriangles(const plateau::polygonMesh::Node& Node, TMap<FString, int32>& GroupLookup,
+        TArray<FReliefTriangles>& OutGroups, TArray<FString>& OutNodeNames) {
+        const auto Mesh = Node.getMesh();
+        if (Mesh != nullptr && Mesh->getVertices().size() > 0) {
+            OutNodeNames.Add(UTF8_TO_TCHAR(Node.getName().c_str()));
+            const auto& Vertices = Mesh->getVertices();
+            const auto& UV1 = Mesh->getUV1();
+            const auto& Indices = Mesh->getIndices();
+            for (const auto& SubMesh : Mesh->getSubMeshes()) {
+                const FString TexturePath = UTF8_TO_TCHAR(SubMesh.getTexturePath().c_str());
+                int32 GroupIndex;
+                if (const auto Found = GroupLookup.Find(TexturePath)) {
+                    GroupIndex = *Found;
+                } else {
+                    GroupIndex = OutGroups.AddDefaulted();
+                    OutGroups[GroupIndex].TexturePath = TexturePath;
+                    GroupLookup.Add(TexturePath, GroupIndex);
+                }
+                auto& Group = OutGroups[GroupIndex];
+                for (size_t i = SubMesh.getStartIndex(); i + 2 <= SubMesh.getEndIndex(); i += 3) {
+                    for (size_t j = 0; j < 3; ++j) {
+                        const auto Index = Indices[i + j];
+                        const auto& Vertex = Vertices[Index];
+                        Group.Positions.Add(FVector3d(Vertex.x, Vertex.y, Vertex.z));
+                        Group.UVs.Add(Index < UV1.size() ? FVector2f(UV1[Index].x, UV1[Index].y) : FVector2f::ZeroVector);
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < Node.getChildCount(); ++i) {
+            CollectReliefTriangles(Node.getChildAt(i), GroupLookup, OutGroups, OutNodeNames);
+        }
+    }
+
+    /**
+     * @brief 値の決まっていない格子点を、最も近い(4近傍での距離)値の決まっている格子点の値で埋めます。
+     */
+    void FillUncoveredCells(TArray<float>& Heights, TArray64<uint8>& Colors, TBitArray<>& Covered, const int32 SizeX, const int32 SizeY) {
+        TArray<int32> Queue;
+        Queue.Reserve(SizeX * SizeY);
+        for (TConstSetBitIterator<> It(Covered); It; ++It) {
+            Queue.Add(It.GetIndex());
+        }
+        for (int32 Head = 0; Head < Queue.Num(); ++Head) {
+            const int32 Index = Queue[Head];
+            const int32 X = Index % SizeX;
+            const int32 Y = Index / SizeX;
+            for (const FIntPoint& Offset : { FIntPoint(-1, 0), FIntPoint(1, 0), FIntPoint(0, -1), FIntPoint(0, 1) }) {
+                const int32 NeighborX = X + Offset.X;
+                const int32 NeighborY = Y + Offset.Y;
+                if (NeighborX < 0 || NeighborX >= SizeX || NeighborY < 0 || NeighborY >= SizeY)
+                    continue;
+                const int32 Neighbor = NeighborY * SizeX + NeighborX;
+                if (Covered[Neighbor])
+                    continue;
+                Covered[Neighbor] = true;
+                Heights[Neighbor] = Heights[Index];
+                if (Colors.Num() > 0)
+                    FMemory::Memcpy(&Colors[static_cast<int64>(Neighbor) * 4], &Colors[static_cast<int64>(Index) * 4], 4);
+                Queue.Add(Neighbor);
+            }
+        }
+    }
+
+    /**
+     * @brief [1 2 1]のフィルターを縦横に適用して高さを平滑化します。
+     */
+    void BlurHeights(TArray<float>& Heights, const int32 SizeX, const int32 SizeY) {
+        TArray<float> Temp;
+        Temp.SetNumUninitialized(Heights.Num());
+        ParallelFor(SizeY, [&](const int32 Y) {
+            for (int32 X = 0; X < SizeX; ++X) {
+                const float Left = Heights[Y * SizeX + FMath::Max(X - 1, 0)];
+                const float Right = Heights[Y * SizeX + FMath::Min(X + 1, SizeX - 1)];
+                Temp[Y * SizeX + X] = (Left + 2.0f * Heights[Y * SizeX + X] + Right) * 0.25f;
+            }
+        });
+        ParallelFor(SizeY, [&](const int32 Y) {
+            const int32 Up = FMath::Max(Y - 1, 0) * SizeX;
+            const int32 Down = FMath::Min(Y + 1, SizeY - 1) * SizeX;
+            for (int32 X = 0; X < SizeX; ++X) {
+                Heights[Y * SizeX + X] = (Temp[Up + X] + 2.0f * Temp[Y * SizeX + X] + Temp[Down + X]) * 0.25f;
+            }
+        });
+    }
+}
 
 
 FPLATEAUMeshLoaderForLandscape::FPLATEAUMeshLoaderForLandscape() {}
@@ -93,6 +215,191 @@ HeightmapCreationResult FPLATEAUMeshLoaderForLandscape::CreateHeightMapFromMesh(
     return Result;
 }
 
+TArray<HeightmapCreationResult> FPLATEAUMeshLoaderForLandscape::CreateUnifiedHeightMap(
+    AActor* ModelActor,
+    const std::shared_ptr<plateau::polygonMesh::Model> Model, FPLATEAULandscapeParam& Param) {
+
+    // 全地形の三角形をテクスチャごとに集める
+    TArray<FReliefTriangles> Groups;
+    TArray<FString> NodeNames;
+    TMap<FString, int32> GroupLookup;
+    for (int i = 0; i < Model->getRootNodeCount(); i++) {
+        CollectReliefTriangles(Model->getRootNodeAt(i), GroupLookup, Groups, NodeNames);
+    }
+
+    FBox3d Bounds(ForceInit);
+    for (const auto& Group : Groups) {
+        for (const auto& Position : Group.Positions) {
+            Bounds += Position;
+        }
+    }
+    if (!Bounds.IsValid || FMath::IsNearlyZero(Bounds.Max.X - Bounds.Min.X) || FMath::IsNearlyZero(Bounds.Max.Y - Bounds.Min.Y))
+        return {};
+
+    // ランドスケープのコンポーネントの境界に揃う格子の大きさを求める。大きすぎる場合は格子の間隔を広げる
+    const int32 ComponentSizeQuads = FMath::Max(Param.NumSubsections * Param.SubsectionSizeQuads, 1);
+    const auto GetGridSize = [&](const double Extent) {
+        const int32 Quads = FMath::Max(FMath::CeilToInt32(Extent / FMath::Max(Param.UnifiedGridSpacing, 1.0f)), 1);
+        const int32 NumComponents = FMath::Min(FMath::DivideAndRoundUp(Quads, ComponentSizeQuads), (MaxUnifiedHeightMapSize - 1) / ComponentSizeQuads);
+        return FMath::Max(NumComponents, 1) * ComponentSizeQuads + 1;
+    };
+    const int32 SizeX = GetGridSize(Bounds.Max.X - Bounds.Min.X);
+    const int32 SizeY = GetGridSize(Bounds.Max.Y - Bounds.Min.Y);
+    const double SpacingX = (Bounds.Max.X - Bounds.Min.X) / (SizeX - 1);
+    const double SpacingY = (Bounds.Max.Y - Bounds.Min.Y) / (SizeY - 1);
+    Param.TextureWidth = SizeX;
+    Param.TextureHeight = SizeY;
+    UE_LOG(LogTemp, Log, TEXT("Create unified heightmap: %d nodes, %dx%d, spacing (%f, %f)"), NodeNames.Num(), SizeX, SizeY, SpacingX, SpacingY);
+
+    const bool bHasTexture = Groups.ContainsByPredicate([](const FReliefTriangles& Group) {
+        return !Group.TexturePath.IsEmpty();
+    });
+    TArray<float> Heights;
+    Heights.Init(TNumericLimits<float>::Lowest(), SizeX * SizeY);
+    TArray64<uint8> Colors;
+    if (bHasTexture)
+        Colors.SetNumZeroed(static_cast<int64>(SizeX) * SizeY * 4);
+
+    // テクスチャごとに、三角形をタイルに振り分けてタイル単位で並列にラスタライズする(テクスチャは1枚ずつ展開する)
+    const int32 NumTilesX = FMath::DivideAndRoundUp(SizeX, UnifiedTileSize);
+    const int32 NumTilesY = FMath::DivideAndRoundUp(SizeY, UnifiedTileSize);
+    for (const auto& Group : Groups) {
+        TArray64<uint8> TexturePixels;
+        int32 TextureWidth = 0;
+        int32 TextureHeight = 0;
+        if (bHasTexture && !Group.TexturePath.IsEmpty()) {
+            TArray64<uint8> Compressed;
+            if (!FPLATEAUTextureLoader::LoadCompressedImage(Group.TexturePath, Compressed, TextureWidth, TextureHeight)
+                || !FPLATEAUTextureLoader::DecompressImage(Compressed, TexturePixels, TextureWidth, TextureHeight)) {
+                TexturePixels.Reset();
+                UE_LOG(LogTemp, Warning, TEXT("Failed to load relief texture: %s"), *Group.TexturePath);
+            }
+        }
+
+        const int32 NumTriangles = Group.Positions.Num() / 3;
+        TArray<FIntRect> TriangleRects;
+        TriangleRects.SetNumUninitialized(NumTriangles);
+        TArray<TArray<int32>> TileTriangles;
+        TileTriangles.SetNum(NumTilesX * NumTilesY);
+        for (int32 Triangle = 0; Triangle < NumTriangles; ++Triangle) {
+            const auto& P0 = Group.Positions[Triangle * 3];
+            const auto& P1 = Group.Positions[Triangle * 3 + 1];
+            const auto& P2 = Group.Positions[Triangle * 3 + 2];
+            const FIntRect Rect(
+                FMath::Max(FMath::CeilToInt32((FMath::Min3(P0.X, P1.X, P2.X) - Bounds.Min.X) / SpacingX), 0),
+                FMath::Max(FMath::CeilToInt32((FMath::Min3(P0.Y, P1.Y, P2.Y) - Bounds.Min.Y) / SpacingY), 0),
+                FMath::Min(FMath::FloorToInt32((FMath::Max3(P0.X, P1.X, P2.X) - Bounds.Min.X) / SpacingX), SizeX - 1),
+                FMath::Min(FMath::FloorToInt32((FMath::Max3(P0.Y, P1.Y, P2.Y) - Bounds.Min.Y) / SpacingY), SizeY - 1));
+            TriangleRects[Triangle] = Rect;
+            if (Rect.Min.X > Rect.Max.X || Rect.Min.Y > Rect.Max.Y)
+                continue;
+            for (int32 TileY = Rect.Min.Y / UnifiedTileSize; TileY <= Rect.Max.Y / UnifiedTileSize; ++TileY) {
+                for (int32 TileX = Rect.Min.X / UnifiedTileSize; TileX <= Rect.Max.X / UnifiedTileSize; ++TileX) {
+                    TileTriangles[TileY * NumTilesX + TileX].Add(Triangle);
+                }
+            }
+        }
+
+        ParallelFor(TileTriangles.Num(), [&](const int32 Tile) {
+            const int32 TileMinX = (Tile % NumTilesX) * UnifiedTileSize;
+            const int32 TileMinY = (Tile / NumTilesX) * UnifiedTileSize;
+            for (const int32 Triangle : TileTriangles[Tile]) {
+                const auto& P0 = Group.Positions[Triangle * 3];
+                const auto& P1 = Group.Positions[Triangle * 3 + 1];
+                const auto& P2 = Group.Positions[Triangle * 3 + 2];
+                const double Area = (P1.X - P0.X) * (P2.Y - P0.Y) - (P1.Y - P0.Y) * (P2.X - P0.X);
+                if (FMath::IsNearlyZero(Area))
+                    continue;
+
+                const auto& Rect = TriangleRects[Triangle];
+                for (int32 Y = FMath::Max(Rect.Min.Y, TileMinY); Y <= FMath::Min(Rect.Max.Y, TileMinY + UnifiedTileSize - 1); ++Y) {
+                    const double PY = Bounds.Min.Y + Y * SpacingY;
+                    for (int32 X = FMath::Max(Rect.Min.X, TileMinX); X <= FMath::Min(Rect.Max.X, TileMinX + UnifiedTileSize - 1); ++X) {
+                        const double PX = Bounds.Min.X + X * SpacingX;
+                        const double W0 = ((P1.X - PX) * (P2.Y - PY) - (P1.Y - PY) * (P2.X - PX)) / Area;
+                        const double W1 = ((P2.X - PX) * (P0.Y - PY) - (P2.Y - PY) * (P0.X - PX)) / Area;
+                        const double W2 = 1.0 - W0 - W1;
+                        if (W0 < -UE_KINDA_SMALL_NUMBER || W1 < -UE_KINDA_SMALL_NUMBER || W2 < -UE_KINDA_SMALL_NUMBER)
+                            continue;
+
+                        // 重なる地形は高い方を採用
+                        const int32 Index = Y * SizeX + X;
+                        const float Height = static_cast<float>(W0 * P0.Z + W1 * P1.Z + W2 * P2.Z);
+                        if (Height <= Heights[Index])
+                            continue;
+                        Heights[Index] = Height;
+
+                        if (TexturePixels.Num() > 0) {
+                            const FVector2f UV = Group.UVs[Triangle * 3] * static_cast<float>(W0)
+                                + Group.UVs[Triangle * 3 + 1] * static_cast<float>(W1)
+                                + Group.UVs[Triangle * 3 + 2] * static_cast<float>(W2);
+                            const int32 TexelX = FMath::Clamp(FMath::FloorToInt32(NormalizeUV(UV.X) * TextureWidth), 0, TextureWidth - 1);
+                            const int32 TexelY = FMath::Clamp(FMath::FloorToInt32((1.0f - NormalizeUV(UV.Y)) * TextureHeight), 0, TextureHeight - 1);
+                            FMemory::Memcpy(&Colors[static_cast<int64>(Index) * 4], &TexturePixels[(static_cast<int64>(TexelY) * TextureWidth + TexelX) * 4], 4);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // 全地形で共通の高さの範囲
+    TBitArray<> Covered(false, Heights.Num());
+    float MinHeight = TNumericLimits<float>::Max();
+    float MaxHeight = TNumericLimits<float>::Lowest();
+    for (int32 i = 0; i < Heights.Num(); ++i) {
+        if (Heights[i] == TNumericLimits<float>::Lowest())
+            continue;
+        Covered[i] = true;
+        MinHeight = FMath::Min(MinHeight, Heights[i]);
+        MaxHeight = FMath::Max(MaxHeight, Heights[i]);
+    }
+    if (MinHeight > MaxHeight)
+        return {};
+    MaxHeight = FMath::Max(MaxHeight, MinHeight + 1.0f);
+
+    // 地形の無い格子点は最も近い地形の高さ、または最低の高さで埋める
+    if (Param.FillEdges) {
+        FillUncoveredCells(Heights, Colors, Covered, SizeX, SizeY);
+    } else {
+        for (int32 i = 0; i < Heights.Num(); ++i) {
+            if (!Covered[i])
+                Heights[i] = MinHeight;
+        }
+    }
+    if (Param.ApplyBlurFilter)
+        BlurHeights(Heights, SizeX, SizeY);
+
+    const auto HeightMapData = MakeShared<std::vector<uint16_t>>(Heights.Num());
+    ParallelFor(SizeY, [&](const int32 Y) {
+        for (int32 X = 0; X < SizeX; ++X) {
+            const float Normalized = (Heights[Y * SizeX + X] - MinHeight) / (MaxHeight - MinHeight);
+            (*HeightMapData)[Y * SizeX + X] = static_cast<uint16_t>(FMath::Clamp(FMath::RoundToInt32(Normalized * MAX_uint16), 0, MAX_uint16));
+        }
+    });
+
+    const FString NodeName = TEXT("Relief_") + ModelActor->GetName();
+    SaveHeightmapImage(Param.HeightmapImageOutput, "HM_" + NodeName, SizeX, SizeY, HeightMapData->data());
+
+    // 合成したテクスチャの画素は格子点と1対1で対応する
+    FString TexturePath;
+    if (bHasTexture) {
+        IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+        const auto ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+        const FString SavePath = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir() / TEXT("PLATEAU/Landscapes") / NodeName + TEXT(".png"));
+        if (ImageWrapper->SetRaw(Colors.GetData(), Colors.Num(), SizeX, SizeY, ERGBFormat::BGRA, 8)
+            && FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *SavePath)) {
+            TexturePath = SavePath;
+        } else {
+            UE_LOG(LogTemp, Warning, TEXT("Failed to save unified relief texture: %s"), *SavePath);
+        }
+    }
+
+    HeightmapCreationResult Result{ NodeName, HeightMapData,
+        TVec3d(Bounds.Min.X, Bounds.Min.Y, MinHeight), TVec3d(Bounds.Max.X, Bounds.Max.Y, MaxHeight),
+        TVec2f(0, 0), TVec2f(1, 1), TexturePath, NodeNames };
+    return { Result };
+}
 
 void FPLATEAUMeshLoaderForLandscape::CreateReference(ALandscape* Landscape, AActor* Actor, const FString NodeName) {
     const FString ReplacedNodeName = NodeName.Replace(*FString("Mesh_"), *FString()); //Mesh Prefix ����
@@ -2,6 +2,7 @@
 
 
 #include "Reconstruct/PLATEAUMeshLoaderForLandscapeMesh.h"
+#include "Reconstruct/PLATEAUTerrainMesher.h"
 #include "PLATEAUCityModelLoader.h"
 #include "Component/PLATEAUCityObjectGroup.h"
 #include "plateau/polygon_mesh/mesh_extractor.h"
@@ -9,7 +10,6 @@
 #include "MeshDescription.h"
 #include "StaticMeshOperations.h"
 #include "StaticMeshAttributes.h"
-#include "plateau/height_map_generator/heightmap_mesh_generator.h"
 
 FPLATEAUMeshLoaderForLandscapeMesh::FPLATEAUMeshLoaderForLandscapeMesh() {}
 
@@ -17,21 +17,65 @@ FPLATEAUMeshLoaderForLandscapeMesh::FPLATEAUMeshLoaderForLandscapeMesh(const boo
     bAutomationTest = InbAutomationTest;
 }
 
+namespace {
+    /**
+     * @brief 地形メッシュのチャンクをハイトマップの範囲に合わせて配置したメッシュに変換します。
+     */
+    plateau::polygonMesh::Mesh CreateMeshFromChunk(const FPLATEAUTerrainMeshChunk& Chunk, const int32 SizeX, const int32 SizeY,
+        const TVec3d& Min, const TVec3d& Max, const TVec2f& MinUV, const TVec2f& MaxUV,
+        const uint16_t* HeightRawData, const double HeightScale, const FString& TexturePath) {
+
+        std::vector<TVec3d> Vertices;
+        plateau::polygonMesh::UV UV1;
+        Vertices.reserve(Chunk.Vertices.Num());
+        UV1.reserve(Chunk.Vertices.Num());
+        for (const auto& Point : Chunk.Vertices) {
+            const double U = static_cast<double>(Point.X) / (SizeX - 1);
+            const double V = static_cast<double>(Point.Y) / (SizeY - 1);
+            Vertices.emplace_back(
+                Min.x + U * (Max.x - Min.x),
+                Min.y + V * (Max.y - Min.y),
+                Min.z + HeightRawData[Point.Y * SizeX + Point.X] * HeightScale);
+            // テクスチャのVは行方向と逆向き
+            UV1.emplace_back(
+                MinUV.x + U * (MaxUV.x - MinUV.x),
+                MaxUV.y - V * (MaxUV.y - MinUV.y));
+        }
+        plateau::polygonMesh::UV UV4(Vertices.size(), TVec2f(0, 0));
+        std::vector<unsigned> Indices(Chunk.Indices.GetData(), Chunk.Indices.GetData() + Chunk.Indices.Num());
+        const auto NumIndices = Indices.size();
+
+        plateau::polygonMesh::Mesh TerrainMesh(std::move(Vertices), std::move(Indices), std::move(UV1), std::move(UV4), {}, {});
+        TerrainMesh.addSubMesh(TCHAR_TO_UTF8(*TexturePath), nullptr, 0, NumIndices - 1, -1);
+        return TerrainMesh;
+    }
+}
+
 void FPLATEAUMeshLoaderForLandscapeMesh::CreateMeshFromHeightMap(AActor& Actor, const int32 SizeX, const int32 SizeY, 
     const TVec3d Min, const TVec3d Max, 
     const TVec2f MinUV, const TVec2f MaxUV, 
-    uint16_t* HeightRawData, const FString NodeName) {
-    double ActualHeight = abs(Max.z - Min.z);
-    float HeightScale = ActualHeight;
-    plateau::heightMapGenerator::HeightmapMeshGenerator gen;
-    plateau::polygonMesh::Mesh mesh;
-    gen.generateMeshFromHeightmap(mesh, SizeX, SizeY, HeightScale, HeightRawData,
-        plateau::geometry::CoordinateSystem::ESU, Min, Max, MinUV, MaxUV, false);
+    uint16_t* HeightRawData, const FString NodeName,
+    const double MaxError, const int32 ChunkSizeQuads, const FString& TexturePath) {
+    if (SizeX < 2 || SizeY < 2)
+        return;
+
+    // 許容誤差以内でハイトマップを簡略化したメッシュをチャンクごとに生成
+    const double HeightScale = (Max.z - Min.z) / MAX_uint16;
+    const int32 ChunkSize = FPLATEAUTerrainMesher::GetAlignedChunkSize(ChunkSizeQuads);
+    const FPLATEAUTerrainMesher Mesher(SizeX, SizeY, HeightRawData, FMath::Abs(HeightScale), ChunkSize > 0 ? FMath::Min(ChunkSize, 256) : 256);
+    const auto Chunks = Mesher.Extract(MaxError, ChunkSize);
+    if (Chunks.Num() == 0)
+        return;
+
+    OriginalNodeName = NodeName;
 
     auto ParentComponent = Actor.GetRootComponent();
+    auto CollisionComplexity = EPLATEAUCollisionComplexity::Complex;
     const auto BaseComponents = FindComponentsByName(&Actor, NodeName);
     if (BaseComponents.Num() > 0) {
         const auto BaseComponent = BaseComponents[0];
+        if (const auto BaseCityObjectGroup = Cast<UPLATEAUCityObjectGroup>(BaseComponent))
+            CollisionComplexity = BaseCityObjectGroup->CollisionComplexity;
         if (BaseComponent->IsA<UStaticMeshComponent>()) {
 
             const auto BaseStaticMeshComponent = (UStaticMeshComponent*)BaseComponent;
@@ -54,14 +98,21 @@ void FPLATEAUMeshLoaderForLandscapeMesh::CreateMeshFromHeightMap(AActor& Actor,
         false,
         nullptr
     };
-
-    FString ComponentName = FString::Format(*FString(TEXT("Mesh_{0}")), { NodeName });
-    UStaticMeshComponent* Component = CreateStaticMeshComponent(Actor, *ParentComponent, mesh, LoadInputData, nullptr, TCHAR_TO_UTF8(*ComponentName));
-
-    Component->Mobility = EComponentMobility::Movable;
-    Actor.AddInstanceComponent(Component);
-    Component->RegisterComponent();
-    Component->AttachToComponent(ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
+    LoadInputData.CollisionComplexity = CollisionComplexity;
+
+    // チャンクごとにコンポーネントを分けることで、視錐台カリングとLODがチャンク単位で働く
+    for (const auto& Chunk : Chunks) {
+        const auto TerrainMesh = CreateMeshFromChunk(Chunk, SizeX, SizeY, Min, Max, MinUV, MaxUV, HeightRawData, HeightScale, TexturePath);
+        const FString ComponentName = Chunks.Num() == 1
+            ? FString::Format(*FString(TEXT("Mesh_{0}")), { NodeName })
+            : FString::Format(*FString(TEXT("Mesh_{0}_{1}_{2}")), { NodeName, Chunk.ChunkIndex.X, Chunk.ChunkIndex.Y });
+        UStaticMeshComponent* Component = CreateStaticMeshComponent(Actor, *ParentComponent, TerrainMesh, LoadInputData, nullptr, TCHAR_TO_UTF8(*ComponentName));
+
+        Component->Mobility = EComponentMobility::Movable;
+        Actor.AddInstanceComponent(Component);
+        Component->RegisterComponent();
+        Component->AttachToComponent(ParentComponent, FAttachmentTransformRules::KeepWorldTransform);
+    }
 
     // メッシュをワールド内にビルド
     const auto CopiedStaticMeshes = StaticMeshes;
@@ -95,7 +146,7 @@ UStaticMeshComponent* FPLATEAUMeshLoaderForLandscapeMesh::GetStaticMeshComponent
     const auto& PLATEAUCityObjectGroup = NewObject<UPLATEAUCityObjectGroup>(&Actor, NAME_None);
 
     // Originalコンポーネントの属性をそのまま利用
-    const FString ReplacedName = NodeName.Replace(*FString("Mesh_"), *FString());
+    const FString ReplacedName = OriginalNodeName.IsEmpty() ? NodeName.Replace(*FString("Mesh_"), *FString()) : OriginalNodeName;
     const auto& OriginalComponent = GetOriginalComponent(&Actor, ReplacedName);
     if (OriginalComponent) {
         PLATEAUCityObjectGroup->SerializedCityObjects = OriginalComponent->SerializedCityObjects;
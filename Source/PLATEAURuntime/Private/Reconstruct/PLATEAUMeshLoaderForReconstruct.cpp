@@ -144,6 +144,8 @@ USceneComponent* FPLATEAUMeshLoaderForReconstruct::ReloadNode(USceneComponent* P
         false,
         nullptr
     };
+    LoadInputData.VertexFormat = VertexFormat;
+    LoadInputData.CollisionComplexity = CollisionComplexity;
     return CreateStaticMeshComponent(Actor, *ParentComponent, *Node.getMesh(), LoadInputData, nullptr,
         Node.getName());
 }
@@ -5,6 +5,10 @@
 #include <PLATEAUTextureLoader.h>
 #include "Materials/MaterialInstanceConstant.h"
 #include "UObject/SavePackage.h"
+#include "LandscapeSubsystem.h"
+#if WITH_EDITOR
+#include "LandscapeConfigHelper.h"
+#endif
 
 namespace {
 
@@ -27,6 +31,11 @@ TArray<HeightmapCreationResult> FPLATEAUModelLandscape::CreateHeightMap(std::sha
     return HMap.CreateHeightMap(CityModelActor, Model, Param);
 }
 
+TArray<HeightmapCreationResult> FPLATEAUModelLandscape::CreateUnifiedHeightMap(std::shared_ptr<plateau::polygonMesh::Model> Model, FPLATEAULandscapeParam& Param) {
+    FPLATEAUMeshLoaderForLandscape HMap = FPLATEAUMeshLoaderForLandscape(false);
+    return HMap.CreateUnifiedHeightMap(CityModelActor, Model, Param);
+}
+
 /**
 * @brief ComponentのChildrenからUPLATEAUCityObjectGroupを探してtypeがTINRelief || ReliefFeatureの場合のみリストに追加します
 */
@@ -57,7 +66,8 @@ TArray<UPLATEAUCityObjectGroup*> FPLATEAUModelLandscape::GetUPLATEAUCityObjectGr
 
 
 ALandscape* FPLATEAUModelLandscape::CreateLandScape(UWorld* World, const int32 NumSubsections, const int32 SubsectionSizeQuads, const  int32 ComponentCountX, const int32 ComponentCountY, const  int32 SizeX, const int32 SizeY,
-    const TVec3d Min, const TVec3d Max, const TVec2f MinUV, const TVec2f MaxUV, const FString TexturePath, TArray<uint16> HeightData, const FString ActorName) {
+    const TVec3d Min, const TVec3d Max, const TVec2f MinUV, const TVec2f MaxUV, const FString TexturePath, TArray<uint16> HeightData, const FString ActorName,
+    const int32 StreamingGridSize) {
 
     // Weightmap is sized the same as the component
     const int32 WeightmapSize = (SubsectionSizeQuads + 1) * NumSubsections;
@@ -147,6 +157,18 @@ ALandscape* FPLATEAUModelLandscape::CreateLandScape(UWorld* World, const int32 N
     Landscape->PostEditChange();
     Landscape->SetActorLabel(FString(ActorName));
 
+    // World Partitionのレベルではコンポーネントを領域ごとのストリーミングプロキシに移し、領域単位で読み込まれるようにする
+    if (StreamingGridSize > 0) {
+        const auto LandscapeSubsystem = World->GetSubsystem<ULandscapeSubsystem>();
+        if (LandscapeSubsystem != nullptr && LandscapeSubsystem->IsGridBased()) {
+            TSet<AActor*> ActorsToDelete;
+            FLandscapeConfigHelper::ChangeGridSize(LandscapeInfo, StreamingGridSize, ActorsToDelete);
+            for (const auto ActorToDelete : ActorsToDelete) {
+                World->DestroyActor(ActorToDelete);
+            }
+        }
+    }
+
     return Landscape;
 #endif   
     return nullptr;
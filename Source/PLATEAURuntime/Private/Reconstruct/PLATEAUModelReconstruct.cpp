@@ -4,6 +4,7 @@
 #include <plateau/granularity_convert/granularity_converter.h>
 #include <PLATEAUMeshExporter.h>
 #include <PLATEAUExportSettings.h>
+#include <PLATEAUTextureAtlas.h>
 
 using namespace plateau::granularityConvert;
 
@@ -68,6 +69,8 @@ std::shared_ptr<plateau::polygonMesh::Model> FPLATEAUModelReconstruct::ConvertMo
 
     //属性情報を覚えておきます。
     CityObjMap = FPLATEAUMeshLoaderForReconstruct::CreateMapFromCityObjectGroups(TargetCityObjects);
+    VertexFormat = TargetCityObjects.Num() > 0 ? TargetCityObjects[0]->GetVertexFormat() : EPLATEAUVertexFormat::Standard;
+    CollisionComplexity = TargetCityObjects.Num() > 0 ? TargetCityObjects[0]->CollisionComplexity : EPLATEAUCollisionComplexity::Complex;
 
     check(CityModelActor != nullptr);
 
@@ -75,6 +78,15 @@ std::shared_ptr<plateau::polygonMesh::Model> FPLATEAUModelReconstruct::ConvertMo
 
     std::shared_ptr<plateau::polygonMesh::Model> converted = std::make_shared<plateau::polygonMesh::Model>(Converter.convert(*smodel, ConvOption));
 
+    // テクスチャをアトラスに詰め、再生成時のマテリアルをアトラスごとに集約
+    if (TexturePackingResolution.IsSet()) {
+        FPLATEAUTextureAtlasOptions AtlasOptions;
+        AtlasOptions.PageSize = FPLATEAUTextureAtlas::GetPageSize(TexturePackingResolution.GetValue());
+        AtlasOptions.OutputDirectory = FPLATEAUTextureAtlas::GetDefaultOutputDirectory();
+        AtlasOptions.NamePrefix = GetTextureAtlasNamePrefix(*CityModelActor);
+        FPLATEAUTextureAtlas::Pack(*converted, AtlasOptions);
+    }
+
     ConvGranularity = OriginalGranularity;
 
     return converted;
@@ -86,6 +98,8 @@ TArray<USceneComponent*> FPLATEAUModelReconstruct::ReconstructFromConvertedModel
 }
 
 TArray<USceneComponent*> FPLATEAUModelReconstruct::ReconstructFromConvertedModelWithMeshLoader(FPLATEAUMeshLoaderForReconstruct& MeshLoader, std::shared_ptr<plateau::polygonMesh::Model> Model) {
+    MeshLoader.SetVertexFormat(VertexFormat);
+    MeshLoader.SetCollisionComplexity(CollisionComplexity);
     for (int i = 0; i < Model->getRootNodeCount(); i++) {
         MeshLoader.ReloadComponentFromNode(CityModelActor->GetRootComponent(), Model->getRootNodeAt(i), ConvGranularity, CityObjMap, *CityModelActor);
     }
@@ -107,6 +121,18 @@ ConvertGranularity FPLATEAUModelReconstruct::GetConvertGranularityFromReconstruc
     }
 }
 
+FString FPLATEAUModelReconstruct::GetTextureAtlasNamePrefix(const APLATEAUInstancedCityModel& CityModel) {
+#if WITH_EDITOR
+    return FString::Printf(TEXT("Atlas_%s"), *CityModel.GetActorGuid().ToString(EGuidFormats::Digits));
+#else
+    return FString::Printf(TEXT("Atlas_%s"), *CityModel.GetName());
+#endif
+}
+
+bool FPLATEAUModelReconstruct::IsValidReconstructType(const EPLATEAUMeshGranularity ReconstructType) {
+    return ReconstructType != EPLATEAUMeshGranularity::Auto;
+}
+
 void FPLATEAUModelReconstruct::GetChildrenGmlIds(const FPLATEAUCityObject CityObj, TSet<FString>& IdList) {
     for (auto child : CityObj.Children) {
         IdList.Add(child.GmlID);
@@ -0,0 +1,199 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#include "Reconstruct/PLATEAUTerrainMesher.h"
+#include "Async/ParallelFor.h"
+
+FPLATEAUTerrainMesher::FPLATEAUTerrainMesher(const int32 InSizeX, const int32 InSizeY, const uint16* InHeights, const double InHeightScale, const int32 InBlockSize)
+    : SizeX(InSizeX), SizeY(InSizeY), Heights(InHeights), HeightScale(InHeightScale) {
+    check(SizeX >= 2 && SizeY >= 2);
+
+    BlockSize = FMath::Max(2, static_cast<int32>(FMath::RoundUpToPowerOfTwo(FMath::Max(InBlockSize, 2))));
+    NumBlocksX = FMath::DivideAndRoundUp(SizeX - 1, BlockSize);
+    NumBlocksY = FMath::DivideAndRoundUp(SizeY - 1, BlockSize);
+    GridSizeX = NumBlocksX * BlockSize + 1;
+    GridSizeY = NumBlocksY * BlockSize + 1;
+    ComputeErrors();
+}
+
+int32 FPLATEAUTerrainMesher::GetAlignedChunkSize(const int32 ChunkSizeQuads) {
+    if (ChunkSizeQuads <= 0)
+        return 0;
+    return static_cast<int32>(FMath::RoundUpToPowerOfTwo(FMath::Max(ChunkSizeQuads, 2)));
+}
+
+float FPLATEAUTerrainMesher::ComputeTriangleError(const FIntPoint& A, const FIntPoint& B, const FIntPoint& C) const {
+    // 三角形内の全格子点について、頂点の高さから平面補間した高さとの差の最大値を求める
+    const int32 Area = (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+    const int32 Sign = Area > 0 ? 1 : -1;
+    const float HeightA = GetHeight(A.X, A.Y);
+    const float HeightB = GetHeight(B.X, B.Y);
+    const float HeightC = GetHeight(C.X, C.Y);
+    float Error = 0.0f;
+    for (int32 Y = FMath::Min3(A.Y, B.Y, C.Y); Y <= FMath::Max3(A.Y, B.Y, C.Y); ++Y) {
+        for (int32 X = FMath::Min3(A.X, B.X, C.X); X <= FMath::Max3(A.X, B.X, C.X); ++X) {
+            const int32 WeightA = (B.X - X) * (C.Y - Y) - (B.Y - Y) * (C.X - X);
+            const int32 WeightB = (C.X - X) * (A.Y - Y) - (C.Y - Y) * (A.X - X);
+            const int32 WeightC = Area - WeightA - WeightB;
+            if (WeightA * Sign < 0 || WeightB * Sign < 0 || WeightC * Sign < 0)
+                continue;
+            const float Interpolated = (WeightA * HeightA + WeightB * HeightB + WeightC * HeightC) / Area;
+            Error = FMath::Max(Error, FMath::Abs(Interpolated - GetHeight(X, Y)));
+        }
+    }
+    return Error;
+}
+
+void FPLATEAUTerrainMesher::ComputeErrors() {
+    Errors.SetNumZeroed(GridSizeX * GridSizeY);
+
+    const int32 LastX = SizeX - 1;
+    const int32 LastY = SizeY - 1;
+
+    // (X, Y)を斜辺の中点とする三角形の組は中心から各方向にStepの範囲を覆う。
+    // 範囲がハイトマップ内なら組の三角形の誤差、はみ出す場合は必ず分割、完全に外側なら分割不要とする
+    const auto ComputeError = [&](const int32 X, const int32 Y, const int32 Step, const FIntPoint& A, const FIntPoint& B) {
+        if (FMath::Min(X + Step, GridSizeX - 1) <= LastX && FMath::Min(Y + Step, GridSizeY - 1) <= LastY) {
+            // 直角の頂点は斜辺の中点からBを±90度回した位置
+            float Error = 0.0f;
+            for (const FIntPoint& C : { FIntPoint(X - (B.Y - Y), Y + (B.X - X)), FIntPoint(X + (B.Y - Y), Y - (B.X - X)) }) {
+                if (C.X >= 0 && C.X < GridSizeX && C.Y >= 0 && C.Y < GridSizeY)
+                    Error = FMath::Max(Error, ComputeTriangleError(A, B, C));
+            }
+            return Error;
+        }
+        if (X - Step >= LastX || Y - Step >= LastY)
+            return 0.0f;
+        return TNumericLimits<float>::Max();
+    };
+
+    // 細かい階層から順に、各点の誤差に子の三角形の分割点の誤差を含める。これにより親が分割されずに残るのは子孫も含めて許容誤差以内の場合に限られる。
+    // 同じ階層の点は互いに依存しないため行ごとに並列に計算する
+    for (int32 Step = 1; Step <= BlockSize / 2; Step *= 2) {
+        // 斜辺が軸に平行な三角形(斜辺の長さ 2 * Step)
+        ParallelFor((GridSizeY - 1) / Step + 1, [&, Step](const int32 Row) {
+            const int32 Y = Row * Step;
+            const bool bHorizontal = Row % 2 == 0;
+            for (int32 X = bHorizontal ? Step : 0; X < GridSizeX; X += 2 * Step) {
+                const FIntPoint A = bHorizontal ? FIntPoint(X - Step, Y) : FIntPoint(X, Y - Step);
+                const FIntPoint B = bHorizontal ? FIntPoint(X + Step, Y) : FIntPoint(X, Y + Step);
+                float Error = ComputeError(X, Y, Step, A, B);
+
+                // 子の三角形は1辺Stepの正方形の対角線を斜辺とする
+                if (Step > 1) {
+                    const int32 Half = Step / 2;
+                    for (const int32 ChildY : { Y - Half, Y + Half }) {
+                        for (const int32 ChildX : { X - Half, X + Half }) {
+                            if (ChildX >= 0 && ChildX < GridSizeX && ChildY >= 0 && ChildY < GridSizeY)
+                                Error = FMath::Max(Error, Errors[ChildY * GridSizeX + ChildX]);
+                        }
+                    }
+                }
+                Errors[Y * GridSizeX + X] = Error;
+            }
+        });
+
+        // 斜辺が1辺 2 * Step の正方形の対角線となる三角形。対角線の向きは正方形ごとに交互になる
+        const int32 NumSquaresX = (GridSizeX - 1) / (2 * Step);
+        ParallelFor((GridSizeY - 1) / (2 * Step), [&, Step, NumSquaresX](const int32 SquareY) {
+            const int32 Y = Step + SquareY * 2 * Step;
+            for (int32 SquareX = 0; SquareX < NumSquaresX; ++SquareX) {
+                const int32 X = Step + SquareX * 2 * Step;
+                const bool bMainDiagonal = (SquareX + SquareY) % 2 == 0;
+                const FIntPoint A(X - Step, bMainDiagonal ? Y - Step : Y + Step);
+                const FIntPoint B(X + Step, bMainDiagonal ? Y + Step : Y - Step);
+                float Error = ComputeError(X, Y, Step, A, B);
+
+                // 子の三角形は正方形の各辺を斜辺とする
+                Error = FMath::Max(Error, Errors[Y * GridSizeX + X - Step]);
+                Error = FMath::Max(Error, Errors[Y * GridSizeX + X + Step]);
+                Error = FMath::Max(Error, Errors[(Y - Step) * GridSizeX + X]);
+                Error = FMath::Max(Error, Errors[(Y + Step) * GridSizeX + X]);
+                Errors[Y * GridSizeX + X] = Error;
+            }
+        });
+    }
+}
+
+void FPLATEAUTerrainMesher::AddTriangles(const FIntPoint A, const FIntPoint B, const FIntPoint C, const float Threshold, TArray<FIntPoint>& OutTriangles) const {
+    // A, Bが斜辺、Cが直角の頂点
+    const FIntPoint M((A.X + B.X) / 2, (A.Y + B.Y) / 2);
+    if (FMath::Abs(A.X - C.X) + FMath::Abs(A.Y - C.Y) > 1 && GetError(M) > Threshold) {
+        AddTriangles(C, A, M, Threshold, OutTriangles);
+        AddTriangles(B, C, M, Threshold, OutTriangles);
+        return;
+    }
+
+    // ハイトマップの外の三角形は出力しない
+    if (FMath::Max3(A.X, B.X, C.X) > SizeX - 1 || FMath::Max3(A.Y, B.Y, C.Y) > SizeY - 1)
+        return;
+
+    // Cross(P0 - P2, P0 - P1)が+Zとなる順
+    const int32 Cross = (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+    OutTriangles.Add(A);
+    OutTriangles.Add(Cross < 0 ? B : C);
+    OutTriangles.Add(Cross < 0 ? C : B);
+}
+
+TArray<FPLATEAUTerrainMeshChunk> FPLATEAUTerrainMesher::Extract(const double MaxError, const int32 ChunkSizeQuads) const {
+    // 許容誤差を高さの値の単位に変換。高さの値の範囲を超える場合ははみ出したブロックの分割のみ行う
+    const float Threshold = HeightScale > 0.0
+        ? static_cast<float>(FMath::Clamp(MaxError / HeightScale, 0.0, static_cast<double>(MAX_uint16)))
+        : 0.0f;
+
+    TArray<TArray<FIntPoint>> BlockTriangles;
+    BlockTriangles.SetNum(NumBlocksX * NumBlocksY);
+    ParallelFor(BlockTriangles.Num(), [&](const int32 BlockIndex) {
+        const int32 BlockX = BlockIndex % NumBlocksX;
+        const int32 BlockY = BlockIndex / NumBlocksX;
+        const FIntPoint P0(BlockX * BlockSize, BlockY * BlockSize);
+        const FIntPoint P1 = P0 + FIntPoint(BlockSize, BlockSize);
+
+        // 隣接するブロックと対角線の向きを交互にすることで、ブロックの辺上の分割点を共有する
+        auto& Triangles = BlockTriangles[BlockIndex];
+        if ((BlockX + BlockY) % 2 == 0) {
+            AddTriangles(P0, P1, FIntPoint(P1.X, P0.Y), Threshold, Triangles);
+            AddTriangles(P1, P0, FIntPoint(P0.X, P1.Y), Threshold, Triangles);
+        } else {
+            AddTriangles(FIntPoint(P0.X, P1.Y), FIntPoint(P1.X, P0.Y), P0, Threshold, Triangles);
+            AddTriangles(FIntPoint(P1.X, P0.Y), FIntPoint(P0.X, P1.Y), P1, Threshold, Triangles);
+        }
+    });
+
+    // 三角形の重心の位置でチャンクに振り分け、チャンクごとに頂点を共有する
+    TArray<FPLATEAUTerrainMeshChunk> Chunks;
+    TMap<FIntPoint, int32> ChunkLookup;
+    TArray<TMap<FIntPoint, uint32>> VertexLookups;
+    for (const auto& Triangles : BlockTriangles) {
+        for (int32 i = 0; i + 2 < Triangles.Num(); i += 3) {
+            FIntPoint ChunkIndex = FIntPoint::ZeroValue;
+            if (ChunkSizeQuads > 0) {
+                const FIntPoint Sum = Triangles[i] + Triangles[i + 1] + Triangles[i + 2];
+                ChunkIndex = FIntPoint(Sum.X / (3 * ChunkSizeQuads), Sum.Y / (3 * ChunkSizeQuads));
+            }
+
+            int32 ChunkArrayIndex;
+            if (const auto Found = ChunkLookup.Find(ChunkIndex)) {
+                ChunkArrayIndex = *Found;
+            } else {
+                ChunkArrayIndex = Chunks.AddDefaulted();
+                Chunks[ChunkArrayIndex].ChunkIndex = ChunkIndex;
+                VertexLookups.AddDefaulted();
+                ChunkLookup.Add(ChunkIndex, ChunkArrayIndex);
+            }
+
+            auto& Chunk = Chunks[ChunkArrayIndex];
+            auto& VertexLookup = VertexLookups[ChunkArrayIndex];
+            for (int32 j = 0; j < 3; ++j) {
+                const FIntPoint& Vertex = Triangles[i + j];
+                if (const auto Found = VertexLookup.Find(Vertex)) {
+                    Chunk.Indices.Add(*Found);
+                    continue;
+                }
+                const uint32 VertexIndex = Chunk.Vertices.Add(Vertex);
+                VertexLookup.Add(Vertex, VertexIndex);
+                Chunk.Indices.Add(VertexIndex);
+            }
+        }
+    }
+    return Chunks;
+}
@@ -0,0 +1,119 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PLATEAUAttributeStore.generated.h"
+
+struct FPLATEAUAttributeMap;
+class UPLATEAUCityObjectGroup;
+
+/**
+ * @brief 属性条件の比較演算子です。
+ */
+UENUM(BlueprintType, Category = "PLATEAU|CityGML")
+enum class EPLATEAUAttributeOperator : uint8 {
+    Equal,
+    NotEqual,
+    Less,
+    LessOrEqual,
+    Greater,
+    GreaterOrEqual,
+    //! 属性を持つかどうかのみを判定
+    Exists
+};
+
+/**
+ * @brief 属性に対する条件です。
+ * 属性値と比較値がともに数値として解釈できる場合は数値として、それ以外は文字列として比較します。
+ */
+USTRUCT(BlueprintType, Category = "PLATEAU|CityGML")
+struct PLATEAURUNTIME_API FPLATEAUAttributeCondition {
+    GENERATED_BODY()
+
+    //! 属性キー。入れ子の属性は"親キー/子キー"のように指定
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|CityGML")
+    FString Key;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|CityGML")
+    EPLATEAUAttributeOperator Operator = EPLATEAUAttributeOperator::Equal;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|CityGML")
+    FString Value;
+};
+
+/**
+ * @brief 属性検索の結果です。
+ */
+USTRUCT(BlueprintType, Category = "PLATEAU|CityGML")
+struct PLATEAURUNTIME_API FPLATEAUAttributeQueryResult {
+    GENERATED_BODY()
+
+    //! 条件を満たす都市オブジェクトのGmlID
+    UPROPERTY(BlueprintReadOnly, Category = "PLATEAU|CityGML")
+    TSet<FString> GmlIDs;
+
+    //! 条件を満たす都市オブジェクトを含むコンポーネント
+    UPROPERTY(BlueprintReadOnly, Category = "PLATEAU|CityGML")
+    TSet<TObjectPtr<UPLATEAUCityObjectGroup>> Components;
+};
+
+/**
+ * @brief 3D都市モデル内の全ての都市オブジェクトの属性を、属性キーごとの列として保持して検索します。
+ * 行は(コンポーネント, 都市オブジェクト)の組で、列は入れ子の属性を"親キー/子キー"に展開したキーごとに作成されます。
+ * 列の値は辞書化されているため、条件は値の種類ごとに1度だけ評価され、行の判定は表の参照のみで行われます。
+ */
+class PLATEAURUNTIME_API FPLATEAUAttributeStore {
+public:
+    /**
+     * @brief コンポーネントが持つ都市オブジェクトから列を構築します。ゲームスレッドから呼び出してください。
+     */
+    void Build(const TArray<UPLATEAUCityObjectGroup*>& InComponents);
+
+    /**
+     * @brief 構築時から対象のコンポーネントが変わっていないかどうかを返します。
+     */
+    bool IsUpToDate(const TArray<UPLATEAUCityObjectGroup*>& InComponents) const;
+
+    /**
+     * @brief 全ての条件を満たす行を返します。条件が空の場合は全ての行を返します。
+     */
+    TBitArray<> Evaluate(const TArray<FPLATEAUAttributeCondition>& Conditions) const;
+
+    /**
+     * @brief 全ての条件を満たす都市オブジェクトのGmlIDとコンポーネントを返します。
+     */
+    FPLATEAUAttributeQueryResult Query(const TArray<FPLATEAUAttributeCondition>& Conditions) const;
+
+    int32 GetNumRows() const {
+        return RowGmlIDs.Num();
+    }
+
+    /**
+     * @brief 全ての属性キーを返します。
+     */
+    TArray<FString> GetKeys() const;
+
+private:
+    struct FColumn {
+        //! 値を持つ行(昇順)
+        TArray<int32> Rows;
+        //! 行ごとの値のDictionaryにおける要素番号
+        TArray<int32> ValueIds;
+        //! 値の種類
+        TArray<FString> Dictionary;
+        //! 値の種類ごとの数値(数値でない場合NaN)
+        TArray<double> DictionaryNumbers;
+        TMap<FString, int32> DictionaryIds;
+
+        void Add(const int32 Row, const FString& Value);
+    };
+
+    void AddAttributes(const int32 Row, const FPLATEAUAttributeMap& Attributes, const FString& KeyPrefix);
+    void EvaluateCondition(const FPLATEAUAttributeCondition& Condition, TBitArray<>& OutRows) const;
+
+    TArray<TWeakObjectPtr<UPLATEAUCityObjectGroup>> Components;
+    TArray<int32> RowComponents;
+    TArray<FString> RowGmlIDs;
+    TMap<FString, FColumn> Columns;
+};
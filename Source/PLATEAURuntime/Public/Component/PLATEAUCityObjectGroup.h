@@ -9,6 +9,8 @@
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "PLATEAUComponentInterface.h"
+#include "PLATEAUImportSettings.h"
+#include "Interface_CollisionDataProvider.h"
 #include "PLATEAUCityObjectGroup.generated.h"
 
 namespace plateau::CityObjectGroup {
@@ -36,19 +38,31 @@ namespace citygml {
 
 struct FPLATEAUCityObject;
 struct FLoadInputData;
+class UTexture2D;
+class UBodySetup;
 
 
 UCLASS()
-class PLATEAURUNTIME_API UPLATEAUCityObjectGroup : public UStaticMeshComponent , public IPLATEAUComponentInterface{
+class PLATEAURUNTIME_API UPLATEAUCityObjectGroup : public UStaticMeshComponent , public IPLATEAUComponentInterface, public IInterface_CollisionDataProvider{
     GENERATED_BODY()
 public:
     /**
      * @brief レイキャストヒットした位置のUVを取得
      * @param HitResult レイキャストヒット結果
      * @param UV 取得したい位置のUV
-     * @param UVChannel 対象のUVチャンネル
+     * @param UVChannel 対象のUVチャンネル。INDEX_NONEの場合は都市オブジェクトインデックスを格納するUVチャンネル
      */
-    static void FindCollisionUV(const FHitResult& HitResult, FVector2D& UV, const int32 UVChannel = 3);
+    static void FindCollisionUV(const FHitResult& HitResult, FVector2D& UV, const int32 UVChannel = INDEX_NONE);
+
+    /**
+     * @brief 都市オブジェクトインデックスを格納するUVチャンネルを取得します。
+     * インデックスは頂点レイアウトによらず最後のUVチャンネルに格納されます(標準: UV4, コンパクト: UV2)。
+     * @param NumUVChannels メッシュのUVチャンネル数
+     * @return インデックスを格納するUVチャンネルが無い場合INDEX_NONE
+     */
+    static int32 GetCityObjectIndexUVChannel(const int32 NumUVChannels) {
+        return NumUVChannels >= 2 ? NumUVChannels - 1 : INDEX_NONE;
+    }
     
     /**
      * @brief メッシュを持たないがCityObjectを持つノードをシリアライズ
@@ -66,6 +80,24 @@ public:
      */
     void SerializeCityObject(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const FLoadInputData& InLoadInputData, std::shared_ptr<const citygml::CityModel> InCityModel);
 
+    /**
+     * @brief メッシュを持たないがCityObjectを持つノードのシリアライズ結果を作成します。
+     * コンポーネントに依存しないため、ワーカースレッドから呼び出せます。結果はSetSerializedCityObjectsで設定します。
+     */
+    static FString CreateSerializedCityObjects(const plateau::polygonMesh::Node& InNode, const citygml::CityObject* InCityObject);
+
+    /**
+     * @brief メッシュを持つノードのシリアライズ結果を作成します。
+     * コンポーネントに依存しないため、ワーカースレッドから呼び出せます。結果はSetSerializedCityObjectsで設定します。
+     */
+    static FString CreateSerializedCityObjects(const std::string& InNodeName, const plateau::polygonMesh::Mesh& InMesh,
+                                               const plateau::polygonMesh::MeshGranularity Granularity, std::shared_ptr<const citygml::CityModel> InCityModel);
+
+    /**
+     * @brief CreateSerializedCityObjectsで作成したシリアライズ結果を設定します。
+     */
+    void SetSerializedCityObjects(FString&& InSerializedCityObjects, const plateau::polygonMesh::MeshGranularity& Granularity);
+
     /**
      * @brief 結合・分割時のメッシュを持たないノードをシリアライズ
      * @param InNode シリアライズ対象ノード
@@ -88,8 +120,28 @@ public:
      * @brief MeshGranularity取得Getter
      */
     const plateau::granularityConvert::ConvertGranularity GetConvertGranularity();
+
+    /**
+     * @brief StaticMeshのUVチャンネル数から頂点レイアウトを取得します。
+     */
+    EPLATEAUVertexFormat GetVertexFormat() const;
     void SetConvertGranularity(const plateau::granularityConvert::ConvertGranularity Granularity);
 
+    /**
+     * @brief 複雑コリジョンの三角形ごとの都市オブジェクトインデックス表をStaticMeshのUVから構築します。
+     * レイキャストのFaceIndexから都市オブジェクトを特定する際に使用され、"Support UV From Hit Results"を必要としません。
+     * StaticMeshの描画データをCPUから参照できない場合は構築できません。
+     * @return 構築できた場合true
+     */
+    bool UpdateTriangleCityObjectIndices();
+
+    /**
+     * @brief レイキャストヒットした三角形の都市オブジェクトインデックスを取得します。
+     * 三角形ごとのインデックス表が無い場合はFindCollisionUVで取得します。
+     * @return 取得できた場合true
+     */
+    bool FindCityObjectIndexByRaycast(const FHitResult& HitResult, FPLATEAUCityObjectIndex& OutIndex);
+
     UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
     FPLATEAUCityObject GetPrimaryCityObjectByRaycast(const FHitResult& HitResult);
 
@@ -120,8 +172,109 @@ public:
     UPROPERTY(BlueprintReadOnly, Category = "PLATEAU")
     int MeshGranularityIntValue;
 
+    /**
+     * @brief インポート時のパッケージごとのコリジョンの種類です。結合・分割等でメッシュを再生成する際に引き継がれます。
+     */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+    EPLATEAUCollisionComplexity CollisionComplexity = EPLATEAUCollisionComplexity::Complex;
+
+    /**
+     * @brief 都市オブジェクトごとのルックアップ値(RGB: 分類色, A: 可視性)を更新し、ルックアップマテリアルを適用します。
+     * メッシュは再構築せず、UV4の都市オブジェクトインデックスで参照されるテクスチャのみを書き換えます。
+     * @param UpdateFunc 都市オブジェクトごとに呼ばれ、ルックアップ値を書き換える関数
+     * @return ルックアップマテリアルを適用できた場合true
+     */
+    bool UpdateCityObjectLookup(TFunctionRef<void(const FPLATEAUCityObject& CityObject, FColor& LookupValue)> UpdateFunc);
+
+    /**
+     * @brief ルックアップ値の分類色で描画するかどうかを設定します。falseの場合は元のテクスチャ、基本色で描画されます。
+     */
+    void SetCityObjectClassColorEnabled(const bool bEnabled);
+
+    bool IsCityObjectClassColorEnabled() const {
+        return bCityObjectClassColorEnabled;
+    }
+
+    /**
+     * @brief 結合されたメッシュ内の都市オブジェクトごとに可視性を設定します。
+     * 非表示の都市オブジェクトはルックアップテクスチャの可視性によって描画されず、複雑コリジョンからも除外されます。
+     * メッシュは再構築されません。
+     * @param bKeepHidden trueの場合、既に非表示の都市オブジェクトは非表示のままとし、絞り込みを重ねます。
+     * @return 可視の都市オブジェクトが存在する場合true
+     */
+    bool SetCityObjectVisibility(TFunctionRef<bool(const FPLATEAUCityObject& CityObject)> IsVisible, const bool bKeepHidden = false);
+
+    /**
+     * @brief SetCityObjectVisibilityにより非表示になっている都市オブジェクトが存在するかどうかを返します。
+     */
+    bool HasHiddenCityObjects() const;
+
+    /**
+     * @brief ルックアップを破棄し、元のマテリアルに戻します。
+     */
+    void ResetCityObjectLookup();
+
+    bool HasCityObjectLookup() const {
+        return CityObjectLookupPixels.Num() > 0;
+    }
+
+    virtual void OnRegister() override;
+    virtual UBodySetup* GetBodySetup() override;
+
+    //~ Begin IInterface_CollisionDataProvider Interface
+    virtual bool GetPhysicsTriMeshData(struct FTriMeshCollisionData* CollisionData, bool InUseAllTriData) override;
+    virtual bool ContainsPhysicsTriMeshData(bool InUseAllTriData) const override;
+    virtual bool WantsNegXTriMesh() override {
+        return false;
+    }
+    //~ End IInterface_CollisionDataProvider Interface
+
 private:
     TArray<FPLATEAUCityObject> RootCityObjects;
+
+    //! ルックアップテクスチャの内容。テクスチャ自体は保存されないため、読み込み時にこれから再生成します。
+    UPROPERTY()
+    TArray<FColor> CityObjectLookupPixels;
+
+    UPROPERTY()
+    FIntPoint CityObjectLookupSize = FIntPoint::ZeroValue;
+
+    UPROPERTY()
+    bool bCityObjectClassColorEnabled = false;
+
+    //! ルックアップマテリアル適用前のマテリアル
+    UPROPERTY()
+    TArray<TObjectPtr<UMaterialInterface>> CityObjectLookupOriginalMaterials;
+
+    UPROPERTY(Transient)
+    TObjectPtr<UTexture2D> CityObjectLookupTexture;
+
+    //! 複雑コリジョンの三角形ごとの、TriangleCityObjectIndexPaletteの要素番号
+    UPROPERTY()
+    TArray<int32> TriangleCityObjectSlots;
+
+    //! 三角形が参照する都市オブジェクトインデックス
+    UPROPERTY()
+    TArray<FPLATEAUCityObjectIndex> TriangleCityObjectIndexPalette;
+
+    //! CityObjectFilterBodySetupの三角形ごとの、StaticMeshのコリジョンにおける三角形番号
+    TArray<int32> CityObjectFilterFaceMap;
+
+    //! クッキング中のコリジョンの三角形ごとの、StaticMeshのコリジョンにおける三角形番号
+    TArray<int32> PendingCityObjectFilterFaceMap;
+
+    //! 非表示の都市オブジェクトを除いた複雑コリジョン。非表示の都市オブジェクトが無い場合はStaticMeshのものを使用します。
+    UPROPERTY(Transient)
+    TObjectPtr<UBodySetup> CityObjectFilterBodySetup;
+
+    //! クッキング中のコリジョン。完了時にCityObjectFilterBodySetupと置き換えます。
+    UPROPERTY(Transient)
+    TObjectPtr<UBodySetup> PendingCityObjectFilterBodySetup;
+
+    bool ApplyCityObjectLookupMaterials();
+    bool IsCityObjectHidden(const FVector2D& CityObjectIndexUV) const;
+    bool IsCityObjectHidden(const FPLATEAUCityObjectIndex& Index) const;
+    void UpdateCityObjectFilterCollision();
     void SetMeshGranularity(const plateau::polygonMesh::MeshGranularity Granularity);
     void SerializeCityObjectInner(const FString& InNodeName, const plateau::polygonMesh::Mesh& InMesh, const plateau::polygonMesh::MeshGranularity& Granularity, TMap<FString, FPLATEAUCityObject> CityObjMap);
 };
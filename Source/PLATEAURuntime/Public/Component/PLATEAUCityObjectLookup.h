@@ -0,0 +1,64 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPLATEAUCityObjectIndex;
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+class UTexture2D;
+
+/**
+ * @brief UVに格納された都市オブジェクトインデックスで参照するルックアップテクスチャと、それを描画する共有マテリアルを扱います。
+ * ルックアップテクスチャは(AtomicIndex + 1, PrimaryIndex)のテクセルにRGB: 分類色、A: 可視性を格納します。
+ * AtomicIndex = -1 は主要地物自身を表すため、テクスチャの0列目が主要地物に対応します。
+ */
+class PLATEAURUNTIME_API FPLATEAUCityObjectLookup {
+public:
+    //! ルックアップテクスチャのマテリアルパラメータ名
+    static const FName LookupTextureParameterName;
+    //! ルックアップテクスチャのサイズ(X: 幅, Y: 高さ)のマテリアルパラメータ名
+    static const FName LookupSizeParameterName;
+    //! 分類色の適用度合い(0: 元の色, 1: 分類色)のマテリアルパラメータ名
+    static const FName ClassColorWeightParameterName;
+
+    //! 共有マテリアルのアセットパス(プラグインのコンテンツ)
+    static const FString BaseMaterialPackageName;
+
+    /**
+     * @brief ルックアップテクスチャを参照する共有マテリアルを取得します。
+     * エディタではプラグインのコンテンツにアセットが存在しない場合、保存しない一時的なマテリアルを生成します。
+     * @param UVChannel 都市オブジェクトインデックスを格納するUVチャンネル。UV4以外の場合はチャンネルごとに別のアセットを使用
+     * @return マテリアルが存在せず生成もできない場合nullptr
+     */
+    static UMaterialInterface* GetBaseMaterial(const int32 UVChannel = 3);
+
+    /**
+     * @brief 元のマテリアルに対応する、ルックアップテクスチャを参照するマテリアルを生成します。
+     * ルックアップテクスチャのパラメータを持つマテリアルは元のマテリアルのインスタンスとし、
+     * SDKの既定マテリアルはテクスチャ、基本色を引き継いで共有マテリアルのインスタンスとします。
+     * @param Original 元のマテリアル(nullptr可)
+     * @param UVChannel 都市オブジェクトインデックスを格納するUVチャンネル
+     * @param Outer 生成するマテリアルのOuter
+     * @return ユーザー指定やFallback等、ルックアップに対応しないマテリアルの場合nullptr
+     */
+    static UMaterialInstanceDynamic* CreateMaterial(UMaterialInterface* Original, const int32 UVChannel, UObject* Outer);
+
+    /**
+     * @brief 都市オブジェクトインデックスに対応するテクセル座標を取得します。
+     * @return インデックスが範囲外の場合false
+     */
+    static bool TryGetTexel(const FPLATEAUCityObjectIndex& Index, FIntPoint& OutTexel);
+
+    /**
+     * @brief ルックアップテクスチャの内容を更新します。
+     * サイズが一致する既存テクスチャはテクセルのみ書き換え、それ以外の場合は新しいテクスチャを生成します。
+     * @param Texture 既存のルックアップテクスチャ(nullptr可)
+     * @param Size テクスチャサイズ
+     * @param Pixels Size.X * Size.Y 個のテクセル値
+     * @param Outer 新しく生成するテクスチャのOuter
+     * @return 更新後のテクスチャ。サイズが上限を超える場合nullptr
+     */
+    static UTexture2D* UpdateTexture(UTexture2D* Texture, const FIntPoint& Size, const TArray<FColor>& Pixels, UObject* Outer);
+};
@@ -0,0 +1,110 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace plateau::dataset {
+    enum class PredefinedCityModelPackage : uint32_t;
+}
+
+class IFileHandle;
+
+/**
+ * @brief zip形式で配布されたデータセットを展開せずに読み込みます。
+ * アーカイブ内のファイルは"{zipファイルのパス}/{アーカイブ内のパス}"形式の仮想パスで表されます。
+ * 無圧縮およびDeflate形式(ZIP64を含む)のエントリに対応します。
+ */
+class PLATEAURUNTIME_API FPLATEAUDatasetArchive {
+public:
+    explicit FPLATEAUDatasetArchive(const FString& InArchivePath);
+    ~FPLATEAUDatasetArchive();
+
+    /**
+     * @brief パスがzipファイル、またはzipファイル内の仮想パスかどうかを返します。
+     */
+    static bool IsArchivePath(const FString& Path);
+
+    /**
+     * @brief 仮想パスをzipファイルのパスとアーカイブ内のパスに分割します。
+     * @return 仮想パスでない場合false
+     */
+    static bool SplitVirtualPath(const FString& VirtualPath, FString& OutArchivePath, FString& OutEntryName);
+
+    /**
+     * @brief zipファイルに対応するアーカイブを取得します。初回呼び出し時にzipファイルを開きます。
+     * @return zipファイルを開けない場合nullptr
+     */
+    static TSharedPtr<FPLATEAUDatasetArchive> Get(const FString& ArchivePath);
+
+    /**
+     * @brief zipファイルに対応するアーカイブをキャッシュから取り除きます。他で参照されていない場合はzipファイルを閉じます。
+     */
+    static void Release(const FString& ArchivePath);
+
+    /**
+     * @brief 仮想パスまたは通常のファイルパスからファイル内容を読み込みます。
+     */
+    static bool LoadFileToArray(const FString& Path, TArray<uint8>& OutData);
+    static bool LoadFileToArray(const FString& Path, TArray64<uint8>& OutData);
+
+    /**
+     * @brief 仮想パスまたは通常のファイルパスのファイルサイズを返します。仮想パスの場合は展開後のサイズを返します。
+     * @return ファイルが存在しない場合-1
+     */
+    static int64 GetFileSize(const FString& Path);
+
+    bool IsValid() const;
+
+    const FString& GetArchivePath() const {
+        return ArchivePath;
+    }
+
+    /**
+     * @brief アーカイブ内のGMLファイルのうち、メッシュコードおよびパッケージが一致するものの仮想パスを返します。
+     * GMLファイルのメッシュコードが指定メッシュコードを含む場合、または指定メッシュコードに含まれる場合に一致とみなします。
+     */
+    TArray<FString> FindGmlFiles(const TArray<FString>& MeshCodes, plateau::dataset::PredefinedCityModelPackage Package) const;
+
+    /**
+     * @brief アーカイブ内のGMLファイルに含まれる全てのメッシュコードを返します。
+     */
+    TSet<FString> GetMeshCodes() const;
+
+    /**
+     * @brief アーカイブ内のパスの末尾が一致するファイルの仮想パスを返します。見つからない場合は空文字列を返します。
+     */
+    FString FindFileBySuffix(const FString& Suffix) const;
+
+    /**
+     * @brief アーカイブ内のファイルを読み込みます。圧縮データの読み込みのみ排他し、展開は並列に行われます。
+     */
+    bool ReadFile(const FString& EntryName, TArray<uint8>& OutData) const;
+    bool ReadFile(const FString& EntryName, TArray64<uint8>& OutData) const;
+
+    /**
+     * @brief アーカイブ内のファイルの展開後のサイズを返します。存在しない場合-1を返します。
+     */
+    int64 GetEntrySize(const FString& EntryName) const;
+
+private:
+    /**
+     * @brief セントラルディレクトリに記録されたエントリの情報です。
+     */
+    struct FEntry {
+        uint16 CompressionMethod = 0;
+        int64 CompressedSize = 0;
+        int64 UncompressedSize = 0;
+        int64 LocalHeaderOffset = 0;
+    };
+
+    FString ArchivePath;
+    TArray<FString> EntryNames;
+    TMap<FString, FEntry> Entries;
+    TUniquePtr<IFileHandle> FileHandle;
+    mutable FCriticalSection FileHandleSection;
+
+    bool ReadCentralDirectory();
+    bool ReadEntry(const FString& EntryName, TFunctionRef<uint8*(int64 Size)> Allocate) const;
+    FString MakeVirtualPath(const FString& EntryName) const;
+};
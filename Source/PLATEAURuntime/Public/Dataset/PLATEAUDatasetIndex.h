@@ -0,0 +1,68 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+namespace plateau::dataset {
+    class GmlFile;
+}
+
+/**
+ * @brief データセットインデックスに記録されるGMLファイル1件分の情報です。
+ */
+struct FPLATEAUDatasetIndexEntry {
+    FString MeshCode;
+    uint32 Package = 0;
+    //! 未計算の場合は-1
+    int MaxLod = -1;
+    int64 FileSize = -1;
+    FDateTime ModificationTime;
+};
+
+/**
+ * @brief ローカルデータセットのGMLファイル情報(メッシュコード、パッケージ、最大LOD、ファイルサイズ、更新日時)をディスク上にキャッシュします。
+ * GMLファイルのサイズまたは更新日時が変化した場合、そのファイルの情報のみ再計算されます。
+ * キャッシュはProjectSavedDir()/PLATEAU/DatasetIndex以下にデータセットごとに保存されます。
+ */
+class PLATEAURUNTIME_API FPLATEAUDatasetIndex {
+public:
+    explicit FPLATEAUDatasetIndex(const FString& InSourcePath);
+
+    /**
+     * @brief データセットのルートパスに対応するインデックスを取得します。初回呼び出し時にディスクから読み込まれます。
+     */
+    static TSharedRef<FPLATEAUDatasetIndex> Get(const FString& SourcePath);
+
+    /**
+     * @brief GMLファイルの最大LODを取得します。キャッシュが有効な場合はGMLファイルを読み込みません。
+     */
+    int GetMaxLod(plateau::dataset::GmlFile& GmlFile);
+
+    /**
+     * @brief キャッシュ済みの最大LODを取得します。GMLファイルが更新されている、または未計算の場合はfalseを返します。
+     */
+    bool TryGetCachedMaxLod(const FString& GmlPath, int& OutMaxLod) const;
+
+    /**
+     * @brief GMLファイルの情報をインデックスに記録します。最大LODは更新されません。
+     */
+    void Register(const plateau::dataset::GmlFile& GmlFile);
+
+    /**
+     * @brief 変更がある場合、インデックスをディスクに書き出します。
+     */
+    void Save();
+
+private:
+    FString SourcePath;
+    FString IndexFilePath;
+    TMap<FString, FPLATEAUDatasetIndexEntry> Entries;
+    bool bDirty;
+    mutable FCriticalSection EntriesSection;
+
+    static FString NormalizePath(const FString& Path);
+    static bool IsUpToDate(const FPLATEAUDatasetIndexEntry& Entry, const FFileStatData& StatData);
+    void Load();
+};
@@ -0,0 +1,31 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <memory>
+
+namespace citygml {
+    class CityModel;
+    class ParserParams;
+    class CityGMLLogger;
+}
+
+/**
+ * @brief CityGMLファイルをパスの種類に応じた方法で読み込みます。
+ * zipアーカイブ内の仮想パスはメモリ上に展開して、一定サイズ以上の通常ファイルはメモリマップして読み込みます。
+ * いずれの場合もCityModelのGMLパスには引数のパスが設定されるため、テクスチャパスは元の位置を基準に解決されます。
+ */
+class PLATEAURUNTIME_API FPLATEAUGmlReader {
+public:
+    /**
+     * @brief CityGMLファイルを読み込みます。失敗した場合はcitygml::loadと同様に例外を送出するかnullptrを返します。
+     */
+    static std::shared_ptr<const citygml::CityModel> Load(
+        const FString& GmlPath, const citygml::ParserParams& Params,
+        const std::shared_ptr<citygml::CityGMLLogger>& Logger = nullptr);
+
+    //! このサイズ以上のGMLファイルはメモリマップして読み込みます
+    static constexpr int64 MemoryMapThresholdBytes = 16 * 1024 * 1024;
+};
@@ -0,0 +1,56 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace citygml {
+    class CityModel;
+}
+
+namespace plateau::polygonMesh {
+    struct MeshExtractOptions;
+}
+
+/**
+ * @brief 自動粒度で目標とする描画コストです。
+ */
+struct FPLATEAUAutoGranularityBudget {
+    //! GMLファイル1つあたりのメッシュ数(ドローコール数)の上限
+    int32 MaxDrawCalls = 2000;
+    //! 地域単位で結合する場合のメッシュ1つあたりの三角形数の目安
+    int32 MaxTrianglesPerMesh = 65536;
+};
+
+/**
+ * @brief パース済みCityModelから集計した、粒度ごとのメッシュ数と三角形数です。
+ * メッシュ数は抽出対象のLODごとに別メッシュとなることを考慮した値です。
+ */
+struct FPLATEAUCityModelMeshStats {
+    //! 最小地物単位で抽出した場合のメッシュ数
+    int64 AtomicMeshCount = 0;
+    //! 主要地物単位で抽出した場合のメッシュ数
+    int64 PrimaryMeshCount = 0;
+    //! 抽出対象の三角形数
+    int64 TriangleCount = 0;
+    //! ジオメトリを含むLODの数
+    int32 LodCount = 0;
+};
+
+/**
+ * @brief GMLファイルごとに、描画コストの目安からメッシュ抽出の粒度と地域単位のグリッド分割数を決定します。
+ * 目標ドローコール数に収まる粒度のうち最も細かいものを選び、収まらない場合は三角形数に応じて分割した地域単位とします。
+ */
+class PLATEAURUNTIME_API FPLATEAUAutoGranularity {
+public:
+    /**
+     * @brief CityModelのうちMinLod～MaxLodのジオメトリについて、粒度ごとのメッシュ数と三角形数を集計します。
+     */
+    static FPLATEAUCityModelMeshStats CountMeshes(const citygml::CityModel& CityModel, const int32 MinLod, const int32 MaxLod);
+
+    /**
+     * @brief 集計結果と目標からExtractOptionsのmesh_granularity, grid_count_of_sideを設定します。
+     */
+    static void Resolve(const FPLATEAUCityModelMeshStats& Stats, const FPLATEAUAutoGranularityBudget& Budget,
+                        plateau::polygonMesh::MeshExtractOptions& OutExtractOptions);
+};
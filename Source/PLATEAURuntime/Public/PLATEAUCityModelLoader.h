@@ -8,6 +8,8 @@
 #include "GameFramework/Actor.h"
 #include "PLATEAUGeometry.h"
 #include "PLATEAUImportSettings.h"
+#include "PLATEAUImportStats.h"
+#include "PLATEAUAutoGranularity.h"
 #include <plateau/network/client.h>
 
 #include "PLATEAUCityModelLoader.generated.h"
@@ -24,6 +26,9 @@ namespace citygml {
 }
 
 class FPLATEAUMeshLoader;
+class FPLATEAUMaterialCache;
+class FPLATEAUAbandonedTasks;
+class APLATEAUInstancedCityModel;
 enum class MeshGranularity;
 struct FLoadInputData {
     plateau::polygonMesh::MeshExtractOptions ExtractOptions;
@@ -31,6 +36,21 @@ struct FLoadInputData {
     FString GmlPath;
     bool bIncludeAttrInfo;
     UMaterialInterface* FallbackMaterial;
+    EPLATEAUCollisionComplexity CollisionComplexity = EPLATEAUCollisionComplexity::Complex;
+    bool bDeferCollisionCooking = false;
+    EPLATEAUVertexFormat VertexFormat = EPLATEAUVertexFormat::Standard;
+    //! 計測値の記録先(nullptrの場合は記録しない)
+    TSharedPtr<FPLATEAUGmlLoadStats> LoadStats;
+    //! 読み込み先の3D都市モデルで共有するマテリアル、テクスチャ(nullptrの場合は共有しない)
+    TSharedPtr<FPLATEAUMaterialCache> MaterialCache;
+    //! trueの場合、既存のテクスチャアセットを上書きせずに使い回す
+    bool bReuseExistingTextures = false;
+    //! 設定されている場合、パース後にExtractOptionsの粒度とグリッド分割数を自動決定する
+    TOptional<FPLATEAUAutoGranularityBudget> AutoGranularityBudget;
+    //! 設定されている場合、同じ座標の頂点を共有し、面の角度差がこの値(度)を超える箇所で法線を分割する
+    TOptional<float> WeldCreaseAngle;
+    //! 設定されている場合、抽出後にテクスチャをこの大きさ(ピクセル)以下のアトラスに詰める
+    TOptional<int32> TexturePackingPageSize;
 };
 
 UENUM(BlueprintType)
@@ -53,6 +73,22 @@ enum class ECityModelLoadingPhase : uint8 {
     Finished = 3
 };
 
+/**
+ * @brief インポート時に3D都市モデルアクタを分割する単位を表します。
+ * 分割されたアクタはWorld Partitionのストリーミング対象となります。
+ */
+UENUM(BlueprintType)
+enum class EPLATEAUCityModelSplitMode : uint8 {
+    //! 分割しない(全GMLを1つのアクタに格納)
+    None = 0,
+    //! GMLファイルごと
+    PerGml = 1,
+    //! 2次メッシュごと
+    PerSecondMeshCode = 2,
+    //! 3次メッシュごと
+    PerThirdMeshCode = 3
+};
+
 namespace plateau::udx {
     enum class PredefinedCityModelPackage : uint32_t;
 }
@@ -74,6 +110,25 @@ public:
     UPROPERTY(EditAnywhere, Category = "PLATEAU")
         TArray<FString> FailedGmls;
 
+    /**
+     * @brief 読み込みが完了したGMLごとの段階別所要時間、三角形数、テクスチャサイズ、ピークメモリです。
+     */
+    UPROPERTY(VisibleAnywhere, Category = "PLATEAU")
+        TArray<FPLATEAUGmlLoadReport> GmlReports;
+
+    /**
+     * @brief 計測結果の出力先(拡張子無し)です。LoadAsync完了時に.csvと.jsonが出力されます。
+     */
+    UPROPERTY(VisibleAnywhere, Category = "PLATEAU")
+        FString ReportPath;
+
+    /**
+     * @brief キャンセルにより結果を破棄したが、LoadAsync完了時点でまだ実行中のパース、メッシュ抽出処理の数です。
+     * これらの処理は低優先度の専用スレッドで実行され、次回のLoadAsyncは同じGMLファイルを読み込む場合のみ終了を待ちます。
+     */
+    UPROPERTY(VisibleAnywhere, Category = "PLATEAU")
+        int AbandonedTaskCount = 0;
+
 };
 
 UCLASS()
@@ -105,9 +160,37 @@ public:
     UPROPERTY(EditAnywhere, Category = "PLATEAU")
         bool bImportFromServer;
 
+    /**
+     * @brief ローカルからのインポート時にGMLファイルをContent/PLATEAU/Datasetsにコピーするかどうかを指定します。
+     * falseの場合はインポート元のファイルを直接読み込みます。Sourceがzipファイルの場合は常にコピーしません。
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+        bool bCopyGmlFiles = true;
+
     UPROPERTY(EditAnywhere, Category = "PLATEAU")
         ECityModelLoadingPhase Phase;
 
+    /**
+     * @brief 3D都市モデルアクタの分割単位を指定します。None以外の場合、分割単位ごとにアクタを生成します。
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+        EPLATEAUCityModelSplitMode SplitMode = EPLATEAUCityModelSplitMode::None;
+
+    /**
+     * @brief 分割されたアクタを配置するWorld Partitionのランタイムグリッド名を指定します。空の場合はデフォルトのグリッドに配置されます。
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+        FName RuntimeGrid;
+
+    /**
+     * @brief 追加インポートの対象となる既存の3D都市モデルアクタを指定します。
+     * 指定した場合は新規アクタを生成せず、MeshCodesおよびインポート設定と既存のGMLファイルの差分のみを読み込み、
+     * インポート対象のパッケージのうちMeshCodesの範囲外となったGMLファイルのコンポーネントを破棄します。対象外のパッケージのGMLファイルは維持されます。
+     * SplitModeとGeoReferenceは無視され(SplitModeを指定した場合は警告を出力します)、対象アクタの基準点が使用されます。
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+        TObjectPtr<APLATEAUInstancedCityModel> TargetCityModel;
+
     UPROPERTY(BlueprintAssignable, Category = "PLATEAU")
         FImportGmlFilesDelegate ImportGmlFilesDelegate;
 
@@ -139,11 +222,15 @@ public:
 protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
+    virtual void BeginDestroy() override;
 
     TAtomic<bool> bCanceled;
 
     FCriticalSection LoadMeshSection;
 
+    //! キャンセル時に完了を待たずに結果を破棄した処理。次回のLoadAsyncでは同じGMLファイルを読み込む前にのみ終了を待つ
+    TSharedPtr<FPLATEAUAbandonedTasks> AbandonedTasks;
+
 public:
     // Called every frame
     virtual void Tick(float DeltaTime) override;
@@ -66,6 +66,31 @@ public:
     plateau::geometry::GeoReference& GetData();
     void UpdateNativeData();
 
+    /**
+     * @brief 緯度・経度・高さの配列を平面直角座標系(座標軸変換を含む)へ一括変換します。
+     * 要素数が多い場合は複数スレッドで処理します。
+     * @param OutPoints InCoordinatesと同じ要素数の出力先
+     */
+    void ProjectBatch(TConstArrayView<FPLATEAUGeoCoordinate> InCoordinates, TArrayView<FVector> OutPoints);
+
+    /**
+     * @brief 平面直角座標系の座標の配列を緯度・経度・高さへ一括変換します。
+     * 要素数が多い場合は複数スレッドで処理します。
+     * @param OutCoordinates InPointsと同じ要素数の出力先
+     */
+    void UnprojectBatch(TConstArrayView<FVector> InPoints, TArrayView<FPLATEAUGeoCoordinate> OutCoordinates);
+
+    /**
+     * @brief 頂点座標の座標軸を一括変換します。各頂点には Offset加算 → 座標軸変換 → Scale倍 の順に適用されます。
+     * 座標軸変換は軸の入れ替えと符号反転のみのため、変換行列を一度だけ求めて全頂点に適用します。
+     * 要素数が多い場合は複数スレッドで処理します。
+     * @param OutPoints InPointsと同じ要素数の出力先
+     */
+    static void ConvertAxisBatch(
+        const plateau::geometry::CoordinateSystem From, const plateau::geometry::CoordinateSystem To,
+        TConstArrayView<FVector3f> InPoints, TArrayView<FVector3d> OutPoints,
+        const FVector3d& Offset = FVector3d::ZeroVector, const double Scale = 1.0);
+
 private:
     friend class UPLATEAUGeoReferenceBlueprintLibrary;
 
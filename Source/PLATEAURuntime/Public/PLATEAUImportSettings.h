@@ -26,6 +26,8 @@ enum class EPLATEAUMeshGranularity : uint8 {
     PerPrimaryFeatureObject = 2,
     //! 都市モデル地域単位(GMLファイル内のすべてを結合)
     PerCityModelArea = 3,
+    //! GMLファイルごとに描画コストの目安から自動決定(インポート時のみ)
+    Auto = 4,
     //! 変更しない
     DoNotChange = 1000
 };
@@ -37,6 +39,30 @@ enum class EPLATEAUTexturePackingResolution : uint8 {
     H8192W8192 = 2 UMETA(DisplayName = "8192x8192")
 };
 
+/**
+ * @brief インポート時に生成するコリジョンの種類を表します。
+ */
+UENUM(BlueprintType)
+enum class EPLATEAUCollisionComplexity : uint8 {
+    //! コリジョンを生成しない
+    None = 0,
+    //! メッシュのバウンディングボックスを単純コリジョンとして使用(レイキャストによる属性情報取得は不可)
+    Simple = 1,
+    //! メッシュ形状をそのままコリジョンとして使用
+    Complex = 2
+};
+
+/**
+ * @brief インポート時に生成するメッシュの頂点レイアウトを表します。
+ */
+UENUM(BlueprintType)
+enum class EPLATEAUVertexFormat : uint8 {
+    //! UV1にテクスチャ座標、UV4に都市オブジェクトのインデックスを格納(UV2, UV3は未使用)
+    Standard = 0,
+    //! UV1にテクスチャ座標、UV2に都市オブジェクトのインデックスを格納し、未使用のUVチャンネルを持たない
+    Compact = 1
+};
+
 UENUM(BlueprintType, meta = (Bitflags))
 enum class EPLATEAUCityModelPackage : uint8 {
     None = 0,
@@ -101,9 +127,57 @@ public:
     UPROPERTY(EditAnywhere, Category = "Import Settings")
         bool bSetCollider = true;
 
+    /*
+    * @brief 生成するコリジョンの種類を指定します。bSetColliderがfalseの場合は常にコリジョンを生成しません。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings", meta = (EditCondition = "bSetCollider"))
+        EPLATEAUCollisionComplexity CollisionComplexity = EPLATEAUCollisionComplexity::Complex;
+
+    /*
+    * @brief trueの場合、コリジョンのクッキングをメッシュビルド後に非同期で行います。クッキング完了までコリジョンは無効化されます。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings", meta = (EditCondition = "bSetCollider"))
+        bool bDeferCollisionCooking = false;
+
     UPROPERTY(EditAnywhere, Category = "Import Settings")
         EPLATEAUMeshGranularity MeshGranularity = EPLATEAUMeshGranularity::PerPrimaryFeatureObject;
 
+    /*
+    * @brief 地域単位で結合する際のグリッドの1辺の分割数を指定します。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings", meta = (ClampMin = 1, UIMin = 1, EditCondition = "MeshGranularity == EPLATEAUMeshGranularity::PerCityModelArea"))
+        int GridCountOfSide = 10;
+
+    /*
+    * @brief 自動粒度において、GMLファイル1つあたりのメッシュ数(ドローコール数)の上限を指定します。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings", meta = (ClampMin = 1, UIMin = 1, EditCondition = "MeshGranularity == EPLATEAUMeshGranularity::Auto"))
+        int TargetDrawCallsPerGml = 2000;
+
+    /*
+    * @brief 自動粒度において、地域単位で結合する場合のメッシュ1つあたりの三角形数の目安を指定します。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings", meta = (ClampMin = 1, UIMin = 1, EditCondition = "MeshGranularity == EPLATEAUMeshGranularity::Auto"))
+        int MaxTrianglesPerMesh = 65536;
+
+    /*
+    * @brief 生成するメッシュの頂点レイアウトを指定します。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings")
+        EPLATEAUVertexFormat VertexFormat = EPLATEAUVertexFormat::Standard;
+
+    /*
+    * @brief trueの場合、同じ座標の頂点を共有し、面の角度差がCreaseAngleを超える箇所とUVの境界でのみ頂点を分割します。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings")
+        bool bWeldVertices = false;
+
+    /*
+    * @brief 頂点を共有する場合に、法線を分割する面の角度差(度)を指定します。
+    */
+    UPROPERTY(EditAnywhere, Category = "Import Settings", meta = (ClampMin = 0, UIMin = 0, ClampMax = 180, UIMax = 180, EditCondition = "bWeldVertices"))
+        float CreaseAngle = 30.0f;
+
     UPROPERTY(EditAnywhere, Category = "Import Settings")
         bool bEnableTexturePacking = true;
 
@@ -154,7 +228,15 @@ struct FPackageInfoSettings {
         , FallbackMaterial(nullptr)
         , bAttachMapTile(false)
         , MapTileUrl("")
-        , ZoomLevel(7) {
+        , ZoomLevel(7)
+        , CollisionComplexity(EPLATEAUCollisionComplexity::Complex)
+        , bDeferCollisionCooking(false)
+        , GridCountOfSide(10)
+        , TargetDrawCallsPerGml(2000)
+        , MaxTrianglesPerMesh(65536)
+        , VertexFormat(EPLATEAUVertexFormat::Standard)
+        , bWeldVertices(false)
+        , CreaseAngle(30.0f) {
     }
 
     FPackageInfoSettings(
@@ -181,7 +263,15 @@ struct FPackageInfoSettings {
         , FallbackMaterial(InFallbackMaterial)
         , bAttachMapTile(InbAttachMapTile)
         , MapTileUrl(InMapTileUrl)
-        , ZoomLevel(InZoomLevel) {
+        , ZoomLevel(InZoomLevel)
+        , CollisionComplexity(EPLATEAUCollisionComplexity::Complex)
+        , bDeferCollisionCooking(false)
+        , GridCountOfSide(10)
+        , TargetDrawCallsPerGml(2000)
+        , MaxTrianglesPerMesh(65536)
+        , VertexFormat(EPLATEAUVertexFormat::Standard)
+        , bWeldVertices(false)
+        , CreaseAngle(30.0f) {
     }
 
     UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
@@ -228,6 +318,54 @@ struct FPackageInfoSettings {
     */
     UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
     int ZoomLevel;
+
+    /*
+    * @brief 生成するコリジョンの種類を指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    EPLATEAUCollisionComplexity CollisionComplexity;
+
+    /*
+    * @brief コリジョンのクッキングを非同期で行うかどうかを指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    bool bDeferCollisionCooking;
+
+    /*
+    * @brief 地域単位で結合する際のグリッドの1辺の分割数を指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    int GridCountOfSide;
+
+    /*
+    * @brief 自動粒度において、GMLファイル1つあたりのメッシュ数の上限を指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    int TargetDrawCallsPerGml;
+
+    /*
+    * @brief 自動粒度において、地域単位で結合する場合のメッシュ1つあたりの三角形数の目安を指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    int MaxTrianglesPerMesh;
+
+    /*
+    * @brief 生成するメッシュの頂点レイアウトを指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    EPLATEAUVertexFormat VertexFormat;
+
+    /*
+    * @brief 同じ座標の頂点を共有するかどうかを指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    bool bWeldVertices;
+
+    /*
+    * @brief 頂点を共有する場合に、法線を分割する面の角度差(度)を指定します。
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "PLATEAU|ImportSettings")
+    float CreaseAngle;
 };
 
 UCLASS()
@@ -444,6 +582,7 @@ public:
         Items.Add(EPLATEAUMeshGranularity::PerAtomicFeatureObject, LOCTEXT("AtomicFeatureObject", "最小地物単位"));
         Items.Add(EPLATEAUMeshGranularity::PerPrimaryFeatureObject, LOCTEXT("PrimaryFeatureObject", "主要地物単位"));
         Items.Add(EPLATEAUMeshGranularity::PerCityModelArea, LOCTEXT("CityModelArea", "地域単位"));
+        Items.Add(EPLATEAUMeshGranularity::Auto, LOCTEXT("AutoGranularity", "自動"));
         return Items;
     }
     
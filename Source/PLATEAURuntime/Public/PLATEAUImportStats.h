@@ -0,0 +1,221 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+#include "PLATEAUImportStats.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("PLATEAUImport"), STATGROUP_PLATEAUImport, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.Copy"), STAT_PLATEAUImport_Copy, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.Parse"), STAT_PLATEAUImport_Parse, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.Extract"), STAT_PLATEAUImport_Extract, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.ConvertMesh"), STAT_PLATEAUImport_ConvertMesh, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.ComponentSetup"), STAT_PLATEAUImport_ComponentSetup, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.TextureLoad"), STAT_PLATEAUImport_TextureLoad, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.MaterialCreation"), STAT_PLATEAUImport_MaterialCreation, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.BatchBuild"), STAT_PLATEAUImport_BatchBuild, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.Collision"), STAT_PLATEAUImport_Collision, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.SerializeAttributes"), STAT_PLATEAUImport_SerializeAttributes, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import.TexturePacking"), STAT_PLATEAUImport_TexturePacking, STATGROUP_PLATEAUImport, PLATEAURUNTIME_API);
+
+/**
+ * @brief インポート処理のトレースチャンネルです。Unreal Insightsで -trace=cpu,PLATEAUImport を指定すると記録されます。
+ */
+UE_TRACE_CHANNEL_EXTERN(PLATEAUImportChannel, PLATEAURUNTIME_API);
+
+/**
+ * @brief インポート処理の段階です。
+ */
+UENUM(BlueprintType)
+enum class EPLATEAUImportStage : uint8 {
+    //! GMLファイルおよび関連ファイルのコピー
+    Copy = 0,
+    //! CityGMLのパース
+    Parse,
+    //! ポリゴンメッシュの抽出
+    Extract,
+    //! FMeshDescriptionへの変換
+    ConvertMesh,
+    //! ゲームスレッドでのコンポーネント生成、設定
+    ComponentSetup,
+    //! テクスチャ読み込み
+    TextureLoad,
+    //! マテリアル作成
+    MaterialCreation,
+    //! StaticMeshのビルド(コリジョン設定を含む)
+    BatchBuild,
+    //! コリジョン設定(bDeferCollisionCooking有効時は非同期クッキングの完了までを含む)
+    Collision,
+    //! ワーカースレッドでの属性情報のシリアライズ
+    SerializeAttributes,
+    //! テクスチャのアトラスへの結合
+    TexturePacking,
+
+    Count UMETA(Hidden)
+};
+
+/**
+ * @brief GMLファイル1つ分のインポート計測結果です。
+ */
+USTRUCT(BlueprintType)
+struct PLATEAURUNTIME_API FPLATEAUGmlLoadReport {
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        FString GmlName;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        bool bSucceeded = false;
+
+    /**
+     * @brief 段階ごとの所要時間(秒)の合計です。EPLATEAUImportStageをインデックスとします。
+     * 並列に実行された処理の所要時間をそれぞれ合計する(CPU時間の合計に相当する)ため、経過時間を超える場合があります。
+     */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        TArray<double> StageSeconds;
+
+    /**
+     * @brief 段階ごとの経過時間(秒)です。EPLATEAUImportStageをインデックスとします。
+     * いずれかのスレッドでその段階の処理が実行されていた時間の長さです。
+     */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        TArray<double> StageWallSeconds;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        double TotalSeconds = 0.0;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        int64 TriangleCount = 0;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        int64 TextureBytes = 0;
+
+    /**
+     * @brief GML読み込み完了時点での、プロセス起動からのピーク物理メモリ使用量(MB)です。
+     * 並列に読み込まれている他のGMLやエディタ自体の使用量を含むため、このGMLのみの使用量ではありません。
+     */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PLATEAU")
+        double ProcessPeakUsedPhysicalMB = 0.0;
+
+    double GetStageSeconds(const EPLATEAUImportStage Stage) const {
+        return StageSeconds.IsValidIndex(static_cast<int32>(Stage)) ? StageSeconds[static_cast<int32>(Stage)] : 0.0;
+    }
+
+    double GetStageWallSeconds(const EPLATEAUImportStage Stage) const {
+        return StageWallSeconds.IsValidIndex(static_cast<int32>(Stage)) ? StageWallSeconds[static_cast<int32>(Stage)] : 0.0;
+    }
+};
+
+/**
+ * @brief GMLファイル1つ分のインポート計測値を集計します。
+ * ワーカースレッドとゲームスレッドの双方から記録されるため、スレッドセーフです。
+ */
+class PLATEAURUNTIME_API FPLATEAUGmlLoadStats {
+public:
+    explicit FPLATEAUGmlLoadStats(const FString& InGmlName);
+
+    /**
+     * @brief 段階の処理の開始を記録します。EndStageと対にして呼び出します。
+     */
+    void BeginStage(const EPLATEAUImportStage Stage);
+
+    /**
+     * @brief 段階の処理の終了を記録します。
+     * @param Seconds 処理の所要時間
+     */
+    void EndStage(const EPLATEAUImportStage Stage, const double Seconds);
+
+    void AddTriangleCount(const int64 Count);
+    void AddTextureBytes(const int64 Bytes);
+
+    const FString& GetGmlName() const {
+        return GmlName;
+    }
+
+    /**
+     * @brief 開始後に終了していない段階の処理(非同期のコリジョンクッキング等)があるかどうかを返します。
+     */
+    bool HasRunningStages() const;
+
+    /**
+     * @brief 集計結果を返します。呼び出し時点のピークメモリを記録します。
+     */
+    FPLATEAUGmlLoadReport ToReport(const bool bSucceeded) const;
+
+    /**
+     * @brief ToReportで作成した集計結果の段階ごとの時間を、現在の値で更新します。
+     * GMLの読み込み完了後に終了した非同期の処理の時間を反映するために使用します。
+     */
+    void UpdateStageSeconds(FPLATEAUGmlLoadReport& Report) const;
+
+private:
+    static constexpr int32 StageCount = static_cast<int32>(EPLATEAUImportStage::Count);
+
+    FString GmlName;
+    double StartSeconds;
+    mutable FCriticalSection Section;
+    double StageSeconds[StageCount] = {};
+    double StageWallSeconds[StageCount] = {};
+    //! 段階ごとの実行中の処理の数
+    int32 RunningCounts[StageCount] = {};
+    //! 段階ごとの実行中の処理のうち最も早く開始した時刻
+    double RunningStartSeconds[StageCount] = {};
+    int64 TriangleCount = 0;
+    int64 TextureBytes = 0;
+};
+
+/**
+ * @brief スコープの所要時間をFPLATEAUGmlLoadStatsに記録します。Statsがnullptrの場合は何もしません。
+ */
+class PLATEAURUNTIME_API FPLATEAUImportStageScope {
+public:
+    FPLATEAUImportStageScope(FPLATEAUGmlLoadStats* InStats, const EPLATEAUImportStage InStage)
+        : Stats(InStats), Stage(InStage), StartSeconds(FPlatformTime::Seconds()) {
+        if (Stats != nullptr)
+            Stats->BeginStage(Stage);
+    }
+
+    ~FPLATEAUImportStageScope() {
+        if (Stats != nullptr)
+            Stats->EndStage(Stage, FPlatformTime::Seconds() - StartSeconds);
+    }
+
+private:
+    FPLATEAUGmlLoadStats* Stats;
+    EPLATEAUImportStage Stage;
+    double StartSeconds;
+};
+
+/**
+ * @brief インポート計測結果をファイルに出力します。
+ */
+class PLATEAURUNTIME_API FPLATEAUImportReportWriter {
+public:
+    /**
+     * @brief 計測結果をCSVおよびJSON形式で出力します。
+     * @param BaseFilePath 拡張子無しの出力先パス
+     * @return 出力に成功した場合true
+     */
+    static bool Write(const TArray<FPLATEAUGmlLoadReport>& Reports, const FString& BaseFilePath);
+
+    /**
+     * @brief 既定の出力先(Saved/PLATEAU/ImportReports/{DatasetName}_{日時})を返します。
+     */
+    static FString GetDefaultBaseFilePath(const FString& DatasetName);
+};
+
+/**
+ * @brief 段階の計測(stat、トレース、GMLごとの集計)を開始します。
+ * @param Stats FPLATEAUGmlLoadStats* (nullptr可)
+ * @param Stage EPLATEAUImportStageの列挙子名
+ */
+#define PLATEAU_IMPORT_STAGE_SCOPE(Stats, Stage) \
+    SCOPE_CYCLE_COUNTER(STAT_PLATEAUImport_##Stage); \
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("PLATEAU::" #Stage, PLATEAUImportChannel); \
+    FPLATEAUImportStageScope PLATEAUImportStageScope_##Stage(Stats, EPLATEAUImportStage::Stage)
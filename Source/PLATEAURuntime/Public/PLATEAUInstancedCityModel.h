@@ -6,6 +6,7 @@
 #include "PLATEAUGeometry.h"
 #include "GameFramework/Actor.h"
 #include "Component/PLATEAUCityObjectGroup.h"
+#include "CityGML/PLATEAUAttributeStore.h"
 #include <plateau/polygon_mesh/model.h>
 #include <plateau/dataset/city_model_package.h>
 #include <PLATEAUImportSettings.h>
@@ -15,6 +16,7 @@
 
 
 struct FPLATEAUCityObject;
+class FPLATEAUMaterialCache;
 class FPLATEAUModelReconstruct;
 class FPLATEAUModelClassification;
 struct FPLATEAUMinMaxLod {
@@ -33,6 +35,12 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
         FString GmlName;
 
+    /**
+     * @brief GMLファイルをコピーせずにインポートした場合のインポート元パスです。空の場合はContent/PLATEAU/Datasets以下を参照します。
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
+        FString DatasetSourcePath;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU")
         FString ID;
 };
@@ -104,18 +112,39 @@ public:
     UPROPERTY(EditAnywhere, Category = "PLATEAU")
         FString DatasetName;
 
+    /**
+     * @brief GMLファイルをコピーせずにインポートした場合のインポート元(フォルダまたはzipファイル)のパスです。
+     */
+    UPROPERTY(EditAnywhere, Category = "PLATEAU")
+        FString DatasetSourcePath;
+
     UPROPERTY(VisibleDefaultsOnly, Category = "PLATEAU", BlueprintGetter = GetLatitude)
         double Latitude;
 
     UPROPERTY(VisibleDefaultsOnly, Category = "PLATEAU", BlueprintGetter = GetLongitude)
         double Longitude;
 
+    /**
+     * @brief インポート元のローダーです。分割インポートで生成されたアクタでは、ストリーミングを妨げないよう設定されません。
+     */
     UPROPERTY(EditAnywhere, Category = "PLATEAU")
         TObjectPtr<class APLATEAUCityModelLoader> Loader;
 
     UPROPERTY(EditAnywhere, Category = "PLATEAU")
         TArray<FString> MeshCodes;
 
+    /**
+     * @brief インポート時にアクタを分割した場合のセル名(GML名またはメッシュコード)です。分割されていない場合は空文字列です。
+     */
+    UPROPERTY(EditAnywhere, Category = "PLATEAU")
+        FString StreamingCellName;
+
+    /**
+     * @brief インポート時にアクタを分割した場合に、同一のインポートで生成されたアクタで共通のIDです。
+     */
+    UPROPERTY(VisibleAnywhere, Category = "PLATEAU")
+        FGuid StreamingGroupId;
+
     UFUNCTION(BlueprintGetter)
         double GetLatitude();
 
@@ -128,6 +157,37 @@ public:
     UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
         TArray<FPLATEAUCityObject>& GetAllRootCityObjects();
 
+    /**
+     * @brief 同一のインポートで分割生成された3D都市モデルアクタのうち、読み込み済みのものを自身を含めて全て返します。
+     * 分割されていない場合は自身のみを返します。フィルタリングとエクスポートはこのアクタ全てに適用されるため、
+     * World Partitionで未読み込みのセルがある場合は事前に全てのセルを読み込む必要があります。
+     */
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+        TArray<APLATEAUInstancedCityModel*> GetStreamingCellCityModels() const;
+
+    /**
+     * @brief 同一のインポートで分割生成された3D都市モデルアクタのうち、World Partitionで未読み込みのものの数を返します。
+     * アクタ記述子にはセルのIDが含まれないため、アクタラベル(データセット名_セル名)で判定します。エディタ以外では常に0を返します。
+     */
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+        int32 GetUnloadedStreamingCellCount() const;
+
+    /**
+     * @brief 読み込み済みのGMLファイル名(拡張子無し)を返します。
+     */
+    TSet<FString> GetLoadedGmlNames() const;
+
+    /**
+     * @brief 指定されたGMLファイル(拡張子無しのファイル名)のコンポーネントを子孫も含めて破棄します。
+     */
+    void RemoveGmlComponents(const TSet<FString>& GmlNames);
+
+    /**
+     * @brief インポート時に作成したマテリアル、テクスチャを保持するキャッシュを返します。追加インポートで使い回されます。
+     * ゲームスレッドから呼び出してください。
+     */
+    TSharedPtr<FPLATEAUMaterialCache> GetMaterialCache();
+
     /**
      * @brief パッケージ種を含むコンポーネントを返します
      */
@@ -156,6 +216,29 @@ public:
     APLATEAUInstancedCityModel* FilterByFeatureTypes(const citygml::CityObject::CityObjectsType InCityObjectType);
     APLATEAUInstancedCityModel* FilterByFeatureTypesLegacy(const citygml::CityObject::CityObjectsType InCityObjectType); //属性情報がない場合Modelを取得して判定
 
+    /**
+     * @brief 3D都市モデル内の各地物について、全ての属性条件を満たす都市オブジェクトのみを可視化します。
+     * 結合されたメッシュはメッシュを再構築せず都市オブジェクト単位で非表示にします。
+     * 主要地物が条件を満たす場合、その最小地物(壁面・屋根面等)も表示します。
+     * 既に非表示の都市オブジェクトは表示しないため、FilterByFeatureTypes等の後に呼び出すと絞り込みを重ねられます。
+     * @param Conditions 属性条件
+     * @return thisを返します。
+     */
+    APLATEAUInstancedCityModel* FilterByAttributes(const TArray<FPLATEAUAttributeCondition>& Conditions);
+
+    /**
+     * @brief 全ての属性条件を満たす都市オブジェクトを検索します。
+     * 属性は初回の検索時に属性キーごとの列として構築され、コンポーネントが変更されるまで再利用されます。
+     */
+    UFUNCTION(BlueprintCallable, meta = (Category = "PLATEAU|CityGML"))
+        FPLATEAUAttributeQueryResult QueryCityObjectsByAttributes(const TArray<FPLATEAUAttributeCondition>& Conditions);
+
+    /**
+     * @brief 属性検索用の列を返します。コンポーネントが変更されている場合は再構築します。
+     * ゲームスレッドから呼び出してください。
+     */
+    TSharedPtr<FPLATEAUAttributeStore> GetAttributeStore();
+
     /**
      * @brief 3D都市モデル内に含まれるLodを取得します。
      * @param InPackage 検索対象のパッケージ。フラグによって複数指定可能です。
@@ -170,9 +253,17 @@ public:
 
     /**
      * @brief 選択されたComponentの結合・分割処理を行います。
-     * @param 
+     * @param ReconstructType 変換後の粒度。Autoはインポート時のみ有効なため、指定した場合は何もせず空の結果を返します。
+     * @param TexturePacking 設定されている場合、結合・分割と同時にテクスチャをこの解像度のアトラスに詰めます
      */
-    UE::Tasks::TTask<TArray<USceneComponent*>> ReconstructModel(const TArray<USceneComponent*> TargetComponents, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal);
+    UE::Tasks::TTask<TArray<USceneComponent*>> ReconstructModel(const TArray<USceneComponent*> TargetComponents, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal,
+                                                                const TOptional<EPLATEAUTexturePackingResolution> TexturePacking = {});
+
+    /**
+     * @brief 選択されたComponentの粒度を変えずに、テクスチャをアトラスに詰めてマテリアルをアトラスごとに1つに集約します。
+     * @param Resolution アトラス1枚の最大解像度
+     */
+    UE::Tasks::TTask<TArray<USceneComponent*>> PackTextures(const TArray<USceneComponent*> TargetComponents, const EPLATEAUTexturePackingResolution Resolution, bool bDestroyOriginal);
 
 
     /**
@@ -229,6 +320,12 @@ protected:
      */
     bool HasAttributeInfo();
 
+    /**
+     * @brief この3D都市モデルのテクスチャアトラス画像のうち、どのコンポーネントからも参照されなくなったものを削除します。
+     * 非表示のコンポーネントからの参照も含みます。ゲームスレッドから呼び出してください。
+     */
+    void DeleteUnusedTextureAtlases();
+
 public:
     // Called every frame
     virtual void Tick(float DeltaTime) override;
@@ -236,6 +333,12 @@ public:
 private:
     TAtomic<bool> bIsFiltering;
     TArray<FPLATEAUCityObject> RootCityObjects;
+    TSharedPtr<FPLATEAUMaterialCache> MaterialCache;
+    TSharedPtr<FPLATEAUAttributeStore> AttributeStore;
+
+    //! 属性情報が無い場合のフィルタリングに用いる都市オブジェクトの種類(GMLファイル名 → GmlID → CityObjectsType)。
+    //! 全都市オブジェクトのIDを含み大きくなるため保存せず、レベルの読み込み後の初回のフィルタリング時にGMLファイルごとに構築します。
+    TMap<FString, TMap<FString, int64>> CityObjectTypeCache;
 
     void FilterByFeatureTypesInternal(const citygml::CityObject::CityObjectsType InCityObjectType);
 };
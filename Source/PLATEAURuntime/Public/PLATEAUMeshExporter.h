@@ -22,6 +22,9 @@ namespace plateau {
 
 class PLATEAURUNTIME_API FPLATEAUMeshExporter {
 public:
+    /**
+     * @brief 3D都市モデルをGMLごとのファイルに出力します。インポート時に分割された場合は同一のインポートで生成された全てのアクタを出力します。
+     */
     bool Export(const FString ExportPath, APLATEAUInstancedCityModel* ModelActor, const FPLATEAUMeshExportOptions& Option);
     std::shared_ptr<plateau::polygonMesh::Model> CreateModelFromComponents(APLATEAUInstancedCityModel* ModelActor, const TArray<UPLATEAUCityObjectGroup*> ModelComponents, const FPLATEAUMeshExportOptions Option);
 
@@ -22,14 +22,14 @@ namespace plateau::polygonMesh {
 
 struct FSubMeshMaterialSet {
 public:
-    bool hasMaterial;
-    FVector3f Diffuse;
-    FVector3f Specular;
-    FVector3f Emissive;
-    float Shininess;
-    float Transparency;
-    float Ambient;
-    bool isSmooth;
+    bool hasMaterial = false;
+    FVector3f Diffuse = FVector3f::ZeroVector;
+    FVector3f Specular = FVector3f::ZeroVector;
+    FVector3f Emissive = FVector3f::ZeroVector;
+    float Shininess = 0.f;
+    float Transparency = 0.f;
+    float Ambient = 0.f;
+    bool isSmooth = false;
     FString TexturePath;
     FPolygonGroupID PolygonGroupID = 0;
     FString MaterialSlot = FString("");
@@ -44,6 +44,27 @@ private:
 
 FORCEINLINE uint32 GetTypeHash(const FSubMeshMaterialSet& Value);
 
+/**
+ * @brief 3D都市モデルアクタ単位で作成済みのマテリアルとテクスチャを保持し、GMLファイル間および追加インポート時に使い回します。
+ * ゲームスレッドからのみアクセスしてください。
+ */
+class PLATEAURUNTIME_API FPLATEAUMaterialCache {
+public:
+    UMaterialInstanceDynamic* FindMaterial(const FSubMeshMaterialSet& Key) const;
+    void AddMaterial(const FSubMeshMaterialSet& Key, UMaterialInstanceDynamic* Material);
+
+    /**
+     * @brief 読み込み済みのテクスチャを取得します。読み込みに失敗したテクスチャはnullptrとして記録されています。
+     * @return 記録されている場合true
+     */
+    bool TryGetTexture(const FString& TexturePath, UTexture2D*& OutTexture) const;
+    void AddTexture(const FString& TexturePath, UTexture2D* Texture);
+
+private:
+    TMap<FSubMeshMaterialSet, TWeakObjectPtr<UMaterialInstanceDynamic>> Materials;
+    TMap<FString, TWeakObjectPtr<UTexture2D>> Textures;
+};
+
 struct FLoadInputData;
 class UPLATEAUCityObjectGroup;
 
@@ -57,13 +78,19 @@ public:
         bAutomationTest = InbAutomationTest;
     }
 
+    /**
+     * @brief ModelをParentComponent以下にコンポーネントとして読み込みます。
+     * @param bCanceled ノードごとに確認され、trueになった時点で読み込みを中断します。
+     * @param OnNodeLoaded ノードを1つ読み込むごとに(読み込み済みノード数, 全ノード数)を引数に呼ばれます。ワーカースレッドから呼ばれます。
+     */
     void LoadModel(
         AActor* ModelActor,
         USceneComponent* ParentComponent,
         std::shared_ptr<plateau::polygonMesh::Model> Model,
         const FLoadInputData& LoadInputData,
         const std::shared_ptr<const citygml::CityModel> CityModel,
-        TAtomic<bool>* bCanceled);
+        TAtomic<bool>* bCanceled,
+        TFunction<void(int32, int32)> OnNodeLoaded = nullptr);
 
     //前回のロードで作成されたComponentのリストを返します
     TArray<USceneComponent*> GetLastCreatedComponents();
@@ -94,6 +121,26 @@ protected:
     // 前回のLoadModel, ReloadComponentFromNode実行時に作成されたComponentを保持しておきます
     TArray<USceneComponent*> LastCreatedComponents;
 
+    // LoadModel実行中のキャンセルフラグと進捗
+    TAtomic<bool>* bCanceledRef = nullptr;
+    TFunction<void(int32, int32)> OnNodeLoadedCallback;
+    int32 LoadedNodeCount = 0;
+    int32 TotalNodeCount = 0;
+
+    bool IsCanceled() const {
+        return bCanceledRef != nullptr && bCanceledRef->Load(EMemoryOrder::Relaxed);
+    }
+
+    // LoadModel実行前にワーカースレッドで作成した属性情報のシリアライズ結果。コンポーネント作成時に取り出されます。
+    TMap<const plateau::polygonMesh::Node*, FString> PreparedNodeCityObjects;
+    TMap<const plateau::polygonMesh::Mesh*, FString> PreparedMeshCityObjects;
+
+    /**
+     * @brief Model内の全ノードの属性情報をワーカースレッドで並列にシリアライズし、PreparedNodeCityObjects, PreparedMeshCityObjectsに格納します。
+     */
+    void PrepareSerializedCityObjects(const plateau::polygonMesh::Model& Model, const FLoadInputData& LoadInputData,
+                                      const std::shared_ptr<const citygml::CityModel> CityModel);
+
     virtual UStaticMeshComponent* CreateStaticMeshComponent(
         AActor& Actor,
         USceneComponent& ParentComponent,
@@ -0,0 +1,115 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EPLATEAUTexturePackingResolution : uint8;
+
+namespace plateau::polygonMesh {
+    class Model;
+}
+
+/**
+ * @brief 矩形をMaxRects法(Best Short Side Fit)でページに詰めます。
+ * 既存のどのページにも収まらない矩形に対しては新しいページを追加するため、ページ数は入力に応じて決まります。
+ */
+class PLATEAURUNTIME_API FPLATEAURectPacker {
+public:
+    FPLATEAURectPacker(const int32 InPageWidth, const int32 InPageHeight);
+
+    /**
+     * @brief 矩形を配置します。
+     * @param OutPage 配置されたページ番号
+     * @param OutPosition ページ内の左上の位置
+     * @return 矩形がページより大きく配置できない場合false
+     */
+    bool Insert(const int32 Width, const int32 Height, int32& OutPage, FIntPoint& OutPosition);
+
+    int32 GetNumPages() const {
+        return Pages.Num();
+    }
+
+    /**
+     * @brief ページ内で矩形が配置されている範囲の右下の位置を返します。
+     */
+    FIntPoint GetUsedExtent(const int32 Page) const {
+        return Pages[Page].UsedExtent;
+    }
+
+    /**
+     * @brief 全ページの面積に対する配置済み矩形の面積の割合を返します。
+     */
+    double GetOccupancy() const;
+
+private:
+    struct FPage {
+        //! 空き領域(互いに重なり得る極大な矩形)
+        TArray<FIntRect> FreeRects;
+        int64 UsedArea = 0;
+        FIntPoint UsedExtent = FIntPoint::ZeroValue;
+    };
+
+    bool FindPosition(const FPage& Page, const int32 Width, const int32 Height, FIntPoint& OutPosition, int32& OutShortSide, int32& OutLongSide) const;
+    static void PlaceRect(FPage& Page, const FIntRect& Rect);
+
+    int32 PageWidth;
+    int32 PageHeight;
+    TArray<FPage> Pages;
+};
+
+/**
+ * @brief テクスチャアトラス化の設定です。
+ */
+struct FPLATEAUTextureAtlasOptions {
+    //! アトラス1枚の最大の幅・高さ
+    int32 PageSize = 4096;
+    //! テクスチャ間の余白(ピクセル)。ミップマップでの滲みを防ぐため、端のピクセルを複製して埋めます。
+    int32 Padding = 4;
+    //! アトラス画像の出力先(絶対パス)。テクスチャアセットのソースパスを保つため Content/PLATEAU 以下としてください。
+    FString OutputDirectory;
+    //! アトラス画像のファイル名の接頭辞
+    FString NamePrefix = TEXT("Atlas");
+};
+
+/**
+ * @brief テクスチャアトラス化の結果です。
+ */
+struct FPLATEAUTextureAtlasResult {
+    //! Model内のテクスチャの種類数
+    int32 NumSourceTextures = 0;
+    //! アトラスに詰めたテクスチャの数
+    int32 NumPackedTextures = 0;
+    //! 出力したアトラス画像のパス
+    TArray<FString> PagePaths;
+};
+
+/**
+ * @brief Model内のサブメッシュのテクスチャを少数のアトラスに詰め、UV1とサブメッシュのテクスチャパスを書き換えます。
+ * 画像の読み込み・縮小・転写・PNGへのエンコード、UVの書き換えは並列に行います。
+ * アトラス画像の名前は入力(テクスチャの内容と配置)から決まるため、同じ入力で繰り返しても画像は増えません。
+ * UVが0～1の範囲外(繰り返し)となるテクスチャ、読み込めないテクスチャ、フォールバックマテリアル用のテクスチャは対象外です。
+ * 同じアトラスを参照するサブメッシュは同じマテリアルとなるため、メッシュ生成時にマテリアルとドローコールが集約されます。
+ */
+class PLATEAURUNTIME_API FPLATEAUTextureAtlas {
+public:
+    static FPLATEAUTextureAtlasResult Pack(plateau::polygonMesh::Model& Model, const FPLATEAUTextureAtlasOptions& Options);
+
+    /**
+     * @brief OutputDirectory内のNamePrefixで始まるアトラス画像のうち、UsedFileNamesに含まれないものを削除します。
+     * 再度アトラス化したことで参照されなくなった画像を削除するために使用します。
+     * @param UsedFileNames 参照されているアトラス画像のファイル名(ディレクトリを含まない)
+     * @return 削除した画像の数
+     */
+    static int32 DeleteUnusedPages(const FString& OutputDirectory, const FString& NamePrefix, const TSet<FString>& UsedFileNames);
+
+    /**
+     * @brief アトラス画像の既定の出力先 (Content/PLATEAU/Atlases) を返します。
+     */
+    static FString GetDefaultOutputDirectory();
+
+    /**
+     * @brief EPLATEAUTexturePackingResolutionをピクセル数に変換します。
+     */
+    static int32 GetPageSize(const EPLATEAUTexturePackingResolution Resolution);
+};
@@ -8,4 +8,16 @@ class PLATEAURUNTIME_API FPLATEAUTextureLoader {
 public:
     static UTexture2D* Load(const FString& TexturePath, bool OverwriteTextre);
     static UTexture2D* LoadTransient(const FString& TexturePath);
+
+    /**
+     * @brief 画像ファイルを圧縮されたまま読み込み、ヘッダから幅・高さを取得します。
+     * アセットは作成しないため、ゲームスレッド以外からも呼び出せます。
+     * @return 読み込めない場合、または8bit以外の画像の場合false
+     */
+    static bool LoadCompressedImage(const FString& TexturePath, TArray64<uint8>& OutCompressed, int32& OutWidth, int32& OutHeight);
+
+    /**
+     * @brief LoadCompressedImageで読み込んだ画像を8bit BGRAの画素に展開します。
+     */
+    static bool DecompressImage(const TArray64<uint8>& Compressed, TArray64<uint8>& OutPixels, int32& OutWidth, int32& OutHeight);
 };
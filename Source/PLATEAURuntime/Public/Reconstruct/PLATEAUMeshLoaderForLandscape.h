@@ -51,6 +51,11 @@ struct PLATEAURUNTIME_API FPLATEAULandscapeParam {
         FillEdges(true),
         AlignLand(true),
         InvertRoadLod3(true),
+        MeshMaxError(10.0f),
+        MeshChunkSizeQuads(0),
+        UnifiedLandscape(false),
+        UnifiedGridSpacing(100.0f),
+        StreamingGridSize(4),
         HeightmapImageOutput(EPLATEAULandscapeHeightmapImageOutput::None){}
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape")
@@ -79,6 +84,21 @@ struct PLATEAURUNTIME_API FPLATEAULandscapeParam {
         bool AlignLand;
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape")
         bool InvertRoadLod3;
+    //! 平滑化Mesh生成時の簡略化の許容誤差(cm)。0の場合は同一平面上の三角形のみを統合します。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape", meta = (ClampMin = "0"))
+        float MeshMaxError;
+    //! 平滑化Meshをチャンクに分割する際の1辺の格子数(2のべき乗に切り上げ)。0の場合は分割しません。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape", meta = (ClampMin = "0"))
+        int32 MeshChunkSizeQuads;
+    //! 選択したすべての地形を共通の高さの範囲・格子の1つのハイトマップにまとめ、継ぎ目の無い1つの地形を生成します。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape")
+        bool UnifiedLandscape;
+    //! UnifiedLandscape有効時の格子の間隔(cm)。ハイトマップが大きくなりすぎる場合は広げます。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape", meta = (ClampMin = "1"))
+        float UnifiedGridSpacing;
+    //! UnifiedLandscape有効時、World Partitionのレベルでストリーミングプロキシ1つにまとめるランドスケープコンポーネントの数(1辺)。0の場合は分割しません。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape", meta = (ClampMin = "0"))
+        int32 StreamingGridSize;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PLATEAU|BPLibraries|Landscape")
         EPLATEAULandscapeHeightmapImageOutput HeightmapImageOutput;
@@ -93,6 +113,8 @@ struct  HeightmapCreationResult {
     TVec2f MinUV;
     TVec2f MaxUV;
     FString TexturePath;
+    //! 複数の地形をまとめたハイトマップの場合、元の地形のノード名
+    TArray<FString> SourceNodeNames;
 };
 
 
@@ -108,6 +130,17 @@ public:
         AActor* ModelActor,
         const std::shared_ptr<plateau::polygonMesh::Model> Model, FPLATEAULandscapeParam Param);
 
+    /**
+     * @brief Model内のすべての地形を共通の高さの範囲・格子に並べた1つのハイトマップを生成します。
+     * 格子をタイルに区切って三角形を振り分け、テクスチャごとにタイル単位で並列にラスタライズします。
+     * 地形のテクスチャは同じ格子の1枚の画像に合成します。
+     * @param Param TextureWidth, TextureHeightに生成したハイトマップの大きさを設定します。
+     * @return 地形が無い場合は空
+     */
+    TArray<HeightmapCreationResult> CreateUnifiedHeightMap(
+        AActor* ModelActor,
+        const std::shared_ptr<plateau::polygonMesh::Model> Model, FPLATEAULandscapeParam& Param);
+
     void CreateReference(ALandscape* Landscape, AActor* Actor, const FString NodeName);
 
 protected:
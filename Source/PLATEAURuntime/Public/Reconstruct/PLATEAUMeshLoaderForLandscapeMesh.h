@@ -14,11 +14,19 @@ public:
     FPLATEAUMeshLoaderForLandscapeMesh();
     FPLATEAUMeshLoaderForLandscapeMesh(const bool InbAutomationTest);
 
+    /**
+     * @brief ハイトマップから地形メッシュを生成します。
+     * @param MaxError 簡略化の許容誤差(cm)。0の場合は同一平面上の三角形のみを統合します。
+     * @param ChunkSizeQuads チャンクの1辺の格子数(2のべき乗に切り上げ)。0の場合は1つのメッシュとします。
+     * @param TexturePath 元の地形のマテリアルが無い場合に使用するテクスチャ
+     */
     void CreateMeshFromHeightMap(AActor& Actor, const int32 SizeX, const int32 SizeY, 
         const TVec3d Min, const TVec3d Max, 
         const TVec2f MinUV, const TVec2f MaxUV, 
         uint16_t* HeightRawData, 
-        const FString NodeName);
+        const FString NodeName,
+        const double MaxError = 0.0, const int32 ChunkSizeQuads = 0,
+        const FString& TexturePath = FString());
 
 protected:
     UStaticMeshComponent* GetStaticMeshComponentForCondition(AActor& Actor, EName Name, const std::string& InNodeName,
@@ -32,7 +40,9 @@ protected:
     void ModifyMeshDescription(FMeshDescription& MeshDescription) override;
 
 private:
-    UMaterialInstanceDynamic* ReplaceMaterial;
+    UMaterialInstanceDynamic* ReplaceMaterial = nullptr;
+    //! チャンクに分割したコンポーネントの属性のコピー元となるコンポーネント名
+    FString OriginalNodeName;
 
 };
 
@@ -32,6 +32,20 @@ public:
         TMap<FString, FPLATEAUCityObject> CityObj,
         AActor& InActor);
 
+    /**
+     * @brief 再生成するメッシュの頂点レイアウトを設定します
+     */
+    void SetVertexFormat(const EPLATEAUVertexFormat InVertexFormat) {
+        VertexFormat = InVertexFormat;
+    }
+
+    /**
+     * @brief 再生成するメッシュのコリジョンの種類を設定します
+     */
+    void SetCollisionComplexity(const EPLATEAUCollisionComplexity InCollisionComplexity) {
+        CollisionComplexity = InCollisionComplexity;
+    }
+
 protected:
 
     virtual void ReloadNodeRecursive(
@@ -59,5 +73,9 @@ protected:
 
     ConvertGranularity ConvGranularity;
 
+    EPLATEAUVertexFormat VertexFormat = EPLATEAUVertexFormat::Standard;
+
+    EPLATEAUCollisionComplexity CollisionComplexity = EPLATEAUCollisionComplexity::Complex;
+
 private:
 };
@@ -21,8 +21,17 @@ public:
 
     TArray<HeightmapCreationResult> CreateHeightMap(std::shared_ptr<plateau::polygonMesh::Model> Model, FPLATEAULandscapeParam Param);
 
+    /**
+     * @brief Model内のすべての地形をまとめた1つのハイトマップを生成します。ParamのTextureWidth, TextureHeightを更新します。
+     */
+    TArray<HeightmapCreationResult> CreateUnifiedHeightMap(std::shared_ptr<plateau::polygonMesh::Model> Model, FPLATEAULandscapeParam& Param);
+
+    /**
+     * @param StreamingGridSize World Partitionのレベルの場合、この数(1辺)のランドスケープコンポーネントごとにストリーミングプロキシに分割します。0の場合は分割しません。
+     */
     ALandscape* CreateLandScape(UWorld* World, const int32 NumSubsections, const int32 SubsectionSizeQuads, const int32 ComponentCountX, const int32 ComponentCountY, const int32 SizeX, const int32 SizeY,
-        const TVec3d Min, const TVec3d Max, const TVec2f MinUV, const TVec2f MaxUV, const FString TexturePath, TArray<uint16> HeightData, const FString ActorName);
+        const TVec3d Min, const TVec3d Max, const TVec2f MinUV, const TVec2f MaxUV, const FString TexturePath, TArray<uint16> HeightData, const FString ActorName,
+        const int32 StreamingGridSize = 0);
 
     void CreateLandScapeReference(ALandscape* Landscape, AActor* Actor, const FString ActorName);
 
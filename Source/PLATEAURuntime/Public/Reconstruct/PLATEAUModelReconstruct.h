@@ -41,11 +41,36 @@ public:
      */
     static ConvertGranularity GetConvertGranularityFromReconstructType(const EPLATEAUMeshGranularity ReconstructType);
 
+    /**
+     * @brief 結合・分離、分類の変換先として指定できる粒度かどうかを返します。
+     * Autoはインポート時のみ有効なため、falseを返します。
+     */
+    static bool IsValidReconstructType(const EPLATEAUMeshGranularity ReconstructType);
+
+    /**
+     * @brief 変換したModelのテクスチャを指定の解像度のアトラスに詰めるよう設定します
+     */
+    void SetTexturePacking(const EPLATEAUTexturePackingResolution Resolution) {
+        TexturePackingResolution = Resolution;
+    }
+
+    /**
+     * @brief 3D都市モデルのテクスチャアトラス画像のファイル名の接頭辞を返します。
+     * 他の3D都市モデルのアトラス画像と区別できるよう、エディタではアクターのGUIDを使用します。
+     */
+    static FString GetTextureAtlasNamePrefix(const APLATEAUInstancedCityModel& CityModel);
+
 protected:
     
     APLATEAUInstancedCityModel* CityModelActor;
     ConvertGranularity ConvGranularity;
     bool bDivideGrid;
+    //! 再生成するメッシュの頂点レイアウト(変換元のコンポーネントに合わせる)
+    EPLATEAUVertexFormat VertexFormat = EPLATEAUVertexFormat::Standard;
+    //! 再生成するメッシュのコリジョンの種類(変換元のコンポーネントに合わせる)
+    EPLATEAUCollisionComplexity CollisionComplexity = EPLATEAUCollisionComplexity::Complex;
+    //! 設定されている場合、テクスチャをこの解像度のアトラスに詰める
+    TOptional<EPLATEAUTexturePackingResolution> TexturePackingResolution;
 
     TMap<FString, FPLATEAUCityObject> CityObjMap;
 
@@ -0,0 +1,72 @@
+// Copyright 2023 Ministry of Land, Infrastructure and Transport
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief 地形メッシュのチャンク1つ分の三角形です。頂点はハイトマップの格子上の位置(列, 行)で表します。
+ */
+struct FPLATEAUTerrainMeshChunk {
+    //! チャンクの位置(チャンク単位)
+    FIntPoint ChunkIndex = FIntPoint::ZeroValue;
+    TArray<FIntPoint> Vertices;
+    TArray<uint32> Indices;
+};
+
+/**
+ * @brief ハイトマップからRTIN(Right-Triangulated Irregular Network)により簡略化した三角形メッシュを生成します。
+ * 格子点ごとに、その点を斜辺の中点とする三角形の組を分割しなかった場合の誤差(三角形内の全格子点での高さの差と子孫の誤差の最大値)を
+ * 事前に計算し、許容誤差を超える三角形のみを分割します。斜辺を共有する三角形は必ず同時に分割されるため、T字頂点による隙間は生じません。
+ *
+ * 任意の大きさのハイトマップを扱うため、格子を2のべき乗の大きさのブロックに区切り、ブロックごとに2つの三角形から分割を始めます。
+ * ハイトマップの外にはみ出すブロックは端に沿って最も細かく分割し、はみ出した三角形を取り除きます。
+ */
+class PLATEAURUNTIME_API FPLATEAUTerrainMesher {
+public:
+    /**
+     * @param InHeights SizeX * SizeY の高さの値。Extractが終わるまで保持してください。
+     * @param InHeightScale 高さの値1あたりの実際の高さ(cm)
+     * @param InBlockSize 分割を始めるブロックの1辺の格子数。2のべき乗に切り上げます。
+     */
+    FPLATEAUTerrainMesher(const int32 InSizeX, const int32 InSizeY, const uint16* InHeights, const double InHeightScale, const int32 InBlockSize = 256);
+
+    /**
+     * @brief 許容誤差以内に簡略化した三角形をチャンクごとに返します。
+     * 三角形は FPLATEAUMeshLoader の法線計算(InvertMeshNormal無効時)で+Zを向く順に並べます。
+     * @param MaxError 許容誤差(cm)
+     * @param ChunkSizeQuads チャンクの1辺の格子数。0以下の場合は分割せず1つのチャンクとします。
+     */
+    TArray<FPLATEAUTerrainMeshChunk> Extract(const double MaxError, const int32 ChunkSizeQuads) const;
+
+    /**
+     * @brief チャンクの1辺の格子数をブロックの境界に揃う大きさに切り上げます。
+     */
+    static int32 GetAlignedChunkSize(const int32 ChunkSizeQuads);
+
+private:
+    void ComputeErrors();
+    float ComputeTriangleError(const FIntPoint& A, const FIntPoint& B, const FIntPoint& C) const;
+    void AddTriangles(const FIntPoint A, const FIntPoint B, const FIntPoint C, const float Threshold, TArray<FIntPoint>& OutTriangles) const;
+
+    float GetHeight(const int32 X, const int32 Y) const {
+        return Heights[Y * SizeX + X];
+    }
+
+    float GetError(const FIntPoint& Point) const {
+        return Errors[Point.Y * GridSizeX + Point.X];
+    }
+
+    int32 SizeX;
+    int32 SizeY;
+    const uint16* Heights;
+    double HeightScale;
+    int32 BlockSize;
+    int32 NumBlocksX;
+    int32 NumBlocksY;
+    //! ブロックで覆う格子の大きさ(ハイトマップ以上)
+    int32 GridSizeX;
+    int32 GridSizeY;
+    //! 格子点ごとの誤差(高さの値の単位)
+    TArray<float> Errors;
+};
@@ -39,9 +39,17 @@ namespace {
             Feature.bEnableTexturePacking = PackageInfoSettings.bEnableTexturePacking;
             Feature.TexturePackingResolution = PackageInfoSettings.TexturePackingResolution;
             Feature.MeshGranularity = static_cast<EPLATEAUMeshGranularity>(PackageInfoSettings.Granularity);
+            Feature.GridCountOfSide = PackageInfoSettings.GridCountOfSide;
+            Feature.TargetDrawCallsPerGml = PackageInfoSettings.TargetDrawCallsPerGml;
+            Feature.MaxTrianglesPerMesh = PackageInfoSettings.MaxTrianglesPerMesh;
+            Feature.VertexFormat = PackageInfoSettings.VertexFormat;
+            Feature.bWeldVertices = PackageInfoSettings.bWeldVertices;
+            Feature.CreaseAngle = PackageInfoSettings.CreaseAngle;
             Feature.MinLod = PackageInfoSettings.MinLod;
             Feature.MaxLod = PackageInfoSettings.MaxLod;
             Feature.FallbackMaterial = PackageInfoSettings.FallbackMaterial;
+            Feature.CollisionComplexity = PackageInfoSettings.CollisionComplexity;
+            Feature.bDeferCollisionCooking = PackageInfoSettings.bDeferCollisionCooking;
             if (Package == plateau::dataset::PredefinedCityModelPackage::Relief) {
                 Feature.bAttachMapTile = PackageInfoSettings.bAttachMapTile;
                 Feature.MapTileUrl = PackageInfoSettings.MapTileUrl;
@@ -8,6 +8,20 @@
 #include "PLATEAURuntime/Public/PLATEAUInstancedCityModel.h"
 using namespace citygml;
 
+namespace {
+    /**
+     * @brief 分割インポートで未読み込みのセルが無いことを確認します。未読み込みのセルがある場合はエラーを出力します。
+     */
+    bool CheckAllStreamingCellsLoaded(const APLATEAUInstancedCityModel* TargetCityModel) {
+        const auto UnloadedCellCount = TargetCityModel->GetUnloadedStreamingCellCount();
+        if (UnloadedCellCount <= 0)
+            return true;
+
+        UE_LOG(LogTemp, Error, TEXT("%d streaming cells of %s are not loaded. Load all cells before filtering."), UnloadedCellCount, *TargetCityModel->DatasetName);
+        return false;
+    }
+}
+
 /**
  * @brief フィルタリング項目のパッケージ値とタイトルのマップ取得
  * @return フィルタリング項目情報を格納したマップ
@@ -18,28 +32,50 @@ TMap<int64, FText> UPLATEAUModelAdjustmentFilterAPI::GetFilteringNames() {
 
 /**
  * @brief 選択中のPLATEAUInstancedCityModelからパッケージ情報取得
+ * インポート時に分割された場合は同一のインポートで生成された全てのアクタのパッケージを合わせます。
  * @param TargetCityModel アウトライナー上で選択したPLATEAUInstancedCityModel
  * @return パッケージ情報
  */
 int64 UPLATEAUModelAdjustmentFilterAPI::GetCityModelPackages(const APLATEAUInstancedCityModel* TargetCityModel) {
     if (TargetCityModel == nullptr)
         return 0;
-    return static_cast<int64>(TargetCityModel->GetCityModelPackages());
+
+    int64 Packages = 0;
+    for (const auto CellCityModel : TargetCityModel->GetStreamingCellCityModels()) {
+        Packages |= static_cast<int64>(CellCityModel->GetCityModelPackages());
+    }
+    return Packages;
 }
 
 /**
  * @brief 選択中のPLATEAUInstancedCityModelからLod情報取得
+ * インポート時に分割された場合は対象パッケージを含む全てのアクタのLod範囲を合わせます。
  * @param TargetCityModel アウトライナー上で選択したPLATEAUInstancedCityModel
  * @param Package Lod取得対象のパッケージ
  * @return 対象パッケージのLod情報を格納した構造体
  */
 FPLATEAUPackageLod UPLATEAUModelAdjustmentFilterAPI::GetMinMaxLod(const APLATEAUInstancedCityModel* TargetCityModel, const int64 Package) {
-    const auto [MinLod, MaxLod] = TargetCityModel->GetMinMaxLod(static_cast<plateau::dataset::PredefinedCityModelPackage>(Package));
-    return FPLATEAUPackageLod(MinLod, MaxLod);
+    const auto CastPackage = static_cast<plateau::dataset::PredefinedCityModelPackage>(Package);
+    TOptional<FPLATEAUPackageLod> PackageLod;
+    for (const auto CellCityModel : TargetCityModel->GetStreamingCellCityModels()) {
+        if ((CellCityModel->GetCityModelPackages() & CastPackage) == plateau::dataset::PredefinedCityModelPackage::None)
+            continue;
+
+        const auto [MinLod, MaxLod] = CellCityModel->GetMinMaxLod(CastPackage);
+        if (PackageLod.IsSet()) {
+            PackageLod->MinLod = FMath::Min(PackageLod->MinLod, MinLod);
+            PackageLod->MaxLod = FMath::Max(PackageLod->MaxLod, MaxLod);
+        }
+        else {
+            PackageLod = FPLATEAUPackageLod(MinLod, MaxLod);
+        }
+    }
+    return PackageLod.Get(FPLATEAUPackageLod(0, 0));
 }
 
 /**
  * @brief フィルタリング実行
+ * インポート時に分割された場合は同一のインポートで生成された全てのアクタに適用します。
  * @param TargetCityModel アウトライナー上で選択したPLATEAUInstancedCityModel
  * @param EnablePackage 有効化パッケージ
  * @param PackageToLodRangeMap パッケージごとのLodに関してのユーザー選択結果 
@@ -60,7 +96,11 @@ void UPLATEAUModelAdjustmentFilterAPI::ApplyFilter(APLATEAUInstancedCityModel* T
     for (const auto& Entity : PackageToLodRangeMap) {
         CastPackageToLodRangeMap.Add(static_cast<plateau::dataset::PredefinedCityModelPackage>(Entity.Key), { Entity.Value.MinLod, Entity.Value.MaxLod });
     }
-    TargetCityModel->FilterByLods(static_cast<plateau::dataset::PredefinedCityModelPackage>(EnablePackage), CastPackageToLodRangeMap, bOnlyMaxLod)->FilterByFeatureTypes(static_cast<CityObject::CityObjectsType>(EnableCityObject | HiddenFeatureTypes));
+    if (!CheckAllStreamingCellsLoaded(TargetCityModel))
+        return;
+    for (const auto CellCityModel : TargetCityModel->GetStreamingCellCityModels()) {
+        CellCityModel->FilterByLods(static_cast<plateau::dataset::PredefinedCityModelPackage>(EnablePackage), CastPackageToLodRangeMap, bOnlyMaxLod)->FilterByFeatureTypes(static_cast<CityObject::CityObjectsType>(EnableCityObject | HiddenFeatureTypes));
+    }
 }
 
 void UPLATEAUModelAdjustmentFilterAPI::FilterModel(APLATEAUInstancedCityModel* TargetCityModel, const TArray<EPLATEAUCityModelPackage> EnablePackages, const TMap<EPLATEAUCityModelPackage, FPLATEAUPackageLod>& PackageToLodRangeMap, const bool bOnlyMaxLod, const TArray<EPLATEAUCityObjectsType> EnableCityObjects) {
@@ -78,6 +118,14 @@ void UPLATEAUModelAdjustmentFilterAPI::FilterModel(APLATEAUInstancedCityModel* T
     ApplyFilter(TargetCityModel, EnablePackage, LodMap, bOnlyMaxLod, EnableCityObject);
 }
 
+void UPLATEAUModelAdjustmentFilterAPI::FilterByAttributes(APLATEAUInstancedCityModel* TargetCityModel, const TArray<FPLATEAUAttributeCondition>& Conditions) {
+    if (TargetCityModel == nullptr || !CheckAllStreamingCellsLoaded(TargetCityModel))
+        return;
+    for (const auto CellCityModel : TargetCityModel->GetStreamingCellCityModels()) {
+        CellCityModel->FilterByAttributes(Conditions);
+    }
+}
+
 TArray<EPLATEAUCityModelPackage> UPLATEAUModelAdjustmentFilterAPI::ConvertCityModelPackagesToEnumArray(const int64 Package) {
     TSet<EPLATEAUCityModelPackage> EnumSet;
     for (plateau::dataset::PredefinedCityModelPackage Pkg : UPLATEAUImportSettings::GetAllPackages()) {
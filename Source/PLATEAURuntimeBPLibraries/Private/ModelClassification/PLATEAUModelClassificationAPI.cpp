@@ -80,6 +80,42 @@ namespace {
         return Values;
     }
 
+    /**
+     * @brief 対象コンポーネントとその子孫のうち、メッシュを持つUPLATEAUCityObjectGroupを取得
+     */
+    TArray<UPLATEAUCityObjectGroup*> GetCityObjectGroups(const TArray<USceneComponent*>& TargetComponents) {
+        TSet<UPLATEAUCityObjectGroup*> CityObjectGroups;
+        for (const auto Comp : TargetComponents) {
+            if (Comp == nullptr)
+                continue;
+
+            TArray<USceneComponent*> Components;
+            Comp->GetChildrenComponents(true, Components);
+            Components.Add(Comp);
+            for (const auto Component : Components) {
+                if (const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Component); CityObjectGroup != nullptr && CityObjectGroup->GetStaticMesh() != nullptr)
+                    CityObjectGroups.Add(CityObjectGroup);
+            }
+        }
+        return CityObjectGroups.Array();
+    }
+
+    void SetClassColor(FColor& LookupValue, const FLinearColor& Color) {
+        // アルファは可視性として使用されるため保持
+        const auto ClassColor = Color.ToFColor(true);
+        LookupValue.R = ClassColor.R;
+        LookupValue.G = ClassColor.G;
+        LookupValue.B = ClassColor.B;
+    }
+
+    void ApplyClassColor(UPLATEAUCityObjectGroup* CityObjectGroup, TFunctionRef<void(const FPLATEAUCityObject&, FColor&)> UpdateFunc) {
+        if (CityObjectGroup->UpdateCityObjectLookup(UpdateFunc)) {
+            CityObjectGroup->SetCityObjectClassColorEnabled(true);
+        }
+        else {
+            UE_LOG(LogTemp, Error, TEXT("Failed to classify %s with lookup texture."), *CityObjectGroup->GetName());
+        }
+    }
 }
 
 TSet<FString> UPLATEAUModelClassificationAPI::SearchAttributeKeys(const TArray<USceneComponent*> TargetComponents) {
@@ -158,4 +194,71 @@ void UPLATEAUModelClassificationAPI::ClassifyByAttribute(APLATEAUInstancedCityMo
 #else
     FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(TEXT("この機能は、エディタのみでご利用いただけます。")));
 #endif  
-}
\ No newline at end of file
+}
+
+void UPLATEAUModelClassificationAPI::ClassifyByTypeWithLookup(TArray<USceneComponent*> TargetComponents, TMap<EPLATEAUCityObjectsType, FLinearColor> Colors, FLinearColor DefaultColor) {
+    for (const auto CityObjectGroup : GetCityObjectGroups(TargetComponents)) {
+        ApplyClassColor(CityObjectGroup, [&Colors, &DefaultColor](const FPLATEAUCityObject& CityObject, FColor& LookupValue) {
+            const auto Color = Colors.Find(CityObject.Type);
+            SetClassColor(LookupValue, Color != nullptr ? *Color : DefaultColor);
+        });
+    }
+}
+
+void UPLATEAUModelClassificationAPI::ClassifyByAttributeWithLookup(TArray<USceneComponent*> TargetComponents, FString AttributeKey, TMap<FString, FLinearColor> Colors, FLinearColor DefaultColor) {
+    const auto FindColor = [&Colors, &AttributeKey](const FPLATEAUCityObject& CityObject) -> const FLinearColor* {
+        for (const auto& Attr : UPLATEAUAttributeValueBlueprintLibrary::GetAttributesByKey(AttributeKey, CityObject.Attributes)) {
+            if (const auto Color = Colors.Find(Attr.StringValue))
+                return Color;
+        }
+        return nullptr;
+    };
+
+    for (const auto CityObjectGroup : GetCityObjectGroups(TargetComponents)) {
+        // 属性を持たない最小地物のために主要地物の分類色を保持
+        TMap<int32, FLinearColor> PrimaryColors;
+        for (const auto& CityObject : CityObjectGroup->GetAllRootCityObjects()) {
+            if (const auto Color = FindColor(CityObject))
+                PrimaryColors.Add(CityObject.CityObjectIndex.PrimaryIndex, *Color);
+        }
+
+        ApplyClassColor(CityObjectGroup, [&](const FPLATEAUCityObject& CityObject, FColor& LookupValue) {
+            auto Color = FindColor(CityObject);
+            if (Color == nullptr)
+                Color = PrimaryColors.Find(CityObject.CityObjectIndex.PrimaryIndex);
+            SetClassColor(LookupValue, Color != nullptr ? *Color : DefaultColor);
+        });
+    }
+}
+
+void UPLATEAUModelClassificationAPI::ClassifyByAttributeQueryWithLookup(APLATEAUInstancedCityModel* TargetCityModel, const TArray<FPLATEAUAttributeCondition>& Conditions, FLinearColor MatchedColor, FLinearColor DefaultColor) {
+    if (TargetCityModel == nullptr)
+        return;
+
+    const auto Result = TargetCityModel->QueryCityObjectsByAttributes(Conditions);
+    TArray<UPLATEAUCityObjectGroup*> CityObjectGroups;
+    TargetCityModel->GetComponents<UPLATEAUCityObjectGroup>(CityObjectGroups);
+    for (const auto CityObjectGroup : CityObjectGroups) {
+        // 主要地物が条件を満たす場合はその最小地物も条件を満たすものとして扱う
+        TSet<int32> MatchedPrimaryIndices;
+        for (const auto& CityObject : CityObjectGroup->GetAllRootCityObjects()) {
+            if (Result.GmlIDs.Contains(CityObject.GmlID))
+                MatchedPrimaryIndices.Add(CityObject.CityObjectIndex.PrimaryIndex);
+        }
+
+        ApplyClassColor(CityObjectGroup, [&](const FPLATEAUCityObject& CityObject, FColor& LookupValue) {
+            const auto bMatched = Result.GmlIDs.Contains(CityObject.GmlID) || MatchedPrimaryIndices.Contains(CityObject.CityObjectIndex.PrimaryIndex);
+            SetClassColor(LookupValue, bMatched ? MatchedColor : DefaultColor);
+        });
+    }
+}
+
+void UPLATEAUModelClassificationAPI::ResetLookupClassification(TArray<USceneComponent*> TargetComponents) {
+    for (const auto CityObjectGroup : GetCityObjectGroups(TargetComponents)) {
+        // フィルタリングで非表示にしている都市オブジェクトがある場合はルックアップを残す
+        if (CityObjectGroup->HasHiddenCityObjects())
+            CityObjectGroup->SetCityObjectClassColorEnabled(false);
+        else
+            CityObjectGroup->ResetCityObjectLookup();
+    }
+}
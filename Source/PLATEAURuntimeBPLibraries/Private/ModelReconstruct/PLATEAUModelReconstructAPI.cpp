@@ -30,4 +30,12 @@ void UPLATEAUModelReconstructAPI::ReconstructModel(APLATEAUInstancedCityModel* T
 #else
     FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(TEXT("この機能は、エディタのみでご利用いただけます。")));
 #endif
-}
\ No newline at end of file
+}
+
+void UPLATEAUModelReconstructAPI::PackTextures(APLATEAUInstancedCityModel* TargetCityModel, TArray<USceneComponent*> TargetComponents, const EPLATEAUTexturePackingResolution Resolution, bool bDestroyOriginal) {
+#if WITH_EDITOR
+    TargetCityModel->PackTextures(TargetComponents, Resolution, bDestroyOriginal);
+#else
+    FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(TEXT("この機能は、エディタのみでご利用いただけます。")));
+#endif
+}
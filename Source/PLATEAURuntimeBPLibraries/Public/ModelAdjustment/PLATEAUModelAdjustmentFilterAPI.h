@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "CityGML/PLATEAUAttributeStore.h"
 #include "PLATEAUModelAdjustmentFilterAPI.generated.h"
 
 class APLATEAUInstancedCityModel;
@@ -44,6 +45,13 @@ public:
     UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelAdjustmentAPI")
     static void FilterModel(APLATEAUInstancedCityModel* TargetCityModel, const TArray<EPLATEAUCityModelPackage> EnablePackages, const TMap<EPLATEAUCityModelPackage, FPLATEAUPackageLod>& PackageToLodRangeMap, const bool bOnlyMaxLod, const TArray<EPLATEAUCityObjectsType> EnableCityObjects);
 
+    /**
+     * @brief 全ての属性条件を満たす都市オブジェクトのみを表示します。FilterModelの後に呼び出すことで絞り込みを重ねられます。
+     * インポート時に分割された場合は同一のインポートで生成された全てのアクタに適用します。
+     */
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelAdjustmentAPI")
+    static void FilterByAttributes(APLATEAUInstancedCityModel* TargetCityModel, const TArray<FPLATEAUAttributeCondition>& Conditions);
+
     UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelAdjustmentAPI")
     static TArray<EPLATEAUCityModelPackage> ConvertCityModelPackagesToEnumArray(const int64 Package);
 };
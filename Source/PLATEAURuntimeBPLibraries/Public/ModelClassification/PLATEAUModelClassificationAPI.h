@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "CityGML/PLATEAUAttributeStore.h"
 #include "PLATEAUModelClassificationAPI.generated.h"
 
 class APLATEAUInstancedCityModel;
@@ -30,4 +31,31 @@ class PLATEAURUNTIMEBPLIBRARIES_API UPLATEAUModelClassificationAPI : public UBlu
 
     UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelClassificationAPI")
     static void ClassifyByAttribute(APLATEAUInstancedCityModel* TargetCityModel, TArray<USceneComponent*> TargetComponents, FString AttributeKey, TMap<FString, UMaterialInterface*> Materials, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal);
+
+    /**
+     * @brief メッシュを再構築せずに、都市オブジェクトの種類ごとの色で描画します。
+     * UV4の都市オブジェクトインデックスで参照するルックアップテクスチャを更新するため、再分類はテクスチャ更新のみで完了します。
+     */
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelClassificationAPI")
+    static void ClassifyByTypeWithLookup(TArray<USceneComponent*> TargetComponents, TMap<EPLATEAUCityObjectsType, FLinearColor> Colors, FLinearColor DefaultColor);
+
+    /**
+     * @brief メッシュを再構築せずに、属性値ごとの色で描画します。
+     * 属性を持たない最小地物は主要地物の属性値で分類されます。
+     */
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelClassificationAPI")
+    static void ClassifyByAttributeWithLookup(TArray<USceneComponent*> TargetComponents, FString AttributeKey, TMap<FString, FLinearColor> Colors, FLinearColor DefaultColor);
+
+    /**
+     * @brief メッシュを再構築せずに、全ての属性条件を満たす都市オブジェクトをMatchedColor、それ以外をDefaultColorで描画します。
+     * 主要地物が条件を満たす場合、その最小地物もMatchedColorで描画されます。
+     */
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelClassificationAPI")
+    static void ClassifyByAttributeQueryWithLookup(APLATEAUInstancedCityModel* TargetCityModel, const TArray<FPLATEAUAttributeCondition>& Conditions, FLinearColor MatchedColor, FLinearColor DefaultColor);
+
+    /**
+     * @brief ClassifyByTypeWithLookup, ClassifyByAttributeWithLookup, ClassifyByAttributeQueryWithLookupによる分類色を解除し、元のマテリアルに戻します。
+     */
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ModelClassificationAPI")
+    static void ResetLookupClassification(TArray<USceneComponent*> TargetComponents);
 };
@@ -8,6 +8,7 @@
 
 class APLATEAUInstancedCityModel;
 class UPLATEAUCityObjectGroup;
+enum class EPLATEAUTexturePackingResolution : uint8;
 
 UCLASS()
 class PLATEAURUNTIMEBPLIBRARIES_API UPLATEAUModelReconstructAPI : public UBlueprintFunctionLibrary
@@ -22,4 +23,7 @@ public:
 
     UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ReconstructAPI")
     static void ReconstructModel(APLATEAUInstancedCityModel* TargetCityModel, TArray<USceneComponent*> TargetComponents, const EPLATEAUMeshGranularity ReconstructType, bool bDestroyOriginal);
+
+    UFUNCTION(BlueprintCallable, Category = "PLATEAU|BPLibraries|ReconstructAPI")
+    static void PackTextures(APLATEAUInstancedCityModel* TargetCityModel, TArray<USceneComponent*> TargetComponents, const EPLATEAUTexturePackingResolution Resolution, bool bDestroyOriginal);
 };
@@ -27,6 +27,9 @@ public class PLATEAUTests : ModuleRules {
 				"PLATEAUEditorBPLibraries",
                 "PLATEAURuntimeBPLibraries",
                 "UnrealEd",
+				"Json",
+				"FileUtilities",
+				"ImageWrapper",
 			});
 
 		DynamicallyLoadedModuleNames.AddRange(
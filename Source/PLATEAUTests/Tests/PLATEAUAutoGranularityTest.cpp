@@ -0,0 +1,115 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "PLATEAUAutoGranularity.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "SyntheticDataset/PLATEAUSyntheticDatasetGenerator.h"
+#include <citygml/citygml.h>
+#include <citygml/citymodel.h>
+#include <plateau/polygon_mesh/mesh_extract_options.h>
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_AutoGranularity_Resolve, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.AutoGranularity.Resolve",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_AutoGranularity_Resolve::RunTest(const FString& Parameters) {
+    using plateau::polygonMesh::MeshGranularity;
+
+    FPLATEAUAutoGranularityBudget Budget;
+    Budget.MaxDrawCalls = 1000;
+    Budget.MaxTrianglesPerMesh = 10000;
+
+    FPLATEAUCityModelMeshStats Stats;
+    Stats.LodCount = 1;
+    Stats.TriangleCount = 1000000;
+
+    // 最小地物単位が目標に収まる場合は最小地物単位
+    Stats.AtomicMeshCount = 800;
+    Stats.PrimaryMeshCount = 100;
+    plateau::polygonMesh::MeshExtractOptions ExtractOptions;
+    FPLATEAUAutoGranularity::Resolve(Stats, Budget, ExtractOptions);
+    TestTrue("Atomic", ExtractOptions.mesh_granularity == MeshGranularity::PerAtomicFeatureObject);
+
+    // 主要地物単位のみ目標に収まる場合は主要地物単位
+    Stats.AtomicMeshCount = 5000;
+    Stats.PrimaryMeshCount = 1000;
+    FPLATEAUAutoGranularity::Resolve(Stats, Budget, ExtractOptions);
+    TestTrue("Primary", ExtractOptions.mesh_granularity == MeshGranularity::PerPrimaryFeatureObject);
+
+    // いずれも収まらない場合は三角形数から分割数を決定した地域単位
+    Stats.PrimaryMeshCount = 2000;
+    FPLATEAUAutoGranularity::Resolve(Stats, Budget, ExtractOptions);
+    TestTrue("Area", ExtractOptions.mesh_granularity == MeshGranularity::PerCityModelArea);
+    TestEqual("GridCount", ExtractOptions.grid_count_of_side, 10);
+
+    // 分割数はLODごとのメッシュ数がドローコールの上限を超えない範囲に制限
+    Stats.LodCount = 4;
+    Stats.TriangleCount = 100000000;
+    FPLATEAUAutoGranularity::Resolve(Stats, Budget, ExtractOptions);
+    TestEqual("GridCountClamped", ExtractOptions.grid_count_of_side, 15);
+
+    // 三角形が少ない場合は分割しない
+    Stats.TriangleCount = 100;
+    FPLATEAUAutoGranularity::Resolve(Stats, Budget, ExtractOptions);
+    TestEqual("GridCountMin", ExtractOptions.grid_count_of_side, 1);
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_AutoGranularity_CountMeshes, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.AutoGranularity.CountMeshes",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_AutoGranularity_CountMeshes::RunTest(const FString& Parameters) {
+    const auto WorkDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/AutoGranularity"));
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+
+    // 建築物はLOD1の立体と、LOD2の6つの境界面(地面、屋根、壁4面)を持つ
+    FPLATEAUSyntheticDatasetOptions Options;
+    Options.ThirdMeshCount = 1;
+    Options.BuildingCount = 4;
+    Options.MaxLod = 2;
+    Options.bGenerateTexture = false;
+    TArray<FString> GmlPaths;
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, WorkDir, GmlPaths)) {
+        AddError("Failed to generate synthetic dataset");
+        return false;
+    }
+    const auto GmlPath = GmlPaths.FindByPredicate([](const FString& Path) {
+        return Path.Contains(TEXT("/udx/bldg/"));
+    });
+    if (!TestNotNull("Building GML", GmlPath))
+        return false;
+
+    citygml::ParserParams ParserParams;
+    ParserParams.tesselate = true;
+    const auto CityModel = citygml::load(TCHAR_TO_UTF8(**GmlPath), ParserParams);
+    if (!TestNotNull("CityModel", CityModel.get()))
+        return false;
+
+    // 全LOD: 最小地物単位は建築物ごとにLOD1の1つと境界面の6つ、主要地物単位は建築物ごとにLOD1、LOD2の2つ
+    const auto AllStats = FPLATEAUAutoGranularity::CountMeshes(*CityModel, 0, 3);
+    TestEqual("All.AtomicMeshCount", AllStats.AtomicMeshCount, static_cast<int64>(4 * 7));
+    TestEqual("All.PrimaryMeshCount", AllStats.PrimaryMeshCount, static_cast<int64>(4 * 2));
+    TestEqual("All.LodCount", AllStats.LodCount, 2);
+    TestEqual("All.TriangleCount", AllStats.TriangleCount, static_cast<int64>(4 * 2 * 12));
+
+    // LOD2のみ: LOD1の立体は数えない
+    const auto Lod2Stats = FPLATEAUAutoGranularity::CountMeshes(*CityModel, 2, 2);
+    TestEqual("Lod2.AtomicMeshCount", Lod2Stats.AtomicMeshCount, static_cast<int64>(4 * 6));
+    TestEqual("Lod2.PrimaryMeshCount", Lod2Stats.PrimaryMeshCount, static_cast<int64>(4));
+    TestEqual("Lod2.LodCount", Lod2Stats.LodCount, 1);
+    TestEqual("Lod2.TriangleCount", Lod2Stats.TriangleCount, static_cast<int64>(4 * 12));
+
+    // 対象のLODにジオメトリが無い場合は何も数えない
+    const auto Lod3Stats = FPLATEAUAutoGranularity::CountMeshes(*CityModel, 3, 3);
+    TestEqual("Lod3.AtomicMeshCount", Lod3Stats.AtomicMeshCount, static_cast<int64>(0));
+    TestEqual("Lod3.PrimaryMeshCount", Lod3Stats.PrimaryMeshCount, static_cast<int64>(0));
+    TestEqual("Lod3.LodCount", Lod3Stats.LodCount, 0);
+
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+    return true;
+}
@@ -91,6 +91,10 @@ protected:
     }
     
     APLATEAUCityModelLoader* GetInstancedCityLoader(const UWorld& World) {
+        return GetInstancedCityLoader(World, plateau::dataset::PredefinedCityModelPackage::Building);
+    }
+
+    APLATEAUCityModelLoader* GetInstancedCityLoader(const UWorld& World, const plateau::dataset::PredefinedCityModelPackage Package) {
         TArray<AActor*> FoundActors;
         UGameplayStatics::GetAllActorsOfClass(&World, APLATEAUInstancedCityModel::StaticClass(), FoundActors);
         if (0 < FoundActors.Num()) {
@@ -98,12 +102,12 @@ protected:
         } else {
             constexpr int ZoneId = 9;
             const FVector ReferencePoint = FVector(-472281.96875, 5131018, 0);
-            constexpr int64 PackageMask = static_cast<int64>(plateau::dataset::PredefinedCityModelPackage::Building);
+            const int64 PackageMask = static_cast<int64>(Package);
             const FString SourcePath = UKismetSystemLibrary::GetProjectContentDirectory().Append("data");
-            const auto defaultMat = UPLATEAUImportAreaSelectBtn::GetDefaultFallbackMaterial(static_cast<int64>(plateau::dataset::PredefinedCityModelPackage::Building));
+            const auto defaultMat = UPLATEAUImportAreaSelectBtn::GetDefaultFallbackMaterial(static_cast<int64>(Package));
             const FPackageInfoSettings PackageInfoSettings(true, true, true, true, EPLATEAUTexturePackingResolution::H4096W4096, 0, 4, 1, defaultMat, false, "", 7);
             TMap<int64, FPackageInfoSettings> PackageInfoSettingsData;
-            PackageInfoSettingsData.Add(static_cast<int64>(plateau::dataset::PredefinedCityModelPackage::Building), PackageInfoSettings);
+            PackageInfoSettingsData.Add(static_cast<int64>(Package), PackageInfoSettings);
             const auto& Loader = GetLocalCityModelLoader(ZoneId, ReferencePoint, PackageMask, SourcePath, PackageInfoSettingsData);
             if (Loader) {
                 return Loader;
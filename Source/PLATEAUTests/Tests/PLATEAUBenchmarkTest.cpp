@@ -0,0 +1,452 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "FileHelpers.h"
+#include "PLATEAUAutomationTestBase.h"
+#include "PLATEAUCityModelLoader.h"
+#include "PLATEAUInstancedCityModel.h"
+#include "PLATEAUExportSettings.h"
+#include "Export/PLATEAUExportModelAPI.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "HAL/FileManagerGeneric.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "Tasks/Task.h"
+
+/**
+ * パフォーマンス計測用のテストです。
+ * 各処理の所要時間とメモリ使用量を計測し、TestLogs/Benchmark/{テスト名}.json に出力します。
+ * 処理ごとのメモリ増減はBegin、Endで計測した処理のusedPhysicalDeltaMBに記録します。
+ * usedPhysicalMBは各処理の完了時点の使用量です。プロセス起動からのピーク(processPeakUsedPhysicalMB)は処理ごとには分離できないため、結果全体に1つだけ記録します。
+ * 環境変数PLATEAU_BENCHMARK_REVISIONが設定されている場合はその値(コミットハッシュ等)を結果に記録します。
+ */
+namespace {
+    constexpr double BytesPerMegaByte = 1024.0 * 1024.0;
+
+    /**
+     * @brief 計測結果を記録し、機械可読な形式で書き出します。
+     */
+    class FPLATEAUBenchmarkRecorder {
+    public:
+        explicit FPLATEAUBenchmarkRecorder(const FString& InBenchmarkName)
+            : BenchmarkName(InBenchmarkName) {
+        }
+
+        void Begin(const FString& InStageName) {
+            StageName = InStageName;
+            StartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+            StartSeconds = FPlatformTime::Seconds();
+        }
+
+        void End() {
+            const auto Seconds = FPlatformTime::Seconds() - StartSeconds;
+            const auto UsedPhysicalDelta = static_cast<double>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<double>(StartUsedPhysical);
+            Add(StageName, Seconds, { { TEXT("usedPhysicalDeltaMB"), UsedPhysicalDelta / BytesPerMegaByte } });
+        }
+
+        /**
+         * @param Metrics 所要時間、メモリ以外に記録する値(頂点数等)
+         */
+        void Add(const FString& InStageName, const double Seconds, const TMap<FString, double>& Metrics = {}) {
+            const auto MemoryStats = FPlatformMemory::GetStats();
+            const TSharedPtr<FJsonObject> StageJsonObject = MakeShareable(new FJsonObject);
+            StageJsonObject->SetStringField(TEXT("name"), InStageName);
+            StageJsonObject->SetNumberField(TEXT("seconds"), Seconds);
+            StageJsonObject->SetNumberField(TEXT("usedPhysicalMB"), MemoryStats.UsedPhysical / BytesPerMegaByte);
+            for (const auto& [MetricName, Value] : Metrics) {
+                StageJsonObject->SetNumberField(MetricName, Value);
+            }
+            Stages.Emplace(MakeShared<FJsonValueObject>(StageJsonObject));
+        }
+
+        bool Write() const {
+            const TSharedPtr<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
+            JsonRootObject->SetStringField(TEXT("benchmark"), BenchmarkName);
+            JsonRootObject->SetStringField(TEXT("revision"), FPlatformMisc::GetEnvironmentVariable(TEXT("PLATEAU_BENCHMARK_REVISION")));
+            JsonRootObject->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+            JsonRootObject->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+            JsonRootObject->SetNumberField(TEXT("processPeakUsedPhysicalMB"), FPlatformMemory::GetStats().PeakUsedPhysical / BytesPerMegaByte);
+            JsonRootObject->SetArrayField(TEXT("stages"), Stages);
+
+            FString SerializedResult;
+            const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SerializedResult);
+            FJsonSerializer::Serialize(JsonRootObject.ToSharedRef(), Writer);
+
+            const FString ResultPath = FPaths::ProjectDir().Append("TestLogs/Benchmark/" + BenchmarkName + ".json");
+            FFileManagerGeneric::Get().MakeDirectory(*FPaths::GetPath(ResultPath), true);
+            return FFileHelper::SaveStringToFile(SerializedResult, *ResultPath);
+        }
+
+    private:
+        FString BenchmarkName;
+        FString StageName;
+        double StartSeconds = 0;
+        uint64 StartUsedPhysical = 0;
+        TArray<TSharedPtr<FJsonValue>> Stages;
+    };
+
+    APLATEAUInstancedCityModel* FindCityModel(const UWorld* World) {
+        TArray<AActor*> CityModelActors;
+        UGameplayStatics::GetAllActorsOfClass(World, APLATEAUInstancedCityModel::StaticClass(), CityModelActors);
+        return CityModelActors.Num() > 0 ? Cast<APLATEAUInstancedCityModel>(CityModelActors[0]) : nullptr;
+    }
+
+    TArray<USceneComponent*> GetGmlComponentArray(const APLATEAUInstancedCityModel& CityModel) {
+        TArray<USceneComponent*> GmlComponents;
+        for (const auto& GmlComponent : CityModel.GetGmlComponents()) {
+            GmlComponents.Add(GmlComponent);
+        }
+        return GmlComponents;
+    }
+
+    bool IsLoadCompleted(const APLATEAUCityModelLoader* Loader) {
+        return Loader->Phase == ECityModelLoadingPhase::Cancelling || Loader->Phase == ECityModelLoadingPhase::Finished;
+    }
+
+    /**
+     * @brief コンポーネントの描画用メッシュ(LOD0)の頂点数と頂点バッファのサイズを集計します。
+     * @return 頂点数
+     */
+    int64 CountRenderVertices(const TArray<USceneComponent*>& Components, int64& OutVertexBytes) {
+        int64 VertexCount = 0;
+        OutVertexBytes = 0;
+        for (const auto Component : Components) {
+            const auto StaticMeshComponent = Cast<UStaticMeshComponent>(Component);
+            const auto StaticMesh = StaticMeshComponent != nullptr ? StaticMeshComponent->GetStaticMesh() : nullptr;
+            const auto RenderData = StaticMesh != nullptr ? StaticMesh->GetRenderData() : nullptr;
+            if (RenderData == nullptr || RenderData->LODResources.Num() == 0)
+                continue;
+
+            const auto& VertexBuffers = RenderData->LODResources[0].VertexBuffers;
+            const auto NumVertices = VertexBuffers.PositionVertexBuffer.GetNumVertices();
+            VertexCount += NumVertices;
+            OutVertexBytes += static_cast<int64>(NumVertices) * VertexBuffers.PositionVertexBuffer.GetStride()
+                + VertexBuffers.StaticMeshVertexBuffer.GetTangentSize()
+                + VertexBuffers.StaticMeshVertexBuffer.GetTexCoordSize();
+        }
+        return VertexCount;
+    }
+
+    /**
+     * @brief ローダーが計測したGMLごとの所要時間と、生成されたメッシュの描画用の頂点数等を記録します。
+     * @param Prefix 記録する処理名の接頭辞
+     */
+    void AddGmlReports(FPLATEAUBenchmarkRecorder& Recorder, const FString& Prefix, const APLATEAUCityModelLoader& Loader) {
+        const auto CityModel = FindCityModel(Loader.GetWorld());
+        for (const auto& Report : Loader.Status.GmlReports) {
+            const auto GmlName = FPaths::GetBaseFilename(Report.GmlName);
+
+            // GMLのコンポーネント名は拡張子無しのGML名
+            TArray<USceneComponent*> MeshComponents;
+            if (CityModel != nullptr) {
+                for (const auto& GmlComponent : CityModel->GetGmlComponents()) {
+                    if (GmlComponent->GetName().StartsWith(GmlName))
+                        GmlComponent->GetChildrenComponents(true, MeshComponents);
+                }
+            }
+            int64 VertexBytes;
+            const auto VertexCount = CountRenderVertices(MeshComponents, VertexBytes);
+
+            Recorder.Add(Prefix + TEXT(".Gml.") + GmlName, Report.TotalSeconds, {
+                { TEXT("succeeded"), Report.bSucceeded ? 1.0 : 0.0 },
+                { TEXT("triangleCount"), static_cast<double>(Report.TriangleCount) },
+                { TEXT("textureMB"), Report.TextureBytes / BytesPerMegaByte },
+                { TEXT("vertexCount"), static_cast<double>(VertexCount) },
+                { TEXT("vertexBufferMB"), VertexBytes / BytesPerMegaByte },
+            });
+        }
+    }
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUBenchmark_Import_Stages, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUBenchmark.Import.Stages",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPLATEAUBenchmark_Import_Stages::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark_Import_Stages");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Recorder = MakeShared<FPLATEAUBenchmarkRecorder>(TEXT("Import_Stages"));
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    const auto StartSeconds = FPlatformTime::Seconds();
+    Loader->LoadAsync(true);
+
+    // ローダー全体の所要時間と、ローダーが計測したGMLごとの段階別所要時間を記録
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, Recorder, StartSeconds] {
+        if (!IsLoadCompleted(Loader))
+            return false;
+
+        Recorder->Add(TEXT("Import.Total"), FPlatformTime::Seconds() - StartSeconds);
+        if (Loader->Status.GmlReports.Num() == 0) {
+            FinishTest(false, "GmlReports.Num() == 0");
+            return true;
+        }
+
+        const auto StageEnum = StaticEnum<EPLATEAUImportStage>();
+        for (const auto& Report : Loader->Status.GmlReports) {
+            const auto GmlName = FPaths::GetBaseFilename(Report.GmlName);
+            for (int32 Stage = 0; Stage < static_cast<int32>(EPLATEAUImportStage::Count); ++Stage) {
+                const auto StageName = StageEnum->GetNameStringByValue(Stage);
+                Recorder->Add(TEXT("Import.") + StageName + TEXT(".CpuSum.") + GmlName, Report.GetStageSeconds(static_cast<EPLATEAUImportStage>(Stage)));
+                Recorder->Add(TEXT("Import.") + StageName + TEXT(".Wall.") + GmlName, Report.GetStageWallSeconds(static_cast<EPLATEAUImportStage>(Stage)));
+            }
+        }
+        AddGmlReports(*Recorder, TEXT("Import"), *Loader);
+
+        FinishTest(Recorder->Write(), "Failed to write benchmark result");
+        return true;
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUBenchmark_Import_VertexWelding, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUBenchmark.Import.VertexWelding",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPLATEAUBenchmark_Import_VertexWelding::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark_Import_VertexWelding");
+
+    const auto Recorder = MakeShared<FPLATEAUBenchmarkRecorder>(TEXT("Import_VertexWelding"));
+
+    // 頂点の溶接なし、ありでそれぞれインポートし、GMLごとの所要時間と描画用の頂点数、頂点バッファのサイズを比較
+    const TArray<TPair<FString, bool>> Modes = {
+        { TEXT("Split"), false },
+        { TEXT("Welded"), true },
+    };
+    for (const auto& [ModeName, bWeldVertices] : Modes) {
+        const auto Loader = MakeShared<APLATEAUCityModelLoader*>(nullptr);
+        ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Recorder, Loader, ModeName, bWeldVertices] {
+            if (*Loader == nullptr) {
+                if (!OpenNewMap())
+                    AddError("Failed to OpenNewMap");
+
+                *Loader = GetInstancedCityLoader(*GetWorld());
+                if (*Loader == nullptr)
+                    return true;
+
+                auto& Settings = (*Loader)->ImportSettings->GetFeatureSettingsRef(plateau::dataset::PredefinedCityModelPackage::Building);
+                Settings.bWeldVertices = bWeldVertices;
+                Settings.CreaseAngle = 30.0f;
+                (*Loader)->LoadAsync(true);
+                return false;
+            }
+
+            if (!IsLoadCompleted(*Loader))
+                return false;
+
+            AddGmlReports(*Recorder, TEXT("Import.") + ModeName, **Loader);
+            return true;
+        }));
+    }
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Recorder] {
+        FinishTest(Recorder->Write(), "Failed to write benchmark result");
+        return true;
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUBenchmark_Reconstruct_Granularity, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUBenchmark.Reconstruct.Granularity",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPLATEAUBenchmark_Reconstruct_Granularity::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark_Reconstruct_Granularity");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Recorder = MakeShared<FPLATEAUBenchmarkRecorder>(TEXT("Reconstruct_Granularity"));
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    Loader->LoadAsync(true);
+
+    const TArray Granularities = {
+        EPLATEAUMeshGranularity::PerAtomicFeatureObject,
+        EPLATEAUMeshGranularity::PerPrimaryFeatureObject,
+        EPLATEAUMeshGranularity::PerCityModelArea,
+    };
+
+    // 粒度ごとに順番に結合・分離を実行し、完了を待って計測
+    const auto CurrentIndex = MakeShared<int>(-1);
+    const auto CurrentTask = MakeShared<UE::Tasks::TTask<TArray<USceneComponent*>>>();
+    const auto StartSeconds = MakeShared<double>(0);
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, Recorder, Granularities, CurrentIndex, CurrentTask, StartSeconds] {
+        if (!IsLoadCompleted(Loader))
+            return false;
+
+        const auto CityModel = FindCityModel(Loader->GetWorld());
+        if (CityModel == nullptr) {
+            FinishTest(false, "CityModel == nullptr");
+            return true;
+        }
+
+        if (*CurrentIndex >= 0) {
+            if (!CurrentTask->IsCompleted())
+                return false;
+            Recorder->Add(TEXT("Reconstruct.") + UEnum::GetValueAsString(Granularities[*CurrentIndex]), FPlatformTime::Seconds() - *StartSeconds);
+        }
+
+        if (++*CurrentIndex >= Granularities.Num()) {
+            FinishTest(Recorder->Write(), "Failed to write benchmark result");
+            return true;
+        }
+
+        *StartSeconds = FPlatformTime::Seconds();
+        *CurrentTask = CityModel->ReconstructModel(GetGmlComponentArray(*CityModel), Granularities[*CurrentIndex], false);
+        return false;
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUBenchmark_Classification, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUBenchmark.Classification.Type",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPLATEAUBenchmark_Classification::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark_Classification");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Recorder = MakeShared<FPLATEAUBenchmarkRecorder>(TEXT("Classification"));
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    Loader->LoadAsync(true);
+
+    const auto Task = MakeShared<UE::Tasks::TTask<TArray<USceneComponent*>>>();
+    const auto StartSeconds = MakeShared<double>(0);
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, Recorder, Task, StartSeconds] {
+        if (!IsLoadCompleted(Loader))
+            return false;
+
+        const auto CityModel = FindCityModel(Loader->GetWorld());
+        if (CityModel == nullptr) {
+            FinishTest(false, "CityModel == nullptr");
+            return true;
+        }
+
+        if (!Task->IsValid()) {
+            TMap<EPLATEAUCityObjectsType, UMaterialInterface*> Materials;
+            Materials.Add(EPLATEAUCityObjectsType::COT_RoofSurface, nullptr);
+            Materials.Add(EPLATEAUCityObjectsType::COT_WallSurface, nullptr);
+            *StartSeconds = FPlatformTime::Seconds();
+            *Task = CityModel->ClassifyModel(GetGmlComponentArray(*CityModel), Materials, EPLATEAUMeshGranularity::PerAtomicFeatureObject, false);
+            return false;
+        }
+
+        if (!Task->IsCompleted())
+            return false;
+
+        Recorder->Add(TEXT("Classification.Type"), FPlatformTime::Seconds() - *StartSeconds);
+        FinishTest(Recorder->Write(), "Failed to write benchmark result");
+        return true;
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUBenchmark_Landscape, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUBenchmark.Landscape.Create",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPLATEAUBenchmark_Landscape::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark_Landscape");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Recorder = MakeShared<FPLATEAUBenchmarkRecorder>(TEXT("Landscape"));
+    const auto& Loader = GetInstancedCityLoader(*GetWorld(), plateau::dataset::PredefinedCityModelPackage::Relief);
+    Loader->LoadAsync(true);
+
+    const auto Task = MakeShared<UE::Tasks::FTask>();
+    const auto StartSeconds = MakeShared<double>(0);
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, Recorder, Task, StartSeconds] {
+        if (!IsLoadCompleted(Loader))
+            return false;
+
+        const auto CityModel = FindCityModel(Loader->GetWorld());
+        if (CityModel == nullptr || CityModel->GetGmlComponents().Num() == 0) {
+            // テストデータに起伏パッケージが含まれない場合は計測しない
+            AddWarning(TEXT("No relief package in test dataset."));
+            FinishTest(true, "");
+            return true;
+        }
+
+        if (!Task->IsValid()) {
+            FPLATEAULandscapeParam Param;
+            Param.ConvertToLandscape = true;
+            Param.AlignLand = false;
+            *StartSeconds = FPlatformTime::Seconds();
+            *Task = CityModel->CreateLandscape(GetGmlComponentArray(*CityModel), Param, false);
+            return false;
+        }
+
+        if (!Task->IsCompleted())
+            return false;
+
+        Recorder->Add(TEXT("Landscape.Create"), FPlatformTime::Seconds() - *StartSeconds);
+        FinishTest(Recorder->Write(), "Failed to write benchmark result");
+        return true;
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUBenchmark_Export_Formats, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUBenchmark.Export.Formats",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPLATEAUBenchmark_Export_Formats::RunTest(const FString& Parameters) {
+    InitializeTest("Benchmark_Export_Formats");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto Recorder = MakeShared<FPLATEAUBenchmarkRecorder>(TEXT("Export_Formats"));
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, Recorder] {
+        if (!IsLoadCompleted(Loader))
+            return false;
+
+        const auto CityModel = FindCityModel(Loader->GetWorld());
+        if (CityModel == nullptr) {
+            FinishTest(false, "CityModel == nullptr");
+            return true;
+        }
+
+        const TArray Formats = { EMeshFileFormat::OBJ, EMeshFileFormat::FBX, EMeshFileFormat::GLTF };
+        for (const auto Format : Formats) {
+            const auto FormatName = UEnum::GetValueAsString(Format);
+            const FString ExportDir = FPaths::ProjectDir().Append("Tests/Benchmark/" + FormatName);
+            FFileManagerGeneric::Get().DeleteDirectory(*ExportDir, false, true);
+            FFileManagerGeneric::Get().MakeDirectory(*ExportDir, true);
+
+            FPLATEAUMeshExportOptions Options;
+            Options.FileFormat = Format;
+            Options.bExportAsBinary = true;
+            Options.bExportHiddenObjects = false;
+            Options.bExportTexture = true;
+            Options.TransformType = EMeshTransformType::Local;
+            Options.CoordinateSystem = ECoordinateSystem::ENU;
+
+            Recorder->Begin(TEXT("Export.") + FormatName);
+            UPLATEAUExportModelAPI::ExportModel(CityModel, ExportDir, Options);
+            Recorder->End();
+        }
+
+        FinishTest(Recorder->Write(), "Failed to write benchmark result");
+        return true;
+    }));
+
+    return true;
+}
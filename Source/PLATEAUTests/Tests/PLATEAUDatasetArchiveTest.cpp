@@ -0,0 +1,138 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "Dataset/PLATEAUDatasetArchive.h"
+#include "Dataset/PLATEAUGmlReader.h"
+#include "FileUtilities/ZipArchiveWriter.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SyntheticDataset/PLATEAUSyntheticDatasetGenerator.h"
+
+#include <citygml/citygml.h>
+#include <citygml/citymodel.h>
+#include <plateau/dataset/city_model_package.h>
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_DatasetArchive_Read_Gml_In_Archive, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.DatasetArchive.Read_Gml_In_Archive",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_DatasetArchive_Read_Gml_In_Archive::RunTest(const FString& Parameters) {
+    const auto WorkDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/DatasetArchive"));
+    const auto DatasetDir = WorkDir / TEXT("Dataset");
+    const auto ArchivePath = WorkDir / TEXT("Dataset.zip");
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+
+    FPLATEAUSyntheticDatasetOptions Options;
+    Options.ThirdMeshCount = 2;
+    Options.BuildingCount = 4;
+    TArray<FString> GmlPaths;
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, DatasetDir, GmlPaths)) {
+        AddError("Failed to generate synthetic dataset");
+        return false;
+    }
+
+    // データセットをzipに格納
+    {
+        TArray<FString> Files;
+        IFileManager::Get().FindFilesRecursive(Files, *DatasetDir, TEXT("*"), true, false);
+        FZipArchiveWriter Writer(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*ArchivePath));
+        for (const auto& File : Files) {
+            TArray<uint8> Data;
+            FFileHelper::LoadFileToArray(Data, *File);
+            auto EntryName = File;
+            FPaths::MakePathRelativeTo(EntryName, *(WorkDir + TEXT("/")));
+            Writer.AddFile(EntryName, Data, FDateTime::Now());
+        }
+    }
+
+    auto Archive = FPLATEAUDatasetArchive::Get(ArchivePath);
+    if (!TestTrue("Archive.IsValid()", Archive.IsValid()))
+        return false;
+
+    TestEqual("MeshCodes.Num()", Archive->GetMeshCodes().Num(), 2);
+    const auto BuildingGmls = Archive->FindGmlFiles(Archive->GetMeshCodes().Array(), plateau::dataset::PredefinedCityModelPackage::Building);
+    if (!TestEqual("BuildingGmls.Num()", BuildingGmls.Num(), 2))
+        return false;
+
+    // アーカイブ内のGMLと展開済みのGMLで同じ内容が読み込まれること
+    citygml::ParserParams ParserParams;
+    for (const auto& VirtualPath : BuildingGmls) {
+        FString ArchiveFilePath, EntryName;
+        TestTrue("SplitVirtualPath", FPLATEAUDatasetArchive::SplitVirtualPath(VirtualPath, ArchiveFilePath, EntryName));
+        const auto ExtractedPath = WorkDir / EntryName;
+
+        const auto ArchiveCityModel = FPLATEAUGmlReader::Load(VirtualPath, ParserParams);
+        const auto FileCityModel = citygml::load(TCHAR_TO_UTF8(*ExtractedPath), ParserParams);
+        if (!TestTrue("CityModel != nullptr", ArchiveCityModel != nullptr && FileCityModel != nullptr))
+            continue;
+
+        TestEqual("NumRootCityObjects", ArchiveCityModel->getNumRootCityObjects(), FileCityModel->getNumRootCityObjects());
+        TestEqual("GmlPath", FString(UTF8_TO_TCHAR(ArchiveCityModel->getGmlPath().c_str())), VirtualPath);
+
+        // サイズはセントラルディレクトリに記録された展開後のサイズ
+        TestEqual("GetFileSize", FPLATEAUDatasetArchive::GetFileSize(VirtualPath), IFileManager::Get().FileSize(*ExtractedPath));
+    }
+
+    // キャッシュから取り除くとzipファイルが閉じられ、削除できる
+    FPLATEAUDatasetArchive::Release(ArchivePath);
+    TestTrue("Archive.IsUnique()", Archive.IsUnique());
+    Archive.Reset();
+    TestTrue("Delete archive", IFileManager::Get().Delete(*ArchivePath));
+
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_DatasetArchive_Read_Large_Gml_With_Memory_Map, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.DatasetArchive.Read_Large_Gml_With_Memory_Map",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_DatasetArchive_Read_Large_Gml_With_Memory_Map::RunTest(const FString& Parameters) {
+    const auto WorkDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/DatasetMemoryMap"));
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+
+    FPLATEAUSyntheticDatasetOptions Options;
+    Options.ThirdMeshCount = 1;
+    Options.BuildingCount = 4;
+    TArray<FString> GmlPaths;
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, WorkDir, GmlPaths)) {
+        AddError("Failed to generate synthetic dataset");
+        return false;
+    }
+    const auto SourcePath = GmlPaths.FindByPredicate([](const FString& GmlPath) {
+        return GmlPath.Contains(TEXT("/udx/bldg/"));
+    });
+    if (!TestNotNull("Building GML", SourcePath))
+        return false;
+
+    // XML宣言の直後にコメントを挿入し、メモリマップの閾値以上のサイズにする
+    FString Gml;
+    if (!TestTrue("LoadFileToString", FFileHelper::LoadFileToString(Gml, **SourcePath)))
+        return false;
+    const auto DeclarationEnd = Gml.Find(TEXT("?>"));
+    if (!TestTrue("XML declaration", DeclarationEnd != INDEX_NONE))
+        return false;
+    const auto Padding = TEXT("\n<!--") + FString::ChrN(static_cast<int32>(FPLATEAUGmlReader::MemoryMapThresholdBytes), TEXT('x')) + TEXT("-->");
+    Gml.InsertAt(DeclarationEnd + 2, Padding);
+    const auto LargeGmlPath = FPaths::GetPath(*SourcePath) / TEXT("Large_") + FPaths::GetCleanFilename(*SourcePath);
+    if (!TestTrue("SaveStringToFile", FFileHelper::SaveStringToFile(Gml, *LargeGmlPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)))
+        return false;
+    Gml.Empty();
+    TestTrue("FileSize >= MemoryMapThresholdBytes", IFileManager::Get().FileSize(*LargeGmlPath) >= FPLATEAUGmlReader::MemoryMapThresholdBytes);
+
+    // メモリマップで読み込んだ場合も元のGMLと同じ内容で、GMLパスが設定されること
+    citygml::ParserParams ParserParams;
+    const auto MappedCityModel = FPLATEAUGmlReader::Load(LargeGmlPath, ParserParams);
+    const auto FileCityModel = citygml::load(TCHAR_TO_UTF8(**SourcePath), ParserParams);
+    if (TestTrue("CityModel != nullptr", MappedCityModel != nullptr && FileCityModel != nullptr)) {
+        TestEqual("NumRootCityObjects", MappedCityModel->getNumRootCityObjects(), FileCityModel->getNumRootCityObjects());
+        TestEqual("GmlPath", FString(UTF8_TO_TCHAR(MappedCityModel->getGmlPath().c_str())), LargeGmlPath);
+    }
+
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+    return true;
+}
@@ -4,6 +4,7 @@
 #include "PLATEAUAutomationTestBase.h"
 #include "PLATEAUCityModelLoader.h"
 #include "PLATEAUInstancedCityModel.h"
+#include "CityGML/PLATEAUCityObject.h"
 #include "ModelAdjustment/PLATEAUModelAdjustmentBuilding.h"
 #include "ModelAdjustment/PLATEAUModelAdjustmentFilterAPI.h"
 #include "Kismet/GameplayStatics.h"
@@ -124,3 +125,305 @@ bool FPLATEAUTest_ModelAdjustmentFilter_ApplyFilter_Toggles_Visibility::RunTest(
 
     return true;
 }
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_ModelAdjustmentFilter_QueryByAttributes, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.ModelAdjustmentFilter.QueryByAttributes",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_ModelAdjustmentFilter_QueryByAttributes::RunTest(const FString& Parameters) {
+    InitializeTest("QueryByAttributes");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader] {
+        if (Loader->Phase != ECityModelLoadingPhase::Cancelling && Loader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        TArray<AActor*> CityModelActors;
+        UGameplayStatics::GetAllActorsOfClass(Loader->GetWorld(), APLATEAUInstancedCityModel::StaticClass(), CityModelActors);
+        if (CityModelActors.Num() <= 0) {
+            FinishTest(false, "CityModelActors.Num() <= 0");
+            return true;
+        }
+
+        for (auto* CityModelActor : CityModelActors) {
+            APLATEAUInstancedCityModel* CityModel = Cast<APLATEAUInstancedCityModel>(CityModelActor);
+            const auto AttributeStore = CityModel->GetAttributeStore();
+            const auto Keys = AttributeStore->GetKeys();
+            if (Keys.Num() <= 0) {
+                FinishTest(false, "Keys.Num() <= 0");
+                return true;
+            }
+
+            // 条件が空の場合は全ての都市オブジェクト
+            if (AttributeStore->Evaluate({}).CountSetBits() != AttributeStore->GetNumRows()) {
+                FinishTest(false, "Evaluate({}) != NumRows");
+                return true;
+            }
+
+            FPLATEAUAttributeCondition Exists;
+            Exists.Key = Keys[0];
+            Exists.Operator = EPLATEAUAttributeOperator::Exists;
+            if (CityModel->QueryCityObjectsByAttributes({Exists}).GmlIDs.Num() <= 0) {
+                FinishTest(false, "Exists.GmlIDs.Num() <= 0");
+                return true;
+            }
+
+            // 満たされない条件を重ねた場合は空
+            FPLATEAUAttributeCondition NotFound;
+            NotFound.Key = Keys[0];
+            NotFound.Value = TEXT("__PLATEAUTest_NotFound__");
+            if (CityModel->QueryCityObjectsByAttributes({Exists, NotFound}).GmlIDs.Num() != 0) {
+                FinishTest(false, "NotFound.GmlIDs.Num() != 0");
+                return true;
+            }
+
+            // 数値の属性(計測高さを優先)を持つ都市オブジェクトを探す
+            const FPLATEAUCityObject* NumericCityObject = nullptr;
+            FString NumericKey;
+            double NumericValue = 0.0;
+            for (const auto& CityObject : CityModel->GetAllRootCityObjects()) {
+                for (const auto& [Key, Value] : CityObject.Attributes.AttributeMap) {
+                    if (Value.Type == EPLATEAUAttributeType::AttributeSets || !Value.StringValue.IsNumeric())
+                        continue;
+                    if (NumericCityObject != nullptr && (NumericKey.Contains(TEXT("measuredHeight")) || !Key.Contains(TEXT("measuredHeight"))))
+                        continue;
+                    NumericCityObject = &CityObject;
+                    NumericKey = Key;
+                    NumericValue = FCString::Atod(*Value.StringValue);
+                }
+            }
+            if (NumericCityObject == nullptr) {
+                FinishTest(false, "NumericCityObject == nullptr");
+                return true;
+            }
+
+            // 数値として比較される
+            FPLATEAUAttributeCondition GreaterThanLower;
+            GreaterThanLower.Key = NumericKey;
+            GreaterThanLower.Operator = EPLATEAUAttributeOperator::Greater;
+            GreaterThanLower.Value = FString::SanitizeFloat(NumericValue - 1.0);
+            if (!CityModel->QueryCityObjectsByAttributes({GreaterThanLower}).GmlIDs.Contains(NumericCityObject->GmlID)) {
+                FinishTest(false, "Greater(Value - 1) does not contain the object");
+                return true;
+            }
+
+            FPLATEAUAttributeCondition GreaterThanSelf = GreaterThanLower;
+            GreaterThanSelf.Value = FString::SanitizeFloat(NumericValue);
+            if (CityModel->QueryCityObjectsByAttributes({GreaterThanSelf}).GmlIDs.Contains(NumericCityObject->GmlID)) {
+                FinishTest(false, "Greater(Value) contains the object");
+                return true;
+            }
+
+            // 両方を満たす条件を重ねた場合は、それぞれを満たす都市オブジェクトの積
+            FPLATEAUAttributeCondition NumericExists;
+            NumericExists.Key = NumericKey;
+            NumericExists.Operator = EPLATEAUAttributeOperator::Exists;
+            FPLATEAUAttributeCondition GreaterOrEqualSelf = GreaterThanSelf;
+            GreaterOrEqualSelf.Operator = EPLATEAUAttributeOperator::GreaterOrEqual;
+            const auto BothResult = CityModel->QueryCityObjectsByAttributes({NumericExists, GreaterOrEqualSelf});
+            const auto ExistsResult = CityModel->QueryCityObjectsByAttributes({NumericExists});
+            const auto GreaterOrEqualResult = CityModel->QueryCityObjectsByAttributes({GreaterOrEqualSelf});
+            if (!BothResult.GmlIDs.Contains(NumericCityObject->GmlID)) {
+                FinishTest(false, "Exists && GreaterOrEqual does not contain the object");
+                return true;
+            }
+            if (BothResult.GmlIDs.Num() != ExistsResult.GmlIDs.Intersect(GreaterOrEqualResult.GmlIDs).Num()) {
+                FinishTest(false, "Exists && GreaterOrEqual != Intersect");
+                return true;
+            }
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_ModelAdjustmentFilter_FilterByAttributes_Keeps_Child_Surfaces, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.ModelAdjustmentFilter.FilterByAttributes_Keeps_Child_Surfaces",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_ModelAdjustmentFilter_FilterByAttributes_Keeps_Child_Surfaces::RunTest(const FString& Parameters) {
+    InitializeTest("FilterByAttributes_Keeps_Child_Surfaces");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader] {
+        if (Loader->Phase != ECityModelLoadingPhase::Cancelling && Loader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        TArray<AActor*> CityModelActors;
+        UGameplayStatics::GetAllActorsOfClass(Loader->GetWorld(), APLATEAUInstancedCityModel::StaticClass(), CityModelActors);
+        if (CityModelActors.Num() <= 0) {
+            FinishTest(false, "CityModelActors.Num() <= 0");
+            return true;
+        }
+
+        for (auto* CityModelActor : CityModelActors) {
+            APLATEAUInstancedCityModel* CityModel = Cast<APLATEAUInstancedCityModel>(CityModelActor);
+            TArray<UPLATEAUCityObjectGroup*> Components;
+            CityModel->GetComponents<UPLATEAUCityObjectGroup>(Components);
+
+            // 建物(主要地物)が持つ属性キーを条件とする。壁面・屋根面等の最小地物はこの属性を持たない
+            FString BuildingKey;
+            for (const auto& Component : Components) {
+                for (const auto& CityObject : Component->GetAllRootCityObjects()) {
+                    if (CityObject.Type != EPLATEAUCityObjectsType::COT_Building)
+                        continue;
+                    for (const auto& [Key, Value] : CityObject.Attributes.AttributeMap) {
+                        if (Value.Type != EPLATEAUAttributeType::AttributeSets) {
+                            BuildingKey = Key;
+                            break;
+                        }
+                    }
+                    if (!BuildingKey.IsEmpty())
+                        break;
+                }
+                if (!BuildingKey.IsEmpty())
+                    break;
+            }
+            if (BuildingKey.IsEmpty()) {
+                FinishTest(false, "BuildingKey.IsEmpty()");
+                return true;
+            }
+
+            FPLATEAUAttributeCondition Exists;
+            Exists.Key = BuildingKey;
+            Exists.Operator = EPLATEAUAttributeOperator::Exists;
+            const auto Result = CityModel->QueryCityObjectsByAttributes({Exists});
+
+            // 条件を満たす建物と、その子を持つコンポーネント(最小地物のコンポーネントは親のGmlIDで判定)
+            TArray<UPLATEAUCityObjectGroup*> MatchedComponents;
+            for (const auto& Component : Components) {
+                if (!Component->IsVisible())
+                    continue;
+                const auto bParentMatched = !Component->OutsideParent.IsEmpty() && Result.GmlIDs.Contains(Component->OutsideParent);
+                const auto RootCityObjects = Component->GetAllRootCityObjects();
+                const auto bHasChildren = bParentMatched || RootCityObjects.ContainsByPredicate([](const FPLATEAUCityObject& CityObject) {
+                    return CityObject.Children.Num() > 0;
+                });
+                const auto bAllMatched = RootCityObjects.Num() > 0 && !RootCityObjects.ContainsByPredicate([&Result, bParentMatched](const FPLATEAUCityObject& CityObject) {
+                    return !bParentMatched && !Result.GmlIDs.Contains(CityObject.GmlID);
+                });
+                if (bHasChildren && bAllMatched)
+                    MatchedComponents.Add(Component);
+            }
+            if (MatchedComponents.Num() <= 0) {
+                FinishTest(false, "MatchedComponents.Num() <= 0");
+                return true;
+            }
+
+            CityModel->FilterByAttributes({Exists});
+
+            // 子の面も含めて表示されたまま
+            for (const auto& Component : MatchedComponents) {
+                if (!Component->IsVisible()) {
+                    FinishTest(false, FString::Printf(TEXT("%s->IsVisible() == false"), *Component->GetName()));
+                    return true;
+                }
+                if (Component->HasHiddenCityObjects()) {
+                    FinishTest(false, FString::Printf(TEXT("%s->HasHiddenCityObjects() == true"), *Component->GetName()));
+                    return true;
+                }
+            }
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_ModelAdjustmentFilter_FilterByAttributes_After_FeatureTypes, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.ModelAdjustmentFilter.FilterByAttributes_After_FeatureTypes",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_ModelAdjustmentFilter_FilterByAttributes_After_FeatureTypes::RunTest(const FString& Parameters) {
+    InitializeTest("FilterByAttributes_After_FeatureTypes");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto& Loader = GetInstancedCityLoader(*GetWorld());
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader] {
+        if (Loader->Phase != ECityModelLoadingPhase::Cancelling && Loader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        TArray<AActor*> CityModelActors;
+        UGameplayStatics::GetAllActorsOfClass(Loader->GetWorld(), APLATEAUInstancedCityModel::StaticClass(), CityModelActors);
+        if (CityModelActors.Num() <= 0) {
+            FinishTest(false, "CityModelActors.Num() <= 0");
+            return true;
+        }
+
+        for (auto* CityModelActor : CityModelActors) {
+            APLATEAUInstancedCityModel* CityModel = Cast<APLATEAUInstancedCityModel>(CityModelActor);
+
+            // 屋根面のみを非表示にする(主要地物単位でインポートしているため、屋根面は建物のメッシュに結合されている)
+            const auto RoofSurfaceType = UPLATEAUCityObjectBlueprintLibrary::GetTypeAsInt64(EPLATEAUCityObjectsType::COT_RoofSurface);
+            CityModel->FilterByFeatureTypes(static_cast<citygml::CityObject::CityObjectsType>(~RoofSurfaceType));
+
+            // 結合されたメッシュ内で非表示になった都市オブジェクトを記録
+            TArray<TPair<UPLATEAUCityObjectGroup*, FPLATEAUCityObjectIndex>> HiddenCityObjects;
+            FString BuildingKey;
+            TArray<UPLATEAUCityObjectGroup*> Components;
+            CityModel->GetComponents<UPLATEAUCityObjectGroup>(Components);
+            for (const auto& Component : Components) {
+                for (const auto& CityObject : Component->GetAllRootCityObjects()) {
+                    if (BuildingKey.IsEmpty() && CityObject.Type == EPLATEAUCityObjectsType::COT_Building) {
+                        for (const auto& [Key, Value] : CityObject.Attributes.AttributeMap) {
+                            if (Value.Type != EPLATEAUAttributeType::AttributeSets) {
+                                BuildingKey = Key;
+                                break;
+                            }
+                        }
+                    }
+                    if (!Component->IsVisible())
+                        continue;
+                    for (const auto& Child : CityObject.Children) {
+                        if (Component->IsCityObjectHidden(Child.CityObjectIndex))
+                            HiddenCityObjects.Emplace(Component, Child.CityObjectIndex);
+                    }
+                }
+            }
+            if (HiddenCityObjects.Num() <= 0) {
+                FinishTest(false, "HiddenCityObjects.Num() <= 0");
+                return true;
+            }
+            if (BuildingKey.IsEmpty()) {
+                FinishTest(false, "BuildingKey.IsEmpty()");
+                return true;
+            }
+
+            // 建物の属性で絞り込んでも、先に非表示にした屋根面は非表示のまま
+            FPLATEAUAttributeCondition Exists;
+            Exists.Key = BuildingKey;
+            Exists.Operator = EPLATEAUAttributeOperator::Exists;
+            CityModel->FilterByAttributes({Exists});
+            for (const auto& [Component, Index] : HiddenCityObjects) {
+                if (Component->IsVisible() && !Component->IsCityObjectHidden(Index)) {
+                    FinishTest(false, FString::Printf(TEXT("%s (%d, %d) became visible"), *Component->GetName(), Index.PrimaryIndex, Index.AtomicIndex));
+                    return true;
+                }
+            }
+        }
+
+        FinishTest(true, "");
+        return true;
+    }));
+
+    return true;
+}
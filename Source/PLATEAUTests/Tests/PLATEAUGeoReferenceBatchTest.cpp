@@ -0,0 +1,72 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "PLATEAUGeometry.h"
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_GeoReference_Batch_Matches_Single, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.GeoReference.Batch_Matches_Single",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_GeoReference_Batch_Matches_Single::RunTest(const FString& Parameters) {
+    FPLATEAUGeoReference GeoReference;
+    GeoReference.ZoneID = 9;
+    GeoReference.ReferencePoint = FVector(1000.0, -2000.0, 50.0);
+    const auto& NativeData = GeoReference.GetData();
+
+    // 複数スレッドで処理される要素数
+    constexpr int32 NumPoints = 50000;
+    TArray<FVector3f> Points;
+    TArray<FPLATEAUGeoCoordinate> Coordinates;
+    for (int32 i = 0; i < NumPoints; ++i) {
+        Points.Add(FVector3f(i * 1.5f, -i * 0.25f, i % 100));
+        FPLATEAUGeoCoordinate Coordinate;
+        Coordinate.Latitude = 35.6 + i * 1e-6;
+        Coordinate.Longitude = 139.7 + i * 1e-6;
+        Coordinate.Height = i % 100;
+        Coordinates.Add(Coordinate);
+    }
+
+    // 座標軸変換
+    const FVector3d Offset(GeoReference.ReferencePoint);
+    for (const auto To : { plateau::geometry::CoordinateSystem::ENU, plateau::geometry::CoordinateSystem::WUN,
+                           plateau::geometry::CoordinateSystem::ESU, plateau::geometry::CoordinateSystem::EUN }) {
+        TArray<FVector3d> Converted;
+        Converted.SetNumUninitialized(NumPoints);
+        FPLATEAUGeoReference::ConvertAxisBatch(plateau::geometry::CoordinateSystem::ESU, To, Points, Converted, Offset, 0.01);
+
+        for (int32 i = 0; i < NumPoints; ++i) {
+            auto Expected = TVec3d(Points[i].X + Offset.X, Points[i].Y + Offset.Y, Points[i].Z + Offset.Z);
+            Expected = plateau::geometry::GeoReference::convertAxisToENU(plateau::geometry::CoordinateSystem::ESU, Expected);
+            Expected = plateau::geometry::GeoReference::convertAxisFromENUTo(To, Expected);
+            if (!Converted[i].Equals(FVector3d(Expected.x, Expected.y, Expected.z) * 0.01, 1e-9)) {
+                AddError(FString::Printf(TEXT("ConvertAxisBatch mismatch at %d"), i));
+                return false;
+            }
+        }
+    }
+
+    // 投影と逆投影
+    TArray<FVector> Projected;
+    Projected.SetNumUninitialized(NumPoints);
+    GeoReference.ProjectBatch(Coordinates, Projected);
+    TArray<FPLATEAUGeoCoordinate> Unprojected;
+    Unprojected.SetNumUninitialized(NumPoints);
+    GeoReference.UnprojectBatch(Projected, Unprojected);
+
+    for (int32 i = 0; i < NumPoints; ++i) {
+        const auto Expected = NativeData.project(Coordinates[i].GetNativeData());
+        if (!Projected[i].Equals(FVector(Expected.x, Expected.y, Expected.z), 1e-6)) {
+            AddError(FString::Printf(TEXT("ProjectBatch mismatch at %d"), i));
+            return false;
+        }
+
+        const FPLATEAUGeoCoordinate ExpectedCoordinate = NativeData.unproject(Expected);
+        if (Unprojected[i] != ExpectedCoordinate) {
+            AddError(FString::Printf(TEXT("UnprojectBatch mismatch at %d"), i));
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "PLATEAUImportStats.h"
+#include "HAL/FileManager.h"
+#include "Tasks/Task.h"
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_ImportStats_Report, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.ImportStats.Report",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_ImportStats_Report::RunTest(const FString& Parameters) {
+    FPLATEAUGmlLoadStats Stats(TEXT("53392642_bldg_6697_op,\"copy\".gml"));
+
+    // 2つのスレッドで重なって実行された段階は、所要時間の合計が経過時間を超える
+    const auto ConvertMesh = [&Stats] {
+        FPLATEAUImportStageScope Scope(&Stats, EPLATEAUImportStage::ConvertMesh);
+        FPlatformProcess::Sleep(0.2f);
+    };
+    const auto Task = UE::Tasks::Launch(TEXT("ImportStatsTestTask"), ConvertMesh);
+    ConvertMesh();
+    Task.Wait();
+
+    // 終了していない段階は実行中として扱われ、終了後に更新できる
+    Stats.BeginStage(EPLATEAUImportStage::Collision);
+    TestTrue("HasRunningStages", Stats.HasRunningStages());
+    auto Report = Stats.ToReport(true);
+    Stats.EndStage(EPLATEAUImportStage::Collision, 0.5);
+    TestFalse("HasRunningStages after EndStage", Stats.HasRunningStages());
+    Stats.UpdateStageSeconds(Report);
+
+    const auto CpuSumSeconds = Report.GetStageSeconds(EPLATEAUImportStage::ConvertMesh);
+    const auto WallSeconds = Report.GetStageWallSeconds(EPLATEAUImportStage::ConvertMesh);
+    TestTrue("CpuSumSeconds", CpuSumSeconds >= 0.39);
+    TestTrue("WallSeconds", WallSeconds >= 0.19 && WallSeconds < CpuSumSeconds);
+    TestEqual("Collision CpuSumSeconds", Report.GetStageSeconds(EPLATEAUImportStage::Collision), 0.5);
+    TestTrue("ProcessPeakUsedPhysicalMB", Report.ProcessPeakUsedPhysicalMB > 0.0);
+
+    // 区切り文字、引用符を含むGML名は引用符で囲んで出力する
+    const auto BaseFilePath = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/ImportStats/Report"));
+    TestTrue("Write", FPLATEAUImportReportWriter::Write({ Report }, BaseFilePath));
+    TArray<FString> Lines;
+    FFileHelper::LoadFileToStringArray(Lines, *(BaseFilePath + TEXT(".csv")));
+    if (TestEqual("Lines.Num()", Lines.Num(), 2)) {
+        TestTrue("Header", Lines[0].StartsWith(TEXT("GmlName,Succeeded,CopyCpuSumSeconds,CopyWallSeconds,")));
+        TestTrue("Quoted GmlName", Lines[1].StartsWith(TEXT("\"53392642_bldg_6697_op,\"\"copy\"\".gml\",1,")));
+        TArray<FString> HeaderFields;
+        Lines[0].ParseIntoArray(HeaderFields, TEXT(","));
+        TestEqual("Fields", HeaderFields.Num(), 2 + static_cast<int32>(EPLATEAUImportStage::Count) * 2 + 4);
+    }
+
+    IFileManager::Get().DeleteDirectory(*FPaths::GetPath(BaseFilePath), false, true);
+    return true;
+}
@@ -0,0 +1,167 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "Reconstruct/PLATEAUMeshLoaderForLandscape.h"
+#include "PLATEAUTextureLoader.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "HAL/FileManager.h"
+
+#include <plateau/polygon_mesh/model.h>
+
+namespace {
+    //! 格子の間隔(cm)
+    constexpr double GridSpacing = 100.0;
+    //! 地形1つの1辺の長さ(cm)
+    constexpr double TileSize = 1400.0;
+    //! X方向の高さの傾き
+    constexpr double Slope = 0.05;
+
+    /**
+     * @brief 左上、右上、左下、右下の4色で塗り分けた画像をPNGで書き出します。
+     */
+    bool WriteQuadrantTexture(const FString& Path, const int32 Size, const TArray<FColor>& QuadrantColors) {
+        TArray<FColor> Pixels;
+        Pixels.SetNumUninitialized(Size * Size);
+        for (int32 Y = 0; Y < Size; ++Y) {
+            for (int32 X = 0; X < Size; ++X) {
+                Pixels[Y * Size + X] = QuadrantColors[(Y < Size / 2 ? 0 : 2) + (X < Size / 2 ? 0 : 1)];
+            }
+        }
+
+        IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+        const auto ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+        if (!ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Size, Size, ERGBFormat::BGRA, 8))
+            return false;
+        return FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *Path);
+    }
+
+    /**
+     * @brief X方向に傾いた平面の長方形の地形のノードを作成します。
+     * 座標系はESU(Yは南向き)で、テクスチャの上端(Vが1)が北端(Yが最小)となります。
+     */
+    plateau::polygonMesh::Node CreateReliefNode(const std::string& Name, const double MinX, const double MaxX, const double MaxY, const FString& TexturePath) {
+        std::vector<TVec3d> Vertices = {
+            TVec3d(MinX, 0, MinX * Slope), TVec3d(MaxX, 0, MaxX * Slope),
+            TVec3d(MinX, MaxY, MinX * Slope), TVec3d(MaxX, MaxY, MaxX * Slope),
+        };
+        std::vector<unsigned> Indices = { 0, 2, 1, 1, 2, 3 };
+        plateau::polygonMesh::UV UV1 = { TVec2f(0, 1), TVec2f(1, 1), TVec2f(0, 0), TVec2f(1, 0) };
+        plateau::polygonMesh::UV UV4(Vertices.size(), TVec2f(0, 0));
+        auto Mesh = std::make_unique<plateau::polygonMesh::Mesh>(std::move(Vertices), std::move(Indices), std::move(UV1), std::move(UV4),
+            std::vector<plateau::polygonMesh::SubMesh>{}, plateau::polygonMesh::CityObjectList{});
+        Mesh->addSubMesh(TCHAR_TO_UTF8(*TexturePath), nullptr, 0, 5, -1);
+        return plateau::polygonMesh::Node(Name, std::move(Mesh));
+    }
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_Landscape_UnifiedHeightMap, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.Landscape.UnifiedHeightMap",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_Landscape_UnifiedHeightMap::RunTest(const FString& Parameters) {
+    const auto WorkDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/Landscape"));
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+
+    // 東西に隣接する2つの地形。東の地形は南北の長さが半分で、南東に地形の無い隙間ができる
+    const TArray<FColor> WestColors = { FColor::Red, FColor::Green, FColor::Blue, FColor::White };
+    const TArray<FColor> EastColors = { FColor::Yellow, FColor::Cyan, FColor::Magenta, FColor::Orange };
+    const auto WestTexturePath = WorkDir / TEXT("West.png");
+    const auto EastTexturePath = WorkDir / TEXT("East.png");
+    TestTrue("Write West", WriteQuadrantTexture(WestTexturePath, 16, WestColors));
+    TestTrue("Write East", WriteQuadrantTexture(EastTexturePath, 16, EastColors));
+
+    const auto Model = plateau::polygonMesh::Model::createModel();
+    Model->addNode(CreateReliefNode("West", 0, TileSize, TileSize, WestTexturePath));
+    Model->addNode(CreateReliefNode("East", TileSize, TileSize * 2, TileSize / 2, EastTexturePath));
+
+    const auto Actor = GetWorld()->SpawnActor<AActor>();
+    FPLATEAULandscapeParam Param;
+    Param.NumSubsections = 1;
+    Param.SubsectionSizeQuads = 7;
+    Param.UnifiedGridSpacing = GridSpacing;
+    Param.ApplyBlurFilter = false;
+    Param.FillEdges = true;
+    FPLATEAUMeshLoaderForLandscape Loader(true);
+    const auto Results = Loader.CreateUnifiedHeightMap(Actor, Model, Param);
+    Actor->Destroy();
+
+    if (!TestEqual("Results.Num()", Results.Num(), 1))
+        return true;
+    const auto& Result = Results[0];
+    TestEqual("SourceNodeNames.Num()", Result.SourceNodeNames.Num(), 2);
+
+    // 格子の間隔が100cmとなり、ランドスケープコンポーネント(7x7)の境界に揃う
+    const int32 SizeX = Param.TextureWidth;
+    const int32 SizeY = Param.TextureHeight;
+    TestEqual("TextureWidth", SizeX, 29);
+    TestEqual("TextureHeight", SizeY, 15);
+
+    // 2つの地形で共通の高さの範囲
+    TestEqual("Min.z", Result.Min.z, 0.0, 0.01);
+    TestEqual("Max.z", Result.Max.z, TileSize * 2 * Slope, 0.01);
+
+    // 地形のある格子点は継ぎ目(X = 14)を含めて1つの平面上にあり、隙間は最も近い地形の高さで埋められる
+    const auto& Data = *Result.Data;
+    const int32 SeamX = FMath::RoundToInt32(TileSize / GridSpacing);
+    const int32 EastMaxY = FMath::RoundToInt32(TileSize / 2 / GridSpacing);
+    for (int32 Y = 0; Y < SizeY; ++Y) {
+        for (int32 X = 0; X < SizeX; ++X) {
+            const int32 Value = Data[Y * SizeX + X];
+            if (X <= SeamX || Y <= EastMaxY) {
+                const int32 Expected = FMath::RoundToInt32(static_cast<double>(X) / (SizeX - 1) * MAX_uint16);
+                if (FMath::Abs(Value - Expected) > 2) {
+                    AddError(FString::Printf(TEXT("Height mismatch at (%d, %d): %d != %d"), X, Y, Value, Expected));
+                    return true;
+                }
+            } else if (Value < Data[Y * SizeX + SeamX] - 2) {
+                AddError(FString::Printf(TEXT("Gap not filled at (%d, %d): %d"), X, Y, Value));
+                return true;
+            }
+        }
+    }
+
+    // 合成したテクスチャは格子点と1対1で対応し、上端が北となる
+    if (!TestFalse("TexturePath.IsEmpty()", Result.TexturePath.IsEmpty()))
+        return true;
+    TArray64<uint8> Compressed;
+    TArray64<uint8> Pixels;
+    int32 Width, Height;
+    TestTrue("LoadCompressedImage", FPLATEAUTextureLoader::LoadCompressedImage(Result.TexturePath, Compressed, Width, Height));
+    TestTrue("DecompressImage", FPLATEAUTextureLoader::DecompressImage(Compressed, Pixels, Width, Height));
+    IFileManager::Get().Delete(*Result.TexturePath);
+    if (!TestEqual("Composite width", Width, SizeX) || !TestEqual("Composite height", Height, SizeY))
+        return true;
+
+    const auto GetColor = [&](const int32 X, const int32 Y) {
+        const auto Pixel = Pixels.GetData() + (static_cast<int64>(Y) * Width + X) * 4;
+        return FColor(Pixel[2], Pixel[1], Pixel[0], Pixel[3]);
+    };
+    for (int32 Y = 0; Y < SizeY; ++Y) {
+        for (int32 X = 0; X < SizeX; ++X) {
+            const bool bWest = X < SeamX;
+            const bool bEast = X > SeamX && Y < EastMaxY;
+            if (!bWest && !bEast) {
+                // 継ぎ目と隙間はいずれかの地形の色
+                TestTrue(*FString::Printf(TEXT("Filled at (%d, %d)"), X, Y), GetColor(X, Y).A == 255);
+                continue;
+            }
+
+            // 象限の境界の格子点は除く
+            const double U = (X * GridSpacing - (bWest ? 0.0 : TileSize)) / TileSize;
+            const double V = 1.0 - Y * GridSpacing / (bWest ? TileSize : TileSize / 2);
+            if (FMath::Abs(U - 0.5) < 0.05 || FMath::Abs(V - 0.5) < 0.05)
+                continue;
+            const auto& Colors = bWest ? WestColors : EastColors;
+            const auto Expected = Colors[(V >= 0.5 ? 0 : 2) + (U < 0.5 ? 0 : 1)];
+            if (GetColor(X, Y) != Expected) {
+                AddError(FString::Printf(TEXT("Color mismatch at (%d, %d): %s != %s"), X, Y, *GetColor(X, Y).ToString(), *Expected.ToString()));
+                return true;
+            }
+        }
+    }
+
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+    return true;
+}
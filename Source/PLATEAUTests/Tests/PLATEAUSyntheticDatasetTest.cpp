@@ -0,0 +1,341 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "SyntheticDataset/PLATEAUSyntheticDatasetGenerator.h"
+#include "Component/PLATEAUCityObjectGroup.h"
+#include "ModelAdjustment/PLATEAUModelAdjustmentFilterAPI.h"
+#include "EngineUtils.h"
+
+#include <plateau/dataset/dataset_source.h>
+#include <plateau/dataset/gml_file.h>
+
+namespace {
+    const TArray<plateau::dataset::PredefinedCityModelPackage> SyntheticPackages = {
+        plateau::dataset::PredefinedCityModelPackage::Building, plateau::dataset::PredefinedCityModelPackage::Road,
+        plateau::dataset::PredefinedCityModelPackage::CityFurniture, plateau::dataset::PredefinedCityModelPackage::Vegetation,
+        plateau::dataset::PredefinedCityModelPackage::Relief,
+    };
+
+    /**
+     * @brief 生成したデータセットを生成範囲の中心を基準点としてインポート元から直接読み込むローダーを生成します。
+     */
+    APLATEAUCityModelLoader* SpawnSyntheticDatasetLoader(UWorld& World, const FString& OutputDir, const TArray<FString>& MeshCodes) {
+        const auto Loader = World.SpawnActor<APLATEAUCityModelLoader>();
+        Loader->Source = OutputDir;
+        Loader->MeshCodes = MeshCodes;
+        Loader->bImportFromServer = false;
+        Loader->bCopyGmlFiles = false;
+        Loader->ClientPtr = std::make_shared<plateau::network::Client>("", "");
+        Loader->GeoReference.ZoneID = 9;
+        Loader->GeoReference.UpdateNativeData();
+        const auto CenterPoint = Loader->GeoReference.GetData().project(plateau::dataset::MeshCode(TCHAR_TO_UTF8(*MeshCodes[0])).getExtent().centerPoint());
+        Loader->GeoReference.ReferencePoint = FVector(CenterPoint.x, CenterPoint.y, 0);
+        Loader->GeoReference.UpdateNativeData();
+
+        const auto ImportSettings = DuplicateObject(GetMutableDefault<UPLATEAUImportSettings>(), Loader);
+        for (const auto& Package : UPLATEAUImportSettings::GetAllPackages()) {
+            ImportSettings->GetFeatureSettingsRef(Package).bImport = SyntheticPackages.Contains(Package);
+        }
+        Loader->ImportSettings = ImportSettings;
+        return Loader;
+    }
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_SyntheticDataset_Generate_Readable_Dataset, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.SyntheticDataset.Generate_Readable_Dataset",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_SyntheticDataset_Generate_Readable_Dataset::RunTest(const FString& Parameters) {
+    const auto OutputDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/SyntheticDataset"));
+    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+
+    FPLATEAUSyntheticDatasetOptions Options;
+    Options.ThirdMeshCount = 2;
+    Options.BuildingCount = 4;
+    Options.RoadCount = 1;
+    Options.CityFurnitureCount = 1;
+    Options.VegetationCount = 1;
+    Options.ReliefGridCount = 2;
+    TArray<FString> GmlPaths;
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, OutputDir, GmlPaths)) {
+        AddError("Failed to generate synthetic dataset");
+        return false;
+    }
+    TestEqual("GmlPaths.Num()", GmlPaths.Num(), 10);
+
+    const auto DatasetSource = plateau::dataset::DatasetSource::createLocal(TCHAR_TO_UTF8(*OutputDir));
+    const auto DatasetAccessor = DatasetSource.getAccessor();
+    TestEqual("MeshCodes.size()", static_cast<int>(DatasetAccessor->getMeshCodes().size()), 2);
+
+    const auto Packages = DatasetAccessor->getPackages();
+    for (const auto Package : SyntheticPackages) {
+        TestTrue(FString::Printf(TEXT("Package %lld found"), static_cast<int64>(Package)), (Packages & Package) != plateau::dataset::PredefinedCityModelPackage::None);
+    }
+
+    const auto BuildingGmlFiles = DatasetAccessor->getGmlFiles(plateau::dataset::PredefinedCityModelPackage::Building);
+    TestEqual("BuildingGmlFiles.size()", static_cast<int>(BuildingGmlFiles->size()), 2);
+    for (auto& GmlFile : *BuildingGmlFiles) {
+        TestEqual("MaxLod", GmlFile.getMaxLod(), Options.MaxLod);
+    }
+
+    // LOD3では建築物の壁面に窓が追加される
+    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+    Options.ThirdMeshCount = 1;
+    Options.MaxLod = 3;
+    GmlPaths.Reset();
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, OutputDir, GmlPaths)) {
+        AddError("Failed to generate LOD3 synthetic dataset");
+        return false;
+    }
+    const auto Lod3GmlFiles = plateau::dataset::DatasetSource::createLocal(TCHAR_TO_UTF8(*OutputDir)).getAccessor()
+        ->getGmlFiles(plateau::dataset::PredefinedCityModelPackage::Building);
+    for (auto& GmlFile : *Lod3GmlFiles) {
+        TestEqual("Lod3 MaxLod", GmlFile.getMaxLod(), 3);
+        FString Gml;
+        FFileHelper::LoadFileToString(Gml, UTF8_TO_TCHAR(GmlFile.getPath().c_str()));
+        TestTrue("Lod3 Window", Gml.Contains(TEXT("<bldg:Window")));
+    }
+
+    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_SyntheticDataset_LoadAsync_Imports_All_Packages, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.SyntheticDataset.LoadAsync_Imports_All_Packages",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_SyntheticDataset_LoadAsync_Imports_All_Packages::RunTest(const FString& Parameters) {
+    InitializeTest("SyntheticDataset_LoadAsync_Imports_All_Packages");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto OutputDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/SyntheticDatasetImport"));
+    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+
+    FPLATEAUSyntheticDatasetOptions Options;
+    Options.BuildingCount = 4;
+    Options.RoadCount = 1;
+    Options.CityFurnitureCount = 1;
+    Options.VegetationCount = 1;
+    Options.ReliefGridCount = 2;
+    Options.TextureSize = 16;
+    TArray<FString> GmlPaths;
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, OutputDir, GmlPaths)) {
+        AddError("Failed to generate synthetic dataset");
+        return false;
+    }
+
+    // 生成範囲の中心を基準点として、生成した全パッケージをインポート元から直接読み込む
+    const auto Loader = SpawnSyntheticDatasetLoader(*GetWorld(), OutputDir, FPLATEAUSyntheticDatasetGenerator::GetThirdMeshCodes(Options));
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, OutputDir, NumGmls = GmlPaths.Num()] {
+        if (Loader->Phase != ECityModelLoadingPhase::Cancelling && Loader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        const auto Finish = [this, &OutputDir](const bool bSuccess, const FString& Message) {
+            IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+            FinishTest(bSuccess, Message);
+            return true;
+        };
+
+        if (Loader->Status.FailedGmls.Num() > 0)
+            return Finish(false, TEXT("FailedGmls: ") + FString::Join(Loader->Status.FailedGmls, TEXT(", ")));
+        if (Loader->Status.TotalGmlCount != NumGmls)
+            return Finish(false, FString::Printf(TEXT("TotalGmlCount %d != %d"), Loader->Status.TotalGmlCount, NumGmls));
+
+        TArray<AActor*> CityModelActors;
+        UGameplayStatics::GetAllActorsOfClass(Loader->GetWorld(), APLATEAUInstancedCityModel::StaticClass(), CityModelActors);
+        if (CityModelActors.Num() <= 0)
+            return Finish(false, TEXT("CityModelActors.Num() <= 0"));
+
+        // パッケージごとに、都市オブジェクトを持つコンポーネントが生成されている
+        TMap<plateau::dataset::PredefinedCityModelPackage, int32> ComponentCounts;
+        for (const auto CityModelActor : CityModelActors) {
+            const auto CityModel = Cast<APLATEAUInstancedCityModel>(CityModelActor);
+            for (const auto& GmlComponent : CityModel->GetGmlComponents()) {
+                const auto GmlFileName = GmlComponent->GetName() + TEXT(".gml");
+                const auto Package = plateau::dataset::GmlFile(TCHAR_TO_UTF8(*GmlFileName)).getPackage();
+
+                TArray<USceneComponent*> Descendants;
+                GmlComponent->GetChildrenComponents(true, Descendants);
+                for (const auto Descendant : Descendants) {
+                    const auto CityObjectGroup = Cast<UPLATEAUCityObjectGroup>(Descendant);
+                    if (CityObjectGroup != nullptr && CityObjectGroup->GetAllRootCityObjects().Num() > 0)
+                        ++ComponentCounts.FindOrAdd(Package);
+                }
+            }
+        }
+
+        for (const auto Package : SyntheticPackages) {
+            if (ComponentCounts.FindRef(Package) <= 0)
+                return Finish(false, FString::Printf(TEXT("No components for package %lld"), static_cast<int64>(Package)));
+        }
+
+        return Finish(true, TEXT(""));
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_SyntheticDataset_LoadAsync_Splits_Per_Gml, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.SyntheticDataset.LoadAsync_Splits_Per_Gml",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_SyntheticDataset_LoadAsync_Splits_Per_Gml::RunTest(const FString& Parameters) {
+    InitializeTest("SyntheticDataset_LoadAsync_Splits_Per_Gml");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto OutputDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/SyntheticDatasetSplit"));
+    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+
+    FPLATEAUSyntheticDatasetOptions Options;
+    Options.BuildingCount = 2;
+    Options.RoadCount = 1;
+    Options.CityFurnitureCount = 1;
+    Options.VegetationCount = 1;
+    Options.ReliefGridCount = 2;
+    Options.bGenerateTexture = false;
+    TArray<FString> GmlPaths;
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, OutputDir, GmlPaths)) {
+        AddError("Failed to generate synthetic dataset");
+        return false;
+    }
+
+    const auto Loader = SpawnSyntheticDatasetLoader(*GetWorld(), OutputDir, FPLATEAUSyntheticDatasetGenerator::GetThirdMeshCodes(Options));
+    Loader->SplitMode = EPLATEAUCityModelSplitMode::PerGml;
+    Loader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Loader, OutputDir, NumGmls = GmlPaths.Num()] {
+        if (Loader->Phase != ECityModelLoadingPhase::Cancelling && Loader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        const auto Finish = [this, &OutputDir](const bool bSuccess, const FString& Message) {
+            IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+            FinishTest(bSuccess, Message);
+            return true;
+        };
+
+        if (Loader->Status.FailedGmls.Num() > 0)
+            return Finish(false, TEXT("FailedGmls: ") + FString::Join(Loader->Status.FailedGmls, TEXT(", ")));
+
+        // GMLごとにアクタが生成され、ローダーを参照せず共通のIDを持つ
+        TArray<APLATEAUInstancedCityModel*> CellModels;
+        for (TActorIterator<APLATEAUInstancedCityModel> It(Loader->GetWorld()); It; ++It) {
+            CellModels.Add(*It);
+        }
+        if (CellModels.Num() != NumGmls)
+            return Finish(false, FString::Printf(TEXT("CellModels.Num() %d != %d"), CellModels.Num(), NumGmls));
+
+        const auto StreamingGroupId = CellModels[0]->StreamingGroupId;
+        if (!StreamingGroupId.IsValid())
+            return Finish(false, TEXT("StreamingGroupId is invalid"));
+        for (const auto CellModel : CellModels) {
+            if (CellModel->StreamingCellName.IsEmpty())
+                return Finish(false, CellModel->GetActorLabel() + TEXT(": StreamingCellName.IsEmpty()"));
+            if (CellModel->StreamingGroupId != StreamingGroupId)
+                return Finish(false, CellModel->GetActorLabel() + TEXT(": StreamingGroupId mismatch"));
+            if (CellModel->Loader != nullptr)
+                return Finish(false, CellModel->GetActorLabel() + TEXT(": Loader != nullptr"));
+            if (CellModel->GetGmlComponents().Num() != 1)
+                return Finish(false, CellModel->GetActorLabel() + TEXT(": GetGmlComponents().Num() != 1"));
+        }
+
+        // いずれのセルからも同一のインポートの全てのセルを取得でき、フィルタリングは全セルのパッケージを対象とする
+        if (CellModels.Last()->GetStreamingCellCityModels().Num() != NumGmls)
+            return Finish(false, TEXT("GetStreamingCellCityModels().Num() != NumGmls"));
+        if (CellModels.Last()->GetUnloadedStreamingCellCount() != 0)
+            return Finish(false, TEXT("GetUnloadedStreamingCellCount() != 0"));
+        const auto Packages = UPLATEAUModelAdjustmentFilterAPI::GetCityModelPackages(CellModels.Last());
+        for (const auto Package : SyntheticPackages) {
+            if ((Packages & static_cast<int64>(Package)) == 0)
+                return Finish(false, FString::Printf(TEXT("Package %lld not found"), static_cast<int64>(Package)));
+        }
+
+        return Finish(true, TEXT(""));
+    }));
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_SyntheticDataset_LoadAsync_Incremental_Keeps_Other_Packages, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.SyntheticDataset.LoadAsync_Incremental_Keeps_Other_Packages",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_SyntheticDataset_LoadAsync_Incremental_Keeps_Other_Packages::RunTest(const FString& Parameters) {
+    InitializeTest("SyntheticDataset_LoadAsync_Incremental_Keeps_Other_Packages");
+    if (!OpenNewMap())
+        AddError("Failed to OpenNewMap");
+
+    const auto OutputDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/SyntheticDatasetIncremental"));
+    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+
+    FPLATEAUSyntheticDatasetOptions Options;
+    Options.ThirdMeshCount = 2;
+    Options.BuildingCount = 1;
+    Options.RoadCount = 1;
+    Options.CityFurnitureCount = 0;
+    Options.VegetationCount = 0;
+    Options.bGenerateRelief = false;
+    Options.bGenerateTexture = false;
+    TArray<FString> GmlPaths;
+    if (!FPLATEAUSyntheticDatasetGenerator::Generate(Options, OutputDir, GmlPaths)) {
+        AddError("Failed to generate synthetic dataset");
+        return false;
+    }
+
+    const auto MeshCodes = FPLATEAUSyntheticDatasetGenerator::GetThirdMeshCodes(Options);
+    const auto FirstLoader = SpawnSyntheticDatasetLoader(*GetWorld(), OutputDir, MeshCodes);
+    FirstLoader->LoadAsync(true);
+
+    ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, FirstLoader, OutputDir, MeshCodes, SecondLoader = static_cast<APLATEAUCityModelLoader*>(nullptr)]() mutable {
+        const auto Finish = [this, &OutputDir](const bool bSuccess, const FString& Message) {
+            IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+            FinishTest(bSuccess, Message);
+            return true;
+        };
+
+        if (FirstLoader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        TArray<APLATEAUInstancedCityModel*> CityModels;
+        for (TActorIterator<APLATEAUInstancedCityModel> It(FirstLoader->GetWorld()); It; ++It) {
+            CityModels.Add(*It);
+        }
+        if (CityModels.Num() != 1)
+            return Finish(false, FString::Printf(TEXT("CityModels.Num() %d != 1"), CityModels.Num()));
+
+        // 1つ目の3次メッシュの建築物のみを対象に、分割を指定して追加インポートする
+        if (SecondLoader == nullptr) {
+            SecondLoader = SpawnSyntheticDatasetLoader(*FirstLoader->GetWorld(), OutputDir, { MeshCodes[0] });
+            SecondLoader->ImportSettings->GetFeatureSettingsRef(plateau::dataset::PredefinedCityModelPackage::Road).bImport = false;
+            SecondLoader->TargetCityModel = CityModels[0];
+            SecondLoader->SplitMode = EPLATEAUCityModelSplitMode::PerGml;
+            SecondLoader->LoadAsync(true);
+            return false;
+        }
+        if (SecondLoader->Phase != ECityModelLoadingPhase::Finished)
+            return false;
+
+        // 範囲外となった建築物のみ破棄され、対象外とした道路は範囲外でも維持される
+        const auto LoadedGmlNames = CityModels[0]->GetLoadedGmlNames();
+        const TSet<FString> ExpectedGmlNames = {
+            MeshCodes[0] + TEXT("_bldg_6697_op"),
+            MeshCodes[0] + TEXT("_tran_6697_op"),
+            MeshCodes[1] + TEXT("_tran_6697_op"),
+        };
+        if (!LoadedGmlNames.Includes(ExpectedGmlNames) || !ExpectedGmlNames.Includes(LoadedGmlNames))
+            return Finish(false, TEXT("Unexpected GMLs: ") + FString::Join(LoadedGmlNames.Array(), TEXT(", ")));
+
+        return Finish(true, TEXT(""));
+    }));
+
+    return true;
+}
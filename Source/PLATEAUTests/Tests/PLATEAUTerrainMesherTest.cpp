@@ -0,0 +1,81 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "Reconstruct/PLATEAUTerrainMesher.h"
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_TerrainMesher_Simplify, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.TerrainMesher.Simplify",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_TerrainMesher_Simplify::RunTest(const FString& Parameters) {
+    // ブロックの大きさで割り切れない大きさの、丘と平地からなるハイトマップ
+    constexpr int32 SizeX = 83;
+    constexpr int32 SizeY = 57;
+    constexpr double HeightScale = 0.5;
+    constexpr double MaxError = 20.0;
+    TArray<uint16> Heights;
+    Heights.SetNum(SizeX * SizeY);
+    for (int32 Y = 0; Y < SizeY; ++Y) {
+        for (int32 X = 0; X < SizeX; ++X) {
+            const double Distance = FVector2D(X - 30, Y - 20).Size();
+            Heights[Y * SizeX + X] = static_cast<uint16>(1000 + FMath::Max(0.0, 400.0 - Distance * Distance));
+        }
+    }
+
+    const FPLATEAUTerrainMesher Mesher(SizeX, SizeY, Heights.GetData(), HeightScale, 16);
+    const auto Chunks = Mesher.Extract(MaxError, 32);
+    TestEqual("NumChunks", Chunks.Num(), 3 * 2);
+
+    int64 DoubledArea = 0;
+    int32 NumTriangles = 0;
+    TSet<TPair<FIntPoint, FIntPoint>> Edges;
+    for (const auto& Chunk : Chunks) {
+        for (int32 i = 0; i + 2 < Chunk.Indices.Num(); i += 3) {
+            const FIntPoint A = Chunk.Vertices[Chunk.Indices[i]];
+            const FIntPoint B = Chunk.Vertices[Chunk.Indices[i + 1]];
+            const FIntPoint C = Chunk.Vertices[Chunk.Indices[i + 2]];
+            const int32 Cross = (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+            TestTrue("Winding", Cross < 0);
+            DoubledArea -= Cross;
+            ++NumTriangles;
+            Edges.Add({ A, B });
+            Edges.Add({ B, C });
+            Edges.Add({ C, A });
+
+            // 三角形内の格子点で、補間した高さと元の高さの差が許容誤差以内
+            const int32 MinX = FMath::Min3(A.X, B.X, C.X), MaxX = FMath::Max3(A.X, B.X, C.X);
+            const int32 MinY = FMath::Min3(A.Y, B.Y, C.Y), MaxY = FMath::Max3(A.Y, B.Y, C.Y);
+            for (int32 Y = MinY; Y <= MaxY; ++Y) {
+                for (int32 X = MinX; X <= MaxX; ++X) {
+                    const double L0 = ((B.X - X) * (C.Y - Y) - (B.Y - Y) * (C.X - X)) / static_cast<double>(Cross);
+                    const double L1 = ((C.X - X) * (A.Y - Y) - (C.Y - Y) * (A.X - X)) / static_cast<double>(Cross);
+                    const double L2 = 1.0 - L0 - L1;
+                    if (L0 < -UE_KINDA_SMALL_NUMBER || L1 < -UE_KINDA_SMALL_NUMBER || L2 < -UE_KINDA_SMALL_NUMBER)
+                        continue;
+                    const double Interpolated = L0 * Heights[A.Y * SizeX + A.X] + L1 * Heights[B.Y * SizeX + B.X] + L2 * Heights[C.Y * SizeX + C.X];
+                    if (FMath::Abs(Interpolated - Heights[Y * SizeX + X]) * HeightScale > MaxError + UE_KINDA_SMALL_NUMBER) {
+                        AddError(FString::Printf(TEXT("Error exceeds threshold at (%d, %d)"), X, Y));
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    // 隙間・重なりが無くハイトマップ全体を覆い、簡略化されている
+    TestEqual("Area", DoubledArea, static_cast<int64>(2 * (SizeX - 1) * (SizeY - 1)));
+    TestTrue("Simplified", NumTriangles < (SizeX - 1) * (SizeY - 1));
+
+    // 外周以外の辺は逆向きの辺を持つ(T字頂点が無い)
+    for (const auto& [A, B] : Edges) {
+        const bool bOnBorder = (A.X == B.X && (A.X == 0 || A.X == SizeX - 1))
+            || (A.Y == B.Y && (A.Y == 0 || A.Y == SizeY - 1));
+        if (!bOnBorder && !Edges.Contains({ B, A })) {
+            AddError(FString::Printf(TEXT("Crack between (%d, %d) and (%d, %d)"), A.X, A.Y, B.X, B.Y));
+            return true;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,237 @@
+// Copyright © 2023 Ministry of Land, Infrastructure and Transport
+
+#include "PLATEAUAutomationTestBase.h"
+#include "PLATEAUTextureAtlas.h"
+#include "PLATEAUTextureLoader.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include <plateau/polygon_mesh/model.h>
+
+namespace {
+    /**
+     * @brief 左上、右上、左下、右下の4色で塗り分けた画像をPNGで書き出します。
+     */
+    bool WriteQuadrantTexture(const FString& Path, const int32 Width, const int32 Height, const TArray<FColor>& QuadrantColors) {
+        TArray<FColor> Pixels;
+        Pixels.SetNumUninitialized(Width * Height);
+        for (int32 Y = 0; Y < Height; ++Y) {
+            for (int32 X = 0; X < Width; ++X) {
+                Pixels[Y * Width + X] = QuadrantColors[(Y < Height / 2 ? 0 : 2) + (X < Width / 2 ? 0 : 1)];
+            }
+        }
+
+        IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+        const auto ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+        if (!ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Width, Height, ERGBFormat::BGRA, 8))
+            return false;
+        return FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *Path);
+    }
+
+    /**
+     * @brief UVで指定した位置の色が属する象限の番号(左上、右上、左下、右下の順)を返します。UVのVは画像の下端が0です。
+     */
+    int32 GetQuadrant(const TVec2f& UV) {
+        return (UV.y >= 0.5f ? 0 : 2) + (UV.x < 0.5f ? 0 : 1);
+    }
+
+    /**
+     * @brief 四角形1つからなるサブメッシュを追加します。
+     */
+    void AddQuadSubMesh(std::vector<TVec3d>& Vertices, std::vector<unsigned>& Indices, plateau::polygonMesh::UV& UV1,
+                        const TArray<TVec2f>& QuadUVs) {
+        const auto Base = static_cast<unsigned>(Vertices.size());
+        for (int32 i = 0; i < QuadUVs.Num(); ++i) {
+            Vertices.emplace_back(i % 2, i / 2, Base);
+            UV1.push_back(QuadUVs[i]);
+        }
+        for (const auto Index : { 0u, 1u, 2u, 0u, 2u, 3u }) {
+            Indices.push_back(Base + Index);
+        }
+    }
+
+    struct FAtlasTestTexture {
+        FString Path;
+        TArray<FColor> QuadrantColors;
+        TArray<TVec2f> QuadUVs;
+    };
+
+    /**
+     * @brief テクスチャごとに四角形のサブメッシュを1つ持つModelを作成します。
+     */
+    std::shared_ptr<plateau::polygonMesh::Model> CreateAtlasTestModel(const TArray<FAtlasTestTexture>& Textures) {
+        std::vector<TVec3d> Vertices;
+        std::vector<unsigned> Indices;
+        plateau::polygonMesh::UV UV1;
+        for (const auto& Texture : Textures) {
+            AddQuadSubMesh(Vertices, Indices, UV1, Texture.QuadUVs);
+        }
+        plateau::polygonMesh::UV UV4(Vertices.size(), TVec2f(0, 0));
+        auto Mesh = std::make_unique<plateau::polygonMesh::Mesh>(std::move(Vertices), std::move(Indices), std::move(UV1), std::move(UV4),
+            std::vector<plateau::polygonMesh::SubMesh>{}, plateau::polygonMesh::CityObjectList{});
+        for (int32 i = 0; i < Textures.Num(); ++i) {
+            Mesh->addSubMesh(TCHAR_TO_UTF8(*Textures[i].Path), nullptr, i * 6, i * 6 + 5, -1);
+        }
+
+        const auto Model = plateau::polygonMesh::Model::createModel();
+        Model->addNode(plateau::polygonMesh::Node("Node", std::move(Mesh)));
+        return Model;
+    }
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_TextureAtlas_RectPacker, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.TextureAtlas.RectPacker",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_TextureAtlas_RectPacker::RunTest(const FString& Parameters) {
+    FPLATEAURectPacker Packer(1024, 1024);
+
+    // ページより大きい矩形は配置できない
+    int32 Page;
+    FIntPoint Position;
+    TestFalse("TooLarge", Packer.Insert(1025, 16, Page, Position));
+
+    // 同じ大きさの矩形はページを隙間なく埋める
+    TArray<TPair<int32, FIntRect>> Placed;
+    for (int32 i = 0; i < 20; ++i) {
+        TestTrue("Insert", Packer.Insert(256, 256, Page, Position));
+        Placed.Add({ Page, FIntRect(Position, Position + FIntPoint(256, 256)) });
+    }
+    TestEqual("NumPages", Packer.GetNumPages(), 2);
+    TestEqual("Occupancy", Packer.GetOccupancy(), 20.0 / 32.0);
+
+    // 大きさの異なる矩形も重ならずにページ内に配置される
+    for (int32 i = 0; i < 50; ++i) {
+        const int32 Width = 16 + (i * 37) % 200;
+        const int32 Height = 16 + (i * 53) % 150;
+        TestTrue("InsertVarious", Packer.Insert(Width, Height, Page, Position));
+        Placed.Add({ Page, FIntRect(Position, Position + FIntPoint(Width, Height)) });
+    }
+    for (int32 i = 0; i < Placed.Num(); ++i) {
+        const auto& [PageA, RectA] = Placed[i];
+        TestTrue("InsidePage", RectA.Min.X >= 0 && RectA.Min.Y >= 0 && RectA.Max.X <= 1024 && RectA.Max.Y <= 1024);
+        for (int32 j = i + 1; j < Placed.Num(); ++j) {
+            const auto& [PageB, RectB] = Placed[j];
+            const auto bOverlaps = PageA == PageB
+                && RectA.Min.X < RectB.Max.X && RectA.Max.X > RectB.Min.X
+                && RectA.Min.Y < RectB.Max.Y && RectA.Max.Y > RectB.Min.Y;
+            if (bOverlaps) {
+                AddError(FString::Printf(TEXT("Rect %d and %d overlap"), i, j));
+                return true;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FPLATEAUTest_TextureAtlas_Pack, FPLATEAUAutomationTestBase,
+                                        "PLATEAUTest.FPLATEAUTest.TextureAtlas.Pack",
+                                        EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPLATEAUTest_TextureAtlas_Pack::RunTest(const FString& Parameters) {
+    const auto WorkDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("PLATEAUTests/TextureAtlas"));
+    const auto OutputDir = WorkDir / TEXT("Atlases");
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+
+    // 四角形の頂点のUVは各象限の中心
+    const TArray<TVec2f> QuadrantUVs = { TVec2f(0.25f, 0.75f), TVec2f(0.75f, 0.75f), TVec2f(0.25f, 0.25f), TVec2f(0.75f, 0.25f) };
+    const TArray<TVec2f> RepeatUVs = { TVec2f(0.0f, 0.0f), TVec2f(2.0f, 0.0f), TVec2f(0.0f, 2.0f), TVec2f(2.0f, 2.0f) };
+    const TArray<FAtlasTestTexture> Textures = {
+        { WorkDir / TEXT("A.png"), { FColor::Red, FColor::Green, FColor::Blue, FColor::White }, QuadrantUVs },
+        { WorkDir / TEXT("B.png"), { FColor::Yellow, FColor::Cyan, FColor::Magenta, FColor::Black }, QuadrantUVs },
+        { WorkDir / TEXT("Repeat.png"), { FColor::Orange, FColor::Orange, FColor::Orange, FColor::Orange }, RepeatUVs },
+    };
+    TestTrue("Write A", WriteQuadrantTexture(Textures[0].Path, 64, 64, Textures[0].QuadrantColors));
+    TestTrue("Write B", WriteQuadrantTexture(Textures[1].Path, 32, 64, Textures[1].QuadrantColors));
+    TestTrue("Write Repeat", WriteQuadrantTexture(Textures[2].Path, 16, 16, Textures[2].QuadrantColors));
+
+    /**
+     * Modelをアトラス化し、書き換え後のUVでアトラスから取得した色が元のテクスチャの色と一致することを確認します。
+     */
+    const auto PackAndVerify = [&](const int32 PageSize, const int32 Padding, const int32 ExpectedNumPages) {
+        const auto Model = CreateAtlasTestModel(Textures);
+        FPLATEAUTextureAtlasOptions Options;
+        Options.PageSize = PageSize;
+        Options.Padding = Padding;
+        Options.OutputDirectory = OutputDir;
+        Options.NamePrefix = TEXT("Atlas_Test");
+        const auto Result = FPLATEAUTextureAtlas::Pack(*Model, Options);
+
+        const auto Context = FString::Printf(TEXT("PageSize %d: "), PageSize);
+        TestEqual(*(Context + TEXT("NumSourceTextures")), Result.NumSourceTextures, 3);
+        TestEqual(*(Context + TEXT("NumPackedTextures")), Result.NumPackedTextures, 2);
+        TestEqual(*(Context + TEXT("PagePaths.Num()")), Result.PagePaths.Num(), ExpectedNumPages);
+
+        TArray<TArray64<uint8>> PagePixels;
+        TArray<FIntPoint> PageSizes;
+        for (const auto& PagePath : Result.PagePaths) {
+            TArray64<uint8> Compressed;
+            int32 Width, Height;
+            TestTrue(*(Context + TEXT("LoadCompressedImage")), FPLATEAUTextureLoader::LoadCompressedImage(PagePath, Compressed, Width, Height));
+            FPLATEAUTextureLoader::DecompressImage(Compressed, PagePixels.AddDefaulted_GetRef(), Width, Height);
+            PageSizes.Add(FIntPoint(Width, Height));
+        }
+
+        const auto& Mesh = *Model->getAllMeshes()[0];
+        const auto& SubMeshes = Mesh.getSubMeshes();
+        const auto& UV1 = Mesh.getUV1();
+        for (int32 i = 0; i < Textures.Num(); ++i) {
+            const FString TexturePath = UTF8_TO_TCHAR(SubMeshes[i].getTexturePath().c_str());
+            const auto bRepeat = Textures[i].QuadUVs == RepeatUVs;
+            if (bRepeat) {
+                // UVが0～1の範囲外のテクスチャはテクスチャもUVも変更しない
+                TestEqual(*(Context + TEXT("Repeat texture path")), TexturePath, Textures[i].Path);
+                for (int32 j = 0; j < 4; ++j) {
+                    TestTrue(*(Context + TEXT("Repeat UV")), UV1[i * 4 + j].x == RepeatUVs[j].x && UV1[i * 4 + j].y == RepeatUVs[j].y);
+                }
+                continue;
+            }
+
+            const auto Page = Result.PagePaths.IndexOfByKey(TexturePath);
+            if (!TestTrue(*(Context + TEXT("Packed into atlas")), Page != INDEX_NONE && PagePixels[Page].Num() > 0))
+                continue;
+            const auto PageSize2D = PageSizes[Page];
+            for (int32 j = 0; j < 4; ++j) {
+                const auto& UV = UV1[i * 4 + j];
+                const auto X = FMath::Clamp(FMath::FloorToInt(UV.x * PageSize2D.X), 0, PageSize2D.X - 1);
+                const auto Y = FMath::Clamp(FMath::FloorToInt((1.0f - UV.y) * PageSize2D.Y), 0, PageSize2D.Y - 1);
+                const auto Pixel = PagePixels[Page].GetData() + (static_cast<int64>(Y) * PageSize2D.X + X) * 4;
+                const FColor Actual(Pixel[2], Pixel[1], Pixel[0], Pixel[3]);
+                TestTrue(*(Context + FString::Printf(TEXT("Color %d-%d"), i, j)), Actual == Textures[i].QuadrantColors[GetQuadrant(QuadrantUVs[j])]);
+            }
+        }
+        return Result;
+    };
+
+    // 2つのテクスチャが1ページに収まる場合
+    const auto SinglePageResult = PackAndVerify(128, 2, 1);
+
+    // 同じ入力では同じアトラス画像を再利用する
+    const auto SamePageResult = PackAndVerify(128, 2, 1);
+    TestTrue("Reuse page path", SamePageResult.PagePaths == SinglePageResult.PagePaths);
+
+    // 1つのテクスチャでページが埋まる場合はページが追加される
+    const auto MultiPageResult = PackAndVerify(64, 0, 2);
+
+    // 参照されていないアトラス画像のみ削除される
+    TSet<FString> UsedFileNames;
+    for (const auto& PagePath : SinglePageResult.PagePaths) {
+        UsedFileNames.Add(FPaths::GetCleanFilename(PagePath));
+    }
+    TestEqual("DeleteUnusedPages", FPLATEAUTextureAtlas::DeleteUnusedPages(OutputDir, TEXT("Atlas_Test"), UsedFileNames), MultiPageResult.PagePaths.Num());
+    for (const auto& PagePath : SinglePageResult.PagePaths) {
+        TestTrue("Used page exists", FPaths::FileExists(PagePath));
+    }
+    for (const auto& PagePath : MultiPageResult.PagePaths) {
+        TestFalse("Unused page deleted", FPaths::FileExists(PagePath));
+    }
+
+    IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+    return true;
+}